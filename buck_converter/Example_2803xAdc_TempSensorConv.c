@@ -34,15 +34,45 @@
 * Comparator input: GPIO3       (CMP_MOD_2)
 * ADC input:        ADC_CH_B2
 * Pin toggle:       GPIO12
+* UART (TELEMETRY): GPIO28 Rx, GPIO29 Tx   (UART_MOD_1)
+* SPI (SPI_TELEMETRY): GPIO16 SIMO, GPIO18 CLK, GPIO19 STE   (SPI_MOD_1)
+* I2C (PMBUS):      GPIO32 SDA, GPIO33 SCL   (I2C_MOD_1)
+* UART (SHELL):     GPIO28 Rx, GPIO29 Tx   (UART_MOD_1, shared with TELEMETRY)
 *
 * This example project only allows four IO pins to be used.
 *
+* It runs from RAM with csl_28035_RAM_lnk.cmd. To boot stand alone from flash
+* link with csl_28035_FLASH_lnk.cmd instead; see boot.h.
+*
 * LINKS
 ******************************************************************************/
 
 /****************************** INCLUDES SECTION *****************************/
 
 #include "csl.h"
+#include "mpc.h"
+#include "obs.h"
+#include "sched.h"
+#include "ident.h"
+#include "tune.h"
+#include "telem.h"
+#include "spitlm.h"
+#include "pmbus.h"
+#include "shell.h"
+#include "fault.h"
+#include "prot.h"
+#include "sup.h"
+#include "load.h"
+#include "stack.h"
+#include "soft.h"
+#include "dvs.h"
+#include "rail.h"
+#include "blank.h"
+#include "dead.h"
+#include "acm.h"
+#include "avp.h"
+#include "boot.h"
+#include <string.h>
 
 
 /**************************** DECLARATIONS SECTION ***************************/
@@ -65,6 +95,680 @@
 
 #define PERIOD_NS  5000 /*Our period in ns for fs = 200kHz */
 
+
+/* Soft-start of the reference, see soft.h. It ramps for SOFT_RAMP_MS and
+*  then retires, leaving a 4 cycle test in IsrAdc. SOFT_PROFILE selects a
+*  straight ramp, SOFT_LINEAR, or an S-curve, SOFT_SCURVE, which starts and
+*  ends the ramp without a step in the charging current. With SOFT_PREBIAS
+*  the ramp starts from Vo as the ADC last converted it, so a charged output
+*  is not pulled down, at boot and after FltClear.
+*/
+#ifndef SOFT_PROFILE
+#define SOFT_PROFILE SOFT_LINEAR
+#endif
+
+#ifndef SOFT_PREBIAS
+#define SOFT_PREBIAS 0
+#endif
+
+#define SOFT_RAMP_MS    500
+
+
+/* Selects the control law run by IsrAdc.
+*
+* CONTROL_PCM_2P2Z -> peak current mode. The 2p2z sets the comparator DAC and
+*                     the CLA applies slope compensation (default).
+*
+* CONTROL_VM_MPC   -> voltage mode. The explicit MPC in mpc.c sets the PWM1A
+*                     duty directly. The comparator DAC is held at OCP_DAC so
+*                     the cycle by cycle trip only acts as over current
+*                     protection. Regenerate mpc_table.c with tools/mpc_gen.c
+*                     when the power stage changes.
+*
+* CONTROL_VCM_2P2Z -> valley current mode. The action qualifier of PWM1A is
+*                     reversed: the clock at zero turns it off and the
+*                     comparator, inverted, turns it on through the trip
+*                     zone once the current falls to the DAC, so the 420ns
+*                     blanking is the shortest off-time rather than the
+*                     shortest on-time and the duty can go as low as the
+*                     loop asks. The 2p2z sets the valley current and the
+*                     CLA adds a rising ramp, ValleyTask. There is no cycle
+*                     by cycle limit on the peak current: VCM_MAX_DEMAND
+*                     limits the valley, the peak is that plus the ripple.
+*                     The trip state of PWM1A holds for the one-shot trip
+*                     too, so not with FAULT.
+*
+* CONTROL_ACM_CASCADE -> average current mode, see acm.h. An inner loop sets
+*                     the PWM1A duty every cycle from the sampled inductor
+*                     current and MyCntrl, the outer loop, sets its current
+*                     reference from Vo every ACM_DECIMATE cycles. As in
+*                     voltage mode the comparator DAC is held at OCP_DAC.
+*/
+#define CONTROL_PCM_2P2Z    0
+#define CONTROL_VM_MPC      1
+#define CONTROL_VCM_2P2Z    2
+#define CONTROL_ACM_CASCADE 3
+
+#ifndef CONTROL_MODE
+#define CONTROL_MODE CONTROL_PCM_2P2Z
+#endif
+
+/* The comparator trips on the current demand and so closes the loop, rather
+*  than being the over current limit
+*/
+#define TRIP_LOOP   (CONTROL_MODE == CONTROL_PCM_2P2Z || \
+                     CONTROL_MODE == CONTROL_VCM_2P2Z)
+
+#define OCP_DAC     900     /* comparator DAC value used as current limit */
+#define MPC_KI      (0.002) /* feed-forward trim, ticks per count per cycle */
+#define MPC_UFF     (0.275) /* initial feed-forward duty, Vo/Vin */
+
+/* Valley mode needs a ramp steeper than half the difference of the up and
+*  down slopes of the inductor current, (m1 - m2)/2. At 12V in, 1.3V/A and
+*  33uH that is 33 DAC counts per us at 3.3V out and 59 at 1.2V; ValleyTask
+*  gives 60, 3 counts per 50ns step, for 84 steps. The DAC counts per amp are
+*  as in peak current mode, so K stays, but the demand is the valley and the
+*  ramp on top of it must not pass the top of the DAC.
+*/
+#define VCM_K           K
+#define VCM_RAMP        252     /* DAC counts, ValleyTask, 84 x 3 */
+#define VCM_MAX_DEMAND  (MAX_DUTY - VCM_RAMP)
+#define VCM_WAIT_MAX    60      /* polls of MIRUN, ~6 cycles each */
+
+#if (CONTROL_MODE == CONTROL_VCM_2P2Z)
+#define CNTRL_K         VCM_K
+#define CNTRL_MAX       VCM_MAX_DEMAND
+#else
+#define CNTRL_K         K
+#define CNTRL_MAX       MAX_DUTY
+#endif
+
+/* Average current mode. The current is converted by ADC_MOD_4 on ACM_ISENSE,
+*  on the trigger of Vo, so it is sampled 2.45us before the end of the
+*  period rather than averaged; the outer loop's integrator takes up the
+*  difference. With ACM_INNER_CLA the inner loop is a CLA task, CurrentTask,
+*  started by ADCINT2 at the end of that conversion, and costs the CPU
+*  nothing; otherwise IsrAdc is called at the end of it instead of at the end
+*  of Vo and runs it. ACM_INNER_ORDER is 1 for a 1p1z, 2 for a 2p2z. The outer
+*  loop is always MyCntrl on the CPU, so the soft-start, PMBUS, SHELL and DVS
+*  act on its reference as before; DVS adds no feed-forward here.
+*
+*  The ACM_CYCLES_ are the CPU cycles of each part, see acm.h, and
+*  ACM_CPU_BUDGET what the control law may take of IsrAdc per cycle on
+*  average, about what the 2p2z and the DAC write of peak current mode take;
+*  set them on the command line for a changed build. An inner loop on the CPU
+*  with no decimation goes over.
+*
+*  The coefficients are from tools/acm_sim.c, see doc/average_current.txt:
+*  the inner loop crosses over at 15kHz and the outer at 4kHz, 2.5kHz with a
+*  decimation of 4 and 1.25kHz with 8. ACM_MAX_DUTY is a literal for the CLA.
+*/
+#ifndef ACM_INNER_CLA
+#define ACM_INNER_CLA   1
+#endif
+
+#ifndef ACM_INNER_ORDER
+#define ACM_INNER_ORDER 2
+#endif
+
+#ifndef ACM_DECIMATE
+#define ACM_DECIMATE    4       /* cycles per outer loop run */
+#endif
+
+#ifndef ACM_CYCLES_1P1Z
+#define ACM_CYCLES_1P1Z     35
+#endif
+
+#ifndef ACM_CYCLES_2P2Z
+#define ACM_CYCLES_2P2Z     70
+#endif
+
+#ifndef ACM_CYCLES_OUTER
+#define ACM_CYCLES_OUTER    85      /* ACM_update() on an outer cycle */
+#endif
+
+#ifndef ACM_CYCLES_UPDATE
+#define ACM_CYCLES_UPDATE   6       /* ACM_update() otherwise */
+#endif
+
+#ifndef ACM_CPU_BUDGET
+#define ACM_CPU_BUDGET      100
+#endif
+
+#define ACM_ISENSE      ADC_CH_A4   /* set for the board's current sense */
+#define ACM_IMAX        3630        /* ADC counts, about 2.25A at 1.3V/A */
+#define ACM_MAX_DUTY    180.0       /* ticks, 60% */
+#define ACM_I_K         1.0
+#define ACM_V_K         1.0
+
+#define ACM_I1_A1   +1.00000000
+#define ACM_I1_B0   +0.04787915
+#define ACM_I1_B1   -0.04255230
+#define ACM_I2_A1   +1.02961280
+#define ACM_I2_A2   -0.02961280
+#define ACM_I2_B0   +0.02397251
+#define ACM_I2_B1   +0.00266709
+#define ACM_I2_B2   -0.02130542
+
+#if (ACM_INNER_ORDER == 1)
+#define ACM_I_A1    ACM_I1_A1
+#define ACM_I_A2    0.0
+#define ACM_I_B0    ACM_I1_B0
+#define ACM_I_B1    ACM_I1_B1
+#define ACM_I_B2    0.0
+#define ACM_CYCLES_INNER    ACM_CYCLES_1P1Z
+#else
+#define ACM_I_A1    ACM_I2_A1
+#define ACM_I_A2    ACM_I2_A2
+#define ACM_I_B0    ACM_I2_B0
+#define ACM_I_B1    ACM_I2_B1
+#define ACM_I_B2    ACM_I2_B2
+#define ACM_CYCLES_INNER    ACM_CYCLES_2P2Z
+#endif
+
+#if (ACM_DECIMATE == 1)
+#define ACM_V_A1    +1.59830271
+#define ACM_V_A2    -0.59830271
+#define ACM_V_B0    +1.24319987
+#define ACM_V_B1    +0.03845227
+#define ACM_V_B2    -1.20474760
+#elif (ACM_DECIMATE == 2)
+#define ACM_V_A1    +1.33097766
+#define ACM_V_A2    -0.33097766
+#define ACM_V_B0    +2.10353772
+#define ACM_V_B1    +0.12814343
+#define ACM_V_B2    -1.97539429
+#elif (ACM_DECIMATE == 4)
+#define ACM_V_A1    +1.22826091
+#define ACM_V_A2    -0.22826091
+#define ACM_V_B0    +1.71275262
+#define ACM_V_B1    +0.12943632
+#define ACM_V_B2    -1.58331629
+#elif (ACM_DECIMATE == 8)
+#define ACM_V_A1    +1.22826091
+#define ACM_V_A2    -0.22826091
+#define ACM_V_B0    +0.96482961
+#define ACM_V_B1    +0.07291421
+#define ACM_V_B2    -0.89191540
+#elif (CONTROL_MODE == CONTROL_ACM_CASCADE)
+#error ACM_DECIMATE is 1, 2, 4 or 8, the decimations tools/acm_sim.c designs
+#endif
+
+/* Average CPU cycles of the cascade per control cycle */
+#define ACM_CPU_CYCLES  ((ACM_INNER_CLA ? 0 : ACM_CYCLES_INNER) + \
+                         ACM_CYCLES_UPDATE + ACM_CYCLES_OUTER/ACM_DECIMATE)
+
+
+/* Minimal context ISR, see IsrAdcFast. When enabled IsrAdc runs the
+*  soft-start and then hands the interrupt to IsrAdcFast, which only acks,
+*  reads the ADC, runs CNTRL_2p2zInline() and writes the DAC, saving XAR7 and
+*  XT. None of the per cycle options below can run in it; OBSERVER defaults
+*  to off.
+*
+*  With ISR_BENCH both ISRs store the PWM1 counter, in CPU cycles, in
+*  IsrDacTicks[] as they write the DAC and in IsrEndTicks[] as they finish:
+*  [0] for IsrAdc during the soft-start, [1] for IsrAdcFast after it. See
+*  doc/fast_isr.txt. With CONTROL_VM_MPC, MpcTicks and MpcTicksMax hold the
+*  last and the longest MPC_run(). See doc/timing.txt.
+*/
+#ifndef FAST_ISR
+#define FAST_ISR 0
+#endif
+
+#ifndef ISR_BENCH
+#define ISR_BENCH 0
+#endif
+
+
+/* Multi-rail runtime, see rail.h. With RAILS at 2 or 3 the device runs that
+*  many peak current mode rails in place of IsrAdc: rail 1 on PWM1A and
+*  comparator 2 as the single rail, rail 2 on PWM2A and comparator 1 and
+*  rail 3 on PWM3A and comparator 3, all at RAIL_PERIOD_NS with the
+*  coefficients below, each with its own 2p2z, CLA slope task and ADC
+*  interrupt. The on-time ends with the 60 step slope, at 33%, see rail.h.
+*  Rail 2 powers up RAIL2_DELAY_MS after rail 1 is good and down
+*  the same before it; rail 3 tracks rail 1 ratiometrically. Setting RailsOn
+*  from the debugger powers them up or down, and MyRails.m_Out[].m_Share,
+*  m_Slack and m_Late are the cycle budget of each rail, m_Total of all.
+*  If the slope tasks do not fit their turns the rails stay off with
+*  MyRails.m_State at RAIL_UNFIT and m_Fault the rail at fault.
+*  None of the per cycle options can run alongside; OBSERVER defaults to off.
+*/
+#ifndef RAILS
+#define RAILS 1
+#endif
+
+#define RAIL_PERIOD_NS  10000   /* 600 cycles, ~140 per rail ISR */
+#define RAIL_ISR_EXTRA  41      /* RAIL_isr1..3 entry, prologue, epilogue */
+#define RAIL_RAMP_MS    20
+#define RAIL2_DELAY_MS  5
+#define RAIL2_REF       1241    /* ADC counts, set for the board's divider */
+#define RAIL2_VOUT      ADC_CH_B1
+#define RAIL3_REF       1500
+#define RAIL3_VOUT      ADC_CH_B3
+
+/* The 2p2z of the rails, from tools/pcm_design.c for the 200kHz stage at
+*  100kHz, 3.3ohm and the 60 step slope cut off at its end:
+*    pcm_design -fs 100e3 -steps 60 -maxd 0.328 -fc 7.5e3
+*  7.5kHz and 45 degrees at 3.3ohm, 44 degrees at 6.6ohm. The single rail's
+*  coefficients at 100kHz would cross at 12kHz with 19 degrees.
+*/
+#define RAIL_A1 +1.04321392
+#define RAIL_A2 -0.04321392
+#define RAIL_B0 +4.79740558
+#define RAIL_B1 -3.07810705
+#define RAIL_B2 +0.49374307
+
+
+/* Current observer, see obs.h. Set OBSERVER to 0 to save its ~55 cycles.
+*  The constants are generated by tools/obs_sim.c for L = 33uH, C = 100uF and
+*  a current sense gain of 1.3V/A; regenerate them if the power stage changes.
+*  The estimates are in comparator DAC counts.
+*/
+#ifndef OBSERVER
+#define OBSERVER    (CONTROL_MODE == CONTROL_PCM_2P2Z && !FAST_ISR && \
+                     RAILS == 1)
+#endif
+
+#if (OBSERVER && CONTROL_MODE != CONTROL_PCM_2P2Z)
+#error OBSERVER takes the 2p2z output as the peak current demand
+#endif
+
+#define OBS_KV      (0.07697947)
+#define OBS_A       (0.50000000)
+#define OBS_L1      (0.40000000)
+#define OBS_L2      (0.15588571)
+#define OBS_L3      (-0.62354286)
+#define OBS_OFFSET  101
+
+
+/* Gain scheduling of the 2p2z, see sched.h. When enabled the coefficients are
+*  chosen from MyBanks by the observed load current, checked every
+*  SCHED_DECIMATE cycles. Conduction is discontinuous under about half the
+*  0.36A ripple, 0.18A, but the 2p2z above holds its margins down to about
+*  50mA. Below that the inductor is empty when the ADC samples, the sampled
+*  Vo loses the lead of the capacitor's ESR and the phase margin falls, to
+*  28 degrees at 40mA. The light load bank is from
+*
+*      tools/pcm_design -r 100 -fc 1.7e3 -pm 60 -fp 4e3
+*
+*  designed at 33mA and checked with -check from 25mA to 150mA, 51 to 100
+*  degrees with the cross over from 1.6kHz to 3.6kHz. Under 20mA the
+*  converter skips pulses. The windows change to it under 60mA, 24 counts,
+*  and back over 100mA, 40 counts.
+*/
+#ifndef GAIN_SCHEDULE
+#define GAIN_SCHEDULE 0
+#endif
+
+#if (GAIN_SCHEDULE && !OBSERVER)
+#error GAIN_SCHEDULE needs the observer for its operating point
+#endif
+
+#define SCHED_DECIMATE  8
+
+#define SCHED_A1        +1.88191138     /* light load, K of 0.5 */
+#define SCHED_A2        -0.88191138
+#define SCHED_B0        +4.66914305
+#define SCHED_B1        -8.81811465
+#define SCHED_B2        +4.16345918
+#define SCHED_LO        24              /* DAC counts of Io, 60mA */
+#define SCHED_HI        40              /* 100mA */
+
+
+/* On-target plant identification, see ident.h. When enabled, setting IdRequest
+*  to true from the debugger after the soft-start has finished starts a run:
+*  a +/-ID_AMP count PRBS is added to the reference and the idle loop fits a
+*  model of the power stage. Pass the resulting MyId.m_Theta[] to
+*  tools/ident_design.c to get new coefficients.
+*/
+#ifndef PLANT_ID
+#define PLANT_ID 0
+#endif
+
+#if (PLANT_ID && CONTROL_MODE != CONTROL_PCM_2P2Z)
+#error PLANT_ID identifies the peak current mode loop
+#endif
+
+#define ID_AMP          32      /* PRBS amplitude, ADC counts */
+#define ID_HOLD         2       /* cycles per PRBS bit */
+#define ID_SAMPLES      4000    /* samples per run */
+#define ID_PER_PASS     4       /* samples per idle loop pass */
+
+
+/* Relay feedback autotuner, see tune.h. When enabled, setting TuneRequest to
+*  true from the debugger replaces the 2p2z by a relay for a few hundred
+*  cycles and then loads coefficients designed for TUNE_FC and TUNE_PM.
+*/
+#ifndef AUTOTUNE
+#define AUTOTUNE 0
+#endif
+
+#if (AUTOTUNE && CONTROL_MODE != CONTROL_PCM_2P2Z)
+#error AUTOTUNE tunes the peak current mode loop
+#endif
+
+#if (AUTOTUNE && GAIN_SCHEDULE)
+#error AUTOTUNE and GAIN_SCHEDULE would both write the 2p2z coefficients
+#endif
+
+#define TUNE_FC         10e3    /* cross over, Hz */
+#define TUNE_PM         45.0    /* phase margin, degrees */
+#define TUNE_FP         50e3    /* high frequency pole, Hz */
+#define TUNE_D          40      /* relay amplitude, DAC counts */
+#define TUNE_HYST       2       /* relay hysteresis, ADC counts */
+#define TUNE_SKIP       4       /* oscillation periods to settle */
+#define TUNE_PERIODS    16      /* oscillation periods to average */
+
+
+/* Telemetry over UART_MOD_1, see telem.h. When enabled, Fdbk, Out and the
+*  soft-started Ref are streamed every TLM_DECIMATE cycles. Setting TlmArm to
+*  true from the debugger takes a full rate capture around the next time Fdbk
+*  falls through TLM_LEVEL, e.g. a load step, sends it and goes back to
+*  streaming.
+*/
+#ifndef TELEMETRY
+#define TELEMETRY 0
+#endif
+
+#define TLM_BAUD        115200
+#define TLM_DECIMATE    (CPU_LOAD && STACK_MON ? 250 : 200)    /* per record */
+#define TLM_LEVEL       2008    /* trigger, ADC counts, 2% under REF */
+#define TLM_PRE         25      /* records before the trigger */
+#define TLM_POST        100     /* records from the trigger on */
+
+
+/* High rate telemetry over SPI_MOD_1, see spitlm.h. When enabled, Fdbk and
+*  the DAC demand are streamed every STLM_DECIMATE cycles to a logger on the
+*  SPI pins; reassemble the capture with tools/spitlm_recv.c. For one channel
+*  at the full 200kHz remove the second channel and set STLM_DECIMATE to 1.
+*
+*  With STLM_LOOPBACK the SPI is put in loopback and the Tx ISR checks its own
+*  stream with the receiver: MySpiRx.m_Blocks should follow MySpiTlm.m_Blocks
+*  with m_Errors at 0 and m_Lost equal to MySpiTlm.m_Dropped.
+*/
+#ifndef SPI_TELEMETRY
+#define SPI_TELEMETRY 0
+#endif
+
+#ifndef STLM_LOOPBACK
+#define STLM_LOOPBACK 0
+#endif
+
+#define STLM_BAUD       3750000 /* fastest with LSPCLK at 15MHz */
+#define STLM_DECIMATE   2       /* cycles per sample, 100kHz */
+
+
+/* PMBus style slave on I2C_MOD_1, see pmbus.h. When enabled a system
+*  controller can turn the output on and off through the soft-start, set the
+*  output within +/-10% of REF and read back Vout and the status at up to
+*  400kHz without stopping the loop.
+*/
+#ifndef PMBUS
+#define PMBUS 0
+#endif
+
+#define PMB_ADDRESS     0x40
+#define PMB_VOUT_MIN    1843    /* ADC counts, REF - 10% */
+#define PMB_VOUT_MAX    2253    /* ADC counts, REF + 10% */
+
+
+/* Command shell on UART_MOD_1, see shell.h. When enabled a terminal at
+*  TLM_BAUD, 8N1, can read and write the loop variables, turn the output on and
+*  off through the soft-start, set the reference between PMB_VOUT_MIN and
+*  PMB_VOUT_MAX and restart the soft-start with a new ramp time; type help.
+*  With TELEMETRY the two share the UART: telemetry starts off and is run with
+*  the tlm command, and the shell's echo and replies are held while it sends,
+*  although commands such as "tlm stop" are still carried out.
+*/
+#ifndef SHELL
+#define SHELL 0
+#endif
+
+
+/* Dynamic voltage scaling, see dvs.h. When enabled a new Vout from PMBus or
+*  the shell slews the reference at DVS_RATE ADC counts per ms, about 1.6V/ms,
+*  instead of stepping it, and in current mode DVS_KFF feeds the current that
+*  charges the output capacitor at that rate forward to the DAC, so the loop
+*  does not overshoot the new Vout. A new Vout mid-ramp takes over at once.
+*  With SHELL the command slew sets the rate. Needs PMBUS or SHELL.
+*/
+#ifndef DVS
+#define DVS 0
+#endif
+
+#if (DVS && !(PMBUS || SHELL))
+#error DVS slews the Vout set by PMBUS or SHELL
+#endif
+
+#define DVS_RATE        1000    /* ADC counts per ms */
+#define DVS_KFF         13      /* DAC counts per count/cycle, 1/OBS_KV */
+
+
+/* Adaptive voltage positioning, see avp.h. When enabled the reference the
+*  loop sees is lowered by AVP_MOHM times the load current, so that Vout sits
+*  on a load line and a load step takes about half the window, or the same
+*  window with less output capacitance. The current is the observer's
+*  estimate of the load in peak current mode and the sampled inductor current
+*  in average current mode, the last cycle's with the inner loop on the CLA;
+*  the voltage modes have none. The droop stops at AVP_MAX_DROOP, inside the
+*  power good window. The soft-start, PMBUS, SHELL and DVS set the reference
+*  as before and the droop comes off what they set. With SHELL the avp
+*  command sets the slope.
+*/
+#ifndef AVP
+#define AVP 0
+#endif
+
+#define AVP_MOHM        25      /* load line, mOhm, 50mV at 2A */
+#define AVP_MAX_DROOP   36      /* ADC counts of Vo, 58mV */
+#define AVP_KV          620.5   /* ADC counts per volt of Vo */
+
+#if (CONTROL_MODE == CONTROL_ACM_CASCADE)
+#define AVP_KI          1613.2  /* ADC counts per amp, ACM_ISENSE */
+#define AVP_IO          ADC_getValue(ADC_MOD_4)
+#else
+#define AVP_KI          403.0   /* DAC counts per amp, the observer's Io */
+#define AVP_IO          OBS_getIo(&MyObs)
+#endif
+
+#if (AVP && !(OBSERVER || CONTROL_MODE == CONTROL_ACM_CASCADE))
+#error AVP needs the load current, from OBSERVER or the average current loop
+#endif
+
+#if (AVP && (PLANT_ID || AUTOTUNE))
+#error AVP moves the reference that PLANT_ID and AUTOTUNE measure against
+#endif
+
+#if (AVP && (PMBUS || SHELL) && AVP_MAX_DROOP >= PMB_PG_WINDOW)
+#error AVP_MAX_DROOP takes the output out of the power good window
+#endif
+
+
+/* Adaptive leading edge blanking, see blank.h. When enabled the 420ns window
+*  of PWM1 is set from the current demand, BLANK_MIN_NS with none up to
+*  BLANK_FULL_NS at MAX_DUTY, and widened while trips within BLANK_GUARD_NS
+*  of its end look like ringing, never outside BLANK_MIN_NS..BLANK_MAX_NS.
+*  At light load this gives back on-time to high step-down ratios.
+*  MyBlank.m_Window is the window in ticks and m_SpuriousTotal the count of
+*  trips taken as ringing.
+*/
+#ifndef ADAPTIVE_BLANK
+#define ADAPTIVE_BLANK 0
+#endif
+
+#if (ADAPTIVE_BLANK && CONTROL_MODE != CONTROL_PCM_2P2Z)
+#error ADAPTIVE_BLANK follows the current demand of peak current mode
+#endif
+
+#define BLANK_MIN_NS    200
+#define BLANK_FULL_NS   500
+#define BLANK_MAX_NS    700     /* must end before IsrAdc starts */
+#define BLANK_GUARD_NS  100
+
+
+/* Synchronous rectifier, see dead.h. When enabled PWM1B no longer marks the
+*  ADC trigger on the pin but drives the low side FET as the complement of
+*  PWM1A through the dead band, and is turned on by the peak current trip.
+*  The dead band starts at SYNC_DEAD_NS and, once the soft-start is up, is
+*  moved within SYNC_DEAD_MIN_NS..SYNC_DEAD_MAX_NS to the shortest on-time,
+*  the least loss; MyDead.m_Ticks is where it is. SYNC_DEAD_MIN_NS must cover
+*  the turn off of the low side FET, and the gate driver must keep its own
+*  dead time at the trip. See doc/dead_time.txt for the gain on a loss model.
+*  The trip state of PWM1B holds for the one-shot trip too, so not with FAULT.
+*/
+#ifndef SYNC_RECT
+#define SYNC_RECT 0
+#endif
+
+#if (SYNC_RECT && CONTROL_MODE != CONTROL_PCM_2P2Z)
+#error SYNC_RECT turns the low side on at the peak current trip
+#endif
+
+#define SYNC_DEAD_NS        100
+#define SYNC_DEAD_MIN_NS    17
+#define SYNC_DEAD_MAX_NS    170
+
+
+/* Debounced protection on top of the fault trip, see prot.h. When enabled Vo
+*  above PROT_OV_LEVEL or, once the soft-start is up, below PROT_UV_LEVEL and
+*  the peak current demand above PROT_OC_LEVEL trip PWM1 after the given
+*  number of consecutive cycles, as do the internal temperature sensor,
+*  converted by SOC1 on ADCINA5, above PROT_TEMP_C for PROT_TEMP_US and, with
+*  PROT_VIN, the input voltage on PROT_VIN_CH outside PROT_VIN_MIN..MAX.
+*  MyProt.m_Log holds the last trips with their time in us from CPU timer 1,
+*  which runs free as the time base. Needs FAULT, which it turns on by
+*  default.
+*/
+#ifndef PROTECT
+#define PROTECT 0
+#endif
+
+#ifndef PROT_VIN
+#define PROT_VIN 0
+#endif
+
+#define PROT_OV_LEVEL   2294    /* ADC counts, REF + 12% */
+#define PROT_OV_CYCLES  4
+#define PROT_UV_LEVEL   1638    /* ADC counts, REF - 20% */
+#define PROT_UV_CYCLES  100     /* 500us */
+#define PROT_OC_LEVEL   800     /* DAC counts, peak demand, about 2A */
+#define PROT_OC_CYCLES  40      /* 200us */
+#define PROT_TEMP_C     110     /* degrees C */
+#define PROT_TEMP_US    10000
+#define PROT_VIN_CH     ADC_CH_A1
+#define PROT_VIN_MIN    1500    /* ADC counts, set for the board's divider */
+#define PROT_VIN_MAX    2600
+#define PROT_VIN_US     1000
+
+
+/* Watchdog supervisor, see sup.h. When enabled the idle loop kicks the
+*  watchdog only while IsrAdc runs every cycle and, in current mode, the CLA
+*  slope task runs and ends every cycle. Otherwise PWM1 trips within
+*  SUP_DEADLINE_US, MySup.m_Cause says why, and the watchdog resets the
+*  device. Off by default, as stepping through code with the debugger stops
+*  the kicks. Needs FAULT, which it turns on by default.
+*/
+#ifndef WATCHDOG
+#define WATCHDOG 0
+#endif
+
+#define SUP_DEADLINE_US 200     /* 40 control cycles */
+
+
+/* CPU load meter, see load.h. When enabled CPU timer 2 counts SYSCLKOUT and,
+*  once a second and in 0.01%, MyLoad.m_Load is the share of the CPU not left
+*  to the idle loop, m_Peak its highest value and m_IsrShare the share of
+*  IsrAdc; m_Passes is the idle loop rate. With SHELL they are the variables
+*  load, peak and isr, and with TELEMETRY the load is channel 3.
+*/
+#ifndef CPU_LOAD
+#define CPU_LOAD 0
+#endif
+
+#define LOAD_ISR_EXTRA  41      /* IsrAdc entry, prologue and epilogue */
+
+
+/* Stack monitor, see stack.h. When enabled the stack is filled with the tide
+*  mark at boot and MyStk.m_Used is the most of it ever used, in words, with
+*  SHELL the variable stack and with TELEMETRY the last channel; the stream
+*  slows to 800Hz with CPU_LOAD as well. Fewer than STK_GUARD words left trips
+*  PWM1. Needs FAULT, which it turns on by default.
+*/
+#ifndef STACK_MON
+#define STACK_MON 0
+#endif
+
+#define STK_GUARD       32      /* words */
+
+
+/* Latched fault trip of PWM1, see fault.h. When enabled Fdbk above FLT_OVP
+*  trips PWM1 one-shot, as does the comparator in voltage mode, and IsrFault,
+*  in PIE group 2, nests inside IsrAdc once it has read the ADC. Setting
+*  FltClear to true from the debugger restarts the output through the
+*  soft-start. Calling FLT_test(&MyFlt), or setting MyFlt.m_OvpLevel to -1,
+*  trips it from the start of IsrAdc and MyFlt.m_LatencyMax gives the cycles
+*  to IsrFault; see doc/fault_latency.txt.
+*/
+#ifndef FAULT
+#define FAULT (PROTECT || WATCHDOG || STACK_MON)
+#endif
+
+#if (PROTECT && !FAULT)
+#error PROTECT trips PWM1 through the fault module
+#endif
+
+#if (SYNC_RECT && FAULT)
+#error SYNC_RECT would hold PWM1B, the low side, on at a one-shot trip
+#endif
+
+#if (CONTROL_MODE == CONTROL_VCM_2P2Z && FAULT)
+#error CONTROL_VCM_2P2Z would hold PWM1A, the high side, on at a one-shot trip
+#endif
+
+#if (CONTROL_MODE == CONTROL_ACM_CASCADE && ACM_CPU_CYCLES > ACM_CPU_BUDGET)
+#error CONTROL_ACM_CASCADE is over ACM_CPU_BUDGET, decimate or use the CLA
+#endif
+
+#if (WATCHDOG && !FAULT)
+#error WATCHDOG trips PWM1 through the fault module
+#endif
+
+#if (STACK_MON && !FAULT)
+#error STACK_MON trips PWM1 through the fault module
+#endif
+
+#define FLT_OVP         2458    /* ADC counts, REF + 20% */
+
+/* Interrupt groups let in by ISRs that allow IsrAdc to nest */
+#define NEST_IER        ((1 << INT_GROUP_10) | (FAULT ? 1 << INT_GROUP_2 : 0))
+
+#if (FAST_ISR && CONTROL_MODE != CONTROL_PCM_2P2Z)
+#error FAST_ISR is the peak current mode 2p2z loop only
+#endif
+
+#if (FAST_ISR && (OBSERVER || GAIN_SCHEDULE || PLANT_ID || AUTOTUNE || \
+                  TELEMETRY || SPI_TELEMETRY || PMBUS || SHELL || FAULT || \
+                  PROTECT || WATCHDOG || CPU_LOAD || ADAPTIVE_BLANK || \
+                  SYNC_RECT))
+#error FAST_ISR leaves no room for per cycle work in the ADC interrupt
+#endif
+
+#if (RAILS < 1 || RAILS > RAIL_MAX)
+#error RAILS is 1 to 3, one comparator per rail
+#endif
+
+#if (RAILS > 1 && (FAST_ISR || ISR_BENCH || CONTROL_MODE != CONTROL_PCM_2P2Z))
+#error RAILS runs peak current mode rails in place of IsrAdc
+#endif
+
+#if (RAILS > 1 && (OBSERVER || GAIN_SCHEDULE || PLANT_ID || AUTOTUNE || \
+                   TELEMETRY || SPI_TELEMETRY || PMBUS || SHELL || FAULT || \
+                   PROTECT || WATCHDOG || CPU_LOAD || ADAPTIVE_BLANK || \
+                   SYNC_RECT))
+#error RAILS leaves the options of IsrAdc, which it does not run
+#endif
+
 /************************** POST DECLARATIONS SECTION ************************/
 
 /* Data align memory before instantiating a 2p2z controller. */
@@ -75,6 +779,296 @@
 CNTRL_2p2zData MyCntrl;
 
 
+/* Ramps the reference of MyCntrl */
+SOFT_Data MySoft;
+
+
+#if (CONTROL_MODE == CONTROL_VM_MPC)
+/* Voltage mode explicit MPC. The 2p2z structure above is still initialised so
+* that its soft-start ramps the reference that the MPC follows.
+*/
+MPC_Data MyMpc;
+#endif
+
+
+#if (CONTROL_MODE == CONTROL_ACM_CASCADE)
+/* The cascade, with MyCntrl the outer loop. While the fault module holds the
+* ePWM tripped the inner loop's reference is 0, so it does not wind up far,
+* and CntrlReset() clears it before the ePWM is let go.
+*/
+ACM_Data MyAcm;
+
+#if FAULT
+#define ACM_HOLD    (&MyFlt.m_Tripped)
+#else
+#define ACM_HOLD    0
+#endif
+
+#if (!ACM_INNER_CLA && ACM_INNER_ORDER == 1)
+ACM_1p1zData MyInner;
+#elif !ACM_INNER_CLA
+#pragma DATA_ALIGN ( MyInner , 64 );
+CNTRL_2p2zData MyInner;
+#endif
+#endif
+
+#if (FAULT && (CONTROL_MODE == CONTROL_VM_MPC || \
+               CONTROL_MODE == CONTROL_ACM_CASCADE))
+/* FLT_clear() clears the history of MyCntrl only. CntrlReset() resets the
+* rest of the control, the MPC or the cascade's inner loop, which wind up
+* while PWM1 is tripped.
+*/
+#define CNTRL_RESET     1
+static void CntrlReset( void );
+#else
+#define CNTRL_RESET     0
+#endif
+
+
+#if OBSERVER
+/* Estimated inductor and load current, for use by load dependent features.
+* Read them with OBS_getIL(&MyObs) and OBS_getIo(&MyObs).
+*/
+OBS_Data MyObs;
+#endif
+
+
+#if GAIN_SCHEDULE
+/* Banks in order of load current. The windows overlap for hysteresis. */
+const SCHED_Bank MyBanks[2] =
+{
+    SCHED_BANK( SCHED_A1, SCHED_A2, SCHED_B0, SCHED_B1, SCHED_B2, 0.5,
+                -32768, SCHED_HI ),                         /* light */
+    SCHED_BANK( A1, A2, B0, B1, B2, K, SCHED_LO, 32767 )
+};
+
+SCHED_Data MySched;
+#endif
+
+
+#if PLANT_ID
+ID_Data MyId;
+volatile bool IdRequest = false;
+#endif
+
+
+#if AUTOTUNE
+TUNE_Data MyTune;
+volatile bool TuneRequest = false;
+#endif
+
+
+#if TELEMETRY
+TLM_Data MyTlm;
+volatile bool TlmArm = false;
+#endif
+
+
+#if SPI_TELEMETRY
+STLM_Data MySpiTlm;
+#if STLM_LOOPBACK
+STLM_Rx MySpiRx;
+#endif
+#endif
+
+
+#if CPU_LOAD
+LOAD_Data MyLoad;
+#endif
+
+
+#if STACK_MON
+STK_Data MyStk;
+#endif
+
+
+#if (PMBUS || SHELL)
+/* Without PMBUS the shell uses the same on/off and Vout logic, I2C unused */
+PMB_Data MyPmb;
+#endif
+
+
+#if ADAPTIVE_BLANK
+BLANK_Data MyBlank;
+#endif
+
+
+#if SYNC_RECT
+DEAD_Data MyDead;
+#endif
+
+
+#if DVS
+DVS_Data MyDvs;
+#endif
+
+
+#if AVP
+AVP_Data MyAvp;
+#endif
+
+
+#if SHELL
+static void CmdStat( SH_Data* Ptr, int Argc, char** Argv );
+static void CmdOn( SH_Data* Ptr, int Argc, char** Argv );
+static void CmdOff( SH_Data* Ptr, int Argc, char** Argv );
+static void CmdRef( SH_Data* Ptr, int Argc, char** Argv );
+static void CmdSoftStart( SH_Data* Ptr, int Argc, char** Argv );
+#if AVP
+static void CmdAvp( SH_Data* Ptr, int Argc, char** Argv );
+#endif
+#if DVS
+static void CmdSlew( SH_Data* Ptr, int Argc, char** Argv );
+#endif
+#if TELEMETRY
+static void CmdTlm( SH_Data* Ptr, int Argc, char** Argv );
+#endif
+#if SPI_TELEMETRY
+static void CmdStlm( SH_Data* Ptr, int Argc, char** Argv );
+#endif
+
+const SH_Command MyCmds[] =
+{
+    { "stat", CmdStat,      "show the loop state" },
+    { "on",   CmdOn,        "soft-start up" },
+    { "off",  CmdOff,       "soft-start down" },
+    { "ref",  CmdRef,       "ref <counts>, set the output" },
+    { "ss",   CmdSoftStart, "ss <ms>, restart the soft-start" },
+#if AVP
+    { "avp",  CmdAvp,       "avp [<mohm>], show or set the load line" },
+#endif
+#if DVS
+    { "slew", CmdSlew,      "slew <counts/ms>, set the DVS rate" },
+#endif
+#if TELEMETRY
+    { "tlm",  CmdTlm,       "tlm [stream|arm|stop]" },
+#endif
+#if SPI_TELEMETRY
+    { "stlm", CmdStlm,      "show the SPI telemetry counters" },
+#endif
+};
+
+/* The coefficients are written with one store and used from the next cycle.
+*  With GAIN_SCHEDULE, SCHED_update() loads the active bank of MyBanks over
+*  a1..k every SCHED_DECIMATE cycles whether or not the bank changes, so they
+*  are read-only; min and max are not in the banks.
+*/
+#if GAIN_SCHEDULE
+#define SH_COEF         SH_RO_IQ
+#else
+#define SH_COEF         SH_IQ
+#endif
+
+const SH_Var MyVars[] =
+{
+#if (CONTROL_MODE == CONTROL_VM_MPC)
+    SH_RO_INT( "fdbk", MyMpc.Fdbk.m_Int ),
+    SH_RO_INT( "out",  MyMpc.Out.m_Int ),
+#else
+    SH_RO_INT( "fdbk", MyCntrl.Fdbk.m_Int ),
+    SH_RO_INT( "out",  MyCntrl.Out.m_Int ),
+#endif
+    SH_RO_INT( "ref",  MyCntrl.Ref.m_Int ),
+    SH_COEF(   "a1",   MyCntrl.m_A1, 26 ),
+    SH_COEF(   "a2",   MyCntrl.m_A2, 26 ),
+    SH_COEF(   "b0",   MyCntrl.m_B0, 26 ),
+    SH_COEF(   "b1",   MyCntrl.m_B1, 26 ),
+    SH_COEF(   "b2",   MyCntrl.m_B2, 26 ),
+    SH_COEF(   "k",    MyCntrl.m_K,  23 ),
+    SH_IQ(     "min",  MyCntrl.m_min, 15 ),
+    SH_IQ(     "max",  MyCntrl.m_max, 15 ),
+#if CPU_LOAD
+    SH_RO_INT( "load", MyLoad.m_Load ),
+    SH_INT(    "peak", MyLoad.m_Peak ),
+    SH_RO_INT( "isr",  MyLoad.m_IsrShare ),
+#endif
+#if STACK_MON
+    SH_RO_INT( "stack", MyStk.m_Used ),
+#endif
+#if DVS
+    SH_RO_INT( "slew", MyPmb.m_SlewRate ),
+#endif
+#if AVP
+    SH_RO_INT( "droop", MyAvp.m_Droop ),
+#endif
+};
+
+SH_Data MyShell;
+#endif
+
+
+#if FAULT
+FLT_Data MyFlt;
+volatile bool FltClear = false;
+#endif
+
+
+#if PROTECT
+PROT_Data MyProt;
+#endif
+
+
+#if WATCHDOG
+SUP_Data MySup;
+#endif
+
+
+#if (RAILS > 1)
+/* MyCntrl is rail 1; the others are aligned the same way */
+#pragma DATA_ALIGN ( MyCntrl2 , 64 );
+#pragma DATA_ALIGN ( MyCntrl3 , 64 );
+CNTRL_2p2zData MyCntrl2;
+CNTRL_2p2zData MyCntrl3;
+
+RAIL_Data MyRails;
+volatile bool RailsOn = true;
+
+/* The CLA runs one slope task at a time, so each must end within its turn,
+*  a third of the 600 cycle period: 280ns to start and 60 steps of 3 cycles.
+*  The steps are given twice, as CLA_slopeCode() only takes literals.
+*/
+CLA_slopeCode( RailSlope1, 2,1, -1.0, 60 );
+CLA_slopeCode( RailSlope2, 1,2, -1.0, 60 );
+CLA_slopeCode( RailSlope3, 3,3, -1.0, 60 );
+
+const RAIL_Config MyRailCfg[3] =
+{
+    { PWM_MOD_1, CMP_MOD_2, ADC_CH_B2,  &RailSlope1, 60,
+      (int)_IQ15(REF), RAIL_RAMP_MS, 0,              RAIL_NONE },
+    { PWM_MOD_2, CMP_MOD_1, RAIL2_VOUT, &RailSlope2, 60,
+      RAIL2_REF,       RAIL_RAMP_MS, RAIL2_DELAY_MS, RAIL_NONE },
+    { PWM_MOD_3, CMP_MOD_3, RAIL3_VOUT, &RailSlope3, 60,
+      RAIL3_REF,       RAIL_RAMP_MS, 0,              0 }
+};
+
+static void RailsMain( void );
+#endif
+
+
+#if FAST_ISR
+interrupt void IsrAdcFast( void );
+#endif
+
+
+#if ISR_BENCH
+/* PWM1 counter at the DAC write and at the end, [0] IsrAdc, [1] IsrAdcFast */
+volatile int IsrDacTicks[2];
+volatile int IsrEndTicks[2];
+
+#if (CONTROL_MODE == CONTROL_VM_MPC)
+/* CPU cycles of the last and of the longest MPC_run() */
+volatile int MpcTicks;
+volatile int MpcTicksMax;
+#endif
+
+#if GAIN_SCHEDULE
+/* CPU cycles of the last and of the longest SCHED_update() */
+volatile int SchedTicks;
+volatile int SchedTicksMax;
+#endif
+#endif
+
+
 /* This macro generates CLA assembly code called SlopeTask, which implements
 * slope compensation by subtracting a slope, of user defined gradient, from
 * the demand value of the current before it is fed to the comparator.
@@ -100,6 +1094,37 @@ CNTRL_2p2zData MyCntrl;
 */
 CLA_slopeCode( SlopeTask, 2,1, -1.0, 80 );
 
+#if (CONTROL_MODE == CONTROL_VCM_2P2Z)
+/* The same for valley current mode, ValleyTask, but adding 3 every step, the
+* ramp on the valley demand. The 84 steps end at about 4.56us, just before
+* IsrAdc writes the DAC for the next cycle, so the ramp holds its last value
+* rather than falling back while a short on-time is still to start. The
+* write comes at about 4.7us, too close to rely on, so IsrAdc waits for the
+* task to end first. Keep VCM_RAMP at the product of the two.
+*/
+CLA_slopeCode( ValleyTask, 2,1, +3.0, 84 );
+#endif
+
+#if (CONTROL_MODE == CONTROL_VCM_2P2Z)
+/* Control cycles in which IsrAdc found ValleyTask still running */
+volatile uint16_t ValleyWaits;
+#endif
+
+#if (CONTROL_MODE == CONTROL_ACM_CASCADE && ACM_INNER_CLA)
+/* The inner loop of average current mode, CurrentTask: the 2p2z of the CLA on
+* the current, ADC_MOD_4, setting the duty of PWM1 with K 1.0 in 0 to
+* ACM_MAX_DUTY ticks. It ends about 0.65us after the current conversion, well
+* before CMPA loads at zero.
+*/
+ACM_claInner( CurrentTask, 4, 1, ACM_I_A1, ACM_I_A2, ACM_I_B0, ACM_I_B1,
+              ACM_I_B2, ACM_I_K, 0.0, ACM_MAX_DUTY );
+
+#if CNTRL_RESET
+/* CurrentReset, task 8, clears the history of CurrentTask for CntrlReset() */
+ACM_claReset( CurrentReset, CurrentTask );
+#endif
+#endif
+
 /****************************** FUNCTIONS SECTION ****************************/
 
 /******************************************************************************
@@ -107,8 +1132,15 @@ CLA_slopeCode( SlopeTask, 2,1, -1.0, 80 );
 * DESCRIPTION   :
 * This interrupt is called when the ADC sequencer has finished sampling.
 ******************************************************************************/
+#pragma CODE_SECTION( IsrAdc, "hotfuncs" );
 interrupt void IsrAdc( void )
 {
+#if CPU_LOAD
+    /* First and last, so the stamps take in the whole body; 5 cycles on the
+    *  fault latency of doc/fault_latency.txt
+    */
+    LOAD_enter( &MyLoad );
+#endif
 
     /* Sets GPIO pin 12 tied to TZ test pin on hardware */
     GPIO_set( GPIO_12);
@@ -117,13 +1149,78 @@ interrupt void IsrAdc( void )
      /* Ack group and ADC SEQ interrupt. Re-enable the ADC interrupts -Int1 */
      ADC_ackInt( ADC_INT_1 );
 
+#if FAULT
+    /* Over voltage is checked first; from here on only the fault interrupt
+    *  may nest, so its latency does not depend on the control law below
+    */
+    FLT_checkOvp( &MyFlt, ADC_getValue( ADC_MOD_1 ) );
+    IER &= 1 << INT_GROUP_2;
+    EINT;
+#endif
+
+#if WATCHDOG
+    /* Before the control law, about 3.4us into the cycle, while the CLA
+    *  slope task, from 0.3us to 4.3us, must still be running: 0.9us of
+    *  margin, which code added above this line takes from, see sup.h
+    */
+    SUP_beat( &MySup );
+#endif
+
+
+#if AVP
+    /* The control law sees the reference less the droop, put back after it */
+    AVP_apply( &MyAvp, AVP_IO );
+#endif
 
     /* These three lines read the ADC, call the 2p2z control loop & then update
     *  the duty cycle respectively.
     */
+#if (CONTROL_MODE == CONTROL_VM_MPC)
+    MyMpc.Ref.m_Int  = MyCntrl.Ref.m_Int;
+    MyMpc.Fdbk.m_Int = ADC_getValue(ADC_MOD_1);
+#if ISR_BENCH
+    MpcTicks = EPwm1Regs.TBCTR;
+    MPC_run(&MyMpc);
+    MpcTicks = EPwm1Regs.TBCTR - MpcTicks;
+    if( MpcTicks > MpcTicksMax )
+    {
+        MpcTicksMax = MpcTicks;
+    }
+#else
+    MPC_run(&MyMpc);
+#endif
+    PWM_setDutyA( PWM_MOD_1, MyMpc.Out.m_Int );
+#elif (CONTROL_MODE == CONTROL_ACM_CASCADE)
+    /* The inner loop, unless on the CLA, sets the duty of the next cycle; the
+    *  outer loop then sets its reference, every ACM_DECIMATE cycles
+    */
+#if (!ACM_INNER_CLA && ACM_INNER_ORDER == 1)
+    MyInner.m_Fdbk = ADC_getValue(ADC_MOD_4);
+    ACM_1p1z(&MyInner);
+    PWM_setDutyA( PWM_MOD_1, MyInner.m_Out );
+#elif !ACM_INNER_CLA
+    MyInner.Fdbk.m_Int = ADC_getValue(ADC_MOD_4);
+    CNTRL_2p2z(&MyInner);
+    PWM_setDutyA( PWM_MOD_1, MyInner.Out.m_Int );
+#endif
     MyCntrl.Fdbk.m_Int = ADC_getValue(ADC_MOD_1);
+    ACM_update( &MyAcm );
+#else
+    MyCntrl.Fdbk.m_Int = ADC_getValue(ADC_MOD_1);
+#if AUTOTUNE
+    if( TUNE_isRelay( &MyTune ) )
+    {
+        TUNE_relay( &MyTune, &MyCntrl );
+    }
+    else
+#endif
     CNTRL_2p2z(&MyCntrl);
 
+#if DVS
+    /* Adds the capacitor charging current while the reference slews */
+    DVS_feedForward( &MyDvs, MyCntrl.Out.m_Int, CNTRL_MAX );
+#endif
+
 
     /* This inputs the "initial" value of the demand current (from the 2p2z)
     * controller to the DAC of the comparator. i.e. the demand current before
@@ -131,16 +1228,614 @@ interrupt void IsrAdc( void )
     * comparator 2. This initial DAC value will later get updated by
     * the CLAs slope compensation algorithm
     */
+#if (CONTROL_MODE == CONTROL_VCM_2P2Z)
+    /* A write while ValleyTask runs would be undone by its next step, so
+    *  wait for it to end; the polls are bounded in case it never does
+    */
+    if( Cla1Regs.MIRUN.all & (1 << CLA_MOD_1) )
+    {
+        uint16_t Polls = VCM_WAIT_MAX;
+
+        ValleyWaits++;
+        while( (Cla1Regs.MIRUN.all & (1 << CLA_MOD_1)) && --Polls )
+        {
+        }
+    }
+#endif
     CMP_setDac( CMP_MOD_2, MyCntrl.Out.m_Int );
 
+#if ISR_BENCH
+    IsrDacTicks[0] = EPwm1Regs.TBCTR;
+#endif
+
+#if PLANT_ID
+    ID_push( &MyId, MyCntrl.Out.m_Int, MyCntrl.Fdbk.m_Int );
+#endif
+
+#if AUTOTUNE
+    /* A newly tuned set is loaded here, between two control cycles */
+    TUNE_update( &MyTune, &MyCntrl );
+#endif
+#endif
+
+#if AVP
+    AVP_restore( &MyAvp );
+#endif
+
+
+#if OBSERVER
+    /* The DAC is already updated, so the observer is off the critical path */
+    OBS_update( &MyObs, MyCntrl.Fdbk.m_Int, MyCntrl.Out.m_Int );
+#endif
+
+
+#if GAIN_SCHEDULE
+    /* Any new bank is loaded here, between two runs of the 2p2z */
+#if ISR_BENCH
+    SchedTicks = EPwm1Regs.TBCTR;
+    SCHED_update( &MySched, OBS_getIo( &MyObs ) );
+    SchedTicks = EPwm1Regs.TBCTR - SchedTicks;
+    if( SchedTicks > SchedTicksMax )
+    {
+        SchedTicksMax = SchedTicks;
+    }
+#else
+    SCHED_update( &MySched, OBS_getIo( &MyObs ) );
+#endif
+#endif
+
+
+#if SYNC_RECT
+    /* The on-time of this cycle, for the dead time optimiser. It comes first
+    *  as BLANK_update() clears the trip flag that both read.
+    */
+    DEAD_update( &MyDead );
+#endif
+
+
+#if ADAPTIVE_BLANK
+    /* The window has long ended, so a new one is written between two */
+    BLANK_update( &MyBlank );
+#endif
+
+
+#if PROTECT
+    /* Off the critical path as well. The peak current demand stands for the
+    *  current and is in the same data page as Fdbk, which keeps this to about
+    *  9 cycles; in voltage and average current mode the comparator is the
+    *  over current trip.
+    */
+#if (CONTROL_MODE == CONTROL_VM_MPC)
+    PROT_check( &MyProt, MyMpc.Fdbk.m_Int, 0 );
+#elif !TRIP_LOOP
+    PROT_check( &MyProt, MyCntrl.Fdbk.m_Int, 0 );
+#else
+    PROT_check( &MyProt, MyCntrl.Fdbk.m_Int, MyCntrl.Out.m_Int );
+#endif
+#endif
+
+
+#if TELEMETRY
+    TLM_sample( &MyTlm );
+#endif
+
+#if SPI_TELEMETRY
+    STLM_sample( &MySpiTlm );
+#endif
+
     
     /* Clears GPIO12 pin */
     GPIO_clr( GPIO_12);
 
 
-     /* Sets up soft-start*/
-     CNTRL_2p2zSoftStartUpdate(&MyCntrl);
+    /* Steps the soft-start while it ramps, a test of MySoft.m_Active once
+    *  the reference is up
+    */
+    SOFT_update( &MySoft );
+
+#if DVS
+    /* Moves the set point towards a new VOUT_COMMAND, ~3 cycles once there */
+    DVS_update( &MyDvs );
+#endif
+
+#if (PMBUS || SHELL)
+    /* OPERATION and VOUT_COMMAND act on the soft-started reference */
+    PMB_update( &MyPmb, &MySoft );
+#endif
+
+#if PLANT_ID
+    /* Applied after the soft-start so that it sets the next reference */
+    MyCntrl.Ref.m_Int = ID_excite( &MyId, MyCntrl.Ref.m_Int );
+#endif
+
+#if FAST_ISR
+    /* The reference is up, from the next cycle on IsrAdcFast runs the loop */
+    if( MyCntrl.m_SoftRef == MyCntrl.m_SoftMax )
+    {
+        ADC_setCallback( ADC_MOD_1, IsrAdcFast, ADC_INT_1 );
+    }
+#endif
+
+#if ISR_BENCH
+    IsrEndTicks[0] = EPwm1Regs.TBCTR;
+#endif
+
+#if FAULT
+    DINT;
+#endif
+
+#if CPU_LOAD
+    LOAD_exit( &MyLoad );
+#endif
+}
+
+
+#if FAULT
+/******************************************************************************
+* FUNCTION      : IsrFault
+* DESCRIPTION   :
+* This interrupt is called when PWM1 latches its one-shot trip. It is in PIE
+* group 2, above the ADC, and nests inside IsrAdc and the ISRs that allow
+* IsrAdc to nest.
+******************************************************************************/
+#pragma CODE_SECTION( IsrFault, "hotfuncs" );
+interrupt void IsrFault( void )
+{
+    FLT_event( &MyFlt );
+}
+#endif
+
+
+#if CNTRL_RESET
+/******************************************************************************
+* FUNCTION      : CntrlReset
+* DESCRIPTION   :
+* Called by FLT_clear() with interrupts off and PWM1 still tripped. Puts the
+* MPC, or the cascade and its inner loop, back to where they started.
+******************************************************************************/
+static void CntrlReset( void )
+{
+#if (CONTROL_MODE == CONTROL_VM_MPC)
+    MPC_reset( &MyMpc );
+#else
+    ACM_reset( &MyAcm );
+#if ACM_INNER_CLA
+    /* The CPU cannot write the CLA's data; CurrentTask may run first */
+    CLA_softwareStartWait( CLA_MOD_8 );
+#elif (ACM_INNER_ORDER == 1)
+    ACM_1p1zReset( &MyInner );
+#else
+    MyInner.m_U1 = 0;
+    MyInner.m_U2 = 0;
+    MyInner.m_E0 = 0;
+    MyInner.m_E1 = 0;
+    MyInner.m_E2 = 0;
+#endif
+#endif
 }
+#endif
+
+
+#if FAST_ISR
+/******************************************************************************
+* FUNCTION      : IsrAdcFast
+* DESCRIPTION   :
+* IsrAdc cut down to the control path and written in assembler, so that only
+* the registers it uses are saved. The CPU already saves ACC, P, T, DP, AR0,
+* AR1, ST0 and ST1 on entry; CNTRL_2p2zInline() also uses XAR7 and the low
+* half of XT, so only those two are pushed, not the full context of a C
+* interrupt function. The idle loop, the only code it interrupts, runs with
+* the product shift at 0, which the ADDL ACC,P of the 2p2z relies on.
+*
+* MyCntrl is DATA_ALIGNed to 64 words so the 2p2z needs one DP for all of it.
+* GPIO_12 is pulsed as in IsrAdc, for the scope.
+******************************************************************************/
+asm("        .global _IsrAdcFast"
+    "\t\n    .global _AdcRegs, _AdcResult, _PieCtrlRegs, _Comp2Regs"
+    "\t\n    .global _GpioDataRegs, _MyCntrl"
+    "\t\n    .sect   \"hotfuncs\""
+    "\n_IsrAdcFast:"
+    "\t\n    PUSH    XAR7"
+    "\t\n    PUSH    XT"
+    "\t\n    SPM     0"
+    "\t\n    MOVW    DP, #_GpioDataRegs+2"
+    "\t\n    MOV     @_GpioDataRegs+2, #0x1000   ;GPIO_set(GPIO_12)"
+    "\t\n    MOVW    DP, #_AdcRegs+5"
+    "\t\n    MOV     @_AdcRegs+5, #0x0001        ;ADCINTFLGCLR, ADCINT1"
+    "\t\n    MOVW    DP, #_PieCtrlRegs+1"
+    "\t\n    MOV     @_PieCtrlRegs+1, #0x0200    ;PIEACK, group 10"
+    "\t\n    MOVW    DP, #_AdcResult+0"
+    "\t\n    MOV     AL, @_AdcResult+0           ;ADCRESULT0"
+    "\t\n    MOVW    DP, #_MyCntrl+2"
+    "\t\n    MOV     @_MyCntrl+2, AL             ;(Fdbk)"
+    );
+CNTRL_2p2zInline( MyCntrl );
+asm("        MOVW    DP, #_Comp2Regs+6           ;AL = (Out)"
+    "\t\n    MOV     @_Comp2Regs+6, AL           ;CMP_setDac(CMP_MOD_2)"
+#if ISR_BENCH
+    "\t\n    .global _EPwm1Regs, _IsrDacTicks, _IsrEndTicks"
+    "\t\n    MOVW    DP, #_EPwm1Regs+4"
+    "\t\n    MOV     AL, @_EPwm1Regs+4           ;TBCTR"
+    "\t\n    MOVW    DP, #_IsrDacTicks+1"
+    "\t\n    MOV     @_IsrDacTicks+1, AL"
+#endif
+    "\t\n    MOVW    DP, #_GpioDataRegs+4"
+    "\t\n    MOV     @_GpioDataRegs+4, #0x1000   ;GPIO_clr(GPIO_12)"
+#if ISR_BENCH
+    "\t\n    MOVW    DP, #_EPwm1Regs+4"
+    "\t\n    MOV     AL, @_EPwm1Regs+4"
+    "\t\n    MOVW    DP, #_IsrEndTicks+1"
+    "\t\n    MOV     @_IsrEndTicks+1, AL"
+#endif
+    "\t\n    POP     XT"
+    "\t\n    POP     XAR7"
+    "\t\n    IRET"
+    "\t\n    .text"
+    );
+#endif
+
+
+#if (TELEMETRY || SHELL)
+/******************************************************************************
+* FUNCTION      : IsrUartTx
+* DESCRIPTION   :
+* This interrupt is called when the UART Tx FIFO is empty. IsrAdc is allowed
+* to interrupt it so that telemetry never delays the control loop; IER is
+* restored from the interrupt context on return. Telemetry has the UART while
+* it runs and the shell has it otherwise.
+******************************************************************************/
+#pragma CODE_SECTION( IsrUartTx, "hotfuncs" );
+interrupt void IsrUartTx( void )
+{
+    IER &= NEST_IER;
+    EINT;
+
+#if (TELEMETRY && SHELL)
+    if( TLM_isDone( &MyTlm ) )
+    {
+        SH_drain( &MyShell );
+    }
+    else
+    {
+        TLM_drain( &MyTlm );
+    }
+#elif TELEMETRY
+    TLM_drain( &MyTlm );
+#else
+    SH_drain( &MyShell );
+#endif
+
+    DINT;
+    UART_ackTxInt( UART_MOD_1 );
+}
+#endif
+
+
+#if SHELL
+/******************************************************************************
+* FUNCTION      : IsrUartRx
+* DESCRIPTION   :
+* This interrupt is called for each character received. It is in PIE group 9,
+* above the ADC, so IsrAdc is allowed to interrupt it.
+******************************************************************************/
+#pragma CODE_SECTION( IsrUartRx, "hotfuncs" );
+interrupt void IsrUartRx( void )
+{
+    IER &= NEST_IER;
+    EINT;
+
+    SH_rx( &MyShell );
+
+    DINT;
+    UART_ackRxInt( UART_MOD_1 );
+}
+
+
+/******************************************************************************
+* FUNCTION      : CmdStat
+* DESCRIPTION   :
+* Shell command, prints the loop state and the shell's own counters.
+******************************************************************************/
+static void CmdStat( SH_Data* Ptr, int Argc, char** Argv )
+{
+    SH_puts( Ptr, MyPmb.m_On ? "on, vout " : "off, vout " );
+    SH_putInt( Ptr, MyPmb.m_Vout );
+    SH_puts( Ptr, ", ref " );
+    SH_putInt( Ptr, MyCntrl.Ref.m_Int );
+#if (CONTROL_MODE == CONTROL_VM_MPC)
+    SH_puts( Ptr, ", fdbk " );
+    SH_putInt( Ptr, MyMpc.Fdbk.m_Int );
+    SH_puts( Ptr, ", out " );
+    SH_putInt( Ptr, MyMpc.Out.m_Int );
+#else
+    SH_puts( Ptr, ", fdbk " );
+    SH_putInt( Ptr, MyCntrl.Fdbk.m_Int );
+    SH_puts( Ptr, ", out " );
+    SH_putInt( Ptr, MyCntrl.Out.m_Int );
+#endif
+    SH_puts( Ptr, "\r\nstatus " );
+    SH_putInt( Ptr, MyPmb.m_Status );
+    SH_puts( Ptr, ", rx dropped " );
+    SH_putInt( Ptr, Ptr->m_RxDropped );
+    SH_puts( Ptr, ", tx dropped " );
+    SH_putInt( Ptr, Ptr->m_TxDropped );
+    SH_puts( Ptr, "\r\n" );
+}
+
+
+/******************************************************************************
+* FUNCTION      : CmdOn, CmdOff
+* DESCRIPTION   :
+* Shell commands, soft-start the output up or down.
+******************************************************************************/
+static void CmdOn( SH_Data* Ptr, int Argc, char** Argv )
+{
+    PMB_setOn( &MyPmb, true );
+}
+
+static void CmdOff( SH_Data* Ptr, int Argc, char** Argv )
+{
+    PMB_setOn( &MyPmb, false );
+}
+
+
+/******************************************************************************
+* FUNCTION      : CmdRef
+* DESCRIPTION   :
+* Shell command, sets the output in ADC counts as VOUT_COMMAND does.
+******************************************************************************/
+static void CmdRef( SH_Data* Ptr, int Argc, char** Argv )
+{
+    long Vout;
+
+    if( Argc != 2 || !SH_parse( Argv[1], SH_TYPE_INT, &Vout ) ||
+        !PMB_setVout( &MyPmb, (int)Vout ) )
+    {
+        SH_puts( Ptr, "usage: ref <" );
+        SH_putInt( Ptr, PMB_VOUT_MIN );
+        SH_puts( Ptr, ".." );
+        SH_putInt( Ptr, PMB_VOUT_MAX );
+        SH_puts( Ptr, ">\r\n" );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : CmdSoftStart
+* DESCRIPTION   :
+* Shell command, sets the soft-start ramp time and starts the ramp again from
+* zero, or from the output with SOFT_PREBIAS, e.g. to look at the start up
+* with a new time. PMB_update() scales the ramp as before and turns it back
+* down if the output is off.
+******************************************************************************/
+static void CmdSoftStart( SH_Data* Ptr, int Argc, char** Argv )
+{
+    long Ms;
+
+    if( Argc != 2 || !SH_parse( Argv[1], SH_TYPE_LONG, &Ms ) ||
+        Ms < 1 || Ms > 10000 )
+    {
+        SH_puts( Ptr, "usage: ss <1..10000>\r\n" );
+        return;
+    }
+    SOFT_start( &MySoft, Ms, PERIOD_NS );
+    PMB_setOn( &MyPmb, MyPmb.m_On );
+}
+
+
+#if AVP
+/******************************************************************************
+* FUNCTION      : CmdAvp
+* DESCRIPTION   :
+* Shell command, sets the load line or prints it and the droop.
+******************************************************************************/
+static void CmdAvp( SH_Data* Ptr, int Argc, char** Argv )
+{
+    long MilliOhm;
+
+    if( Argc == 1 )
+    {
+        SH_puts( Ptr, "slope " );
+        SH_putInt( Ptr, MyAvp.m_MilliOhm );
+        SH_puts( Ptr, "mOhm, droop " );
+        SH_putInt( Ptr, MyAvp.m_Droop );
+        SH_puts( Ptr, "\r\n" );
+    }
+    else if( Argc != 2 || !SH_parse( Argv[1], SH_TYPE_LONG, &MilliOhm ) ||
+             MilliOhm < 0 || MilliOhm > AVP_MAX_MOHM )
+    {
+        SH_puts( Ptr, "usage: avp [0..1000]\r\n" );
+    }
+    else
+    {
+        AVP_setSlope( &MyAvp, (int)MilliOhm );
+    }
+}
+#endif
+
+
+#if DVS
+/******************************************************************************
+* FUNCTION      : CmdSlew
+* DESCRIPTION   :
+* Shell command, sets the rate that the next ref or VOUT_COMMAND slews at.
+* The variable slew only shows it, as a rate of 0 or less would make every
+* new Vout fail.
+******************************************************************************/
+static void CmdSlew( SH_Data* Ptr, int Argc, char** Argv )
+{
+    long Rate;
+
+    if( Argc != 2 || !SH_parse( Argv[1], SH_TYPE_INT, &Rate ) ||
+        !PMB_setSlewRate( &MyPmb, (int)Rate ) )
+    {
+        SH_puts( Ptr, "usage: slew <1..32767>\r\n" );
+    }
+}
+#endif
+
+
+#if TELEMETRY
+/******************************************************************************
+* FUNCTION      : CmdTlm
+* DESCRIPTION   :
+* Shell command, starts or stops the telemetry or prints its state.
+******************************************************************************/
+static void CmdTlm( SH_Data* Ptr, int Argc, char** Argv )
+{
+    if( Argc == 1 )
+    {
+        SH_puts( Ptr, "state " );
+        SH_putInt( Ptr, MyTlm.m_State );
+        SH_puts( Ptr, ", dropped " );
+        SH_putInt( Ptr, MyTlm.m_Dropped );
+        SH_puts( Ptr, "\r\n" );
+    }
+    else if( !strcmp( Argv[1], "stream" ) )
+    {
+        TLM_setDecimate( &MyTlm, TLM_DECIMATE );
+        TLM_stream( &MyTlm );
+    }
+    else if( !strcmp( Argv[1], "arm" ) )
+    {
+        TLM_setDecimate( &MyTlm, 1 );
+        TLM_arm( &MyTlm, TLM_LEVEL, TLM_FALLING, TLM_PRE, TLM_POST );
+    }
+    else if( !strcmp( Argv[1], "stop" ) )
+    {
+        TLM_stop( &MyTlm );
+    }
+    else
+    {
+        SH_puts( Ptr, "usage: tlm [stream|arm|stop]\r\n" );
+    }
+}
+#endif
+
+
+#if SPI_TELEMETRY
+/******************************************************************************
+* FUNCTION      : CmdStlm
+* DESCRIPTION   :
+* Shell command, prints the SPI telemetry counters.
+******************************************************************************/
+static void CmdStlm( SH_Data* Ptr, int Argc, char** Argv )
+{
+    SH_puts( Ptr, "blocks " );
+    SH_putInt( Ptr, MySpiTlm.m_Blocks );
+    SH_puts( Ptr, ", dropped " );
+    SH_putInt( Ptr, MySpiTlm.m_Dropped );
+#if STLM_LOOPBACK
+    SH_puts( Ptr, "\r\nloopback blocks " );
+    SH_putInt( Ptr, MySpiRx.m_Blocks );
+    SH_puts( Ptr, ", lost " );
+    SH_putInt( Ptr, MySpiRx.m_Lost );
+    SH_puts( Ptr, ", errors " );
+    SH_putInt( Ptr, MySpiRx.m_Errors );
+#endif
+    SH_puts( Ptr, "\r\n" );
+}
+#endif
+#endif
+
+
+#if SPI_TELEMETRY
+/******************************************************************************
+* FUNCTION      : IsrSpiTx
+* DESCRIPTION   :
+* This interrupt is called when the SPI Tx FIFO has fallen to STLM_TX_LEVEL.
+* It is in PIE group 6, above the ADC, so IsrAdc is allowed to interrupt it.
+******************************************************************************/
+#pragma CODE_SECTION( IsrSpiTx, "hotfuncs" );
+interrupt void IsrSpiTx( void )
+{
+    IER &= NEST_IER;
+    EINT;
+
+#if STLM_LOOPBACK
+    while( SPI_getRxCount( SPI_MOD_1 ) )
+    {
+        STLM_rxWord( &MySpiRx, SPI_read( SPI_MOD_1 ) );
+    }
+#endif
+
+    STLM_drain( &MySpiTlm );
+
+    DINT;
+    SPI_ackTxInt( SPI_MOD_1 );
+}
+#endif
+
+
+#if PMBUS
+/******************************************************************************
+* FUNCTION      : IsrI2c
+* DESCRIPTION   :
+* This interrupt is called on I2C slave events. It is in PIE group 8, above
+* the ADC, so IsrAdc is allowed to interrupt it.
+******************************************************************************/
+#pragma CODE_SECTION( IsrI2c, "hotfuncs" );
+interrupt void IsrI2c( void )
+{
+    IER &= NEST_IER;
+    EINT;
+
+    PMB_event( &MyPmb );
+
+    DINT;
+    INT_ackGroup( INT_GROUP_8 );
+}
+#endif
+
+
+#if (RAILS > 1)
+/******************************************************************************
+* FUNCTION      : RailsMain
+* DESCRIPTION   :
+* Sets up RAILS rails, powers them up and runs their sequencing and budget in
+* the idle loop. It does not return; a rail set up that does not fit leaves
+* the rails off and MyRails.m_State at RAIL_UNFIT.
+******************************************************************************/
+static void RailsMain( void )
+{
+    CNTRL_2p2zData* Cntrl[3] = { &MyCntrl, &MyCntrl2, &MyCntrl3 };
+    bool On = false;
+    int  Rail;
+
+    RAIL_init( &MyRails, RAIL_PERIOD_NS, RAIL_ISR_EXTRA );
+    for( Rail = 0; Rail < RAILS; Rail++ )
+    {
+        CNTRL_2p2zInit(Cntrl[Rail]
+            ,_IQ15(REF)
+            ,_IQ26(RAIL_A1),_IQ26(RAIL_A2)
+            ,_IQ26(RAIL_B0),_IQ26(RAIL_B1),_IQ26(RAIL_B2)
+            ,_IQ23(K),MIN_DUTY,MAX_DUTY
+            );
+        RAIL_add( &MyRails, Cntrl[Rail], &MyRailCfg[Rail] );
+    }
+    /* On failure RAIL_process() ignores RailsOn, m_State says why */
+    RAIL_start( &MyRails );
+
+    INT_enableGlobal(true);
+
+    while(1)
+    {
+        if( RailsOn != On )
+        {
+            On = RailsOn;
+            if( On )
+            {
+                RAIL_powerUp( &MyRails );
+            }
+            else
+            {
+                RAIL_powerDown( &MyRails );
+            }
+        }
+        RAIL_process( &MyRails );
+    }
+}
+#endif
 
 
 /******************************************************************************
@@ -151,16 +1846,31 @@ interrupt void IsrAdc( void )
 void main( void )
 {
 
-    /* Initialize the MCU, ADC & GPIO12 */
+    /* Initialize the MCU, copy the control path to RAM when booting from
+    *  flash (see boot.h), then the ADC & GPIO12
+    */
     SYS_init();
+#if STACK_MON
+    /* Marks the stack above main(), before anything else runs on it */
+    STK_init( &MyStk, &MyFlt, STK_GUARD );
+#endif
+    BOOT_init();
     ADC_init();
     GPIO_config( GPIO_12, GPIO_DIR_OUT, false );
     
+#if (RAILS > 1)
+    /* The rails take the place of everything below */
+    RailsMain();
+#endif
 
     /* Configures the CLA Mod1 to run CLA code "SlopeTask" whenever PWM trigger
     * occurs - The PWM event that causes the trigger is defined later.
     */
+#if (CONTROL_MODE == CONTROL_VCM_2P2Z)
+    CLA_config( CLA_MOD_1, &ValleyTask, CLA_INT_PWM );
+#elif (CONTROL_MODE == CONTROL_PCM_2P2Z)
     CLA_config( CLA_MOD_1, &SlopeTask, CLA_INT_PWM );
+#endif
 
 
     /* Setup PWM Mod1 for fs = 200kHz. PWM1 Ch A is being used for switching
@@ -168,7 +1878,12 @@ void main( void )
     * later.
     */
     PWM_config( PWM_MOD_1, PWM_nsToTicks(PERIOD_NS), PWM_COUNT_UP );
+#if (CONTROL_MODE == CONTROL_VCM_2P2Z)
+    /* Reversed, cleared at zero and set at the compare */
+    PWM_pin( PWM_MOD_1, PWM_CH_A, GPIO_INVERT );
+#else
     PWM_pin( PWM_MOD_1, PWM_CH_A, GPIO_NON_INVERT );
+#endif
     PWM_pin( PWM_MOD_1, PWM_CH_B, GPIO_NON_INVERT );
 
 
@@ -180,6 +1895,30 @@ void main( void )
     */
     PWM_setDutyA(PWM_MOD_1, PWM_nsToTicks(PERIOD_NS)*0.6 );
 
+#if (CONTROL_MODE == CONTROL_VM_MPC)
+    /* In voltage mode the MPC writes the duty every cycle, starting at 0 and
+    * limited to the same 60%.
+    */
+    PWM_setDutyA(PWM_MOD_1, 0 );
+    MPC_init( &MyMpc, &MpcTable, _IQ15(REF), 0,
+              PWM_nsToTicks(PERIOD_NS)*0.6,
+              PWM_nsToTicks(PERIOD_NS)*MPC_UFF, _IQ16(MPC_KI) );
+#endif
+
+#if (CONTROL_MODE == CONTROL_VCM_2P2Z)
+    /* In valley current mode only the trip turns PWM1A on, so the compare
+    * is put past the period, where the counter never gets to.
+    */
+    PWM_setDutyA(PWM_MOD_1, PWM_nsToTicks(PERIOD_NS) );
+#endif
+
+#if (CONTROL_MODE == CONTROL_ACM_CASCADE)
+    /* In average current mode the inner loop writes the duty every cycle,
+    * starting at 0 and limited to the same 60%, ACM_MAX_DUTY.
+    */
+    PWM_setDutyA(PWM_MOD_1, 0 );
+#endif
+
 
 
 
@@ -233,7 +1972,9 @@ void main( void )
     * PWM_INT_PRD_1 indicates that an interrupt should be generated every cycle
     * as opposed to every other cycle
     */
+#if TRIP_LOOP
     PWM_setCallback(PWM_MOD_1, 0, PWM_INT_ZERO, PWM_INT_PRD_1 );
+#endif
 
 
 
@@ -253,8 +1994,16 @@ void main( void )
     PWM_configBlanking( PWM_MOD_1, PWM_CMP_COMP2, GPIO_NON_INVERT, true );
     
     
-    /* Sets the size of the blanking window to 420ns */
+    /* Sets the size of the blanking window to 420ns. In valley current mode
+    * it hides the turn off, at zero, and is the shortest off-time.
+    */
     PWM_setBlankingWindow( PWM_MOD_1, PWM_nsToTicks(420) );
+
+#if ADAPTIVE_BLANK
+    /* From here on the window follows the load, starting at BLANK_FULL_NS */
+    BLANK_init( &MyBlank, PWM_MOD_1, &MyCntrl.Out.m_Int, MAX_DUTY,
+                BLANK_MIN_NS, BLANK_FULL_NS, BLANK_MAX_NS, BLANK_GUARD_NS );
+#endif
     
 
     /* sets up the relevant trip zones: i.e. when PWM_DCEVT occurs clear
@@ -262,32 +2011,158 @@ void main( void )
     * PWM_DCEVT was set up in PWM_configBlanking().
     */
     PWM_setTripZone(  PWM_MOD_1, PWM_DCEVT, PWM_TPZ_CYCLE_BY_CYCLE );
+#if (CONTROL_MODE == CONTROL_VCM_2P2Z)
+    /* The valley trip turns PWM1A on until the latch clears at zero */
+    PWM_setTripState( PWM_MOD_1, PWM_CH_A, GPIO_SET );
+#else
     PWM_setTripState( PWM_MOD_1, PWM_CH_A, GPIO_CLR );
+#endif
+#if SYNC_RECT
+    /* PWM1B is the low side FET: on at the trip, and complementary to PWM1A
+    *  with SYNC_DEAD_NS of dead band from here on
+    */
+    PWM_setTripState( PWM_MOD_1, PWM_CH_B, GPIO_SET );
+    DEAD_init( &MyDead, PWM_MOD_1, &MyCntrl.Out.m_Int, SYNC_DEAD_NS,
+               SYNC_DEAD_MIN_NS, SYNC_DEAD_MAX_NS );
+#if ADAPTIVE_BLANK
+    /* BLANK_update() reads the same trip flag, after DEAD_update(), and
+    *  clears it
+    */
+    DEAD_shareFlag( &MyDead );
+#endif
+#else
     PWM_setTripState( PWM_MOD_1, PWM_CH_B, GPIO_NO_ACTION );
+#endif
 
 
     /* Configures ADC to sample Vo when triggered by PWM1 Ch B's falling edge
      */
     ADC_config( ADC_MOD_1, ADC_SH_WIDTH_7, ADC_CH_B2, ADC_TRIG_EPWM1_SOCB );
 
+#if PROTECT
+    /* The temperature sensor, and Vin, are converted after Vo on the same
+    *  trigger and read in the idle loop. The sensor takes the place of ADCINA5.
+    */
+    EALLOW;
+    AdcRegs.ADCCTL1.bit.TEMPCONV = 1;
+    EDIS;
+    ADC_config( ADC_MOD_2, ADC_SH_WIDTH_7, ADC_CH_A5, ADC_TRIG_EPWM1_SOCB );
+#if PROT_VIN
+    ADC_config( ADC_MOD_3, ADC_SH_WIDTH_7, PROT_VIN_CH, ADC_TRIG_EPWM1_SOCB );
+#endif
+#endif
+
+#if (CONTROL_MODE == CONTROL_ACM_CASCADE)
+    /* The inductor current, after Vo and what PROTECT converts */
+    ADC_config( ADC_MOD_4, ADC_SH_WIDTH_7, ACM_ISENSE, ADC_TRIG_EPWM1_SOCB );
+#endif
+
+#if (CONTROL_MODE == CONTROL_ACM_CASCADE && !ACM_INNER_CLA)
+    /* With the inner loop on the CPU IsrAdc waits for the current as well */
+    ADC_setCallback( ADC_MOD_4, IsrAdc, ADC_INT_1 );
+#else
     /* When conversion is finished, cause interrupt and jump to IsrAdc */
     ADC_setCallback( ADC_MOD_1, IsrAdc, ADC_INT_1 );
+#endif
 
-
+#if (CONTROL_MODE == CONTROL_ACM_CASCADE && ACM_INNER_CLA)
+    /* ADCINT2 at the end of the current conversion starts CurrentTask. No
+    *  ISR clears its flag, so it is made continuous, INT2CONT.
+    */
+    ADC_setCallback( ADC_MOD_4, 0, ADC_INT_2 );
+    EALLOW;
+    AdcRegs.INTSEL1N2.all |= 0x4000;
+    EDIS;
+    CLA_config( CLA_MOD_2, &CurrentTask, CLA_INT_ADC );
+#if CNTRL_RESET
+    CLA_config( CLA_MOD_8, &CurrentReset, CLA_INT_NONE );
+#endif
+#endif
+
+#if FAULT
+    /* In voltage and average current mode the comparator is the over current
+    *  limit and latches the one-shot trip as well; in peak and valley current
+    *  mode it is the current loop
+    */
+#if !TRIP_LOOP
+    FLT_init( &MyFlt, PWM_MOD_1, PWM_DCEVT, FLT_OVP, IsrFault );
+#else
+    FLT_init( &MyFlt, PWM_MOD_1, 0, FLT_OVP, IsrFault );
+#endif
+#if CNTRL_RESET
+    FLT_setReset( &MyFlt, CntrlReset );
+#endif
+#endif
+
+#if PROTECT
+    /* CPU timer 1 counts us from here on. The temperature limit in ADC counts
+    *  comes from the sensor's factory calibration, held in OTP: its slope in
+    *  degrees per count, Q15, and the count at 0 degrees.
+    */
+    TIM_config( TIM_MOD_2, 0xFFFFFFFF, SYS_CLK_HZ/1000000L );
+    PROT_init( &MyProt, &MyFlt, TIM_MOD_2, PERIOD_NS/1000 );
+    PROT_setLimit( &MyProt, PROT_OV, PROT_OV_LEVEL, PROT_OV_CYCLES );
+    PROT_setLimit( &MyProt, PROT_UV, PROT_UV_LEVEL, PROT_UV_CYCLES );
+#if TRIP_LOOP
+    PROT_setLimit( &MyProt, PROT_OC, PROT_OC_LEVEL, PROT_OC_CYCLES );
+#endif
+    PROT_addInput( &MyProt, &AdcResult.ADCRESULT1, 0,
+                   (int)(PROT_TEMP_C*32768L/getTempSlope()) + getTempOffset(),
+                   PROT_TEMP_US, FLT_OTP );
+#if PROT_VIN
+    PROT_addInput( &MyProt, &AdcResult.ADCRESULT2, PROT_VIN_MIN, PROT_VIN_MAX,
+                   PROT_VIN_US, FLT_VIN );
+#endif
+#endif
+
+
+#if (CONTROL_MODE == CONTROL_ACM_CASCADE)
+    /* The outer loop, Vo in and the current reference out, and the inner */
+    CNTRL_2p2zInit(&MyCntrl
+        ,_IQ15(REF)
+        ,_IQ26(ACM_V_A1),_IQ26(ACM_V_A2)
+        ,_IQ26(ACM_V_B0),_IQ26(ACM_V_B1),_IQ26(ACM_V_B2)
+        ,_IQ23(ACM_V_K),0,ACM_IMAX
+        );
+#if ACM_INNER_CLA
+    ACM_init( &MyAcm, &MyCntrl, &CLA_getCtrlPtr(CurrentTask)->m_Ref,
+              ACM_SHIFT_Q16, ACM_DECIMATE, ACM_HOLD );
+#elif (ACM_INNER_ORDER == 1)
+    ACM_1p1zInit( &MyInner, _IQ24(ACM_I_A1), _IQ24(ACM_I_B0),
+                  _IQ24(ACM_I_B1), 0, (int)ACM_MAX_DUTY );
+    ACM_init( &MyAcm, &MyCntrl, &MyInner.m_Ref, ACM_SHIFT_Q16, ACM_DECIMATE,
+              ACM_HOLD );
+#else
+    CNTRL_2p2zInit(&MyInner
+        ,0
+        ,_IQ26(ACM_I_A1),_IQ26(ACM_I_A2)
+        ,_IQ26(ACM_I_B0),_IQ26(ACM_I_B1),_IQ26(ACM_I_B2)
+        ,_IQ23(ACM_I_K),0,(int)ACM_MAX_DUTY
+        );
+    ACM_init( &MyAcm, &MyCntrl, &MyInner.Ref.m_IQ, ACM_SHIFT_Q0,
+              ACM_DECIMATE, ACM_HOLD );
+#endif
+#else
     /* Initalise the 2p2z control structure */
     CNTRL_2p2zInit(&MyCntrl
         ,_IQ15(REF)
         ,_IQ26(A1),_IQ26(A2)
         ,_IQ26(B0),_IQ26(B1),_IQ26(B2)
-        ,_IQ23(K),MIN_DUTY,MAX_DUTY
+        ,_IQ23(CNTRL_K),MIN_DUTY,CNTRL_MAX
         );
+#endif
 
 
     /* Configures the comparator Mod2 with 0 qualification window
     * i.e. asynchronous. The comparator output is not inverted & the inverting
-    * input of the comparator is tied to the on board DAC.
+    * input of the comparator is tied to the on board DAC. In valley current
+    * mode it is inverted, high once the current is below the DAC.
     */
+#if (CONTROL_MODE == CONTROL_VCM_2P2Z)
+    CMP_config( CMP_MOD_2, CMP_ASYNC, GPIO_INVERT, CMP_DAC );
+#else
     CMP_config( CMP_MOD_2, CMP_ASYNC, GPIO_NON_INVERT, CMP_DAC );
+#endif
 
     /* This line connects the output of the comparator to a GPIO pin. On the
     * Piccolo B part this is hard wired to GPIO3 which is connected to PWM2B
@@ -295,16 +2170,238 @@ void main( void )
     */
     CMP_pin( CMP_MOD_2 );
 
+#if !TRIP_LOOP
+    /* Without slope compensation the DAC is static, the current limit */
+    CMP_setDac( CMP_MOD_2, OCP_DAC );
+#endif
+
+
+#if OBSERVER
+    /* Start the observer from the discharged output */
+    OBS_init( &MyObs, _IQ24(OBS_KV), _IQ24(OBS_A), _IQ24(OBS_L1),
+              _IQ24(OBS_L2), _IQ24(OBS_L3), OBS_OFFSET, 0 );
+#endif
+
+
+#if GAIN_SCHEDULE
+    /* The output starts discharged so start with the light load bank */
+    SCHED_init( &MySched, &MyCntrl, MyBanks, 2, 0, SCHED_DECIMATE );
+#endif
+
+
+#if PLANT_ID
+    ID_init( &MyId, ID_AMP, ID_HOLD, ID_SAMPLES );
+#endif
+
+#if AUTOTUNE
+    TUNE_init( &MyTune, PERIOD_NS, TUNE_FC, TUNE_PM, TUNE_FP, K );
+#endif
+
+
+#if (TELEMETRY || SHELL)
+    UART_config( UART_MOD_1, GPIO_28, GPIO_29, UART_baudToTicks(TLM_BAUD),
+                 UART_DATA_8, UART_PARITY_NONE, UART_STOP_1 );
+    UART_setTxCallback( UART_MOD_1, IsrUartTx, 0 );
+#endif
+
+
+#if TELEMETRY
+    /* Channel 0 is the trigger channel */
+    TLM_init( &MyTlm, UART_MOD_1, TLM_DECIMATE );
+#if (CONTROL_MODE == CONTROL_VM_MPC)
+    TLM_addChannel( &MyTlm, &MyMpc.Fdbk.m_Int );
+    TLM_addChannel( &MyTlm, &MyMpc.Out.m_Int );
+#else
+    TLM_addChannel( &MyTlm, &MyCntrl.Fdbk.m_Int );
+    TLM_addChannel( &MyTlm, &MyCntrl.Out.m_Int );
+#endif
+    TLM_addChannel( &MyTlm, &MyCntrl.Ref.m_Int );
+#if CPU_LOAD
+    TLM_addChannel( &MyTlm, &MyLoad.m_Load );
+#endif
+#if STACK_MON
+    TLM_addChannel( &MyTlm, &MyStk.m_Used );
+#endif
+#if !SHELL
+    TLM_stream( &MyTlm );
+#endif
+#endif
+
+
+#if SPI_TELEMETRY
+    SPI_config( SPI_MOD_1, SPI_baudToTicks(STLM_BAUD), SPI_DO_POS_DI_NEG );
+#if STLM_LOOPBACK
+    SPI_setLoopback( SPI_MOD_1, true );
+    STLM_rxInit( &MySpiRx, 2 );
+#endif
+    SPI_setTxCallback( SPI_MOD_1, IsrSpiTx, STLM_TX_LEVEL );
+    STLM_init( &MySpiTlm, SPI_MOD_1, STLM_DECIMATE );
+#if (CONTROL_MODE == CONTROL_VM_MPC)
+    STLM_addChannel( &MySpiTlm, &MyMpc.Fdbk.m_Int );
+    STLM_addChannel( &MySpiTlm, &MyMpc.Out.m_Int );
+#else
+    STLM_addChannel( &MySpiTlm, &MyCntrl.Fdbk.m_Int );
+    STLM_addChannel( &MySpiTlm, &MyCntrl.Out.m_Int );
+#endif
+    STLM_start( &MySpiTlm );
+#endif
+
+
+#if (SHELL && !PMBUS)
+#if (CONTROL_MODE == CONTROL_VM_MPC)
+    PMB_init( &MyPmb, 0, 0, &MyMpc.Fdbk.m_Int, (int)_IQ15(REF),
+              PMB_VOUT_MIN, PMB_VOUT_MAX );
+#else
+    PMB_init( &MyPmb, 0, 0, &MyCntrl.Fdbk.m_Int, (int)_IQ15(REF),
+              PMB_VOUT_MIN, PMB_VOUT_MAX );
+#endif
+#endif
+
+
+#if SHELL
+    UART_setRxCallback( UART_MOD_1, IsrUartRx, 1 );
+    SH_init( &MyShell, UART_MOD_1, MyCmds, sizeof(MyCmds)/sizeof(MyCmds[0]),
+             MyVars, sizeof(MyVars)/sizeof(MyVars[0]) );
+#endif
+
+
+#if PMBUS
+    /* I2C_config() sets the pins and a 10MHz module clock */
+    I2C_config( I2C_MOD_1, 5, 10, 5 );
+#if (CONTROL_MODE == CONTROL_VM_MPC)
+    PMB_init( &MyPmb, I2C_MOD_1, PMB_ADDRESS, &MyMpc.Fdbk.m_Int,
+              (int)_IQ15(REF), PMB_VOUT_MIN, PMB_VOUT_MAX );
+#else
+    PMB_init( &MyPmb, I2C_MOD_1, PMB_ADDRESS, &MyCntrl.Fdbk.m_Int,
+              (int)_IQ15(REF), PMB_VOUT_MIN, PMB_VOUT_MAX );
+#endif
+    INT_setCallback( INT_pieIdToVectorId( PMB_PIE_ID ), IsrI2c );
+    INT_enablePieId( PMB_PIE_ID, true );
+#endif
+
+
+#if DVS
+    /* Settled at VOUT_COMMAND, which PMB_init() set to REF */
+    DVS_init( &MyDvs, (int)_IQ15(REF), PERIOD_NS, DVS_KFF );
+    PMB_setSlew( &MyPmb, &MyDvs, DVS_RATE );
+#endif
+
+
+#if AVP
+    /* On the load line from the first cycle, the droop counts of Vo per count
+    *  of current worked out from the slope in mOhm
+    */
+    AVP_init( &MyAvp, &MyCntrl, _IQ24(AVP_KV/(AVP_KI*1000.0)),
+              AVP_MAX_DROOP );
+    AVP_setSlope( &MyAvp, AVP_MOHM );
+#endif
 
-    /* Set up a 500ms soft-start */
-    CNTRL_2p2zSoftStartConfig(&MyCntrl, 500, PERIOD_NS );
+
+    /* Soft-start up to REF. The ADC has been converting Vo since
+    *  the PWM started, so its result is there for the pre-bias.
+    */
+#if SOFT_PREBIAS
+    SOFT_init( &MySoft, &MyCntrl, SOFT_PROFILE, &AdcResult.ADCRESULT0 );
+#else
+    SOFT_init( &MySoft, &MyCntrl, SOFT_PROFILE, 0 );
+#endif
+    SOFT_start( &MySoft, SOFT_RAMP_MS, PERIOD_NS );
+
+
+#if CPU_LOAD
+    /* CPU timer 2 counts SYSCLKOUT from here on, a result every second */
+    TIM_config( TIM_MOD_3, 0xFFFFFFFF, 1 );
+    LOAD_init( &MyLoad, TIM_MOD_3, SYS_CLK_HZ, LOAD_ISR_EXTRA );
+#endif
 
 
     /* Enables global interrupts and wait in idle loop */
     INT_enableGlobal(true);
 
+#if WATCHDOG
+    /* From here on only the supervisor kicks the watchdog */
+    WDG_config( WDG_RESET, 0 );
+    SUP_init( &MySup, &MyFlt, SUP_DEADLINE_US );
+    /* The slope tasks only; CurrentTask starts after SUP_beat() */
+#if TRIP_LOOP
+    SUP_watchCla( &MySup, CLA_MOD_1 );
+#endif
+#endif
+
     while(1)
     {
-
+#if CPU_LOAD
+        LOAD_process( &MyLoad );
+#endif
+
+#if STACK_MON
+        STK_process( &MyStk );
+#endif
+
+#if ADAPTIVE_BLANK
+        BLANK_process( &MyBlank );
+#endif
+
+#if SYNC_RECT
+        DEAD_process( &MyDead, MySoft.m_Level == SOFT_LEVEL_ONE );
+#endif
+
+#if FAULT
+        if( FltClear )
+        {
+            FltClear = false;
+            FLT_clear( &MyFlt, &MySoft );
+        }
+#endif
+
+#if PROTECT
+        PROT_process( &MyProt, &MyCntrl );
+#endif
+
+#if WATCHDOG
+        SUP_process( &MySup );
+#endif
+
+#if PLANT_ID
+        if( IdRequest )
+        {
+            IdRequest = false;
+            ID_start( &MyId, MyCntrl.Ref.m_Int );
+        }
+        ID_process( &MyId, ID_PER_PASS );
+#endif
+
+#if AUTOTUNE
+        if( TuneRequest )
+        {
+            TuneRequest = false;
+            TUNE_start( &MyTune, MyCntrl.Out.m_Int, TUNE_D, TUNE_HYST,
+                        TUNE_SKIP, TUNE_PERIODS );
+        }
+        TUNE_process( &MyTune, &MyCntrl );
+#endif
+
+#if TELEMETRY
+        if( TlmArm )
+        {
+            TlmArm = false;
+            TLM_setDecimate( &MyTlm, 1 );
+            TLM_arm( &MyTlm, TLM_LEVEL, TLM_FALLING, TLM_PRE, TLM_POST );
+        }
+#if !SHELL
+        else if( TLM_isDone( &MyTlm ) )
+        {
+            /* The capture has been sent, go back to streaming */
+            TLM_setDecimate( &MyTlm, TLM_DECIMATE );
+            TLM_stream( &MyTlm );
+        }
+#endif
+#endif
+
+#if (SHELL && TELEMETRY)
+        SH_process( &MyShell, TLM_isDone( &MyTlm ) );
+#elif SHELL
+        SH_process( &MyShell, true );
+#endif
     }
 }
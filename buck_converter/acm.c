@@ -0,0 +1,141 @@
+/******************************************************************************
+* FILE          : acm.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Average current mode, the cascade of a current and a voltage loop. See
+* acm.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "acm.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#pragma CODE_SECTION( ACM_outer, "hotfuncs" );
+#pragma CODE_SECTION( ACM_1p1z, "hotfuncs" );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : ACM_init
+* DESCRIPTION   :
+* Runs Outer every Decimate cycles and hands its output to the inner loop's
+* reference at pRef, the counts Shift bits up, or 0 while *pHold, if given,
+* is set. The first ACM_update() runs it. The reference starts at 0.
+******************************************************************************/
+void ACM_init( ACM_Data* Ptr, CNTRL_2p2zData* Outer, volatile int32_t* pRef,
+               int Shift, int Decimate, const volatile int* pHold )
+{
+    Ptr->m_Outer    = Outer;
+    Ptr->m_pRef     = pRef;
+    Ptr->m_Shift    = Shift;
+    Ptr->m_pHold    = pHold;
+    Ptr->m_Decimate = Decimate > 0 ? Decimate : 1;
+    Ptr->m_Count    = 1;
+
+    *pRef = 0;
+}
+
+
+/******************************************************************************
+* FUNCTION      : ACM_outer
+* DESCRIPTION   :
+* Runs the outer loop and hands its output over. Called by ACM_update().
+******************************************************************************/
+void ACM_outer( ACM_Data* Ptr )
+{
+    Ptr->m_Count = Ptr->m_Decimate;
+    CNTRL_2p2z( Ptr->m_Outer );
+
+    if( Ptr->m_pHold && *Ptr->m_pHold )
+    {
+        *Ptr->m_pRef = 0;
+    }
+    else
+    {
+        *Ptr->m_pRef = (int32_t)Ptr->m_Outer->Out.m_Int << Ptr->m_Shift;
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : ACM_reset
+* DESCRIPTION   :
+* Sets the inner loop's reference back to 0 and makes the next ACM_update()
+* run the outer loop, as after ACM_init(). The history of the outer and the
+* inner loop is cleared by their owners.
+******************************************************************************/
+void ACM_reset( ACM_Data* Ptr )
+{
+    Ptr->m_Count = 1;
+
+    *Ptr->m_pRef = 0;
+}
+
+
+/******************************************************************************
+* FUNCTION      : ACM_1p1zInit
+* DESCRIPTION   :
+* Sets the coefficients and the output limits, ticks, and clears the history.
+******************************************************************************/
+void ACM_1p1zInit( ACM_1p1zData* Ptr, _iq24 A1, _iq24 B0, _iq24 B1,
+                   int Min, int Max )
+{
+    Ptr->m_Ref  = 0;
+    Ptr->m_Fdbk = 0;
+    Ptr->m_Out  = Min;
+    Ptr->m_U1   = (_iq16)Min << 16;
+    Ptr->m_E1   = 0;
+    Ptr->m_A1   = A1;
+    Ptr->m_B0   = B0;
+    Ptr->m_B1   = B1;
+    Ptr->m_Min  = (_iq16)Min << 16;
+    Ptr->m_Max  = (_iq16)Max << 16;
+}
+
+
+/******************************************************************************
+* FUNCTION      : ACM_1p1zReset
+* DESCRIPTION   :
+* Clears the history back to what ACM_1p1zInit() left, the output at m_Min.
+******************************************************************************/
+void ACM_1p1zReset( ACM_1p1zData* Ptr )
+{
+    Ptr->m_Out  = (int)(Ptr->m_Min >> 16);
+    Ptr->m_U1   = Ptr->m_Min;
+    Ptr->m_E1   = 0;
+}
+
+
+/******************************************************************************
+* FUNCTION      : ACM_1p1z
+* DESCRIPTION   :
+* Runs the inner loop once on m_Fdbk and sets m_Out.
+******************************************************************************/
+void ACM_1p1z( ACM_1p1zData* Ptr )
+{
+    _iq16 E0 = Ptr->m_Ref - ((_iq16)Ptr->m_Fdbk << 16);
+    _iq16 U;
+
+    U = _IQ24mpy( Ptr->m_A1, Ptr->m_U1 ) + _IQ24mpy( Ptr->m_B0, E0 )
+      + _IQ24mpy( Ptr->m_B1, Ptr->m_E1 );
+    if( U > Ptr->m_Max )
+    {
+        U = Ptr->m_Max;
+    }
+    else if( U < Ptr->m_Min )
+    {
+        U = Ptr->m_Min;
+    }
+
+    Ptr->m_U1  = U;
+    Ptr->m_E1  = E0;
+    Ptr->m_Out = (int)(U >> 16);
+}
@@ -0,0 +1,189 @@
+/*******************************************************************************
+* FILE          : acm.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Average current mode: a current loop inside a decimated voltage loop.
+*
+* The inner loop holds the sampled inductor current to a reference by setting
+* the duty, CMPA, every cycle, as a voltage mode loop would hold the output.
+* The outer loop is a CNTRL_2p2z() on Vo whose output is that reference, so
+* its output limit is the current limit, and it runs every m_Decimate'th
+* cycle only. Both are plain difference equations in the units of their ADC
+* channel and of their output, designed by tools/acm_sim.c from the power
+* stage for each decimation, which also simulates the pair; the results are
+* in doc/average_current.txt.
+*
+* The inner loop runs on either core:
+*
+*   CLA     ACM_claInner() makes it a CLA task, CLA_2p2zVMode(), started by
+*           the ADC interrupt of the current conversion; a 1p1z is the same
+*           task with A2 and B2 at 0. It costs the CPU nothing, and the CLA
+*           is otherwise idle in this mode
+*   CPU     ACM_1p1z(), an _iq16 1p1z, or CNTRL_2p2z() on a second
+*           CNTRL_2p2zData, in the control ISR before ACM_update()
+*
+* ACM_update() in the control ISR counts the cycles and on every
+* m_Decimate'th runs the outer 2p2z, whose Fdbk and Ref the ISR and the
+* soft-start keep up to date every cycle, and writes its output to the inner
+* loop's reference. m_pRef points at that reference, a long with the ADC
+* counts m_Shift bits up: 16 for the CLA_Ctrl of the CLA task and for
+* ACM_1p1zData, 0 for a CNTRL_2p2zData. The inner loop takes it up at its
+* next run, the cycle after.
+*
+* While *m_pHold is set, e.g. MyFlt.m_Tripped, the reference handed over is
+* 0: with the ePWM tripped there is no current, so the inner loop does not
+* wind up far. Before the ePWM is let go again ACM_reset() and, on the CPU,
+* ACM_1p1zReset() or clearing the CNTRL_2p2zData history put both loops back
+* to where they started. On the CLA only the CLA can write the history: the
+* task made by ACM_claReset() clears it, started with
+* CLA_softwareStartWait().
+*
+*   ACM_update()    ~6 cycles       in the control ISR, ~85 on an outer cycle
+*   ACM_1p1z()      ~35 cycles      in the control ISR, inner loop on the CPU
+*   CNTRL_2p2z()    ~70 cycles      inner loop on the CPU, with the loads
+*   CLA task        39 instructions .65us of the CLA, none of the CPU
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+* Decimating the outer loop lowers the average CPU cost, not the longest ISR,
+* the outer cycle.
+*
+* EXAMPLES
+*   ACM_claInner( CurTask, 4, 1, ACM_I_A1, ACM_I_A2, ACM_I_B0, ACM_I_B1,
+*                 ACM_I_B2, 1.0, 0.0, 180.0 );
+*
+*   ACM_Data MyAcm;
+*
+*   ADC_config( ADC_MOD_4, ADC_SH_WIDTH_7, ADC_CH_A4, ADC_TRIG_EPWM1_SOCB );
+*   ADC_setCallback( ADC_MOD_4, 0, ADC_INT_2 );
+*   EALLOW;
+*   AdcRegs.INTSEL1N2.all |= 0x4000;                // INT2CONT
+*   EDIS;
+*   CLA_config( CLA_MOD_2, &CurTask, CLA_INT_ADC );
+*   ACM_init( &MyAcm, &MyCntrl, &CLA_getCtrlPtr(CurTask)->m_Ref,
+*             ACM_SHIFT_Q16, 4, 0 );
+*
+*   interrupt void IsrAdc( void )
+*   {
+*       ...
+*       MyCntrl.Fdbk.m_Int = ADC_getValue( ADC_MOD_1 );
+*       ACM_update( &MyAcm );
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _ACM_H
+#define _ACM_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  ACM_1p1zData    ACM_1p1zData;
+typedef struct  ACM_Data        ACM_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+#define ACM_SHIFT_Q16   16      /* m_Shift for a CLA_Ctrl or ACM_1p1zData */
+#define ACM_SHIFT_Q0    0       /* m_Shift for a CNTRL_2p2zData */
+
+/*******************************************************************************
+* STRUCT        : ACM_1p1zData
+* DESCRIPTION   :
+* The inner loop on the CPU, Out = A1.Out1 + B0.E0 + B1.E1 within
+* m_Min..m_Max. The limited output is kept as the history, so it does not
+* wind up against the limits.
+*******************************************************************************/
+struct ACM_1p1zData
+{
+    _iq16       m_Ref;      /* current reference, ADC counts */
+    int         m_Fdbk;     /* current, ADC counts */
+    int         m_Out;      /* duty, ticks */
+    _iq16       m_U1;       /* last output, ticks */
+    _iq16       m_E1;       /* last error, ADC counts */
+    _iq24       m_A1;
+    _iq24       m_B0;
+    _iq24       m_B1;
+    _iq16       m_Min;
+    _iq16       m_Max;
+};
+
+/*******************************************************************************
+* STRUCT        : ACM_Data
+* DESCRIPTION   :
+* The cascade.
+*******************************************************************************/
+struct ACM_Data
+{
+    CNTRL_2p2zData*     m_Outer;        /* Ref and Fdbk Vo, Out the current */
+    volatile int32_t*   m_pRef;         /* reference of the inner loop */
+    int                 m_Shift;        /* of the counts in *m_pRef */
+    const volatile int* m_pHold;        /* 0, or hand over 0 while set */
+    int                 m_Decimate;     /* cycles per outer run */
+    int                 m_Count;        /* cycles to the next */
+};
+
+
+/*******************************************************************************
+* MACRO         : ACM_claInner
+* DESCRIPTION   :
+* CLA_2p2zVMode() with its arguments expanded first, so that unlike that macro
+* they can be defines, as long as they are defines of literals.
+*******************************************************************************/
+#define ACM_claInner( Name, Adc, Pwm, A1, A2, B0, B1, B2, K, MiN, MaX )     \
+    CLA_2p2zVMode( Name, Adc, Pwm, A1, A2, B0, B1, B2, K, MiN, MaX )
+
+/*******************************************************************************
+* MACRO         : ACM_claReset
+* DESCRIPTION   :
+* Makes the CLA task Name, which clears the history, Inner##Data, of the CLA
+* task made by ACM_claInner( Inner, ... ). It has no trigger of its own:
+* configure it with CLA_INT_NONE and start it from the CPU.
+*******************************************************************************/
+#define ACM_claReset( Name, Inner )                                         \
+extern Uint32 Name;                                                         \
+asm (\
+"\n\t.global _"#Inner"Data"\
+"\n\t.global _"#Name""\
+"\n\t"\
+"\n\t .sect Cla1Prog"\
+"\n_"#Name":"\
+"\n\t    MMOVF32    MR0, #0.0L"\
+"\n\t    MMOV32     @_"#Inner"Data+0, MR0       ; PreValue = 0"\
+"\n\t    MMOV32     @_"#Inner"Data+2+(0*2), MR0 ; U[0] = 0"\
+"\n\t    MMOV32     @_"#Inner"Data+2+(1*2), MR0 ; U[1] = 0"\
+"\n\t    MMOV32     @_"#Inner"Data+6+(0*2), MR0 ; E[0] = 0"\
+"\n\t    MMOV32     @_"#Inner"Data+6+(1*2), MR0 ; E[1] = 0"\
+"\n\t    MSTOP"\
+"\n\t    MNOP"\
+"\n\t    MNOP"\
+"\n\t    MNOP"\
+)
+
+/*******************************************************************************
+* MACRO         : ACM_update
+* DESCRIPTION   :
+* Runs the outer loop on every m_Decimate'th call. Call it once per control
+* cycle in the control ISR, after the outer loop's Fdbk has been written.
+*******************************************************************************/
+#define ACM_update( Ptr )                                                   \
+    do { if( --(Ptr)->m_Count == 0 ) { ACM_outer( (Ptr) ); } } while( 0 )
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void ACM_init( ACM_Data* Ptr, CNTRL_2p2zData* Outer,
+                      volatile int32_t* pRef, int Shift, int Decimate,
+                      const volatile int* pHold );
+extern void ACM_outer( ACM_Data* Ptr );
+extern void ACM_reset( ACM_Data* Ptr );
+extern void ACM_1p1zInit( ACM_1p1zData* Ptr, _iq24 A1, _iq24 B0, _iq24 B1,
+                          int Min, int Max );
+extern void ACM_1p1z( ACM_1p1zData* Ptr );
+extern void ACM_1p1zReset( ACM_1p1zData* Ptr );
+
+/********** END ***************************************************************/
+#endif
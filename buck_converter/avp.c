@@ -0,0 +1,57 @@
+/******************************************************************************
+* FILE          : avp.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Adaptive voltage positioning, the output on a load line. See avp.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "avp.h"
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : AVP_init
+* DESCRIPTION   :
+* Puts Cntrl on a load line, flat until AVP_setSlope(). Scale is the ADC
+* counts per volt of Vo over the counts per amp of the current given to
+* AVP_apply() and 1000, and Max the most the reference is lowered by, Vo
+* counts.
+******************************************************************************/
+void AVP_init( AVP_Data* Ptr, CNTRL_2p2zData* Cntrl, _iq24 Scale, int Max )
+{
+    Ptr->m_Cntrl    = Cntrl;
+    Ptr->m_Gain     = 0;
+    Ptr->m_Max      = Max > 0 ? Max : 0;
+    Ptr->m_Ref      = Cntrl->Ref.m_Int;
+    Ptr->m_Droop    = 0;
+    Ptr->m_MilliOhm = 0;
+    Ptr->m_Scale    = Scale;
+}
+
+
+/******************************************************************************
+* FUNCTION      : AVP_setSlope
+* DESCRIPTION   :
+* Sets the load line to MilliOhm, 0 to AVP_MAX_MOHM, 0 for none. The gain is
+* written with one store and used from the next cycle.
+******************************************************************************/
+void AVP_setSlope( AVP_Data* Ptr, int MilliOhm )
+{
+    if( MilliOhm < 0 )
+    {
+        MilliOhm = 0;
+    }
+    else if( MilliOhm > AVP_MAX_MOHM )
+    {
+        MilliOhm = AVP_MAX_MOHM;
+    }
+    Ptr->m_MilliOhm = MilliOhm;
+    Ptr->m_Gain     = (int32_t)(((int64_t)MilliOhm * Ptr->m_Scale) >> 8);
+}
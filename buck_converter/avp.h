@@ -0,0 +1,124 @@
+/*******************************************************************************
+* FILE          : avp.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Adaptive voltage positioning: the output follows a load line.
+*
+* A loop that holds Vout at the reference whatever the load has to undo every
+* load step, and the output capacitor has to hold the output up, or down,
+* until it has: the deviation is twice the step times the impedance the loop
+* leaves. With a load line of R, Vout = Ref - R.Io, the output sits low at
+* full load and high at no load, so a step up starts from above and ends
+* below and the same window takes a step with about half the deviation, or
+* the same step with less capacitance. R is given in mOhm, which is mV per
+* amp.
+*
+* AVP_apply() in the control ISR, before the control law runs, takes the
+* reference of the controller as the soft-start, PMB_update() or DVS have
+* left it, and lowers it by the droop, the load current times m_Gain, within
+* 0..m_Max. AVP_restore() after the control law puts the reference back, so
+* that those that set it, which only write it while it moves, see the value
+* they wrote and the idle loop never sees the lowered one. All in fixed point:
+* m_Gain is ADC counts of Vo per count of current, Q16, which AVP_setSlope()
+* works out in the idle loop from the mOhm and m_Scale, the counts per volt
+* of Vo over the counts per amp of the current and 1000, Q24.
+*
+* The load current is the caller's, e.g. the observer's estimate, see obs.h,
+* or a measured current. A noisy one makes the droop noisy by m_Gain: at
+* 25mOhm, 620.5 counts per volt and 403 counts per amp that is 0.04 counts of
+* Vo per count of current.
+*
+*   AVP_apply()     ~14 cycles      in the control ISR
+*   AVP_restore()   ~3 cycles       in the control ISR
+*   AVP_setSlope()  ~40 cycles      in the idle loop
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+*
+* EXAMPLES
+*   AVP_Data MyAvp;
+*
+*   AVP_init( &MyAvp, &MyCntrl, _IQ24(620.5/(403.0*1000)), 36 );
+*   AVP_setSlope( &MyAvp, 25 );                         // 25mOhm
+*
+*   interrupt void IsrAdc( void )
+*   {
+*       ...
+*       AVP_apply( &MyAvp, OBS_getIo( &MyObs ) );
+*       CNTRL_2p2z( &MyCntrl );
+*       CMP_setDac( CMP_MOD_2, MyCntrl.Out.m_Int );
+*       AVP_restore( &MyAvp );
+*       ...
+*       SOFT_update( &MySoft );
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _AVP_H
+#define _AVP_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  AVP_Data        AVP_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+#define AVP_MAX_MOHM    1000    /* highest slope AVP_setSlope() takes */
+
+/*******************************************************************************
+* STRUCT        : AVP_Data
+* DESCRIPTION   :
+* The load line structure.
+*******************************************************************************/
+struct AVP_Data
+{
+    CNTRL_2p2zData*     m_Cntrl;
+    volatile int32_t    m_Gain;     /* Vo counts per current count, Q16 */
+    int                 m_Max;      /* highest droop, Vo counts */
+    int                 m_Ref;      /* reference as set, put back */
+    int                 m_Droop;    /* taken off it this cycle, Vo counts */
+    int                 m_MilliOhm; /* slope */
+    _iq24               m_Scale;    /* Vo counts per mOhm.current count */
+};
+
+
+/*******************************************************************************
+* MACRO         : AVP_apply
+* DESCRIPTION   :
+* Lowers the reference of the controller by the droop at the load current Io.
+* Call it once per control cycle in the control ISR, before the control law.
+*******************************************************************************/
+#define AVP_apply( Ptr, Io )                                                \
+    do                                                                      \
+    {                                                                       \
+        (Ptr)->m_Ref   = (Ptr)->m_Cntrl->Ref.m_Int;                         \
+        (Ptr)->m_Droop = (int)(((int32_t)(Io) * (Ptr)->m_Gain) >> 16);      \
+        if( (Ptr)->m_Droop > (Ptr)->m_Max )                                 \
+            { (Ptr)->m_Droop = (Ptr)->m_Max; }                              \
+        if( (Ptr)->m_Droop < 0 ) { (Ptr)->m_Droop = 0; }                    \
+        (Ptr)->m_Cntrl->Ref.m_Int = (Ptr)->m_Ref - (Ptr)->m_Droop;          \
+    } while( 0 )
+
+/*******************************************************************************
+* MACRO         : AVP_restore
+* DESCRIPTION   :
+* Puts the reference back. Call it after the control law, before the
+* soft-start and whatever else sets the reference.
+*******************************************************************************/
+#define AVP_restore( Ptr )                                                  \
+    ((Ptr)->m_Cntrl->Ref.m_Int = (Ptr)->m_Ref)
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void AVP_init( AVP_Data* Ptr, CNTRL_2p2zData* Cntrl, _iq24 Scale,
+                      int Max );
+extern void AVP_setSlope( AVP_Data* Ptr, int MilliOhm );
+
+/********** END ***************************************************************/
+#endif
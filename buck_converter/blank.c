@@ -0,0 +1,206 @@
+/******************************************************************************
+* FILE          : blank.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Adaptive leading edge blanking of the peak current trip. See blank.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "blank.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#pragma CODE_SECTION( BLANK_update, "hotfuncs" );
+
+/* TZFLG and TZCLR bit */
+#define BLANK_TZ_DCAEVT2    0x0010
+
+static uint16_t BLANK_ticks( uint32_t Ns );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : BLANK_ticks
+* DESCRIPTION   :
+* Ns in ticks, limited to what DCFWINDOW holds.
+******************************************************************************/
+static uint16_t BLANK_ticks( uint32_t Ns )
+{
+    uint32_t Ticks = PWM_nsToTicks( Ns );
+
+    return Ticks > BLANK_TICKS_MAX ? BLANK_TICKS_MAX : (uint16_t)Ticks;
+}
+
+
+/******************************************************************************
+* FUNCTION      : BLANK_init
+* DESCRIPTION   :
+* Adapts the blanking window of Pwm, already set up by PWM_configBlanking().
+* pDemand is the current demand, which at FullDemand gives a floor of FullNs,
+* MinNs and MaxNs are the limits of the window and GuardNs the time after it
+* in which a trip may be ringing. The window starts at FullNs.
+******************************************************************************/
+void BLANK_init( BLANK_Data* Ptr, PWM_Module Pwm,
+                 const volatile int* pDemand, int FullDemand,
+                 uint32_t MinNs, uint32_t FullNs, uint32_t MaxNs,
+                 uint32_t GuardNs )
+{
+    Ptr->m_Pwm          = Pwm;
+    Ptr->m_pDemand      = pDemand;
+    Ptr->m_FullDemand   = FullDemand > 0 ? FullDemand : 1;
+    Ptr->m_Max          = BLANK_ticks( MaxNs );
+    Ptr->m_Min          = BLANK_ticks( MinNs );
+    if( Ptr->m_Min > Ptr->m_Max )
+    {
+        Ptr->m_Min = Ptr->m_Max;
+    }
+    Ptr->m_Full         = BLANK_ticks( FullNs );
+    if( Ptr->m_Full < Ptr->m_Min )
+    {
+        Ptr->m_Full = Ptr->m_Min;
+    }
+    else if( Ptr->m_Full > Ptr->m_Max )
+    {
+        Ptr->m_Full = Ptr->m_Max;
+    }
+    Ptr->m_Guard        = BLANK_ticks( GuardNs );
+    Ptr->m_Demand       = (long)Ptr->m_FullDemand << 4;
+    Ptr->m_Floor        = Ptr->m_Full;
+    Ptr->m_Extra        = 0;
+    Ptr->m_Hold         = 0;
+    Ptr->m_Window       = Ptr->m_Full;
+    Ptr->m_Next         = Ptr->m_Full;
+    Ptr->m_OnAvg        = 0;
+    Ptr->m_Cycles       = 0;
+    Ptr->m_Trips        = 0;
+    Ptr->m_Spurious     = 0;
+    Ptr->m_LastTrips    = 0;
+    Ptr->m_LastSpurious = 0;
+    Ptr->m_SpuriousTotal = 0;
+    Ptr->m_Widened      = 0;
+    Ptr->m_Narrowed     = 0;
+
+    PWM_setBlankingWindow( Pwm, (uint8_t)Ptr->m_Window );
+
+    /* DCCAP takes the counter at the filtered event, straight away */
+    EALLOW;
+    Pwm->DCCAPCTL.bit.SHDWMODE  = 1;
+    Pwm->DCCAPCTL.bit.CAPE      = 1;
+    Pwm->TZCLR.all              = BLANK_TZ_DCAEVT2;
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : BLANK_update
+* DESCRIPTION   :
+* Counts the cycle, and the trip in it, if any, and writes a new window.
+* Call it once per control cycle in the control ISR, after the window of the
+* cycle has ended.
+******************************************************************************/
+void BLANK_update( BLANK_Data* Ptr )
+{
+    PWM_Module Pwm = Ptr->m_Pwm;
+    uint16_t   On;
+
+    Ptr->m_Cycles++;
+    if( Pwm->TZFLG.bit.DCAEVT2 )
+    {
+        On = Pwm->DCCAP;
+        EALLOW;
+        Pwm->TZCLR.all = BLANK_TZ_DCAEVT2;
+        EDIS;
+
+        Ptr->m_Trips++;
+        if( On < Ptr->m_Window + Ptr->m_Guard &&
+            (On << 4) < Ptr->m_OnAvg - (Ptr->m_OnAvg >> 2) )
+        {
+            Ptr->m_Spurious++;
+        }
+        Ptr->m_OnAvg += ((int)(On << 4) - (int)Ptr->m_OnAvg) >> 4;
+    }
+
+    if( Ptr->m_Next != Ptr->m_Window )
+    {
+        Ptr->m_Window = Ptr->m_Next;
+        PWM_setBlankingWindow( Pwm, (uint8_t)Ptr->m_Window );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : BLANK_process
+* DESCRIPTION   :
+* Filters the current demand and, once a block, sets the next window from it
+* and from the spurious trips of the block. Call it from the idle loop.
+******************************************************************************/
+void BLANK_process( BLANK_Data* Ptr )
+{
+    long     Demand = *Ptr->m_pDemand;
+    uint16_t Trips;
+    uint16_t Spurious;
+    uint16_t Next;
+    uint16_t St;
+
+    Ptr->m_Demand += ((Demand << 4) - Ptr->m_Demand) >> 4;
+    if( Ptr->m_Cycles < BLANK_BLOCK )
+    {
+        return;
+    }
+
+    St = __disable_interrupts();
+    Trips           = Ptr->m_Trips;
+    Spurious        = Ptr->m_Spurious;
+    Ptr->m_Cycles   = 0;
+    Ptr->m_Trips    = 0;
+    Ptr->m_Spurious = 0;
+    __restore_interrupts( St );
+
+    Ptr->m_LastTrips     = Trips;
+    Ptr->m_LastSpurious  = Spurious;
+    Ptr->m_SpuriousTotal += Spurious;
+
+    /* The floor, from the operating point */
+    Demand = Ptr->m_Demand >> 4;
+    if( Demand < 0 )
+    {
+        Demand = 0;
+    }
+    else if( Demand > Ptr->m_FullDemand )
+    {
+        Demand = Ptr->m_FullDemand;
+    }
+    Ptr->m_Floor = Ptr->m_Min + (uint16_t)(((long)(Ptr->m_Full - Ptr->m_Min)
+                                 * Demand) / Ptr->m_FullDemand);
+
+    /* And the margin on it, from the statistics */
+    if( Spurious > BLANK_SPURIOUS )
+    {
+        Ptr->m_Extra += BLANK_UP;
+        if( Ptr->m_Extra > Ptr->m_Max - Ptr->m_Min )
+        {
+            Ptr->m_Extra = Ptr->m_Max - Ptr->m_Min;
+        }
+        Ptr->m_Hold = BLANK_HOLD;
+        Ptr->m_Widened++;
+    }
+    else if( Ptr->m_Hold )
+    {
+        Ptr->m_Hold--;
+    }
+    else if( Spurious == 0 && Ptr->m_Extra )
+    {
+        Ptr->m_Extra--;
+        Ptr->m_Narrowed++;
+    }
+
+    Next = Ptr->m_Floor + Ptr->m_Extra;
+    Ptr->m_Next = Next > Ptr->m_Max ? Ptr->m_Max : Next;
+}
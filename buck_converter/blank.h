@@ -0,0 +1,134 @@
+/*******************************************************************************
+* FILE          : blank.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Adaptive leading edge blanking of the peak current trip.
+*
+* The blanking window hides the turn on spike and the ringing after it from
+* the comparator trip, and is the shortest on-time the loop can give. A fixed
+* window has to be long enough for the worst ringing, at full load, so at
+* light load, where the ringing is small, it takes on-time away from high
+* step-down ratios for nothing. Here the window is set from two things:
+*
+*   the floor   the operating point, from m_Min at no current demand up to
+*               m_Full at m_FullDemand, in a straight line, as the ringing
+*               grows with the current switched. BLANK_process() follows the
+*               demand through a first order filter
+*   m_Extra     spurious trip statistics on top of the floor. A trip less
+*               than m_Guard after the window ends, and a quarter or more
+*               shorter than the average on-time, is ringing that has
+*               outlasted the window. More than BLANK_SPURIOUS of those in a
+*               block of BLANK_BLOCK cycles widens the window by BLANK_UP
+*               ticks at once; none narrows it by a tick, but not for
+*               BLANK_HOLD blocks after a widening
+*
+* The window is never below m_Min nor above m_Max. An on-time at the window
+* itself, where the trip came during it, is not spurious: the average on-time
+* takes in every trip, so short on-times that are the norm are not mistaken
+* for ringing and cannot widen the window without end.
+*
+* The time of a trip is DCCAP, the counter captured by the filtered event, so
+* the on-time in ticks as channel A rises at zero; BLANK_init() enables the
+* capture, straight into the active register. BLANK_update() in the control
+* ISR reads it when the TZFLG DCAEVT2 flag says the cycle tripped, clears the
+* flag and counts the trip; a DEAD_update() that shares the flag, see dead.h,
+* must come before it. The window counter does not shadow DCFWINDOW, so a new
+* window is only written by BLANK_update() itself, through
+* PWM_setBlankingWindow(), which is at a cycle boundary as long as the ISR
+* starts after m_Max has ended and before the next zero. With the ADC at CMPB
+* that is m_Max under about 2.5us at 200kHz.
+*
+*   BLANK_update()  ~28 cycles      in the control ISR, ~45 with a new window
+*   BLANK_process() ~15 cycles      in the idle loop, ~120 once a block
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+*
+* EXAMPLES
+*   BLANK_Data MyBlank;
+*
+*   PWM_configBlanking( PWM_MOD_1, PWM_CMP_COMP2, GPIO_NON_INVERT, true );
+*   BLANK_init( &MyBlank, PWM_MOD_1, &MyCntrl.Out.m_Int, 1023,
+*               200, 500, 700, 100 );
+*
+*   interrupt void IsrAdc( void )
+*   {
+*       ...
+*       BLANK_update( &MyBlank );
+*   }
+*
+*   while(1)
+*   {
+*       BLANK_process( &MyBlank );
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _BLANK_H
+#define _BLANK_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  BLANK_Data      BLANK_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+#define BLANK_BLOCK     256     /* cycles per block of statistics */
+#define BLANK_SPURIOUS  2       /* spurious trips per block let through */
+#define BLANK_UP        4       /* ticks per widening */
+#define BLANK_HOLD      16      /* blocks before narrowing after a widening */
+#define BLANK_TICKS_MAX 255     /* DCFWINDOW is 8 bits */
+
+/*******************************************************************************
+* STRUCT        : BLANK_Data
+* DESCRIPTION   :
+* The adaptive blanking structure.
+*******************************************************************************/
+struct BLANK_Data
+{
+    /* read and written every cycle by BLANK_update() */
+    PWM_Module          m_Pwm;
+    uint16_t            m_Window;       /* ticks, as in DCFWINDOW */
+    volatile uint16_t   m_Next;         /* ticks, from BLANK_process() */
+    uint16_t            m_Guard;        /* ticks after the window */
+    uint16_t            m_OnAvg;        /* on-time of the trips, ticks x 16 */
+    volatile uint16_t   m_Cycles;       /* in the block */
+    volatile uint16_t   m_Trips;
+    volatile uint16_t   m_Spurious;
+
+    /* idle loop */
+    const volatile int* m_pDemand;      /* current demand, DAC counts */
+    int                 m_FullDemand;
+    long                m_Demand;       /* filtered, x 16 */
+    uint16_t            m_Min;          /* ticks */
+    uint16_t            m_Full;         /* ticks, floor at m_FullDemand */
+    uint16_t            m_Max;          /* ticks */
+    uint16_t            m_Floor;        /* ticks */
+    uint16_t            m_Extra;        /* ticks */
+    uint16_t            m_Hold;         /* blocks */
+
+    /* statistics */
+    volatile uint16_t   m_LastTrips;    /* trips in the last block */
+    volatile uint16_t   m_LastSpurious;
+    volatile uint32_t   m_SpuriousTotal;
+    volatile uint16_t   m_Widened;
+    volatile uint16_t   m_Narrowed;
+};
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void BLANK_init( BLANK_Data* Ptr, PWM_Module Pwm,
+                        const volatile int* pDemand, int FullDemand,
+                        uint32_t MinNs, uint32_t FullNs, uint32_t MaxNs,
+                        uint32_t GuardNs );
+extern void BLANK_update( BLANK_Data* Ptr );
+extern void BLANK_process( BLANK_Data* Ptr );
+
+/********** END ***************************************************************/
+#endif
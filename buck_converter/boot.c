@@ -0,0 +1,84 @@
+/******************************************************************************
+* FILE          : boot.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Flash boot start up. See boot.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include <string.h>
+#include "csl.h"
+#include "boot.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+/* Set by the linker command file */
+extern uint16_t BootfuncsLoadStart, BootfuncsLoadEnd, BootfuncsRunStart;
+extern uint16_t HotfuncsLoadStart, HotfuncsLoadEnd, HotfuncsRunStart;
+extern uint16_t MpcTableLoadStart, MpcTableLoadEnd, MpcTableRunStart;
+
+/* The wait states must not be changed by code running from flash */
+#pragma CODE_SECTION( BOOT_initFlash, "bootfuncs" );
+
+static void BOOT_copy( uint16_t* LoadStart, uint16_t* LoadEnd,
+                       uint16_t* RunStart );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : BOOT_init
+* DESCRIPTION   :
+* Copies the hot sections from flash to RAM and sets the flash wait states.
+* Call it after SYS_init() and before any interrupt is enabled.
+******************************************************************************/
+void BOOT_init( void )
+{
+    BOOT_copy( &BootfuncsLoadStart, &BootfuncsLoadEnd, &BootfuncsRunStart );
+    BOOT_copy( &HotfuncsLoadStart, &HotfuncsLoadEnd, &HotfuncsRunStart );
+    BOOT_copy( &MpcTableLoadStart, &MpcTableLoadEnd, &MpcTableRunStart );
+    BOOT_initFlash();
+}
+
+
+/******************************************************************************
+* FUNCTION      : BOOT_copy
+* DESCRIPTION   :
+* Copies a section from its load to its run address, if they differ.
+******************************************************************************/
+static void BOOT_copy( uint16_t* LoadStart, uint16_t* LoadEnd,
+                       uint16_t* RunStart )
+{
+    if( RunStart != LoadStart )
+    {
+        memcpy( RunStart, LoadStart, LoadEnd - LoadStart );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : BOOT_initFlash
+* DESCRIPTION   :
+* Turns the flash prefetch pipeline on and sets the fewest wait states that
+* meet the access times at SYS_CLK_HZ. Runs from RAM; the eight cycle wait
+* at the end lets the flash pipeline take the new settings before any code
+* is fetched from flash again.
+******************************************************************************/
+void BOOT_initFlash( void )
+{
+    EALLOW;
+    FlashRegs.FOPT.bit.ENPIPE         = 1;
+    FlashRegs.FBANKWAIT.bit.PAGEWAIT  = BOOT_waitStates( BOOT_FLASH_PAGE_NS );
+    FlashRegs.FBANKWAIT.bit.RANDWAIT  = BOOT_waitStates( BOOT_FLASH_RAND_NS );
+    FlashRegs.FOTPWAIT.bit.OTPWAIT    = BOOT_waitStates( BOOT_OTP_NS );
+    FlashRegs.FSTDBYWAIT.bit.STDBYWAIT  = 0x01FF;
+    FlashRegs.FACTIVEWAIT.bit.ACTIVEWAIT = 0x01FF;
+    EDIS;
+
+    asm( " RPT #7 || NOP" );
+}
@@ -0,0 +1,77 @@
+/*******************************************************************************
+* FILE          : boot.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Start up for stand alone boot from flash with the control path in RAM.
+*
+* csl_28035_FLASH_lnk.cmd loads everything into flash and gives the control
+* path, and the MPC table it reads, a run address in zero wait state RAM:
+*
+*   hotfuncs    IsrAdc, the PIE handlers, CNTRL_2p2z(), SOFT_step() and
+*               the per cycle functions of the modules, e.g. OBS_update(),
+*               placed with #pragma CODE_SECTION( Func, "hotfuncs" )
+*   mpcTable    the explicit MPC search tree and laws
+*   bootfuncs   BOOT_initFlash(), which must not run from flash
+*
+* BOOT_init(), called straight after SYS_init() and before any callback is
+* set, copies them to RAM and then sets the flash wait states for SYS_CLK_HZ
+* from code already in RAM. With csl_28035_RAM_lnk.cmd the load and run
+* addresses are the same and only the wait states are set, so the same source
+* runs under either linker file.
+*
+* At 60MHz the flash needs 2 wait states on a page or random access and 3 on
+* the OTP, with the prefetch pipeline on. Code running from flash then loses
+* about 3 cycles on every call, return and taken branch and on every constant
+* read from flash, and a few per cent on straight code. Estimates for the
+* default build, ISR entry to return:
+*
+*                           RAM     flash
+*   CNTRL_2p2z()            64      ~80
+*   IsrAdc, PCM + observer  ~200    ~265
+*   IsrAdc, MPC             ~170    ~280
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+* Link with --define=HOT_IN_FLASH to leave the hot sections in flash for the
+* comparison, see doc/flash_boot.txt.
+*
+* EXAMPLES
+*   #pragma CODE_SECTION( IsrAdc, "hotfuncs" );
+*
+*   SYS_init();
+*   BOOT_init();
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _BOOT_H
+#define _BOOT_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+
+
+/********** TYPES SECTION *****************************************************/
+
+/* Flash and OTP access times of the F2803x, ns */
+#define BOOT_FLASH_PAGE_NS  40
+#define BOOT_FLASH_RAND_NS  40
+#define BOOT_OTP_NS         60
+
+/*******************************************************************************
+* MACRO         : BOOT_waitStates
+* DESCRIPTION   :
+* Wait states for an access time of Ns at SYS_CLK_HZ: the access takes
+* BOOT_waitStates + 1 clock cycles.
+*******************************************************************************/
+#define BOOT_waitStates( Ns )   ((1000L*(Ns) + SYS_CLK_PS - 1) / SYS_CLK_PS - 1)
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void BOOT_init( void );
+extern void BOOT_initFlash( void );
+
+/********** END ***************************************************************/
+#endif
@@ -190,9 +190,9 @@ struct CLA_2p2zData
 *******************************************************************************/
 struct CLA_Ctrl
 {
-    long    m_Ref;  /* +0 */
-    long    m_Delta;
-    long    m_Max;
+    int32_t m_Ref;  /* +0 */
+    int32_t m_Delta;
+    int32_t m_Max;
 };
 
 
@@ -125,16 +125,20 @@ extern int CMP_getIndex( CMP_Module Mod );
 extern CMP_Module CMP_getMod( int Index );
 #endif /* LIB_FUNC */
 extern uint16_t CMP_mVtoDacValue( uint16_t mVolts );
+#ifdef LIB_FUNC
 extern void CMP_setDac( CMP_Module Mod, uint16_t Value );
+#endif /* LIB_FUNC */
 
 /********** USER MIDDLE SECTION ***********************************************/
 #ifndef LIB_FUNC
 #define CMP_getIndex( Mod )                     MACRO_CMP_getIndex( Mod )
 #define CMP_getMod( Index )                     MACRO_CMP_getMod( Index )
+#define CMP_setDac( Mod, Value )                MACRO_CMP_setDac( Mod, Value )
 #endif /* LIB_FUNC */
 
 #define MACRO_CMP_getIndex( Mod )           ((TL_CMP_MOD_SIZE*)(Mod)-(TL_CMP_MOD_SIZE*)CMP_MOD_1)
 #define MACRO_CMP_getMod( Index )           ((CMP_Module)((TL_CMP_MOD_SIZE*)(CMP_MOD_1)+Index))
+#define MACRO_CMP_setDac( Mod, Value )      (Mod)->DACVAL.all = (Value)
 
 
 /********** END ***************************************************************/
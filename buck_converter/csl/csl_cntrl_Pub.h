@@ -19,6 +19,9 @@
 * CNTRL_2p2z()        64    .64us
 * CNTRL_2p2zInline()  44    .44us
 *
+* CNTRL_2p2zC() is the same 2p2z in C, see below. It is what CNTRL_2p2z() is
+* on the host and, with CNTRL_INLINE set to 1, on the C28x.
+*
 * The C wrapper contains a small time penalty when compared to pure assembly but
 * it has the advantage that no knowledge of assembly is required.
 *
@@ -420,6 +423,96 @@ extern void CNTRL_3p3zFloat( CNTRL_3p3zDataFloat* Ptr );
 
 /********** USER MIDDLE SECTION ***********************************************/
 
+/*******************************************************************************
+* COMPLEX       : CNTRL_INLINE
+* DESCRIPTION   :
+* Selects what CNTRL_2p2z() is:
+*
+*   0   the assembler function, called. The default on the C28x.
+*   1   CNTRL_2p2zC(), compiled in where it is used. The default on the host.
+*
+* Set it to 1 on the C28x to profile or step the controller at source level.
+* CNTRL_2p2zC() has no call but the compiler does not build the QMPYL and
+* saturating ADDL sequence of the assembler from it, so it is slower there;
+* CNTRL_2p2zInline() is the fast way to remove the call on the C28x.
+*******************************************************************************/
+#ifndef CNTRL_INLINE
+#ifdef __TMS320C28XX__
+#define CNTRL_INLINE 0
+#else
+#define CNTRL_INLINE 1
+#endif
+#endif
+
+#ifndef HEADER_ONLY
+#if CNTRL_INLINE
+#define CNTRL_2p2z( Ptr )   CNTRL_2p2zC( Ptr )
+#endif
+
+/*******************************************************************************
+* MACRO         : CNTRL_qmpyl
+* DESCRIPTION   :
+* The top 32 bits of the 64 bit product of A and B, as QMPYL.
+*******************************************************************************/
+#define CNTRL_qmpyl( A, B ) ((int32_t)(((int64_t)(A)*(int32_t)(B))>>32))
+
+/*******************************************************************************
+* FUNCTION      : CNTRL_addSat
+* DESCRIPTION   :
+* A + B saturated to 32 bits, as ADDL with OVM set.
+*******************************************************************************/
+static __inline int32_t CNTRL_addSat( int32_t A, int32_t B )
+{
+    int32_t Sum = (int32_t)((uint32_t)A + (uint32_t)B);
+
+    if( ((A ^ Sum) & (B ^ Sum)) < 0 )
+    {
+        Sum = (A < 0) ? INT32_MIN : INT32_MAX;
+    }
+    return Sum;
+}
+
+/*******************************************************************************
+* FUNCTION      : CNTRL_2p2zC
+* DESCRIPTION   :
+* C version of CNTRL_2p2z(), bit for bit the same as the assembler: the same Q
+* formats and histories, the products truncated to their top 32 bits, the
+* additions saturated and the final shift by 5 not.
+*******************************************************************************/
+static __inline void CNTRL_2p2zC( CNTRL_2p2zData* Ptr )
+{
+    int32_t Acc;
+
+    Ptr->m_E0 = (int32_t)((uint32_t)(Ptr->Ref.m_Int - Ptr->Fdbk.m_Int) << 16);
+
+    Acc = CNTRL_qmpyl( Ptr->m_E2, Ptr->m_B2 );              /* Q25 */
+    Ptr->m_E2 = Ptr->m_E1;
+    Acc = CNTRL_addSat( Acc, CNTRL_qmpyl( Ptr->m_E1, Ptr->m_B1 ) );
+    Ptr->m_E1 = Ptr->m_E0;
+    Acc = CNTRL_addSat( Acc, CNTRL_qmpyl( Ptr->m_E0, Ptr->m_B0 ) );
+    Ptr->temp = Acc >> 1;                                   /* Q24 */
+
+    Acc = CNTRL_qmpyl( Ptr->m_U2, Ptr->m_A2 );              /* Q18 */
+    Ptr->m_U2 = Ptr->m_U1;
+    Acc = CNTRL_addSat( Acc, CNTRL_qmpyl( Ptr->m_U1, Ptr->m_A1 ) );
+    Acc = (int32_t)((uint32_t)Acc << 5);
+    Acc = CNTRL_addSat( Acc, Acc );                         /* Q24 */
+    Acc = CNTRL_addSat( Acc, (int32_t)Ptr->temp );
+    Ptr->m_U1 = Acc;
+
+    Acc = CNTRL_qmpyl( Acc, Ptr->m_K );                     /* Q15 */
+    if( Acc > Ptr->m_max )
+    {
+        Acc = Ptr->m_max;
+    }
+    if( Acc < Ptr->m_min )
+    {
+        Acc = Ptr->m_min;
+    }
+    Ptr->Out.m_Int = (int16_t)Acc;
+}
+#endif /* HEADER_ONLY */
+
 
 /********** END ***************************************************************/
 #endif
@@ -0,0 +1,202 @@
+/*******************************************************************************
+* FILE          : csl_adc_t3_Pri.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Chip Support Library
+* DESCRIPTION   :
+* Source of the ADC functions of csl_adc_t3_Pub.h that are not macros.
+*
+* An ADC_Module is a start of conversion, SOC0 to SOC15, and its result
+* register. ADC_Interrupt carries the ADCINTx number in its value and the
+* INT_PieId in its register part.
+*
+* Built in place of csl2803x_ml.lib when CSL_SOURCE is defined, see
+* doc/csl_source.txt.
+*
+* HISTORY       :
+*******************************************************************************/
+
+#ifdef CSL_SOURCE
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+/* ADCINTx enable in the INTSELxNy field, with the EOC in the low 5 bits */
+#define ADC_INTSEL_INTE     0x20
+
+static bool gAdcInit = false;
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : ADC_init
+* DESCRIPTION   :
+* Resets the ADC and powers it up on the internal reference, with the
+* interrupt pulse at the end of the conversion and no SOC raising an
+* interrupt, then waits the 1ms the data sheet asks for.
+******************************************************************************/
+void ADC_init( void )
+{
+    EALLOW;
+    SysCtrlRegs.PCLKCR0.bit.ADCENCLK = 1;
+    AdcRegs.ADCCTL1.bit.RESET       = 1;
+    __asm(" RPT #2 || NOP");
+    AdcRegs.ADCCTL1.bit.ADCREFSEL   = 0;
+    AdcRegs.ADCCTL1.bit.ADCBGPWD    = 1;
+    AdcRegs.ADCCTL1.bit.ADCREFPWD   = 1;
+    AdcRegs.ADCCTL1.bit.ADCPWDN     = 1;
+    AdcRegs.ADCCTL1.bit.ADCENABLE   = 1;
+    AdcRegs.ADCCTL1.bit.INTPULSEPOS = 1;
+    AdcRegs.ADCCTL1.bit.VREFLOCONV  = 0;
+    AdcRegs.ADCCTL1.bit.TEMPCONV    = 0;
+    AdcRegs.INTSEL1N2.all           = 0;
+    AdcRegs.INTSEL3N4.all           = 0;
+    AdcRegs.INTSEL5N6.all           = 0;
+    AdcRegs.INTSEL7N8.all           = 0;
+    AdcRegs.INTSEL9N10.all          = 0;
+    EDIS;
+
+    SYS_msDelay( 1 );
+    gAdcInit = true;
+}
+
+
+/******************************************************************************
+* FUNCTION      : ADC_setEarlyInterrupt
+* DESCRIPTION   :
+* Moves the interrupt pulse to the end of the acquisition window if Enable,
+* a conversion time before the result is ready.
+******************************************************************************/
+void ADC_setEarlyInterrupt( int Enable )
+{
+    EALLOW;
+    AdcRegs.ADCCTL1.bit.INTPULSEPOS = Enable ? 0 : 1;
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : ADC_setExternalRefernce
+* DESCRIPTION   :
+* Selects the external VREFHI/VREFLO reference if Enable.
+******************************************************************************/
+void ADC_setExternalRefernce( int Enable )
+{
+    EALLOW;
+    AdcRegs.ADCCTL1.bit.ADCREFSEL = Enable ? 1 : 0;
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : ADC_config
+* DESCRIPTION   :
+* Sets the channel, acquisition window and trigger of a SOC. The ADCINT1/2
+* triggers are taken from ADCINTSOCSELx, with the SOC trigger left at
+* software.
+******************************************************************************/
+void ADC_config( ADC_Module Mod, ADC_SampleHoldWidth SH,
+                 ADC_Channel Chan, ADC_TriggerSelect TrigSel )
+{
+    volatile uint16_t* pSocSel = Mod < ADC_MOD_9 ? &AdcRegs.ADCINTSOCSEL1.all
+                                                 : &AdcRegs.ADCINTSOCSEL2.all;
+    uint16_t Shift  = 2*(Mod & 7);
+    uint16_t IntSel = 0;
+    uint16_t Trig   = TrigSel;
+
+    if( !gAdcInit )
+    {
+        ERR_Value = ERR_ADC_NOT_INIT;
+        return;
+    }
+    if( Chan > ADC_CH_B7 )
+    {
+        ERR_Value = ERR_ADC_CHAN_INVALID;
+        return;
+    }
+
+    if( TrigSel == ADC_TRIG_ADCINT1 || TrigSel == ADC_TRIG_ADCINT2 )
+    {
+        IntSel = TrigSel & 3;
+        Trig   = ADC_TRIG_NONE;
+    }
+
+    EALLOW;
+    *pSocSel = (*pSocSel & ~(3 << Shift)) | (IntSel << Shift);
+    (&AdcRegs.ADCSOC0CTL.all)[Mod] = (Trig << 11) | ((uint16_t)Chan << 6) | SH;
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : ADC_setCallback
+* DESCRIPTION   :
+* Raises AdcInt at the end of conversion of Mod and, if Func is not 0, sets
+* it as the ISR and enables the interrupt in the PIE.
+******************************************************************************/
+void ADC_setCallback( ADC_Module Mod, INT_IsrAddr Func,
+                      ADC_Interrupt AdcInt )
+{
+    uint16_t Int    = SYS_LIT_VALUE( AdcInt );
+    uint16_t Shift  = (Int & 1) * 8;
+    volatile uint16_t* pSel = &AdcRegs.INTSEL1N2.all + Int/2;
+    INT_PieId PieId = ADC_getPieId( AdcInt );
+
+    EALLOW;
+    *pSel = (*pSel & ~(0xFF << Shift)) | ((Mod | ADC_INTSEL_INTE) << Shift);
+    EDIS;
+
+    if( Func )
+    {
+        INT_setCallback( INT_pieIdToVectorId( PieId ), Func );
+        INT_enablePieId( PieId, true );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : ADC_startConversion
+* DESCRIPTION   :
+* Converts Mod in software, waits for AdcInt and returns the result. AdcInt
+* must already be set to the end of conversion of Mod.
+******************************************************************************/
+uint16_t ADC_startConversion( ADC_Module Mod, ADC_Interrupt AdcInt )
+{
+    ADC_clrInt( AdcInt );
+    ADC_socSoftware( Mod );
+    while( !ADC_isReady( AdcInt ) )
+    {
+    }
+    ADC_clrInt( AdcInt );
+    return ADC_getValue( Mod );
+}
+
+
+/******************************************************************************
+* FUNCTION      : ADC_socSoftware
+* DESCRIPTION   :
+* Forces a start of conversion of Mod.
+******************************************************************************/
+void ADC_socSoftware( ADC_Module Mod )
+{
+    AdcRegs.ADCSOCFRC1.all = 1 << Mod;
+}
+
+
+/******************************************************************************
+* FUNCTION      : ADC_setPriority
+* DESCRIPTION   :
+* Gives SOC0 up to Mod high priority over the round robin.
+******************************************************************************/
+void ADC_setPriority( ADC_Module Mod )
+{
+    EALLOW;
+    AdcRegs.SOCPRICTL.bit.SOCPRIORITY = Mod + 1;
+    EDIS;
+}
+
+#endif /* CSL_SOURCE */
@@ -0,0 +1,133 @@
+/*******************************************************************************
+* FILE          : csl_cla_t0_Pri.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Chip Support Library
+* DESCRIPTION   :
+* Source of the CLA task functions of csl_cla_t0_Pub.h used by the buck
+* converter. The task code itself comes from the CLA_...() macros of the
+* header, linked into Cla1Prog.
+*
+* The first CLA_config() turns the CLA clock on, copies Cla1Prog from its
+* load address to the CLA program RAM and hands that RAM to the CLA. A task
+* vector is the offset of the task from the start of the program RAM.
+*
+* Built in place of csl2803x_ml.lib when CSL_SOURCE is defined, see
+* doc/csl_source.txt.
+*
+* HISTORY       :
+*******************************************************************************/
+
+#ifdef CSL_SOURCE
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+/* Set by the linker command file */
+extern uint16_t Cla1funcsLoadStart, Cla1funcsLoadEnd, Cla1funcsRunStart;
+
+static bool gClaInit = false;
+
+static void CLA_init( void );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : CLA_config
+* DESCRIPTION   :
+* Points task Mod at pFunc and sets what starts it.
+******************************************************************************/
+void CLA_config( CLA_Module Mod, Uint32* pFunc, CLA_IntMode Mode )
+{
+    uint16_t Shift = 4*Mod;
+
+    if( !gClaInit )
+    {
+        CLA_init();
+    }
+
+    EALLOW;
+    (&Cla1Regs.MVECT1)[Mod] = (uint16_t)((uint16_t*)pFunc - &Cla1funcsRunStart);
+    Cla1Regs.MPISRCSEL1.all = (Cla1Regs.MPISRCSEL1.all & ~(0xFUL << Shift)) |
+                              ((uint32_t)Mode << Shift);
+    Cla1Regs.MIER.all |= 1 << Mod;
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : CLA_init
+* DESCRIPTION   :
+* Resets the CLA, with all the tasks disabled, and loads its program once.
+******************************************************************************/
+static void CLA_init( void )
+{
+    uint16_t* pSrc = &Cla1funcsLoadStart;
+    uint16_t* pDst = &Cla1funcsRunStart;
+
+    EALLOW;
+    SysCtrlRegs.PCLKCR3.bit.CLA1ENCLK = 1;
+    Cla1Regs.MCTL.bit.HARDRESET = 1;
+    __asm(" RPT #2 || NOP");
+    Cla1Regs.MMEMCFG.bit.PROGE  = 0;
+    Cla1Regs.MIER.all           = 0;
+    EDIS;
+
+    if( pDst != pSrc )
+    {
+        while( pSrc < &Cla1funcsLoadEnd )
+        {
+            *pDst++ = *pSrc++;
+        }
+    }
+
+    EALLOW;
+    Cla1Regs.MMEMCFG.bit.PROGE = 1;
+    Cla1Regs.MCTL.bit.IACKE    = 1;
+    EDIS;
+    gClaInit = true;
+}
+
+
+/******************************************************************************
+* FUNCTION      : CLA_isRunning
+* DESCRIPTION   :
+* True while task Mod is executing.
+******************************************************************************/
+bool CLA_isRunning( CLA_Module Mod )
+{
+    return (Cla1Regs.MIRUN.all & (1 << Mod)) != 0;
+}
+
+
+/******************************************************************************
+* FUNCTION      : CLA_softwareStart
+* DESCRIPTION   :
+* Starts task Mod from the CPU.
+******************************************************************************/
+void CLA_softwareStart( CLA_Module Mod )
+{
+    EALLOW;
+    Cla1Regs.MIFRC.all = 1 << Mod;
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : CLA_softwareStartWait
+* DESCRIPTION   :
+* Starts task Mod from the CPU and waits for it to finish.
+******************************************************************************/
+void CLA_softwareStartWait( CLA_Module Mod )
+{
+    CLA_softwareStart( Mod );
+    while( (Cla1Regs.MIFR.all | Cla1Regs.MIRUN.all) & (1 << Mod) )
+    {
+    }
+}
+
+#endif /* CSL_SOURCE */
@@ -0,0 +1,76 @@
+/*******************************************************************************
+* FILE          : csl_cmp_t0_Pri.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Chip Support Library
+* DESCRIPTION   :
+* Source of the comparator functions of csl_cmp_t0_Pub.h. CMP_setDac() is
+* a macro, the only one called every cycle.
+*
+* Built in place of csl2803x_ml.lib when CSL_SOURCE is defined, see
+* doc/csl_source.txt.
+*
+* HISTORY       :
+*******************************************************************************/
+
+#ifdef CSL_SOURCE
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : CMP_config
+* DESCRIPTION   :
+* Turns the comparator and its DAC on, at 0. The output is qualified over
+* Sample clocks, or passed through asynchronously for CMP_ASYNC.
+******************************************************************************/
+void CMP_config( CMP_Module Mod, CMP_Sample Sample, GPIO_Level Level,
+                 CMP_Source Source )
+{
+    EALLOW;
+    SysCtrlRegs.PCLKCR3.all |= 1 << CMP_getIndex( Mod );
+
+    Mod->COMPCTL.bit.COMPDACEN  = 1;
+    Mod->COMPCTL.bit.COMPSOURCE = Source;
+    Mod->COMPCTL.bit.CMPINV     = Level;
+    if( Sample == CMP_ASYNC )
+    {
+        Mod->COMPCTL.bit.SYNCSEL = 0;
+        Mod->COMPCTL.bit.QUALSEL = 0;
+    }
+    else
+    {
+        Mod->COMPCTL.bit.SYNCSEL = 1;
+        Mod->COMPCTL.bit.QUALSEL = Sample;
+    }
+    Mod->DACCTL.bit.DACSOURCE   = 0;
+    EDIS;
+    Mod->DACVAL.all             = 0;
+}
+
+
+/******************************************************************************
+* FUNCTION      : CMP_pin
+* DESCRIPTION   :
+* Connects the comparator output to its pin, for the scope.
+******************************************************************************/
+void CMP_pin( CMP_Module Mod )
+{
+    GPIO_setMux( CMP_getGpioPin( Mod ), GPIO_MUX_ALT3 );
+}
+
+
+/******************************************************************************
+* FUNCTION      : CMP_mVtoDacValue
+* DESCRIPTION   :
+* Converts mVolts to DAC counts of the 3.3V, 10 bit DAC.
+******************************************************************************/
+uint16_t CMP_mVtoDacValue( uint16_t mVolts )
+{
+    return (uint16_t)((1L*mVolts*CMP_ValueMax) / 3300L);
+}
+
+#endif /* CSL_SOURCE */
@@ -0,0 +1,76 @@
+;*******************************************************************************
+;* FILE          : csl_cntrl_2p2z.asm
+;* AUTHOR        : digital-buck-converter contributors
+;* PROJECT       : Chip Support Library
+;* DESCRIPTION   :
+;* CNTRL_2p2z(), the called version of CNTRL_2p2zInline() in csl_cntrl_Pub.h.
+;* The instruction sequence is the same; the structure is addressed through
+;* XAR4, XAR5 and XAR6 instead of DP since it is passed by pointer, and OVM is
+;* cleared again on return as the C environment expects.
+;*
+;*   void CNTRL_2p2z( CNTRL_2p2zData* Ptr );    Ptr in XAR4
+;*
+;* Uses only the save on call registers ACC, P, XT and XAR4-XAR7. Placed in
+;* hotfuncs so that csl_28035_FLASH_lnk.cmd runs it from RAM.
+;*
+;* Assembled only with --asm_define=CSL_SOURCE, see doc/csl_source.txt.
+;*
+;* HISTORY       :
+;*******************************************************************************
+
+        .if $isdefed("CSL_SOURCE")
+
+        .global _CNTRL_2p2z
+        .sect   "hotfuncs"
+
+_CNTRL_2p2z:
+        MOVL    XAR7,XAR4
+        ADDB    XAR7,#18            ; (COEFF) coefficient pointer, B2
+        MOVL    XAR5,XAR4
+        ADDB    XAR5,#8             ; (DBUFF) U1
+        MOVL    XAR6,XAR4
+        ADDB    XAR6,#16            ; E2
+
+        SETC    SXM,OVM
+        MOV     ACC,*+XAR4[0]       ; (Ref) Q15
+        SUB     ACC,*+XAR4[2]       ; (Fdbk) Q15
+        LSL     ACC,#16             ; Q31
+
+        ; Diff equation
+        MOVL    *+XAR5[4],ACC       ; e(n)
+        MOVL    XT,*XAR6            ; XT = e(n-2), Q31
+        QMPYL   ACC,XT,*XAR7++      ; b2*e(n-2), Q26*Q31 (64-bit result)
+
+        MOVDL   XT,*+XAR5[6]        ; XT = e(n-1), e(n-2) = e(n-1)
+        QMPYL   P,XT,*XAR7++        ; P = b1*e(n-1)
+        ADDL    ACC,P               ; 64-bit result in Q57, so ACC is in Q25
+
+        MOVDL   XT,*+XAR5[4]        ; XT = e(n), e(n-1) = e(n)
+        QMPYL   P,XT,*XAR7++        ; P = b0*e(n)
+        ADDL    ACC,P               ; ACC = b2*e(n-2)+b1*e(n-1)+b0*e(n), Q25
+        SFR     ACC,#1
+        MOVL    *+XAR4[6],ACC       ; (temp) Q24
+
+        MOVL    XT,*+XAR5[2]        ; XT = u(n-2), Q24
+        QMPYL   ACC,XT,*XAR7++      ; ACC = a2*u(n-2), Q26*Q24 (64-bit result)
+
+        MOVDL   XT,*+XAR5[0]        ; XT = u(n-1), u(n-2) = u(n-1)
+        QMPYL   P,XT,*XAR7++        ; P = a1*u(n-1)
+        ADDL    ACC,P               ; ACC = a1*u(n-1)+a2*u(n-2), Q18
+
+        LSL     ACC,#5              ; Q23
+        ADDL    ACC,ACC             ; Q24
+        ADDL    ACC,*+XAR4[6]       ; (temp) ACC = u(n), Q24
+        MOVL    *+XAR5[0],ACC       ; u(n)
+
+        MOVL    XT,ACC              ; XT = u(n), Q24
+        QMPYL   ACC,XT,*XAR7++      ; ACC = u(n)*K(Q23) >> 32 => Q15
+
+        MINL    ACC,*XAR7++         ; saturate the result [min,max]
+        MAXL    ACC,*XAR7++
+
+        MOV     *+XAR4[4],AL        ; (Out)
+        CLRC    OVM
+        LRETR
+
+        .endif
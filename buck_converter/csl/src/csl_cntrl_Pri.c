@@ -0,0 +1,143 @@
+/*******************************************************************************
+* FILE          : csl_cntrl_Pri.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Chip Support Library
+* DESCRIPTION   :
+* Source of the 2p2z controller functions of csl_cntrl_Pub.h. CNTRL_2p2z()
+* itself is csl_cntrl_2p2z.asm on the C28x and CNTRL_2p2zC() elsewhere.
+*
+* The soft-start keeps the nominal reference in m_SoftMax and the ramping one
+* in m_SoftRef, both shifted up by 16 so that ramps longer than 65535 cycles
+* still step. Once configured CNTRL_2p2zSoftStartUpdate() writes Ref on every
+* call, at the end of the ramp with the value it stopped at.
+*
+* Built in place of csl2803x_ml.lib when CSL_SOURCE is defined, see
+* doc/csl_source.txt.
+*
+* HISTORY       :
+*******************************************************************************/
+
+#ifdef CSL_SOURCE
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+/* Called every cycle, run from RAM with csl_28035_FLASH_lnk.cmd */
+#pragma CODE_SECTION( CNTRL_2p2zSoftStartUpdate, "hotfuncs" );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : CNTRL_2p2zInit
+* DESCRIPTION   :
+* Stores the reference, coefficients and output limits and clears the
+* histories. The soft-start is left off, at the reference.
+******************************************************************************/
+void CNTRL_2p2zInit( CNTRL_2p2zData* Ptr, _iq15 Ref, _iq26 A1, _iq26 A2,
+                     _iq26 B0, _iq26 B1, _iq26 B2, _iq23 K, _iq15 Min,
+                     _iq15 Max )
+{
+    Ptr->Ref.m_IQ   = Ref;
+    Ptr->Fdbk.m_IQ  = 0;
+    Ptr->Out.m_IQ   = 0;
+    Ptr->temp       = 0;
+    Ptr->m_U1       = 0;
+    Ptr->m_U2       = 0;
+    Ptr->m_E0       = 0;
+    Ptr->m_E1       = 0;
+    Ptr->m_E2       = 0;
+    Ptr->m_B2       = B2;
+    Ptr->m_B1       = B1;
+    Ptr->m_B0       = B0;
+    Ptr->m_A2       = A2;
+    Ptr->m_A1       = A1;
+    Ptr->m_K        = K;
+    Ptr->m_max      = Max;
+    Ptr->m_min      = Min;
+
+    Ptr->m_PeriodCount  = 0;
+    Ptr->m_SoftRamp     = 0;
+    Ptr->m_SoftMax      = (long)Ptr->Ref.m_Int << 16;
+    Ptr->m_SoftRef      = Ptr->m_SoftMax;
+}
+
+
+#ifndef __TMS320C28XX__
+/******************************************************************************
+* FUNCTION      : CNTRL_2p2z
+* DESCRIPTION   :
+* Called version of CNTRL_2p2zC() for compilers without the assembler.
+******************************************************************************/
+void (CNTRL_2p2z)( CNTRL_2p2zData* Ptr )
+{
+    CNTRL_2p2zC( Ptr );
+}
+#endif
+
+
+/******************************************************************************
+* FUNCTION      : CNTRL_2p2zSoftStartConfig
+* DESCRIPTION   :
+* Starts a ramp of the reference from zero up to its present value over
+* RampMs, CNTRL_2p2zSoftStartUpdate() being called every UpdatePeriodNs.
+******************************************************************************/
+void CNTRL_2p2zSoftStartConfig( CNTRL_2p2zData* Ptr, uint32_t RampMs,
+                                uint32_t UpdatePeriodNs )
+{
+    uint32_t Steps = RampMs * 1000000L / UpdatePeriodNs;
+
+    Ptr->m_SoftMax  = (long)Ptr->Ref.m_Int << 16;
+    Ptr->m_SoftRef  = 0;
+    Ptr->m_SoftRamp = Steps ? Ptr->m_SoftMax / (long)Steps : Ptr->m_SoftMax;
+    if( Ptr->m_SoftRamp == 0 )
+    {
+        Ptr->m_SoftRamp = 1;
+    }
+    Ptr->Ref.m_Int  = 0;
+}
+
+
+/******************************************************************************
+* FUNCTION      : CNTRL_2p2zSoftStartUpdate
+* DESCRIPTION   :
+* Moves the reference one step along the ramp, if one has been configured.
+******************************************************************************/
+void CNTRL_2p2zSoftStartUpdate( CNTRL_2p2zData* Ptr )
+{
+    if( Ptr->m_SoftRamp == 0 )
+    {
+        return;
+    }
+
+    Ptr->m_SoftRef += Ptr->m_SoftRamp;
+    if( Ptr->m_SoftRef > Ptr->m_SoftMax )
+    {
+        Ptr->m_SoftRef = Ptr->m_SoftMax;
+    }
+    else if( Ptr->m_SoftRef < 0 )
+    {
+        Ptr->m_SoftRef = 0;
+    }
+    Ptr->Ref.m_Int = (int)(Ptr->m_SoftRef >> 16);
+}
+
+
+/******************************************************************************
+* FUNCTION      : CNTRL_2p2zSoftStartDirection
+* DESCRIPTION   :
+* Ramps the reference up to the nominal value if PowerUp is true, otherwise
+* down to zero, from wherever it is, at the configured rate.
+******************************************************************************/
+void CNTRL_2p2zSoftStartDirection( CNTRL_2p2zData* Ptr, int PowerUp )
+{
+    long Ramp = Ptr->m_SoftRamp < 0 ? -Ptr->m_SoftRamp : Ptr->m_SoftRamp;
+
+    Ptr->m_SoftRamp = PowerUp ? Ramp : -Ramp;
+}
+
+#endif /* CSL_SOURCE */
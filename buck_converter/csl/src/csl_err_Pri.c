@@ -0,0 +1,26 @@
+/*******************************************************************************
+* FILE          : csl_err_Pri.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Chip Support Library
+* DESCRIPTION   :
+* The error value of csl_err_Pub.h, set by the functions of the CSL when they
+* detect a fault.
+*
+* Built in place of csl2803x_ml.lib when CSL_SOURCE is defined, see
+* doc/csl_source.txt.
+*
+* HISTORY       :
+*******************************************************************************/
+
+#ifdef CSL_SOURCE
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+ERR_Id ERR_Value = ERR_ERR_OK;
+
+#endif /* CSL_SOURCE */
@@ -0,0 +1,164 @@
+/*******************************************************************************
+* FILE          : csl_gpio_t0_Pri.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Chip Support Library
+* DESCRIPTION   :
+* Source of the GPIO functions of csl_gpio_t0_Pub.h.
+*
+* Port B follows port A 16 words later in the control registers, and each
+* port has two mux and two qualification registers of 16 pins, so the pin
+* registers are indexed rather than switched on.
+*
+* Built in place of csl2803x_ml.lib when CSL_SOURCE is defined, see
+* doc/csl_source.txt.
+*
+* HISTORY       :
+*******************************************************************************/
+
+#ifdef CSL_SOURCE
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+/* 32 bit register Reg of the port of Pin, and of its 16 pin half for Half */
+#define GPIO_portReg( Reg, Pin )    (&GpioCtrlRegs.Reg.all + 8*((Pin)>>5))
+#define GPIO_halfReg( Reg, Pin )    (GPIO_portReg( Reg, Pin ) + (((Pin)>>4)&1))
+#define GPIO_portBit( Pin )         (1UL << ((Pin)&0x1F))
+#define GPIO_halfShift( Pin )       (2*((Pin)&0xF))
+
+static void GPIO_setField( volatile uint32_t* pReg, GPIO_Pin Pin,
+                           uint16_t Value );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : GPIO_acquire
+* DESCRIPTION   :
+* Kept for the API; the source build does not count the pins in use.
+******************************************************************************/
+void GPIO_acquire( GPIO_Pin Pin )
+{
+    if( Pin >= Gpio_MAX )
+    {
+        ERR_Value = ERR_GPIO_PIN_INVALID;
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : GPIO_getLimit
+* DESCRIPTION   :
+* Number of pins that may be acquired.
+******************************************************************************/
+int GPIO_getLimit( void )
+{
+    return Gpio_MAX;
+}
+
+
+/******************************************************************************
+* FUNCTION      : GPIO_config
+* DESCRIPTION   :
+* Makes Pin a GPIO in the given direction, synchronised to SYSCLKOUT.
+******************************************************************************/
+void GPIO_config( GPIO_Pin Pin, GPIO_Direction Direction, bool PullUp )
+{
+    GPIO_reConfig( Pin, Direction, PullUp, GPIO_MUX_GPIO, GPIO_SYNCHRONIZE );
+}
+
+
+/******************************************************************************
+* FUNCTION      : GPIO_setMux
+* DESCRIPTION   :
+* Selects the peripheral function of Pin.
+******************************************************************************/
+void GPIO_setMux( GPIO_Pin Pin, GPIO_Multiplex Mux )
+{
+    if( Pin >= Gpio_MAX )
+    {
+        ERR_Value = ERR_GPIO_PIN_INVALID;
+        return;
+    }
+    EALLOW;
+    GPIO_setField( GPIO_halfReg( GPAMUX1, Pin ), Pin, Mux );
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : GPIO_reConfig
+* DESCRIPTION   :
+* Sets the mux, direction, pull up and input qualification of a pin.
+******************************************************************************/
+void GPIO_reConfig( GPIO_Pin PinNumber, GPIO_Direction Direction,
+                    bool PullUp, GPIO_Multiplex Mux,
+                    GPIO_InputMode InputMode )
+{
+    uint32_t Bit = GPIO_portBit( PinNumber );
+
+    if( PinNumber >= Gpio_MAX )
+    {
+        ERR_Value = ERR_GPIO_PIN_INVALID;
+        return;
+    }
+
+    EALLOW;
+    GPIO_setField( GPIO_halfReg( GPAMUX1, PinNumber ), PinNumber, Mux );
+    GPIO_setField( GPIO_halfReg( GPAQSEL1, PinNumber ), PinNumber, InputMode );
+    if( Direction == GPIO_DIR_OUT )
+    {
+        *GPIO_portReg( GPADIR, PinNumber ) |= Bit;
+    }
+    else
+    {
+        *GPIO_portReg( GPADIR, PinNumber ) &= ~Bit;
+    }
+    if( PullUp )
+    {
+        *GPIO_portReg( GPAPUD, PinNumber ) &= ~Bit;
+    }
+    else
+    {
+        *GPIO_portReg( GPAPUD, PinNumber ) |= Bit;
+    }
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : GPIO_setValue
+* DESCRIPTION   :
+* Drives Pin high if Value is non zero, otherwise low.
+******************************************************************************/
+void GPIO_setValue( GPIO_Pin Pin, int Value )
+{
+    if( Value )
+    {
+        GPIO_set( Pin );
+    }
+    else
+    {
+        GPIO_clr( Pin );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : GPIO_setField
+* DESCRIPTION   :
+* Writes the 2 bit field of Pin in a mux or qualification register.
+******************************************************************************/
+static void GPIO_setField( volatile uint32_t* pReg, GPIO_Pin Pin,
+                           uint16_t Value )
+{
+    uint16_t Shift = GPIO_halfShift( Pin );
+
+    *pReg = (*pReg & ~(3UL << Shift)) | ((uint32_t)(Value & 3) << Shift);
+}
+
+#endif /* CSL_SOURCE */
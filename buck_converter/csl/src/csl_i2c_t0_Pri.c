@@ -0,0 +1,58 @@
+/*******************************************************************************
+* FILE          : csl_i2c_t0_Pri.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Chip Support Library
+* DESCRIPTION   :
+* Source of I2C_config() of csl_i2c_t0_Pub.h. The buck converter drives the
+* I2C as a slave from pmbus.c, so the blocking master transfers of the
+* library are not part of the source build.
+*
+* Built in place of csl2803x_ml.lib when CSL_SOURCE is defined, see
+* doc/csl_source.txt.
+*
+* HISTORY       :
+*******************************************************************************/
+
+#ifdef CSL_SOURCE
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : I2C_config
+* DESCRIPTION   :
+* Sets the pins, GPIO32 and GPIO33, and the clocks: the module clock is
+* SYSCLKOUT/(IPSC+1) and SCL is low for ICCL+5 and high for ICCH+5 module
+* clocks. The module is left enabled, interrupts and FIFOs off.
+******************************************************************************/
+void I2C_config( I2C_Module Mod, uint16_t IPSC, uint16_t ICCL, uint16_t ICCH )
+{
+    if( Mod != I2C_MOD_1 )
+    {
+        ERR_Value = ERR_I2C_MOD_X_INVALID;
+        return;
+    }
+
+    EALLOW;
+    SysCtrlRegs.PCLKCR0.bit.I2CAENCLK = 1;
+    EDIS;
+    GPIO_reConfig( GPIO_32, GPIO_DIR_IN, true, GPIO_MUX_ALT1,
+                   GPIO_ASYNCHRONOUS );
+    GPIO_reConfig( GPIO_33, GPIO_DIR_IN, true, GPIO_MUX_ALT1,
+                   GPIO_ASYNCHRONOUS );
+
+    Mod->I2CMDR.bit.IRS = 0;
+    Mod->I2CPSC.all     = IPSC;
+    Mod->I2CCLKL        = ICCL;
+    Mod->I2CCLKH        = ICCH;
+    Mod->I2CIER.all     = 0;
+    Mod->I2CFFTX.all    = 0;
+    Mod->I2CFFRX.all    = 0;
+    Mod->I2CMDR.all     = 0x0020;
+}
+
+#endif /* CSL_SOURCE */
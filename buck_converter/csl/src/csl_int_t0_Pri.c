@@ -0,0 +1,191 @@
+/*******************************************************************************
+* FILE          : csl_int_t0_Pri.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Chip Support Library
+* DESCRIPTION   :
+* Source of the interrupt functions of csl_int_t0_Pub.h.
+*
+* The PIE enable and flag registers of group n are at PIEIER1 + 2*n and
+* PIEIFR1 + 2*n, so the functions index them from the INT_PieId instead of
+* switching on the group.
+*
+* Built in place of csl2803x_ml.lib when CSL_SOURCE is defined, see
+* doc/csl_source.txt.
+*
+* HISTORY       :
+*******************************************************************************/
+
+#ifdef CSL_SOURCE
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#define INT_VECTOR_COUNT    128
+
+#define INT_pieIer( PieId ) (&PieCtrlRegs.PIEIER1.all + 2*INT_pieIdToGroup(PieId))
+#define INT_pieIfr( PieId ) (&PieCtrlRegs.PIEIFR1.all + 2*INT_pieIdToGroup(PieId))
+
+interrupt void INT_defaultIsr( void );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : INT_initPie
+* DESCRIPTION   :
+* Called by SYS_initFunc(). Disables and clears every PIE interrupt, points
+* every vector at INT_defaultIsr() and turns the PIE on.
+******************************************************************************/
+void INT_initPie( void )
+{
+    int i;
+
+    PieCtrlRegs.PIECTRL.bit.ENPIE = 0;
+    for( i = 0; i < 12; i++ )
+    {
+        (&PieCtrlRegs.PIEIER1.all)[2*i] = 0;
+        (&PieCtrlRegs.PIEIFR1.all)[2*i] = 0;
+    }
+
+    EALLOW;
+    for( i = 0; i < INT_VECTOR_COUNT; i++ )
+    {
+        ((volatile INT_IsrAddr*)&PieVectTable)[i] = INT_defaultIsr;
+    }
+    EDIS;
+
+    PieCtrlRegs.PIEACK.all = 0xFFFF;
+    PieCtrlRegs.PIECTRL.bit.ENPIE = 1;
+}
+
+
+/******************************************************************************
+* FUNCTION      : INT_defaultIsr
+* DESCRIPTION   :
+* Taken by any interrupt without a callback. Stops the debugger with the
+* error set.
+******************************************************************************/
+interrupt void INT_defaultIsr( void )
+{
+    ERR_Value = ERR_INT_ISR_DEFAULT;
+    ESTOP0;
+    for( ;; )
+    {
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : INT_setCallback
+* DESCRIPTION   :
+* Sets the vector to Func, or back to INT_defaultIsr() if Func is 0.
+******************************************************************************/
+void INT_setCallback( INT_VectorId VectorId, INT_IsrAddr Func )
+{
+    EALLOW;
+    ((volatile INT_IsrAddr*)&PieVectTable)[VectorId] = Func ? Func : INT_defaultIsr;
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : INT_enableGlobal
+* DESCRIPTION   :
+* Sets or clears INTM, with the real time debug mask to match.
+******************************************************************************/
+void INT_enableGlobal( int Enable )
+{
+    if( Enable )
+    {
+        EINT;
+        ERTM;
+    }
+    else
+    {
+        DINT;
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : INT_enableInt
+* DESCRIPTION   :
+* Enables CPU interrupt IntId, 0 for INT1.
+******************************************************************************/
+void INT_enableInt( int IntId )
+{
+    IER |= 1 << IntId;
+}
+
+
+/******************************************************************************
+* FUNCTION      : INT_enablePieIndex
+* DESCRIPTION   :
+* Sets or clears the PIE enable of PieId within its group.
+******************************************************************************/
+void INT_enablePieIndex( INT_PieId PieId, int Value )
+{
+    uint16_t Mask = 1 << INT_pieIdToIndex( PieId );
+
+    if( Value )
+    {
+        *INT_pieIer( PieId ) |= Mask;
+    }
+    else
+    {
+        *INT_pieIer( PieId ) &= ~Mask;
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : INT_enablePieGroup
+* DESCRIPTION   :
+* Sets or clears the CPU interrupt of the group of PieId.
+******************************************************************************/
+void INT_enablePieGroup( INT_PieId PieId, int Value )
+{
+    uint16_t Mask = 1 << INT_pieIdToGroup( PieId );
+
+    if( Value )
+    {
+        IER |= Mask;
+    }
+    else
+    {
+        IER &= ~Mask;
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : INT_enablePieId
+* DESCRIPTION   :
+* Enables PieId in the PIE and its group in the CPU. Disabling leaves the
+* group on for the other interrupts in it.
+******************************************************************************/
+void INT_enablePieId( INT_PieId PieId, int Value )
+{
+    INT_enablePieIndex( PieId, Value );
+    if( Value )
+    {
+        INT_enablePieGroup( PieId, true );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : INT_ackPieIndex
+* DESCRIPTION   :
+* Clears the pending PIE flag of PieId.
+******************************************************************************/
+void INT_ackPieIndex( INT_PieId PieId )
+{
+    *INT_pieIfr( PieId ) &= ~(1 << INT_pieIdToIndex( PieId ));
+}
+
+#endif /* CSL_SOURCE */
@@ -0,0 +1,391 @@
+/*******************************************************************************
+* FILE          : csl_pwm_t1_Pri.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Chip Support Library
+* DESCRIPTION   :
+* Source of the ePWM functions of csl_pwm_t1_Pub.h that are not macros.
+*
+* PWM_config() sets the time base and the shadowed compares; PWM_pin() sets
+* the action qualifier of the channel for the count mode and hands the pin
+* to the ePWM. A channel is high from the start of the period until its
+* compare, low after, or the other way round with GPIO_INVERT.
+*
+* The digital compare functions take comparator events through DCAH into
+* DCAEVT1 (one shot) and the blanked DCAEVT2 (cycle by cycle), which are the
+* PWM_DCEVT trip of PWM_setTripZone().
+*
+* Built in place of csl2803x_ml.lib when CSL_SOURCE is defined, see
+* doc/csl_source.txt.
+*
+* HISTORY       :
+*******************************************************************************/
+
+#ifdef CSL_SOURCE
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+/* Action qualifier codes */
+#define PWM_AQ_CLR      1
+#define PWM_AQ_SET      2
+
+/* TZDCSEL code for DCxEVTy on DCxH high */
+#define PWM_DC_H_HIGH   2
+
+static uint16_t PWM_actions( PWM_CountMode CountMode, PWM_ModuleChannel Channel,
+                             GPIO_Level Invert );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : PWM_configClocks
+* DESCRIPTION   :
+* Sets the period, clock dividers and count mode of an ePWM, with the phase
+* load and sync out off and the compares loaded at zero. The time base
+* clocks of all the ePWMs are stopped while it is set up so that they stay
+* in step.
+******************************************************************************/
+void PWM_configClocks( PWM_Module Module, uint16_t Ticks,
+                       PWM_HspClkDiv HspClkDiv, PWM_ClkDiv ClkDiv,
+                       PWM_CountMode CountMode )
+{
+    if( CountMode > PWM_COUNT_UP_DOWN )
+    {
+        ERR_Value = ERR_PWM_COUNT_MODE_INVALID;
+        return;
+    }
+
+    EALLOW;
+    SysCtrlRegs.PCLKCR0.bit.TBCLKSYNC = 0;
+    SysCtrlRegs.PCLKCR1.all |= 1 << PWM_getIndex( Module );
+    EDIS;
+
+    Module->TBCTL.bit.CTRMODE   = CountMode;
+    Module->TBCTL.bit.PHSEN     = 0;
+    Module->TBCTL.bit.PRDLD     = 0;
+    Module->TBCTL.bit.SYNCOSEL  = PWM_SYNCOSEL_DISBALE;
+    Module->TBCTL.bit.HSPCLKDIV = SYS_LIT_REG( HspClkDiv );
+    Module->TBCTL.bit.CLKDIV    = SYS_LIT_REG( ClkDiv );
+    Module->TBCTL.bit.FREE_SOFT = 2;
+    Module->TBPHS.half.TBPHS    = 0;
+    Module->TBCTR               = 0;
+
+    /* Up down counts the period twice */
+    Module->TBPRD = CountMode == PWM_COUNT_UP_DOWN ? Ticks/2 : Ticks - 1;
+
+    Module->CMPCTL.bit.SHDWAMODE = 0;
+    Module->CMPCTL.bit.SHDWBMODE = 0;
+    Module->CMPCTL.bit.LOADAMODE = 0;
+    Module->CMPCTL.bit.LOADBMODE = 0;
+    Module->CMPA.half.CMPA       = 0;
+    Module->CMPB                 = 0;
+
+    EALLOW;
+    SysCtrlRegs.PCLKCR0.bit.TBCLKSYNC = 1;
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PWM_config
+* DESCRIPTION   :
+* PWM_configClocks() with the ePWM clocked at SYSCLKOUT.
+******************************************************************************/
+void PWM_config( PWM_Module Module, uint16_t Ticks, PWM_CountMode CountMode )
+{
+    PWM_configClocks( Module, Ticks, PWM_HSP_DIV_1, PWM_DIV_1, CountMode );
+}
+
+
+/******************************************************************************
+* FUNCTION      : PWM_pin
+* DESCRIPTION   :
+* Sets the action qualifier of Channel and connects it to its pin.
+******************************************************************************/
+void PWM_pin( PWM_Module Module, PWM_ModuleChannel Channel, GPIO_Level Invert )
+{
+    uint16_t Actions = PWM_actions( (PWM_CountMode)Module->TBCTL.bit.CTRMODE,
+                                    Channel, Invert );
+    GPIO_Pin Pin     = Channel == PWM_CH_A ? PWM_getGpioPinA( Module )
+                                           : PWM_getGpioPinB( Module );
+
+    if( Channel == PWM_CH_A )
+    {
+        Module->AQCTLA.all = Actions;
+    }
+    else
+    {
+        Module->AQCTLB.all = Actions;
+    }
+    GPIO_reConfig( Pin, GPIO_DIR_OUT, false, GPIO_MUX_ALT1, GPIO_SYNCHRONIZE );
+}
+
+
+/******************************************************************************
+* FUNCTION      : PWM_actions
+* DESCRIPTION   :
+* Action qualifier of a channel: set at the start of the period and cleared
+* at the compare, with set and clear swapped for GPIO_INVERT.
+******************************************************************************/
+static uint16_t PWM_actions( PWM_CountMode CountMode, PWM_ModuleChannel Channel,
+                             GPIO_Level Invert )
+{
+    uint16_t Cmp = Channel == PWM_CH_A ? 4 : 8;   /* shift of CAU or CBU */
+    uint16_t Actions;
+
+    switch( CountMode )
+    {
+    case PWM_COUNT_UP:
+        Actions = (PWM_AQ_SET << 0) | (PWM_AQ_CLR << Cmp);
+        break;
+    case PWM_COUNT_DOWN:
+        Actions = (PWM_AQ_CLR << 0) | (PWM_AQ_SET << (Cmp + 2));
+        break;
+    default:
+        Actions = (PWM_AQ_SET << 0) | (PWM_AQ_CLR << Cmp) |
+                  (PWM_AQ_SET << (Cmp + 2));
+        break;
+    }
+
+    if( Invert == GPIO_INVERT )
+    {
+        /* 01 <-> 10 in every field */
+        Actions ^= ((Actions ^ (Actions >> 1)) & 0x5555) * 3;
+    }
+    return Actions;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PWM_setDuty
+* DESCRIPTION   :
+* Sets the compare of Channel.
+******************************************************************************/
+void PWM_setDuty( PWM_Module Module, PWM_ModuleChannel Channel, uint16_t Ticks )
+{
+    if( Channel == PWM_CH_A )
+    {
+        PWM_setDutyA( Module, Ticks );
+    }
+    else
+    {
+        PWM_setDutyB( Module, Ticks );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : PWM_getDuty
+* DESCRIPTION   :
+* Returns the compare of Channel.
+******************************************************************************/
+uint16_t PWM_getDuty( PWM_Module Mod, PWM_ModuleChannel Channel )
+{
+    return Channel == PWM_CH_A ? Mod->CMPA.half.CMPA : Mod->CMPB;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PWM_setTripZone
+* DESCRIPTION   :
+* Adds the trips of Mask, PWM_TZx or PWM_DCEVT or'ed together, to the cycle
+* by cycle or one shot trips of the ePWM.
+******************************************************************************/
+void PWM_setTripZone( PWM_Module Module, uint16_t Mask, PWM_TpzMode Mode )
+{
+    uint16_t Bits = SYS_LIT_REG( Mask ) & 0x3F;
+    bool     Dc   = (SYS_LIT_REG( Mask ) & SYS_LIT_REG( PWM_DCEVT )) != 0;
+
+    EALLOW;
+    if( Mode == PWM_TPZ_CYCLE_BY_CYCLE )
+    {
+        Module->TZSEL.all |= Bits | (Dc ? (1 << 6) : 0);     /* DCAEVT2 */
+    }
+    else
+    {
+        Module->TZSEL.all |= (Bits << 8) | (Dc ? (1 << 14) : 0); /* DCAEVT1 */
+    }
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PWM_setTripState
+* DESCRIPTION   :
+* Sets what Channel does on a trip zone or digital compare trip.
+******************************************************************************/
+void PWM_setTripState( PWM_Module Module, PWM_ModuleChannel Channel,
+                       GPIO_TriState TripState )
+{
+    EALLOW;
+    if( Channel == PWM_CH_A )
+    {
+        Module->TZCTL.bit.TZA     = TripState;
+        Module->TZCTL.bit.DCAEVT1 = TripState;
+        Module->TZCTL.bit.DCAEVT2 = TripState;
+    }
+    else
+    {
+        Module->TZCTL.bit.TZB     = TripState;
+        Module->TZCTL.bit.DCBEVT1 = TripState;
+        Module->TZCTL.bit.DCBEVT2 = TripState;
+    }
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PWM_enableTpzInt
+* DESCRIPTION   :
+* Enables or disables the trip interrupt of the ePWM for Mode.
+******************************************************************************/
+void PWM_enableTpzInt( PWM_Module Mod, PWM_TpzMode Mode, int Enable )
+{
+    EALLOW;
+    if( Enable )
+    {
+        Mod->TZEINT.all |= Mode;
+    }
+    else
+    {
+        Mod->TZEINT.all &= ~Mode;
+    }
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PWM_setCallback
+* DESCRIPTION   :
+* Raises the ePWM interrupt on the Prd'th Mode event and, if Func is not 0,
+* sets it as the ISR and enables the interrupt in the PIE. With Func 0 the
+* event can still start a CLA task.
+******************************************************************************/
+void PWM_setCallback( PWM_Module Module, INT_IsrAddr Func,
+                      PWM_IntMode Mode, PWM_IntPrd Prd )
+{
+    INT_PieId PieId = PWM_getPieId( Module );
+
+    Module->ETSEL.bit.INTSEL = Mode;
+    Module->ETPS.bit.INTPRD  = SYS_LIT_REG( Prd );
+    Module->ETCLR.all        = 1;
+    Module->ETSEL.bit.INTEN  = 1;
+
+    if( Func )
+    {
+        INT_setCallback( INT_pieIdToVectorId( PieId ), Func );
+        INT_enablePieId( PieId, true );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : PWM_setAdcSoc
+* DESCRIPTION   :
+* Starts an ADC conversion, SOCA or SOCB by Ch, on every Mode event.
+******************************************************************************/
+void PWM_setAdcSoc( PWM_Module Module, PWM_ModuleChannel Ch, PWM_IntMode Mode )
+{
+    if( Ch == PWM_CH_A )
+    {
+        Module->ETSEL.bit.SOCASEL = Mode;
+        Module->ETPS.bit.SOCAPRD  = 1;
+        Module->ETSEL.bit.SOCAEN  = 1;
+    }
+    else
+    {
+        Module->ETSEL.bit.SOCBSEL = Mode;
+        Module->ETPS.bit.SOCBPRD  = 1;
+        Module->ETSEL.bit.SOCBEN  = 1;
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : PWM_setDeadBand
+* DESCRIPTION   :
+* Derives both outputs from channel A with Ticks of rising and falling edge
+* delay, each output inverted as given.
+******************************************************************************/
+void PWM_setDeadBand( PWM_Module Module, uint16_t Ticks,
+                      GPIO_Level InvertA, GPIO_Level InvertB )
+{
+    Module->DBRED            = Ticks;
+    Module->DBFED            = Ticks;
+    Module->DBCTL.bit.IN_MODE  = 0;
+    Module->DBCTL.bit.POLSEL   = InvertA | (InvertB << 1);
+    Module->DBCTL.bit.OUT_MODE = 3;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PWM_setSyncOutSelect
+* DESCRIPTION   :
+* Selects the sync out of the ePWM.
+******************************************************************************/
+void PWM_setSyncOutSelect( PWM_Module Module, PWM_SyncOutSelect Mode )
+{
+    Module->TBCTL.bit.SYNCOSEL = Mode;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PWM_configBlanking
+* DESCRIPTION   :
+* Takes the comparator Select, active high or low by Level, through DCAH into
+* DCAEVT1 and DCAEVT2. DCAEVT2 is filtered by the blanking window, which
+* starts at the start of the period. Async passes the event straight to the
+* trip logic rather than through the time base clock.
+******************************************************************************/
+void PWM_configBlanking( PWM_Module Mod, PWM_CmpSelect Select,
+                         GPIO_Level Level, bool Async )
+{
+    EALLOW;
+    Mod->DCTRIPSEL.bit.DCAHCOMPSEL  = Select;
+    Mod->TZDCSEL.bit.DCAEVT1        = PWM_DC_H_HIGH;
+    Mod->TZDCSEL.bit.DCAEVT2        = PWM_DC_H_HIGH;
+
+    Mod->DCACTL.bit.EVT1SRCSEL      = 0;
+    Mod->DCACTL.bit.EVT1FRCSYNCSEL  = Async ? 1 : 0;
+    Mod->DCACTL.bit.EVT2SRCSEL      = 1;
+    Mod->DCACTL.bit.EVT2FRCSYNCSEL  = Async ? 1 : 0;
+
+    Mod->DCFCTL.bit.SRCSEL          = 1;    /* DCAEVT2 */
+    Mod->DCFCTL.bit.BLANKINV        = Level;
+    Mod->DCFCTL.bit.PULSESEL        = 1;    /* window from zero */
+    Mod->DCFCTL.bit.BLANKE          = 1;
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PWM_setBlankingOffset
+* DESCRIPTION   :
+* Delays the start of the blanking window by Value ticks from zero.
+******************************************************************************/
+void PWM_setBlankingOffset( PWM_Module Mod, uint16_t Value )
+{
+    EALLOW;
+    Mod->DCFOFFSET = Value;
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PWM_setBlankingWindow
+* DESCRIPTION   :
+* Sets the length of the blanking window, ticks.
+******************************************************************************/
+void PWM_setBlankingWindow( PWM_Module Mod, uint8_t Value )
+{
+    EALLOW;
+    Mod->DCFWINDOW = Value;
+    EDIS;
+}
+
+#endif /* CSL_SOURCE */
@@ -0,0 +1,143 @@
+/*******************************************************************************
+* FILE          : csl_spi_t0_Pri.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Chip Support Library
+* DESCRIPTION   :
+* Source of the SPI functions of csl_spi_t0_Pub.h used by the buck converter:
+* SPI-A as a 16 bit master with both FIFOs on. The FIFO levels work as for
+* the SCI, see csl_uart_t0_Pri.c.
+*
+* Built in place of csl2803x_ml.lib when CSL_SOURCE is defined, see
+* doc/csl_source.txt.
+*
+* HISTORY       :
+*******************************************************************************/
+
+#ifdef CSL_SOURCE
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : SPI_config
+* DESCRIPTION   :
+* Starts SPI-A on GPIO16 to GPIO19 as a 16 bit master at LSPCLK/(BRR+1),
+* interrupts off.
+******************************************************************************/
+void SPI_config( SPI_Module Spi, uint16_t BRR, SPI_ClockEdge Mode )
+{
+    GPIO_Pin Pin;
+
+    if( Spi != SPI_MOD_1 )
+    {
+        ERR_Value = ERR_SPI_MOD_X_INVALID;
+        return;
+    }
+    if( BRR < 3 || BRR > 127 )
+    {
+        ERR_Value = ERR_SPI_TICK_INVALID;
+        return;
+    }
+
+    EALLOW;
+    SysCtrlRegs.PCLKCR0.bit.SPIAENCLK = 1;
+    EDIS;
+    for( Pin = GPIO_16; Pin <= GPIO_19; Pin++ )
+    {
+        GPIO_reConfig( Pin, Pin == GPIO_17 ? GPIO_DIR_IN : GPIO_DIR_OUT, true,
+                       GPIO_MUX_ALT1, GPIO_ASYNCHRONOUS );
+    }
+
+    Spi->SPICCR.all             = 0x000F;   /* reset, 16 bit */
+    Spi->SPICCR.bit.CLKPOLARITY = Mode;
+    Spi->SPICTL.all             = 0x0006;   /* master, talk */
+    Spi->SPIBRR                 = BRR;
+    Spi->SPIFFTX.all            = 0xE040;
+    Spi->SPIFFRX.all            = 0x2044;
+    Spi->SPIFFCT.all            = 0;
+    Spi->SPIPRI.bit.FREE        = 1;
+    Spi->SPICCR.bit.SPISWRESET  = 1;
+    Spi->SPIFFTX.bit.TXFIFO     = 1;
+    Spi->SPIFFRX.bit.RXFIFORESET = 1;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SPI_reset
+* DESCRIPTION   :
+* Holds the SPI in reset and lets it go again, dropping any word in progress.
+******************************************************************************/
+void SPI_reset( SPI_Module Spi )
+{
+    Spi->SPICCR.bit.SPISWRESET = 0;
+    Spi->SPICCR.bit.SPISWRESET = 1;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SPI_flush
+* DESCRIPTION   :
+* Throws away both FIFOs.
+******************************************************************************/
+void SPI_flush( SPI_Module Spi )
+{
+    Spi->SPIFFTX.bit.TXFIFO      = 0;
+    Spi->SPIFFTX.bit.TXFIFO      = 1;
+    Spi->SPIFFRX.bit.RXFIFORESET = 0;
+    Spi->SPIFFRX.bit.RXFIFORESET = 1;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SPI_setLoopback
+* DESCRIPTION   :
+* Connects SIMO to SOMI inside the SPI if Value.
+******************************************************************************/
+void SPI_setLoopback( SPI_Module Mod, int Value )
+{
+    Mod->SPICCR.bit.SPISWRESET = 0;
+    Mod->SPICCR.bit.SPILBK     = Value ? 1 : 0;
+    Mod->SPICCR.bit.SPISWRESET = 1;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SPI_setTxCallback
+* DESCRIPTION   :
+* Sets Func as the transmit ISR, raised while no more than TxLevel words are
+* queued, and enables it.
+******************************************************************************/
+void SPI_setTxCallback( SPI_Module Spi, INT_IsrAddr Func, uint16_t TxLevel )
+{
+    INT_PieId PieId = SPI_getTxPieId( Spi );
+
+    Spi->SPIFFTX.bit.TXFFIL     = TxLevel;
+    INT_setCallback( INT_pieIdToVectorId( PieId ), Func );
+    SPI_clrTxInt( Spi );
+    Spi->SPIFFTX.bit.TXFFIENA   = 1;
+    INT_enablePieId( PieId, true );
+}
+
+
+/******************************************************************************
+* FUNCTION      : SPI_setRxCallback
+* DESCRIPTION   :
+* Sets Func as the receive ISR, raised once RxLevel words are waiting, and
+* enables it.
+******************************************************************************/
+void SPI_setRxCallback( SPI_Module Spi, INT_IsrAddr Func, uint16_t RxLevel )
+{
+    INT_PieId PieId = SPI_getRxPieId( Spi );
+
+    Spi->SPIFFRX.bit.RXFFIL     = RxLevel;
+    INT_setCallback( INT_pieIdToVectorId( PieId ), Func );
+    SPI_clrRxInt( Spi );
+    Spi->SPIFFRX.bit.RXFFIENA   = 1;
+    INT_enablePieId( PieId, true );
+}
+
+#endif /* CSL_SOURCE */
@@ -0,0 +1,259 @@
+/*******************************************************************************
+* FILE          : csl_sys_c2803x_Pri.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Chip Support Library
+* DESCRIPTION   :
+* Source of the system functions of csl_sys_c2803x_Pub.h and csl_c2000_Pub.h:
+* start up, clocks and the stack tide marker.
+*
+* SYS_initFunc() follows TI's InitSysCtrl(): the watchdog is turned off, the
+* factory calibration is loaded, ramfuncs is copied to RAM and the flash set
+* from there, every peripheral clock is turned on and the PIE is filled with
+* INT_defaultIsr(). SYS_configClk() follows InitPll().
+*
+* The tide marker fills the unused part of the stack, above the caller, with
+* SYS_TIDE_MARK. The C28x stack grows up from _stack, so the marks left at the
+* top are the words that have never been used.
+*
+* Built in place of csl2803x_ml.lib when CSL_SOURCE is defined, see
+* doc/csl_source.txt.
+*
+* HISTORY       :
+*******************************************************************************/
+
+#ifdef CSL_SOURCE
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+/* Set by the linker command file */
+extern uint16_t RamfuncsLoadStart, RamfuncsLoadEnd, RamfuncsRunStart;
+
+#ifndef SYS_STACK_SIZE
+extern uint16_t _stack[];
+extern uint16_t _STACK_SIZE;
+#define SYS_STACK_SIZE  ((uint16_t)(uint32_t)&_STACK_SIZE)
+#endif
+
+#define SYS_TIDE_MARK   0xA5A5
+
+#define SYS_CLKCTL_OSCSRCSEL    0x0001
+#define SYS_CLKCTL_INTOSC1OFF   0x0100
+#define SYS_CLKCTL_INTOSC2OFF   0x0400
+#define SYS_CLKCTL_XCLKINOFF    0x2000
+#define SYS_CLKCTL_XTALOSCOFF   0x4000
+#define SYS_PCLKCR3_COMP        0x0007  /* COMP1ENCLK to COMP3ENCLK */
+
+/* Run from RAM while the flash wait states change */
+#pragma CODE_SECTION( SYS_initFlash, "ramfuncs" );
+#pragma CODE_SECTION( SYS_dummyRamFuncs, "ramfuncs" );
+
+extern void INT_initPie( void );
+
+static void SYS_initFlash( void );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : SYS_initFunc
+* DESCRIPTION   :
+* First half of SYS_init(), everything but the clock dividers.
+******************************************************************************/
+void SYS_initFunc( void )
+{
+    uint16_t* pSrc;
+    uint16_t* pDst;
+
+    DINT;
+    IER = 0x0000;
+    IFR = 0x0000;
+
+    EALLOW;
+    SysCtrlRegs.WDCR = 0x006B;
+
+    /* The ADC clock must be on for the calibration to load */
+    SysCtrlRegs.PCLKCR0.bit.ADCENCLK = 1;
+    (*Device_cal)();
+    SysCtrlRegs.PCLKCR0.bit.ADCENCLK = 0;
+
+    /* Internal oscillator 1, the crystal, XCLKIN and oscillator 2 off */
+    SysCtrlRegs.CLKCTL.all &= ~(SYS_CLKCTL_INTOSC1OFF | SYS_CLKCTL_OSCSRCSEL);
+    SysCtrlRegs.CLKCTL.all |= SYS_CLKCTL_XCLKINOFF | SYS_CLKCTL_XTALOSCOFF |
+                              SYS_CLKCTL_INTOSC2OFF;
+    EDIS;
+
+    pSrc = &RamfuncsLoadStart;
+    pDst = &RamfuncsRunStart;
+    if( pDst != pSrc )
+    {
+        while( pSrc < &RamfuncsLoadEnd )
+        {
+            *pDst++ = *pSrc++;
+        }
+    }
+    SYS_initFlash();
+
+    /* Each module turns its own clock on; the CPU timers, the GPIO input
+    *  qualification and the CLA keep theirs */
+    EALLOW;
+    SysCtrlRegs.PCLKCR0.all = 0x0000;
+    SysCtrlRegs.PCLKCR1.all = 0x0000;
+    SysCtrlRegs.PCLKCR3.all &= ~SYS_PCLKCR3_COMP;
+    EDIS;
+
+    INT_initPie();
+}
+
+
+/******************************************************************************
+* FUNCTION      : SYS_initFlash
+* DESCRIPTION   :
+* Conservative flash wait states for the fastest clock, pipeline on. BOOT_init()
+* sets the exact ones for SYS_CLK_HZ later.
+******************************************************************************/
+static void SYS_initFlash( void )
+{
+    EALLOW;
+    FlashRegs.FOPT.bit.ENPIPE           = 1;
+    FlashRegs.FBANKWAIT.bit.PAGEWAIT    = 3;
+    FlashRegs.FBANKWAIT.bit.RANDWAIT    = 3;
+    FlashRegs.FOTPWAIT.bit.OTPWAIT      = 5;
+    FlashRegs.FSTDBYWAIT.bit.STDBYWAIT  = 0x01FF;
+    FlashRegs.FACTIVEWAIT.bit.ACTIVEWAIT = 0x01FF;
+    EDIS;
+
+    __asm(" RPT #7 || NOP");
+}
+
+
+/******************************************************************************
+* FUNCTION      : SYS_dummyRamFuncs
+* DESCRIPTION   :
+* Keeps ramfuncs from being empty, which the linker files do not allow.
+******************************************************************************/
+void SYS_dummyRamFuncs( void )
+{
+}
+
+
+/******************************************************************************
+* FUNCTION      : SYS_configClk
+* DESCRIPTION   :
+* Sets the PLL and the clock dividers. The clock is switched with the divider
+* at /4 and the missing clock detect off, as the data sheet requires.
+******************************************************************************/
+void SYS_configClk( SYS_PllMultiplier InMultiplier, SYS_ClockDivide InDiv,
+                    SYS_ClockOutDivide OutDiv )
+{
+    uint16_t Mul = SYS_LIT_REG( InMultiplier );
+    uint16_t Div = SYS_LIT_REG( InDiv );
+
+    /* Running in limp mode, the oscillator has failed */
+    if( SysCtrlRegs.PLLSTS.bit.MCLKSTS != 0 )
+    {
+        ESTOP0;
+    }
+
+    EALLOW;
+    SysCtrlRegs.PLLSTS.bit.DIVSEL = 0;
+    if( SysCtrlRegs.PLLCR.bit.DIV != Mul )
+    {
+        SysCtrlRegs.PLLSTS.bit.MCLKOFF = 1;
+        SysCtrlRegs.PLLCR.bit.DIV      = Mul;
+        EDIS;
+        while( SysCtrlRegs.PLLSTS.bit.PLLLOCKS != 1 )
+        {
+        }
+        EALLOW;
+        SysCtrlRegs.PLLSTS.bit.MCLKOFF = 0;
+    }
+
+    if( Div == 3 )
+    {
+        SysCtrlRegs.PLLSTS.bit.DIVSEL = 2;
+        EDIS;
+        SYS_usDelay( 50 );
+        EALLOW;
+    }
+    SysCtrlRegs.PLLSTS.bit.DIVSEL   = Div;
+    SysCtrlRegs.XCLK.bit.XCLKOUTDIV = SYS_LIT_REG( OutDiv );
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SYS_setPerhiperalClk
+* DESCRIPTION   :
+* Sets the low speed peripheral clock divider.
+******************************************************************************/
+void SYS_setPerhiperalClk( SYS_PerClockDivide LspDiv )
+{
+    EALLOW;
+    SysCtrlRegs.LOSPCP.bit.LSPCLK = SYS_LIT_REG( LspDiv );
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SYS_setTideMarker
+* DESCRIPTION   :
+* Fills the stack above the caller with the tide mark, with interrupts off so
+* that no ISR frame is overwritten. A caller that is not running on _stack,
+* as on the host, has the whole of it marked.
+******************************************************************************/
+void SYS_setTideMarker( void )
+{
+    volatile uint16_t Here;
+    uint16_t* pMark = (uint16_t*)&Here + 16;
+    uint16_t* pEnd  = &_stack[SYS_STACK_SIZE];
+    uint16_t St     = __disable_interrupts();
+
+    if( pMark < _stack || pMark > pEnd )
+    {
+        pMark = _stack;
+    }
+    while( pMark < pEnd )
+    {
+        *pMark++ = SYS_TIDE_MARK;
+    }
+    __restore_interrupts( St );
+}
+
+
+/******************************************************************************
+* FUNCTION      : SYS_getStackUnused
+* DESCRIPTION   :
+* Returns the words at the top of the stack still holding the tide mark.
+******************************************************************************/
+uint16_t SYS_getStackUnused( void )
+{
+    uint16_t Count = 0;
+
+    while( Count < SYS_STACK_SIZE &&
+           _stack[SYS_STACK_SIZE - 1 - Count] == SYS_TIDE_MARK )
+    {
+        Count++;
+    }
+    return Count;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SYS_checkStack
+* DESCRIPTION   :
+* Sets ERR_SYS_STACK_OVERFLOW once the last word of the stack has been used.
+******************************************************************************/
+void SYS_checkStack( void )
+{
+    if( _stack[SYS_STACK_SIZE - 1] != SYS_TIDE_MARK )
+    {
+        ERR_Value = ERR_SYS_STACK_OVERFLOW;
+    }
+}
+
+#endif /* CSL_SOURCE */
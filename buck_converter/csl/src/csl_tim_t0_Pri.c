@@ -0,0 +1,49 @@
+/*******************************************************************************
+* FILE          : csl_tim_t0_Pri.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Chip Support Library
+* DESCRIPTION   :
+* Source of TIM_config() of csl_tim_t0_Pub.h. The timer counts SYSCLKOUT
+* divided by the prescaler down from the period to 0, then reloads.
+*
+* Built in place of csl2803x_ml.lib when CSL_SOURCE is defined, see
+* doc/csl_source.txt.
+*
+* HISTORY       :
+*******************************************************************************/
+
+#ifdef CSL_SOURCE
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#define TIM_TCR_TSS         0x0010
+#define TIM_TCR_TRB         0x0020
+#define TIM_TCR_TIF         0x8000
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : TIM_config
+* DESCRIPTION   :
+* Loads the period, Ticks, and the prescaler, the SYSCLKOUT divider from 1 to
+* 65535, then starts the timer with its interrupt disabled and its flag
+* cleared. The timer stops when the debugger halts the CPU.
+******************************************************************************/
+void TIM_config( TIM_Module Mod, uint32_t Ticks, uint16_t Prescale )
+{
+    uint16_t Div = Prescale ? Prescale - 1 : 0;
+
+    Mod->TCR.all    = TIM_TCR_TSS;
+    Mod->PRD.all    = Ticks;
+    Mod->TPR.all    = Div & 0x00FF;
+    Mod->TPRH.all   = Div >> 8;
+    Mod->TCR.all    = TIM_TCR_TRB | TIM_TCR_TIF;
+}
+
+#endif /* CSL_SOURCE */
@@ -0,0 +1,269 @@
+/*******************************************************************************
+* FILE          : csl_uart_t0_Pri.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Chip Support Library
+* DESCRIPTION   :
+* Source of the SCI functions of csl_uart_t0_Pub.h used by the buck converter.
+* The SCI runs with both FIFOs on; the transmit interrupt is raised while the
+* transmit FIFO holds no more than its level, the receive interrupt once the
+* receive FIFO holds at least its level.
+*
+* Built in place of csl2803x_ml.lib when CSL_SOURCE is defined, see
+* doc/csl_source.txt.
+*
+* HISTORY       :
+*******************************************************************************/
+
+#ifdef CSL_SOURCE
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : UART_config
+* DESCRIPTION   :
+* Sets the pins, baud rate and frame and starts the SCI with the FIFOs on and
+* the interrupts off. SCI-A is on GPIO28/29 or on GPIO7 and GPIO12.
+******************************************************************************/
+void UART_config( UART_Module Mod, GPIO_Pin Rx, GPIO_Pin Tx,
+                  uint16_t Ticks, UART_DataBits DataBits,
+                  UART_Parity Parity, UART_StopBits StopBits )
+{
+    if( Mod != UART_MOD_1 )
+    {
+        ERR_Value = ERR_UART_MOD_X_INVALID;
+        return;
+    }
+    if( Rx != GPIO_28 && Rx != GPIO_7 )
+    {
+        ERR_Value = ERR_UART_RX_PIN_INVALID;
+        return;
+    }
+    if( Tx != GPIO_29 && Tx != GPIO_12 )
+    {
+        ERR_Value = ERR_UART_TX_PIN_INVALID;
+        return;
+    }
+
+    EALLOW;
+    SysCtrlRegs.PCLKCR0.bit.SCIAENCLK = 1;
+    EDIS;
+    GPIO_reConfig( Rx, GPIO_DIR_IN, true,
+                   Rx == GPIO_28 ? GPIO_MUX_ALT1 : GPIO_MUX_ALT2,
+                   GPIO_ASYNCHRONOUS );
+    GPIO_reConfig( Tx, GPIO_DIR_OUT, false,
+                   Tx == GPIO_29 ? GPIO_MUX_ALT1 : GPIO_MUX_ALT2,
+                   GPIO_SYNCHRONIZE );
+
+    Mod->SCICCR.all            = 0;
+    Mod->SCICCR.bit.STOPBITS   = StopBits;
+    Mod->SCICCR.bit.PARITYENA  = Parity >> 1;
+    Mod->SCICCR.bit.PARITY     = Parity & 1;
+    Mod->SCICCR.bit.SCICHAR    = DataBits;
+    Mod->SCICTL1.all           = 0x0003;    /* Rx and Tx on, held in reset */
+    Mod->SCICTL2.all           = 0x0002;    /* RX/BK interrupt enable */
+    UART_setTicks( Mod, Ticks );
+
+    Mod->SCIFFTX.all           = 0xE040;
+    Mod->SCIFFRX.all           = 0x204F;
+    Mod->SCIFFCT.all           = 0;
+    Mod->SCIPRI.bit.FREE       = 1;
+    Mod->SCICTL1.all           = 0x0023;    /* out of reset */
+    Mod->SCIFFTX.bit.TXFIFOXRESET = 1;
+    Mod->SCIFFRX.bit.RXFIFORESET  = 1;
+}
+
+
+/******************************************************************************
+* FUNCTION      : UART_setTicks
+* DESCRIPTION   :
+* Sets the baud rate register, see UART_baudToTicks().
+******************************************************************************/
+void UART_setTicks( UART_Module Mod, uint16_t Ticks )
+{
+    Mod->SCIHBAUD = Ticks >> 8;
+    Mod->SCILBAUD = Ticks & 0xFF;
+}
+
+
+/******************************************************************************
+* FUNCTION      : UART_setLoopback
+* DESCRIPTION   :
+* Connects the transmitter to the receiver inside the SCI if Value.
+******************************************************************************/
+void UART_setLoopback( UART_Module Mod, int Value )
+{
+    Mod->SCICCR.bit.LOOPBKENA = Value ? 1 : 0;
+}
+
+
+/******************************************************************************
+* FUNCTION      : UART_flushRx
+* DESCRIPTION   :
+* Throws away the receive FIFO.
+******************************************************************************/
+void UART_flushRx( UART_Module Mod )
+{
+    Mod->SCIFFRX.bit.RXFIFORESET = 0;
+    Mod->SCIFFRX.bit.RXFIFORESET = 1;
+}
+
+
+/******************************************************************************
+* FUNCTION      : UART_flushTx
+* DESCRIPTION   :
+* Throws away the transmit FIFO.
+******************************************************************************/
+void UART_flushTx( UART_Module Mod )
+{
+    Mod->SCIFFTX.bit.TXFIFOXRESET = 0;
+    Mod->SCIFFTX.bit.TXFIFOXRESET = 1;
+}
+
+
+/******************************************************************************
+* FUNCTION      : UART_flush
+* DESCRIPTION   :
+* Throws away both FIFOs.
+******************************************************************************/
+void UART_flush( UART_Module Mod )
+{
+    UART_flushRx( Mod );
+    UART_flushTx( Mod );
+}
+
+
+/******************************************************************************
+* FUNCTION      : UART_putc
+* DESCRIPTION   :
+* Queues a character, waiting for room in the transmit FIFO.
+******************************************************************************/
+void UART_putc( UART_Module Mod, int a )
+{
+    while( Mod->SCIFFTX.bit.TXFFST >= UART_FIFO_DEPTH )
+    {
+    }
+    Mod->SCITXBUF = a & 0xFF;
+}
+
+
+/******************************************************************************
+* FUNCTION      : UART_puts
+* DESCRIPTION   :
+* Queues a string, waiting for room as needed.
+******************************************************************************/
+void UART_puts( UART_Module Mod, const char* str )
+{
+    while( *str )
+    {
+        UART_putc( Mod, *str++ );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : UART_getRxCount
+* DESCRIPTION   :
+* Characters waiting in the receive FIFO.
+******************************************************************************/
+int UART_getRxCount( UART_Module Mod )
+{
+    return Mod->SCIFFRX.bit.RXFFST;
+}
+
+
+/******************************************************************************
+* FUNCTION      : UART_getc
+* DESCRIPTION   :
+* Takes a character from the receive FIFO; check UART_getRxCount() first.
+******************************************************************************/
+char UART_getc( UART_Module Mod )
+{
+    return (char)Mod->SCIRXBUF.bit.RXDT;
+}
+
+
+/******************************************************************************
+* FUNCTION      : UART_isRxOverFlow
+* DESCRIPTION   :
+* True if the receive FIFO has overflowed since the last clear.
+******************************************************************************/
+int UART_isRxOverFlow( UART_Module Mod )
+{
+    return Mod->SCIFFRX.bit.RXFFOVF;
+}
+
+
+/******************************************************************************
+* FUNCTION      : UART_clrRxOverFlow
+* DESCRIPTION   :
+* Clears the receive FIFO overflow flag.
+******************************************************************************/
+void UART_clrRxOverFlow( UART_Module Mod )
+{
+    Mod->SCIFFRX.bit.RXFFOVRCLR = 1;
+}
+
+
+/******************************************************************************
+* FUNCTION      : UART_setRxCallback
+* DESCRIPTION   :
+* Sets Func as the receive ISR, raised once RxLevel characters are waiting,
+* and enables it.
+******************************************************************************/
+void UART_setRxCallback( UART_Module Mod, INT_IsrAddr Func, int RxLevel )
+{
+    INT_PieId PieId = UART_getRxPieId( Mod );
+
+    Mod->SCIFFRX.bit.RXFFIL = RxLevel;
+    INT_setCallback( INT_pieIdToVectorId( PieId ), Func );
+    UART_clrRxInt( Mod );
+    UART_enableRxInt( Mod, true );
+    INT_enablePieId( PieId, true );
+}
+
+
+/******************************************************************************
+* FUNCTION      : UART_setTxCallback
+* DESCRIPTION   :
+* Sets Func as the transmit ISR, raised while no more than TxLevel characters
+* are queued, and enables it.
+******************************************************************************/
+void UART_setTxCallback( UART_Module Mod, INT_IsrAddr Func, int TxLevel )
+{
+    INT_PieId PieId = UART_getTxPieId( Mod );
+
+    Mod->SCIFFTX.bit.TXFFIL = TxLevel;
+    INT_setCallback( INT_pieIdToVectorId( PieId ), Func );
+    UART_clrTxInt( Mod );
+    UART_enableTxInt( Mod, true );
+    INT_enablePieId( PieId, true );
+}
+
+
+/******************************************************************************
+* FUNCTION      : UART_enableRxInt
+* DESCRIPTION   :
+* Enables or disables the receive FIFO interrupt.
+******************************************************************************/
+void UART_enableRxInt( UART_Module Mod, int Enable )
+{
+    Mod->SCIFFRX.bit.RXFFIENA = Enable ? 1 : 0;
+}
+
+
+/******************************************************************************
+* FUNCTION      : UART_enableTxInt
+* DESCRIPTION   :
+* Enables or disables the transmit FIFO interrupt.
+******************************************************************************/
+void UART_enableTxInt( UART_Module Mod, int Enable )
+{
+    Mod->SCIFFTX.bit.TXFFIENA = Enable ? 1 : 0;
+}
+
+#endif /* CSL_SOURCE */
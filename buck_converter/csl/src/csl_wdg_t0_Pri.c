@@ -0,0 +1,91 @@
+/*******************************************************************************
+* FILE          : csl_wdg_t0_Pri.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Chip Support Library
+* DESCRIPTION   :
+* Source of the watchdog functions of csl_wdg_t0_Pub.h. The watchdog runs
+* from OSCCLK/512 with the prescaler at /4, as the library sets it, about
+* 52ms at 10MHz, and either resets the device or raises the WAKEINT
+* interrupt.
+*
+* Built in place of csl2803x_ml.lib when CSL_SOURCE is defined, see
+* doc/csl_source.txt.
+*
+* HISTORY       :
+*******************************************************************************/
+
+#ifdef CSL_SOURCE
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#define WDG_WDCR_OFF        0x006B
+#define WDG_WDCR_ON         0x002B
+#define WDG_SCSR_OVERRIDE   0x0001
+#define WDG_SCSR_ENINT      0x0002
+#define WDG_LPMCR0_WDINTE   0x8000
+
+interrupt void WDG_defaultIsr( void );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : WDG_config
+* DESCRIPTION   :
+* Sets the watchdog mode. The _LOCK modes clear WDOVERRIDE so the watchdog
+* can no longer be turned off. Func is the ISR of the interrupt modes, 0
+* for WDG_defaultIsr().
+******************************************************************************/
+void WDG_config( WDG_Mode Mode, INT_IsrAddr Func )
+{
+    bool Int  = Mode == WDG_INTERRUPT || Mode == WDG_INTERRUPT_LOCK;
+    bool Lock = Mode == WDG_RESET_LOCK || Mode == WDG_INTERRUPT_LOCK;
+
+    if( Int )
+    {
+        INT_setCallback( INT_pieIdToVectorId( INT_ID_WAKE ),
+                         Func ? Func : WDG_defaultIsr );
+        INT_enablePieId( INT_ID_WAKE, true );
+    }
+
+    EALLOW;
+    SysCtrlRegs.WDCR  = Mode == WDG_NONE ? WDG_WDCR_OFF : WDG_WDCR_ON;
+    SysCtrlRegs.SCSR  = (Int ? WDG_SCSR_ENINT : 0) |
+                        (Lock ? WDG_SCSR_OVERRIDE : 0);
+    SysCtrlRegs.LPMCR0.all |= WDG_LPMCR0_WDINTE;
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : WDG_kick
+* DESCRIPTION   :
+* Restarts the watchdog count.
+******************************************************************************/
+void WDG_kick( void )
+{
+    EALLOW;
+    SysCtrlRegs.WDKEY = 0x0055;
+    SysCtrlRegs.WDKEY = 0x00AA;
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : WDG_defaultIsr
+* DESCRIPTION   :
+* Watchdog interrupt without a callback.
+******************************************************************************/
+interrupt void WDG_defaultIsr( void )
+{
+    ERR_Value = ERR_WDG_ISR_DEFAULT;
+    ESTOP0;
+    WDG_ackInt();
+}
+
+#endif /* CSL_SOURCE */
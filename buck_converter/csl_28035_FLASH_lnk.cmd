@@ -0,0 +1,137 @@
+/* Stand alone boot from flash, see boot.h. Use this file instead of
+*  csl_28035_RAM_lnk.cmd, with the boot mode pins set to boot from flash.
+*  Everything is loaded into flash; hotfuncs, mpcTable, bootfuncs, ramfuncs
+*  and the CLA program are given run addresses in RAM and copied there at
+*  start up by BOOT_init(), SYS_init() and CLA_config().
+*
+*  Link with --define=HOT_IN_FLASH to run hotfuncs and mpcTable from flash
+*  instead, to measure what RAM saves on the scope with GPIO_12.
+*
+*  The csl library must be on the library search path (-i../csl) for the
+*  members named below. Link with --define=CSL_SOURCE when the csl is built
+*  from csl/src instead, see doc/csl_source.txt.
+*
+*  The code security module is not used. Its reserved words and password,
+*  0x3F7F80 to 0x3F7FF5 and 0x3F7FF8 to 0x3F7FFF, are kept out of FLASH and
+*  left erased, so the device stays unsecured. To secure it, add a source
+*  with the csm_rsvd section (all 0x0000) and the csmpasswds section, and
+*  place those sections in the two ranges.
+*/
+MEMORY
+{
+
+PAGE 0 : /* FLASH Memory */
+   FLASH  : origin = 0x3E8000, length = 0x00FF80     /* on-chip FLASH */
+   BEGIN  : origin = 0x3F7FF6, length = 0x000002     /* boot to flash entry */
+
+PAGE 1:    /* PIE Memory as defined by DSP280x_Headers_nonBIOS.cmd */
+   CLA1_MSGRAMLOW       : origin = 0x001480, length = 0x000080
+   CLA1_MSGRAMHIGH      : origin = 0x001500, length = 0x000080
+
+PAGE 2 : /* ROM */
+   BOOTROM              : origin = 0x3FF27C, length = 0x000D44
+   RESET                : origin = 0x3FFFC0, length = 0x000002
+   VECTORS              : origin = 0x3FFFC2, length = 0x00003E     /* part of boot ROM  */
+   IQTABLES             : origin = 0x3FE000, length = 0x000B50     /* IQ Math Tables in Boot ROM */
+   IQTABLES2            : origin = 0x3FEB50, length = 0x00008C     /* IQ Math Tables in Boot ROM */
+   IQTABLES3            : origin = 0x3FEBDC, length = 0x0000AA	 /* IQ Math Tables in Boot ROM */
+
+PAGE 3 : /* RAM */
+
+   RAMM                 : origin = 0x000050, length = 0x0007B0  /* on-chip RAM block M1 & M0 */
+   RAML                 : origin = 0x008000, length = 0x001000
+
+
+PAGE 4 : /* Reserved RAM */
+   BOOT_RSVD            : origin = 0x000000, length = 0x000050     /* Part of M0, BOOT rom will use this for stack */
+
+   CLA1_PROG            : origin = 0x009000, length = 0x001000
+}
+
+
+SECTIONS
+{
+   /* Allocate uninitalized data sections: */
+   .stack           : > RAMM,      PAGE = 3
+   .ebss            : >> RAMM | RAML  PAGE = 3
+   .esysmem         : > RAMM,      PAGE = 3
+   .sysmem          : > RAMM,      PAGE = 3
+   .cio             : > RAMM,      PAGE = 3
+
+   IQmathTables     : > IQTABLES,  PAGE = 2, TYPE = NOLOAD
+   bootrom          : > BOOTROM    PAGE = 2, TYPE = DSECT
+   .reset           : > RESET,     PAGE = 2, TYPE = DSECT /* not used, */
+    vectors         : > VECTORS    PAGE = 2, TYPE = DSECT
+
+   /* Initialised sections, all in flash */
+   codestart        : > BEGIN,     PAGE = 0
+   .cinit           : > FLASH,     PAGE = 0
+   .pinit           : > FLASH,     PAGE = 0
+   .text            : > FLASH,     PAGE = 0
+   .econst          : > FLASH,     PAGE = 0
+   .switch          : > FLASH,     PAGE = 0
+   IQmath           : > FLASH,     PAGE = 0
+   dummyramfuncs    : > FLASH,     PAGE = 0
+
+   /* Flash set up code of the csl, copied by SYS_init() */
+   ramfuncs         : LOAD = FLASH,     PAGE = 0
+                      RUN  = RAML,      PAGE = 3
+                      LOAD_START(_RamfuncsLoadStart),
+                      LOAD_END(_RamfuncsLoadEnd),
+                      RUN_START(_RamfuncsRunStart)
+
+   /* Flash set up code of boot.c, copied by BOOT_init() */
+   bootfuncs        : LOAD = FLASH,     PAGE = 0
+                      RUN  = RAML,      PAGE = 3
+                      LOAD_START(_BootfuncsLoadStart),
+                      LOAD_END(_BootfuncsLoadEnd),
+                      RUN_START(_BootfuncsRunStart)
+
+#ifndef HOT_IN_FLASH
+   /* Control path, copied by BOOT_init(). The csl members are the 2p2z
+   *  controller and the soft-start update, called every cycle; built from
+   *  csl/src they are already in hotfuncs.
+   */
+   hotfuncs         : {
+                        *(hotfuncs)
+#ifndef CSL_SOURCE
+                        -l csl2803x_ml.lib<csl_cntrl_2p2z.obj> (.text)
+                        -l csl2803x_ml.lib<csl_cntrl_Pri.obj> (.text:_CNTRL_2p2zSoftStartUpdate)
+#endif
+                      }
+                      LOAD = FLASH,     PAGE = 0
+                      RUN  = RAML,      PAGE = 3
+                      LOAD_START(_HotfuncsLoadStart),
+                      LOAD_END(_HotfuncsLoadEnd),
+                      RUN_START(_HotfuncsRunStart)
+
+   /* Explicit MPC search tree and laws (mpc_table.c), read every ISR */
+   mpcTable         : LOAD = FLASH,     PAGE = 0
+                      RUN  = RAML,      PAGE = 3
+                      LOAD_START(_MpcTableLoadStart),
+                      LOAD_END(_MpcTableLoadEnd),
+                      RUN_START(_MpcTableRunStart)
+#else
+   /* For the comparison only, BOOT_init() finds nothing to copy */
+   hotfuncs         : > FLASH,          PAGE = 0
+                      LOAD_START(_HotfuncsLoadStart),
+                      LOAD_END(_HotfuncsLoadEnd),
+                      RUN_START(_HotfuncsRunStart)
+
+   mpcTable         : > FLASH,          PAGE = 0
+                      LOAD_START(_MpcTableLoadStart),
+                      LOAD_END(_MpcTableLoadEnd),
+                      RUN_START(_MpcTableRunStart)
+#endif
+
+   Cla1Prog         : LOAD = FLASH,     PAGE = 0
+                      RUN  = CLA1_PROG, PAGE = 4
+                      LOAD_START(_Cla1funcsLoadStart),
+                      LOAD_END(_Cla1funcsLoadEnd),
+                      RUN_START(_Cla1funcsRunStart)
+
+   Cla1ToCpuMsgRAM  : > CLA1_MSGRAMLOW,   PAGE = 1
+   CpuToCla1MsgRAM  : > CLA1_MSGRAMHIGH,  PAGE = 1
+
+
+}
@@ -62,6 +62,25 @@ SECTIONS
    .switch          : PAGE = 3
    IQmath           : PAGE = 3
 
+   /* Explicit MPC search tree and laws (mpc_table.c), read every ISR */
+   mpcTable         : > RAML,      PAGE = 3,
+                      LOAD_START(_MpcTableLoadStart),
+                      LOAD_END(_MpcTableLoadEnd),
+                      RUN_START(_MpcTableRunStart)
+
+   /* Control path and flash set up of boot.c, already in RAM here so
+   *  BOOT_init() copies nothing. See csl_28035_FLASH_lnk.cmd.
+   */
+   hotfuncs         : > RAML,      PAGE = 3,
+                      LOAD_START(_HotfuncsLoadStart),
+                      LOAD_END(_HotfuncsLoadEnd),
+                      RUN_START(_HotfuncsRunStart)
+
+   bootfuncs        : > RAML,      PAGE = 3,
+                      LOAD_START(_BootfuncsLoadStart),
+                      LOAD_END(_BootfuncsLoadEnd),
+                      RUN_START(_BootfuncsRunStart)
+
 
    Cla1Prog         : LOAD = RAMM,      PAGE = 3
                       RUN  = CLA1_PROG, PAGE = 4
@@ -0,0 +1,271 @@
+/******************************************************************************
+* FILE          : dead.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Synchronous rectifier dead time, optimised online. See dead.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "dead.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#pragma CODE_SECTION( DEAD_apply, "hotfuncs" );
+
+#define DEAD_NONE           0xFFFFFFFFUL    /* probe outside m_Min..m_Max */
+
+static void DEAD_set( DEAD_Data* Ptr, uint16_t Ticks );
+static void DEAD_next( DEAD_Data* Ptr );
+static void DEAD_decide( DEAD_Data* Ptr );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : DEAD_init
+* DESCRIPTION   :
+* Makes channel B of Pwm the complement of channel A with StartNs of dead
+* time, which DEAD_process() then moves within MinNs..MaxNs. pDemand is the
+* current demand, to tell a load change.
+******************************************************************************/
+void DEAD_init( DEAD_Data* Ptr, PWM_Module Pwm,
+                const volatile int* pDemand, uint32_t StartNs,
+                uint32_t MinNs, uint32_t MaxNs )
+{
+    uint16_t Ticks = PWM_nsToTicks( StartNs );
+
+    Ptr->m_Pwm          = Pwm;
+    Ptr->m_pDemand      = pDemand;
+    Ptr->m_Min          = PWM_nsToTicks( MinNs );
+    Ptr->m_Max          = PWM_nsToTicks( MaxNs );
+    if( Ptr->m_Min < DEAD_STEP )
+    {
+        Ptr->m_Min = DEAD_STEP;
+    }
+    if( Ptr->m_Max < Ptr->m_Min )
+    {
+        Ptr->m_Max = Ptr->m_Min;
+    }
+    if( Ticks < Ptr->m_Min )
+    {
+        Ticks = Ptr->m_Min;
+    }
+    else if( Ticks > Ptr->m_Max )
+    {
+        Ticks = Ptr->m_Max;
+    }
+    Ptr->m_OnSum        = 0;
+    Ptr->m_DemandSum    = 0;
+    Ptr->m_Count        = 0;
+    Ptr->m_Ticks        = Ticks;
+    Ptr->m_Next         = Ticks;
+    Ptr->m_Clear        = true;
+    Ptr->m_State        = DEAD_IDLE;
+    Ptr->m_Probe        = 0;
+    Ptr->m_Base         = Ticks;
+    Ptr->m_OnTime       = 0;
+    Ptr->m_Rounds       = 0;
+    Ptr->m_Moves        = 0;
+    Ptr->m_Discarded    = 0;
+
+    PWM_setDeadBand( Pwm, Ticks, GPIO_NON_INVERT, GPIO_INVERT );
+
+    /* DCCAP takes the counter at the trip, straight away */
+    EALLOW;
+    Pwm->DCCAPCTL.bit.SHDWMODE  = 1;
+    Pwm->DCCAPCTL.bit.CAPE      = 1;
+    Pwm->TZCLR.all              = DEAD_TZ_DCAEVT2;
+    EDIS;
+}
+
+
+/******************************************************************************
+* FUNCTION      : DEAD_shareFlag
+* DESCRIPTION   :
+* Leaves the TZFLG DCAEVT2 flag to BLANK_update(), which reads the same trip
+* and clears it. DEAD_update() must then come before BLANK_update() in the
+* control ISR.
+******************************************************************************/
+void DEAD_shareFlag( DEAD_Data* Ptr )
+{
+    Ptr->m_Clear = false;
+}
+
+
+/******************************************************************************
+* FUNCTION      : DEAD_apply
+* DESCRIPTION   :
+* Writes the dead time DEAD_process() has asked for to the dead band. Called
+* by DEAD_update().
+******************************************************************************/
+void DEAD_apply( DEAD_Data* Ptr )
+{
+    Ptr->m_Ticks = Ptr->m_Next;
+    PWM_setDeadBand( Ptr->m_Pwm, Ptr->m_Ticks, GPIO_NON_INVERT, GPIO_INVERT );
+}
+
+
+/******************************************************************************
+* FUNCTION      : DEAD_process
+* DESCRIPTION   :
+* Runs the rounds while Run is true, e.g. while the output is up. Otherwise
+* a round under way is dropped and the dead time goes back to where the round
+* started. Call it from the idle loop.
+******************************************************************************/
+void DEAD_process( DEAD_Data* Ptr, int Run )
+{
+    uint32_t OnSum;
+    uint32_t DemandSum;
+    uint16_t Count;
+    uint16_t St;
+
+    if( !Run )
+    {
+        if( Ptr->m_State != DEAD_IDLE )
+        {
+            Ptr->m_Next  = Ptr->m_Base;
+            Ptr->m_State = DEAD_IDLE;
+        }
+        return;
+    }
+
+    switch( Ptr->m_State )
+    {
+        case DEAD_IDLE:
+            Ptr->m_Base  = Ptr->m_Next;
+            Ptr->m_Probe = 0;
+            DEAD_set( Ptr, Ptr->m_Base );
+            break;
+
+        case DEAD_WAIT:
+            if( Ptr->m_Count >= DEAD_SETTLE )
+            {
+                St = __disable_interrupts();
+                Ptr->m_OnSum     = 0;
+                Ptr->m_DemandSum = 0;
+                Ptr->m_Count     = 0;
+                __restore_interrupts( St );
+                Ptr->m_State = DEAD_SUM;
+            }
+            break;
+
+        case DEAD_HOLD:
+            if( Ptr->m_Count >= DEAD_REST )
+            {
+                Ptr->m_State = DEAD_IDLE;
+            }
+            break;
+
+        case DEAD_SUM:
+            if( Ptr->m_Count >= DEAD_AVG )
+            {
+                St = __disable_interrupts();
+                OnSum     = Ptr->m_OnSum;
+                DemandSum = Ptr->m_DemandSum;
+                Count     = Ptr->m_Count;
+                __restore_interrupts( St );
+
+                Ptr->m_On[Ptr->m_Probe]     = (OnSum << 8) / Count;
+                Ptr->m_Demand[Ptr->m_Probe] = (DemandSum << 4) / Count;
+                DEAD_next( Ptr );
+            }
+            break;
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : DEAD_set
+* DESCRIPTION   :
+* Asks for Ticks of dead time and lets the loop settle on it.
+******************************************************************************/
+static void DEAD_set( DEAD_Data* Ptr, uint16_t Ticks )
+{
+    uint16_t St = __disable_interrupts();
+
+    Ptr->m_Next  = Ticks;
+    Ptr->m_Count = 0;
+    __restore_interrupts( St );
+    Ptr->m_State = DEAD_WAIT;
+}
+
+
+/******************************************************************************
+* FUNCTION      : DEAD_next
+* DESCRIPTION   :
+* Goes on to the next probe of the round within m_Min..m_Max, or decides.
+******************************************************************************/
+static void DEAD_next( DEAD_Data* Ptr )
+{
+    uint16_t Ticks;
+
+    while( ++Ptr->m_Probe < DEAD_PROBES )
+    {
+        Ticks = Ptr->m_Probe == 1 ? Ptr->m_Base + DEAD_STEP
+                                  : Ptr->m_Base - DEAD_STEP;
+        if( Ticks >= Ptr->m_Min && Ticks <= Ptr->m_Max )
+        {
+            DEAD_set( Ptr, Ticks );
+            return;
+        }
+        Ptr->m_On[Ptr->m_Probe] = DEAD_NONE;
+    }
+    DEAD_decide( Ptr );
+}
+
+
+/******************************************************************************
+* FUNCTION      : DEAD_decide
+* DESCRIPTION   :
+* Ends the round: moves to the probe with the shortest on-time, if it is
+* shorter by more than DEAD_HYST, unless the load moved during the round, or
+* else rests at the dead time as it was.
+******************************************************************************/
+static void DEAD_decide( DEAD_Data* Ptr )
+{
+    uint32_t Tol  = (Ptr->m_Demand[0] >> 5) + 16;
+    int      Best = 0;
+    int      Probe;
+    long     Diff;
+
+    Ptr->m_OnTime = Ptr->m_On[0];
+    Ptr->m_Rounds++;
+
+    for( Probe = 1; Probe < DEAD_PROBES; Probe++ )
+    {
+        if( Ptr->m_On[Probe] == DEAD_NONE )
+        {
+            continue;
+        }
+        Diff = (long)Ptr->m_Demand[Probe] - (long)Ptr->m_Demand[0];
+        if( (uint32_t)(Diff < 0 ? -Diff : Diff) > Tol )
+        {
+            Ptr->m_Discarded++;
+            Best = 0;
+            break;
+        }
+        if( Ptr->m_On[Probe] < Ptr->m_On[Best] )
+        {
+            Best = Probe;
+        }
+    }
+
+    if( Best && Ptr->m_On[Best] + DEAD_HYST < Ptr->m_On[0] )
+    {
+        Ptr->m_Next  = Best == 1 ? Ptr->m_Base + DEAD_STEP
+                                 : Ptr->m_Base - DEAD_STEP;
+        Ptr->m_State = DEAD_IDLE;
+        Ptr->m_Moves++;
+    }
+    else
+    {
+        DEAD_set( Ptr, Ptr->m_Base );
+        Ptr->m_State = DEAD_HOLD;
+    }
+}
@@ -0,0 +1,181 @@
+/*******************************************************************************
+* FILE          : dead.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Synchronous rectifier dead time, optimised online.
+*
+* With a synchronous rectifier channel B drives the low side FET as the
+* complement of channel A, through the dead band of PWM_setDeadBand(): B
+* falls at zero and A rises m_Ticks later, and where A ends at its duty, B
+* rises m_Ticks after it. The peak current trip acts after the dead band, so
+* the trip state of B must be GPIO_SET: the trip turns A off and B on at
+* once, and the gate driver keeps its own dead time at that edge. The dead
+* band is then what the ePWM controls at the start of every cycle, the low
+* side off to the high side on.
+*
+* Too short and the two FETs conduct together as the low side turns off; too
+* long and the body diode of the low side carries the current, and recovers,
+* for the rest of it. Either costs power, which the loop has to make up with
+* a longer on-time for the same Vout, so the dead time with the shortest
+* on-time is the one with the least loss. The point moves with the load, as
+* the current charges the switch node.
+*
+* DEAD_update() in the control ISR adds the on-time of the cycle and the
+* current demand to sums. The on-time is DCCAP, the counter at the trip, when
+* the TZFLG DCAEVT2 flag says the cycle tripped, and CMPA, where channel A
+* ends at the duty clamp, when it did not; DCCAP then still holds an older
+* trip. DEAD_update() clears the flag, unless BLANK_update() shares it: see
+* DEAD_shareFlag().
+*
+* DEAD_process() in the idle loop perturbs and observes: a round tries the
+* dead time as it is, one DEAD_STEP longer and one shorter, each for
+* DEAD_SETTLE cycles to let the loop settle and then DEAD_AVG cycles averaged,
+* and moves to the one with the shortest average on-time if that is more than
+* DEAD_HYST shorter than now. After a move the next round starts at once; when
+* the dead time stays the probes, each a little loss, wait DEAD_REST cycles. A
+* round in which the average current demand moved by more than 1/32, a load
+* change rather than a loss change, is thrown away. The dead time stays within
+* m_Min..m_Max; m_Min must not be below the turn off time of the low side.
+*
+* DEAD_update() writes a new dead time to the dead band when it sees one, in
+* the off-time, after the delay of the rising edge has run.
+*
+*   DEAD_update()   ~18 cycles      in the control ISR, ~36 with a new time
+*   DEAD_process()  ~20 cycles      in the idle loop, ~150 once a step
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+* A round is about 70ms at 200kHz, and a rest 300ms.
+*
+* tools/dead_sim.c runs DEAD_process() on a loss model of the power stage,
+* with the results in doc/dead_time.txt.
+*
+* EXAMPLES
+*   DEAD_Data MyDead;
+*
+*   PWM_setTripState( PWM_MOD_1, PWM_CH_B, GPIO_SET );
+*   DEAD_init( &MyDead, PWM_MOD_1, &MyCntrl.Out.m_Int, 100, 20, 170 );
+*
+*   interrupt void IsrAdc( void )
+*   {
+*       ...
+*       DEAD_update( &MyDead );
+*   }
+*
+*   while(1)
+*   {
+*       DEAD_process( &MyDead, MySoft.m_Level == SOFT_LEVEL_ONE );
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _DEAD_H
+#define _DEAD_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  DEAD_Data       DEAD_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+#define DEAD_STEP       1       /* ticks per perturbation */
+#define DEAD_SETTLE     512     /* cycles after a change, not averaged */
+#define DEAD_AVG        4096    /* cycles averaged per dead time */
+#define DEAD_HYST       8       /* on-time, ticks x 256, to move */
+#define DEAD_REST       60000   /* cycles at a dead time that stayed */
+#define DEAD_PROBES     3       /* as it is, longer, shorter */
+
+#define DEAD_TZ_DCAEVT2 0x0010  /* TZFLG and TZCLR bit */
+
+/*******************************************************************************
+* ENUM          : DEAD_State
+* DESCRIPTION   :
+* Where the round is.
+*******************************************************************************/
+typedef enum
+{
+    DEAD_IDLE = 0,      /* not running, or between rounds */
+    DEAD_WAIT,          /* m_Probe applied, the loop settling */
+    DEAD_SUM,           /* m_Probe applied, summing */
+    DEAD_HOLD           /* the dead time stayed, resting */
+} DEAD_State;
+
+/*******************************************************************************
+* STRUCT        : DEAD_Data
+* DESCRIPTION   :
+* The dead time structure.
+*******************************************************************************/
+struct DEAD_Data
+{
+    /* read and written every cycle by DEAD_update() */
+    PWM_Module          m_Pwm;
+    const volatile int* m_pDemand;      /* current demand, DAC counts */
+    volatile uint32_t   m_OnSum;        /* ticks */
+    volatile uint32_t   m_DemandSum;
+    volatile uint16_t   m_Count;        /* cycles in the sums */
+    uint16_t            m_Ticks;        /* in the dead band */
+    volatile uint16_t   m_Next;         /* from DEAD_process() */
+    int                 m_Clear;        /* clear the DCAEVT2 flag */
+
+    /* idle loop */
+    uint16_t            m_Min;          /* ticks */
+    uint16_t            m_Max;          /* ticks */
+    int                 m_State;        /* DEAD_State */
+    int                 m_Probe;        /* 0 as it is, 1 longer, 2 shorter */
+    uint16_t            m_Base;         /* ticks at the start of the round */
+    uint32_t            m_On[DEAD_PROBES];      /* average, ticks x 256 */
+    uint32_t            m_Demand[DEAD_PROBES];  /* average, x 16 */
+
+    /* statistics */
+    volatile uint32_t   m_OnTime;       /* at m_Base, ticks x 256 */
+    volatile uint16_t   m_Rounds;
+    volatile uint16_t   m_Moves;
+    volatile uint16_t   m_Discarded;    /* rounds with a load change */
+};
+
+
+/*******************************************************************************
+* MACRO         : DEAD_update
+* DESCRIPTION   :
+* Sums the on-time and the current demand of the cycle and applies a new dead
+* time. Call it once per control cycle in the control ISR, after the trip.
+*******************************************************************************/
+#define DEAD_update( Ptr )                                                  \
+    do                                                                      \
+    {                                                                       \
+        if( (Ptr)->m_Pwm->TZFLG.bit.DCAEVT2 )                               \
+        {                                                                   \
+            (Ptr)->m_OnSum += (Ptr)->m_Pwm->DCCAP;                          \
+            if( (Ptr)->m_Clear )                                            \
+            {                                                               \
+                EALLOW;                                                     \
+                (Ptr)->m_Pwm->TZCLR.all = DEAD_TZ_DCAEVT2;                  \
+                EDIS;                                                       \
+            }                                                               \
+        }                                                                   \
+        else                                                                \
+        {                                                                   \
+            (Ptr)->m_OnSum += (Ptr)->m_Pwm->CMPA.half.CMPA;                 \
+        }                                                                   \
+        (Ptr)->m_DemandSum += *(Ptr)->m_pDemand;                            \
+        (Ptr)->m_Count++;                                                   \
+        if( (Ptr)->m_Next != (Ptr)->m_Ticks ) { DEAD_apply( (Ptr) ); }      \
+    } while( 0 )
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void DEAD_init( DEAD_Data* Ptr, PWM_Module Pwm,
+                       const volatile int* pDemand, uint32_t StartNs,
+                       uint32_t MinNs, uint32_t MaxNs );
+extern void DEAD_shareFlag( DEAD_Data* Ptr );
+extern void DEAD_process( DEAD_Data* Ptr, int Run );
+extern void DEAD_apply( DEAD_Data* Ptr );
+
+/********** END ***************************************************************/
+#endif
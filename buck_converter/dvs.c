@@ -0,0 +1,111 @@
+/******************************************************************************
+* FILE          : dvs.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Reference slewing for dynamic voltage scaling. See dvs.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "dvs.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#pragma CODE_SECTION( DVS_setTarget, "hotfuncs" );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : DVS_init
+* DESCRIPTION   :
+* Settles the value at Value. DVS_update() is called every UpdatePeriodNs,
+* which must divide 1ms, and Kff is the feed-forward per count per cycle.
+******************************************************************************/
+void DVS_init( DVS_Data* Ptr, int Value, uint32_t UpdatePeriodNs, int Kff )
+{
+    Ptr->m_Count        = 0;
+    Ptr->m_Pos          = (long)Value << 16;
+    Ptr->m_Step         = 0;
+    Ptr->m_End          = Ptr->m_Pos;
+    Ptr->m_Value        = Value;
+    Ptr->m_Ff           = 0;
+    Ptr->m_CyclesPerMs  = (int)(1000000L / UpdatePeriodNs);
+    Ptr->m_Kff          = Kff;
+    Ptr->m_Target       = Value;
+    Ptr->m_Preempted    = 0;
+}
+
+
+/******************************************************************************
+* FUNCTION      : DVS_setTarget
+* DESCRIPTION   :
+* Slews the value to Target at RatePerMs counts per ms from where it is now,
+* with the feed-forward if FeedForward is true. A ramp longer than
+* DVS_COUNT_MAX cycles is made that long, a little faster. Returns -1, and
+* changes nothing, if RatePerMs is not above 0.
+******************************************************************************/
+int DVS_setTarget( DVS_Data* Ptr, int Target, int RatePerMs, int FeedForward )
+{
+    long     End = (long)Target << 16;
+    long     Rate;
+    long     Pos;
+    long     Delta;
+    long     Step;
+    uint32_t Count;
+    int      Ff;
+    int      Done;
+    uint16_t St;
+
+    if( RatePerMs <= 0 )
+    {
+        return -1;
+    }
+    Rate = ((long)RatePerMs << 16) / Ptr->m_CyclesPerMs;
+    if( Rate == 0 )
+    {
+        Rate = 1;
+    }
+
+    do
+    {
+        Pos   = Ptr->m_Pos;
+        Delta = End - Pos;
+        Count = ((Delta < 0 ? -Delta : Delta) + Rate - 1) / Rate;
+        if( Count > DVS_COUNT_MAX )
+        {
+            Count = DVS_COUNT_MAX;
+        }
+        Step  = Count ? Delta / (long)Count : 0;
+        Ff    = FeedForward ? (int)((Step * Ptr->m_Kff) >> 16) : 0;
+
+        St   = __disable_interrupts();
+        Done = Ptr->m_Pos == Pos;
+        if( Done )
+        {
+            if( Ptr->m_Count )
+            {
+                Ptr->m_Preempted++;
+            }
+            Ptr->m_End    = End;
+            Ptr->m_Step   = Step;
+            Ptr->m_Count  = (uint16_t)Count;
+            Ptr->m_Ff     = Ff;
+            Ptr->m_Target = Target;
+            if( Count == 0 )
+            {
+                Ptr->m_Ff    = 0;
+                Ptr->m_Value = Target;
+            }
+        }
+        __restore_interrupts( St );
+    }
+    while( !Done );
+
+    return 0;
+}
@@ -0,0 +1,150 @@
+/*******************************************************************************
+* FILE          : dvs.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Reference slewing for dynamic voltage scaling.
+*
+* A step in the reference is a step in the error: the 2p2z answers with a
+* burst of current that charges the output capacitor past the new voltage
+* before the loop pulls it back. DVS_setTarget() instead gives the value a
+* straight trajectory to the target at a slew rate, and DVS_update() in the
+* control ISR moves it one step per cycle:
+*
+*   m_Pos       the value, 16.16, moved by m_Step while m_Count counts the
+*               cycles left; at the last one it is set to m_End itself
+*   m_Value     m_Pos >> 16, what the reference is taken from
+*
+* The step is the distance over the cycles, rounded towards zero, so the value
+* never passes the target on the way and lands on it exactly. A new target
+* pre-empts the ramp at once, from wherever the value is: DVS_setTarget()
+* does its divisions on a copy of m_Pos and only commits if no step came in
+* between, else it does them again, so the new trajectory starts where the
+* value really is.
+*
+* Charging the output capacitor at the slew rate takes a current C.dV/dt on
+* top of the load. The loop would have to find it through its error, which
+* lags and then overshoots; with FeedForward the current is m_Ff, m_Kff
+* times the step in demand counts, and DVS_feedForward() adds it to the
+* current demand while the value moves, so the loop only trims. For the buck
+* m_Kff = C.Kdac/(Ts.Kadc) = 1/OBS_KV of obs.h.
+*
+*   DVS_update()        ~3 cycles       in the control ISR, settled
+*                       ~14 cycles      slewing
+*   DVS_feedForward()   ~3 cycles       settled, ~9 slewing
+*   DVS_setTarget()     ~150 cycles     two 32 bit divisions, ~15 of them
+*                                       with the interrupts off
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+*
+* EXAMPLES
+*   DVS_Data MyDvs;
+*
+*   DVS_init( &MyDvs, 2048, PERIOD_NS, 13 );
+*   DVS_setTarget( &MyDvs, 2200, 1000, true );      // 1000 counts per ms
+*
+*   interrupt void IsrAdc( void )
+*   {
+*       ...
+*       CNTRL_2p2z( &MyCntrl );
+*       DVS_feedForward( &MyDvs, MyCntrl.Out.m_Int, MAX_DUTY );
+*       CMP_setDac( CMP_MOD_2, MyCntrl.Out.m_Int );
+*       ...
+*       DVS_update( &MyDvs );
+*       MyCntrl.Ref.m_Int = MyDvs.m_Value;
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _DVS_H
+#define _DVS_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  DVS_Data        DVS_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+#define DVS_COUNT_MAX   0xFFFF  /* cycles per ramp, the rate is raised */
+
+/*******************************************************************************
+* STRUCT        : DVS_Data
+* DESCRIPTION   :
+* The slewing structure.
+*******************************************************************************/
+struct DVS_Data
+{
+    /* written every cycle by DVS_update() while slewing */
+    uint16_t            m_Count;        /* cycles left, 0 settled */
+    long                m_Pos;          /* value, 16.16 */
+    long                m_Step;         /* per cycle, 16.16 */
+    long                m_End;          /* target, 16.16 */
+    volatile int        m_Value;        /* m_Pos >> 16 */
+    volatile int        m_Ff;           /* feed-forward, 0 settled */
+
+    int                 m_CyclesPerMs;
+    int                 m_Kff;          /* m_Ff per count per cycle */
+    volatile int        m_Target;
+    volatile uint16_t   m_Preempted;    /* targets set while slewing */
+};
+
+
+/*******************************************************************************
+* MACRO         : DVS_update
+* DESCRIPTION   :
+* Moves the value one step towards the target, if it is not there. Call it
+* once per control cycle in the control ISR.
+*******************************************************************************/
+#define DVS_update( Ptr )                                                   \
+    do                                                                      \
+    {                                                                       \
+        if( (Ptr)->m_Count )                                                \
+        {                                                                   \
+            (Ptr)->m_Pos += (Ptr)->m_Step;                                  \
+            if( --(Ptr)->m_Count == 0 )                                     \
+            {                                                               \
+                (Ptr)->m_Pos = (Ptr)->m_End;                                \
+                (Ptr)->m_Ff  = 0;                                           \
+            }                                                               \
+            (Ptr)->m_Value = (int)((Ptr)->m_Pos >> 16);                     \
+        }                                                                   \
+    } while( 0 )
+
+/*******************************************************************************
+* MACRO         : DVS_feedForward
+* DESCRIPTION   :
+* Adds the feed-forward to the current demand Out, limited to 0..Max, while
+* the value moves. Call it between the controller and the DAC write.
+*******************************************************************************/
+#define DVS_feedForward( Ptr, Out, Max )                                    \
+    do                                                                      \
+    {                                                                       \
+        if( (Ptr)->m_Ff )                                                   \
+        {                                                                   \
+            (Out) += (Ptr)->m_Ff;                                           \
+            if( (Out) > (Max) )                                             \
+            {                                                               \
+                (Out) = (Max);                                              \
+            }                                                               \
+            else if( (Out) < 0 )                                            \
+            {                                                               \
+                (Out) = 0;                                                  \
+            }                                                               \
+        }                                                                   \
+    } while( 0 )
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void DVS_init( DVS_Data* Ptr, int Value, uint32_t UpdatePeriodNs,
+                      int Kff );
+extern int  DVS_setTarget( DVS_Data* Ptr, int Target, int RatePerMs,
+                           int FeedForward );
+
+/********** END ***************************************************************/
+#endif
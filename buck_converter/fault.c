@@ -0,0 +1,219 @@
+/******************************************************************************
+* FILE          : fault.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Latched one-shot trip with a nested fault interrupt. See fault.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "fault.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#pragma CODE_SECTION( FLT_trip, "hotfuncs" );
+#pragma CODE_SECTION( FLT_event, "hotfuncs" );
+
+/* TZFLG, TZCLR and TZFRC bits */
+#define FLT_TZ_INT          0x0001
+#define FLT_TZ_OST          0x0004
+#define FLT_TZ_DCAEVT1      0x0008
+#define FLT_TZ_DCBEVT1      0x0020
+
+#define FLT_OVP_OFF         0x7FFF
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : FLT_init
+* DESCRIPTION   :
+* Makes Sources, a mask of PWM_TZx and PWM_DCEVT or 0 for none, latch the
+* one-shot trip of Pwm and sets Func as the ISR of its trip zone interrupt.
+* OvpLevel is the feedback in ADC counts above which FLT_checkOvp() trips.
+* The output states are those set with PWM_setTripState().
+******************************************************************************/
+void FLT_init( FLT_Data* Ptr, PWM_Module Pwm, uint16_t Sources,
+               int OvpLevel, INT_IsrAddr Func )
+{
+    INT_PieId PieId = (INT_PieId)(PWM_getIndex( Pwm ) + (int)INT_ID_TZINT1);
+
+    Ptr->m_Pwm          = Pwm;
+    Ptr->m_OvpLevel     = OvpLevel;
+    Ptr->m_OvpNom       = OvpLevel;
+    Ptr->m_Reset        = 0;
+    Ptr->m_Tripped      = false;
+    Ptr->m_Cause        = FLT_NONE;
+    Ptr->m_Flags        = 0;
+    Ptr->m_Count        = 0;
+    Ptr->m_ForceTicks   = 0;
+    Ptr->m_Forced       = false;
+    Ptr->m_Latency      = 0;
+    Ptr->m_LatencyMax   = 0;
+
+    if( Sources )
+    {
+        PWM_setTripZone( Pwm, Sources, PWM_TPZ_ONE_SHOT );
+    }
+
+    /* The comparator trip goes through the blanking window as well, so the
+    *  turn on spike does not latch the one-shot trip
+    */
+    EALLOW;
+    Pwm->DCACTL.bit.EVT1SRCSEL = 1;
+    Pwm->TZCLR.all = FLT_TZ_OST | FLT_TZ_DCAEVT1 | FLT_TZ_DCBEVT1 | FLT_TZ_INT;
+    EDIS;
+    PWM_enableTpzInt( Pwm, PWM_TPZ_ONE_SHOT, true );
+
+    INT_setCallback( INT_pieIdToVectorId( PieId ), Func );
+    INT_enablePieId( PieId, true );
+}
+
+
+/******************************************************************************
+* FUNCTION      : FLT_trip
+* DESCRIPTION   :
+* Forces the one-shot trip and keeps the time for the latency. Called once;
+* FLT_checkOvp() is off until FLT_clear().
+******************************************************************************/
+void FLT_trip( FLT_Data* Ptr, FLT_Cause Cause )
+{
+    if( Ptr->m_Forced )
+    {
+        return;
+    }
+
+    EALLOW;
+    Ptr->m_Pwm->TZFRC.all = FLT_TZ_OST;
+    EDIS;
+    Ptr->m_ForceTicks = Ptr->m_Pwm->TBCTR;
+
+    if( Cause == FLT_OVP && Ptr->m_OvpLevel < 0 )
+    {
+        Cause = FLT_TEST;
+    }
+    if( !Ptr->m_Tripped )
+    {
+        Ptr->m_Cause = Cause;
+    }
+    Ptr->m_OvpLevel = FLT_OVP_OFF;
+    Ptr->m_Forced   = true;
+}
+
+
+/******************************************************************************
+* FUNCTION      : FLT_event
+* DESCRIPTION   :
+* Call from the trip zone ISR. Records the first trip and acknowledges the
+* interrupt. The one-shot trip stays latched until FLT_clear().
+******************************************************************************/
+void FLT_event( FLT_Data* Ptr )
+{
+    uint16_t Ticks = Ptr->m_Pwm->TBCTR;
+    uint16_t Flags = Ptr->m_Pwm->TZFLG.all;
+    int      Latency;
+
+    if( Ptr->m_Forced )
+    {
+        Latency = (int)(Ticks - Ptr->m_ForceTicks);
+        if( Latency < 0 )
+        {
+            Latency += PWM_getPeriod( Ptr->m_Pwm );
+        }
+        Ptr->m_Latency = Latency;
+        if( Latency > Ptr->m_LatencyMax )
+        {
+            Ptr->m_LatencyMax = Latency;
+        }
+    }
+
+    if( !Ptr->m_Tripped )
+    {
+        if( !Ptr->m_Forced )
+        {
+            Ptr->m_Cause = (Flags & (FLT_TZ_DCAEVT1 | FLT_TZ_DCBEVT1)) ?
+                           FLT_OCP : FLT_TRIP_ZONE;
+        }
+        Ptr->m_Flags   = Flags;
+        Ptr->m_Tripped = true;
+        Ptr->m_Count++;
+    }
+
+    EALLOW;
+    Ptr->m_Pwm->TZCLR.all = FLT_TZ_INT;
+    EDIS;
+    INT_ackGroup( INT_GROUP_2 );
+}
+
+
+/******************************************************************************
+* FUNCTION      : FLT_test
+* DESCRIPTION   :
+* Makes the next FLT_checkOvp() trip, to measure the fault latency. Call it
+* or set m_OvpLevel to -1 from the debugger with the output off.
+******************************************************************************/
+void FLT_test( FLT_Data* Ptr )
+{
+    Ptr->m_OvpLevel = -1;
+}
+
+
+/******************************************************************************
+* FUNCTION      : FLT_clear
+* DESCRIPTION   :
+* Restarts the soft-start, pre-biased if it is, clears the history of its
+* controller and calls the reset function for the rest of the control, then
+* releases the one-shot trip and re-arms the fault. Call it from the idle
+* loop once the cause has gone; m_LatencyMax and m_Count are kept.
+******************************************************************************/
+void FLT_clear( FLT_Data* Ptr, SOFT_Data* Soft )
+{
+    CNTRL_2p2zData* Cntrl = Soft->m_Cntrl;
+
+    /* The pre-bias search is too long to run with the interrupts off */
+    SOFT_restart( Soft );
+
+    INT_enableGlobal( false );
+
+    Cntrl->m_U1      = 0;
+    Cntrl->m_U2      = 0;
+    Cntrl->m_E0      = 0;
+    Cntrl->m_E1      = 0;
+    Cntrl->m_E2      = 0;
+
+    if( Ptr->m_Reset )
+    {
+        Ptr->m_Reset();
+    }
+
+    Ptr->m_OvpLevel = Ptr->m_OvpNom;
+    Ptr->m_Forced   = false;
+    Ptr->m_Tripped  = false;
+    Ptr->m_Cause    = FLT_NONE;
+    Ptr->m_Flags    = 0;
+
+    EALLOW;
+    Ptr->m_Pwm->TZCLR.all = FLT_TZ_OST | FLT_TZ_DCAEVT1 | FLT_TZ_DCBEVT1 |
+                            FLT_TZ_INT;
+    EDIS;
+
+    INT_enableGlobal( true );
+}
+
+
+/******************************************************************************
+* FUNCTION      : FLT_setReset
+* DESCRIPTION   :
+* Sets the function that FLT_clear() calls, with interrupts off and the ePWM
+* still tripped, to reset the controller state that the soft-start's 2p2z
+* does not hold. 0 for none.
+******************************************************************************/
+void FLT_setReset( FLT_Data* Ptr, FLT_ResetFunc Func )
+{
+    Ptr->m_Reset = Func;
+}
@@ -0,0 +1,166 @@
+/*******************************************************************************
+* FILE          : fault.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Latched one-shot trip of the power stage with a fault interrupt that can
+* nest inside IsrAdc.
+*
+* A fault latches the one-shot trip (PWM_TPZ_ONE_SHOT) of the ePWM, which
+* forces the outputs to their PWM_setTripState() levels until FLT_clear().
+* The trip comes from
+*
+*   hardware    the Sources given to FLT_init(), e.g. PWM_DCEVT for the
+*               comparator in voltage mode, where it is an over current
+*               limit: the ePWM trips without the CPU, in tens of ns
+*   software    FLT_checkOvp() in the control ISR, once Fdbk is above the
+*               over voltage level: FLT_trip() forces the one-shot trip
+*
+* Either way the ePWM raises its trip zone interrupt, EPWMx_TZINT in PIE group
+* 2, and the fault ISR calls FLT_event() to record the cause and time. The
+* trip itself never waits for the CPU; the ISR only does the book keeping, so
+* it is the ISR that must not wait for the control law. For that IsrAdc acks
+* its own interrupt, runs FLT_checkOvp() and then sets IER to group 2 only and
+* enables interrupts before the control law, and disables them again at the
+* end. The other ISRs that allow IsrAdc to nest let group 2 in as well. The
+* worst case fault ISR latency is then the longest stretch with interrupts
+* off, the start of IsrAdc up to its EINT, whatever the control law costs.
+*
+* In peak current mode the comparator is the current loop and trips every
+* cycle, so it cannot also be the one-shot over current trip; the peak demand
+* is limited by the 2p2z output clamp instead.
+*
+* FLT_event() does not touch the controller, which may be part way through a
+* cycle. The loop keeps running into the tripped ePWM and winds up; FLT_clear()
+* restarts the soft-start, clears the history of the soft-start's 2p2z and
+* calls the FLT_setReset() function, if any, before it lets the ePWM go. That
+* function resets whatever else the control ISR runs, such as the MPC or the
+* inner loop of the cascade; it is called with interrupts off.
+*
+* FLT_test() makes the next FLT_checkOvp() trip, from inside the masked start
+* of IsrAdc, and the time from the forced trip to FLT_event() is kept in
+* m_Latency and m_LatencyMax, in CPU cycles. See doc/fault_latency.txt. Cost:
+*
+*   FLT_checkOvp()  ~4 cycles       in the control ISR, no fault
+*   FLT_event()     ~30 cycles      in the fault ISR
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+*
+* EXAMPLES
+*   FLT_Data MyFlt;
+*
+*   interrupt void IsrFault( void )
+*   {
+*       FLT_event( &MyFlt );
+*   }
+*
+*   interrupt void IsrAdc( void )
+*   {
+*       ADC_ackInt( ADC_INT_1 );
+*       MyCntrl.Fdbk.m_Int = ADC_getValue( ADC_MOD_1 );
+*       FLT_checkOvp( &MyFlt, MyCntrl.Fdbk.m_Int );
+*       IER &= 1 << INT_GROUP_2;
+*       EINT;
+*       ...
+*       DINT;
+*   }
+*
+*   FLT_init( &MyFlt, PWM_MOD_1, 0, 2250, IsrFault );
+*   FLT_setReset( &MyFlt, CntrlReset );
+*   ...
+*   if( MyFlt.m_Tripped )
+*   {
+*       FLT_clear( &MyFlt, &MySoft );
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _FAULT_H
+#define _FAULT_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+#include "soft.h"
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  FLT_Data        FLT_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+typedef void (*FLT_ResetFunc)( void );
+
+/*******************************************************************************
+* ENUM          : FLT_Cause
+* DESCRIPTION   :
+* What tripped the ePWM first.
+*******************************************************************************/
+typedef enum
+{
+    FLT_NONE = 0,
+    FLT_OVP,            /* FLT_checkOvp(), Fdbk above m_OvpLevel, or PROT_OV */
+    FLT_OCP,            /* the comparator, through the digital compare */
+    FLT_TRIP_ZONE,      /* a trip zone pin */
+    FLT_TEST,           /* FLT_test() */
+    FLT_UVP,            /* PROT_UV, see prot.h */
+    FLT_OVERLOAD,       /* PROT_OC */
+    FLT_VIN,            /* input voltage outside its window */
+    FLT_OTP,            /* over temperature */
+    FLT_WATCHDOG,       /* the supervisor, see sup.h */
+    FLT_STACK           /* the stack monitor, see stack.h */
+} FLT_Cause;
+
+/*******************************************************************************
+* STRUCT        : FLT_Data
+* DESCRIPTION   :
+* The fault structure.
+*******************************************************************************/
+struct FLT_Data
+{
+    PWM_Module          m_Pwm;
+    int                 m_OvpLevel;     /* ADC counts, -1 for FLT_test() */
+    int                 m_OvpNom;
+    FLT_ResetFunc       m_Reset;        /* 0, or called by FLT_clear() */
+
+    /* written by FLT_trip() and the fault ISR */
+    volatile int        m_Tripped;
+    volatile int        m_Cause;        /* FLT_Cause of the first trip */
+    volatile uint16_t   m_Flags;        /* TZFLG at the first trip */
+    volatile int        m_Count;        /* trips since FLT_init() */
+    volatile uint16_t   m_ForceTicks;   /* counter at the forced trip */
+    volatile int        m_Forced;       /* m_ForceTicks is valid */
+    volatile int        m_Latency;      /* forced trip to FLT_event(), cycles */
+    volatile int        m_LatencyMax;
+};
+
+
+/*******************************************************************************
+* MACRO         : FLT_checkOvp
+* DESCRIPTION   :
+* Trips the ePWM if Fdbk is above the over voltage level. Call it in the
+* control ISR straight after the ADC read, before interrupts are enabled.
+*******************************************************************************/
+#define FLT_checkOvp( Ptr, Fdbk )                                           \
+    do                                                                      \
+    {                                                                       \
+        if( (Fdbk) > (Ptr)->m_OvpLevel )                                    \
+        {                                                                   \
+            FLT_trip( (Ptr), FLT_OVP );                                     \
+        }                                                                   \
+    } while( 0 )
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void FLT_init( FLT_Data* Ptr, PWM_Module Pwm, uint16_t Sources,
+                      int OvpLevel, INT_IsrAddr Func );
+extern void FLT_trip( FLT_Data* Ptr, FLT_Cause Cause );
+extern void FLT_event( FLT_Data* Ptr );
+extern void FLT_test( FLT_Data* Ptr );
+extern void FLT_clear( FLT_Data* Ptr, SOFT_Data* Soft );
+extern void FLT_setReset( FLT_Data* Ptr, FLT_ResetFunc Func );
+
+/********** END ***************************************************************/
+#endif
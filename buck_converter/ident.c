@@ -0,0 +1,263 @@
+/******************************************************************************
+* FILE          : ident.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* PRBS excitation, sample recording and recursive least squares estimation of
+* the power stage. See ident.h.
+*
+* Only IQmath is used so this file can also be built into host simulations.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "IQmathLib.h"
+#include "csl_stdint.h"
+#include "ident.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#pragma CODE_SECTION( ID_excite, "hotfuncs" );
+#pragma CODE_SECTION( ID_push, "hotfuncs" );
+
+/* The differenced samples are scaled so that 2^ID_SCALE_BITS counts is 1.0 */
+#define ID_SCALE_BITS   4
+
+/* Initial covariance, i.e. the confidence in the initial zero estimate */
+#define ID_P0           _IQ20(16.0)
+
+#define ID_MASK         (ID_BUF_SIZE-1)
+
+/* Samples needed after a gap before the regressor is complete */
+#define ID_VALID        4
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : ID_init
+* DESCRIPTION   :
+* Initialises the structure. Amp is the PRBS amplitude in ADC counts, each
+* PRBS bit is held for Hold cycles, which moves its energy down towards the
+* loop cross over, and Samples is the length of a run.
+******************************************************************************/
+void ID_init( ID_Data* Ptr, int Amp, int Hold, uint32_t Samples )
+{
+    Ptr->m_State   = ID_IDLE;
+    Ptr->m_Head    = 0;
+    Ptr->m_Tail    = 0;
+    Ptr->m_Amp     = Amp;
+    Ptr->m_Hold    = Hold;
+    Ptr->m_Target  = Samples;
+    Ptr->m_Dropped = 0;
+}
+
+
+/******************************************************************************
+* FUNCTION      : ID_start
+* DESCRIPTION   :
+* Resets the estimator and starts a run around the reference RefNom. Called
+* from the idle loop. The state is written last, so the ISR sees a complete
+* structure as soon as it sees ID_RUN.
+******************************************************************************/
+void ID_start( ID_Data* Ptr, int RefNom )
+{
+    int i, j;
+
+    if( Ptr->m_State != ID_IDLE )
+    {
+        return;
+    }
+
+    for( i = 0; i < ID_PARAMS; i++ )
+    {
+        Ptr->m_Theta[i] = 0;
+        Ptr->m_Phi[i]   = 0;
+        for( j = 0; j < ID_PARAMS; j++ )
+        {
+            Ptr->m_P[i][j] = (i == j) ? ID_P0 : 0;
+        }
+    }
+    Ptr->m_Valid     = 0;
+    Ptr->m_Count     = 0;
+    Ptr->m_Head      = 0;
+    Ptr->m_Tail      = 0;
+    Ptr->m_Gap       = 1;
+    Ptr->m_Dropped   = 0;
+    Ptr->m_Lfsr      = 0x1FF;
+    Ptr->m_HoldCount = 0;
+    Ptr->m_RefNom    = RefNom;
+    Ptr->m_State     = ID_RUN;
+}
+
+
+/******************************************************************************
+* FUNCTION      : ID_excite
+* DESCRIPTION   :
+* Called by the ISR before the controller with the current reference Ref and
+* returns the reference to use. While running this is the nominal reference
+* plus or minus m_Amp from a 9 bit PRBS (x^9 + x^5 + 1, 511 bits long).
+******************************************************************************/
+int ID_excite( ID_Data* Ptr, int Ref )
+{
+    uint16_t Lfsr;
+
+    if( Ptr->m_State == ID_RUN )
+    {
+        if( --Ptr->m_HoldCount <= 0 )
+        {
+            Ptr->m_HoldCount = Ptr->m_Hold;
+            Lfsr = Ptr->m_Lfsr;
+            Ptr->m_Lfsr = ((Lfsr << 1) | (((Lfsr >> 8) ^ (Lfsr >> 4)) & 1))
+                        & 0x1FF;
+        }
+        return Ptr->m_RefNom + ((Ptr->m_Lfsr & 1) ? Ptr->m_Amp : -Ptr->m_Amp);
+    }
+    if( Ptr->m_State == ID_STOP )
+    {
+        Ptr->m_State = ID_IDLE;
+        return Ptr->m_RefNom;
+    }
+    return Ref;
+}
+
+
+/******************************************************************************
+* FUNCTION      : ID_push
+* DESCRIPTION   :
+* Called by the ISR after the controller to record the cycle. The sample is
+* written before m_Head is moved, so the idle loop never reads a sample that
+* is only partly written.
+******************************************************************************/
+void ID_push( ID_Data* Ptr, int U, int Y )
+{
+    uint16_t Head = Ptr->m_Head;
+    uint16_t Next = (Head + 1) & ID_MASK;
+
+    if( Ptr->m_State != ID_RUN )
+    {
+        return;
+    }
+    /* After an overflow wait for the buffer to empty, so that the estimator
+    * gets long runs of consecutive samples rather than single ones.
+    */
+    if( Next == Ptr->m_Tail || (Ptr->m_Gap && Head != Ptr->m_Tail) )
+    {
+        Ptr->m_Dropped++;
+        Ptr->m_Gap = 1;
+        return;
+    }
+
+    Ptr->m_Buf[Head].m_U   = U;
+    Ptr->m_Buf[Head].m_Y   = Y;
+    Ptr->m_Buf[Head].m_Gap = Ptr->m_Gap;
+    Ptr->m_Gap  = 0;
+    Ptr->m_Head = Next;
+}
+
+
+/******************************************************************************
+* FUNCTION      : ID_rls
+* DESCRIPTION   :
+* One recursive least squares update with the regressor m_Phi and the new
+* measurement Y, both _iq24. No forgetting factor is used as a run is short
+* and the plant does not change during it.
+*
+*   K     = P.phi / (1 + phi'.P.phi)
+*   theta = theta + K.(Y - phi'.theta)
+*   P     = P - K.phi'.P
+******************************************************************************/
+static void ID_rls( ID_Data* Ptr, _iq24 Y )
+{
+    _iq20 Pphi[ID_PARAMS];
+    _iq20 Gain[ID_PARAMS];
+    _iq20 Den, Inv;
+    _iq24 Err;
+    int   i, j;
+
+    Den = _IQ20(1.0);
+    Err = Y;
+    for( i = 0; i < ID_PARAMS; i++ )
+    {
+        Pphi[i] = 0;
+        for( j = 0; j < ID_PARAMS; j++ )
+        {
+            Pphi[i] += _IQ24mpy( Ptr->m_P[i][j], Ptr->m_Phi[j] );
+        }
+        Err -= _IQ24mpy( Ptr->m_Phi[i], Ptr->m_Theta[i] );
+    }
+    for( i = 0; i < ID_PARAMS; i++ )
+    {
+        Den += _IQ24mpy( Pphi[i], Ptr->m_Phi[i] );
+    }
+
+    Inv = _IQ20div( _IQ20(1.0), Den );
+    for( i = 0; i < ID_PARAMS; i++ )
+    {
+        Gain[i] = _IQ20mpy( Pphi[i], Inv );
+        Ptr->m_Theta[i] += _IQ20mpy( Gain[i], Err );
+    }
+
+    /* P stays symmetric, so only the upper triangle is calculated */
+    for( i = 0; i < ID_PARAMS; i++ )
+    {
+        for( j = i; j < ID_PARAMS; j++ )
+        {
+            Ptr->m_P[i][j] -= _IQ20mpy( Gain[i], Pphi[j] );
+            Ptr->m_P[j][i]  = Ptr->m_P[i][j];
+        }
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : ID_process
+* DESCRIPTION   :
+* Called from the idle loop. Takes up to MaxSamples samples from the buffer
+* and runs the estimator on them. When m_Target samples have been used the
+* ISR is told to stop. Returns true once the run is complete.
+******************************************************************************/
+int ID_process( ID_Data* Ptr, int MaxSamples )
+{
+    ID_Sample*  pSample;
+    uint16_t    Tail = Ptr->m_Tail;
+    _iq24       Du, Dy;
+
+    while( MaxSamples-- > 0 && Tail != Ptr->m_Head )
+    {
+        pSample = &Ptr->m_Buf[Tail];
+        if( pSample->m_Gap )
+        {
+            Ptr->m_Valid = 0;
+        }
+
+        Du = (_iq24)(pSample->m_U - Ptr->m_PrevU) << (24 - ID_SCALE_BITS);
+        Dy = (_iq24)(pSample->m_Y - Ptr->m_PrevY) << (24 - ID_SCALE_BITS);
+        Ptr->m_PrevU = pSample->m_U;
+        Ptr->m_PrevY = pSample->m_Y;
+
+        Tail = (Tail + 1) & ID_MASK;
+        Ptr->m_Tail = Tail;
+
+        if( ++Ptr->m_Valid >= ID_VALID )
+        {
+            Ptr->m_Valid = ID_VALID;
+            ID_rls( Ptr, Dy );
+            if( ++Ptr->m_Count >= Ptr->m_Target && Ptr->m_State == ID_RUN )
+            {
+                Ptr->m_State = ID_STOP;
+            }
+        }
+
+        /* shift the regressor, phi = [-dy(k-1) -dy(k-2) du(k-1) du(k-2)] */
+        Ptr->m_Phi[1] = Ptr->m_Phi[0];
+        Ptr->m_Phi[0] = -Dy;
+        Ptr->m_Phi[3] = Ptr->m_Phi[2];
+        Ptr->m_Phi[2] = Du;
+    }
+
+    return Ptr->m_Count >= Ptr->m_Target && Ptr->m_State == ID_IDLE;
+}
@@ -0,0 +1,162 @@
+/*******************************************************************************
+* FILE          : ident.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* On-target identification of the power stage by recursive least squares.
+*
+* While identification runs, a pseudo random binary sequence (PRBS) of +/-m_Amp
+* ADC counts is added to the 2p2z reference and the control ISR appends the
+* controller output u (DAC counts) and the feedback y (ADC counts) of every
+* cycle to a lock-free ring buffer. The idle loop empties the buffer and runs a
+* fixed point RLS estimator on the differenced samples to fit the second order
+* model
+*
+*   dy(k) = -a1.dy(k-1) - a2.dy(k-2) + b1.du(k-1) + b2.du(k-2)
+*
+* i.e. G(z) = (b1.z^-1 + b2.z^-2) / (1 + a1.z^-1 + a2.z^-2) from the DAC demand
+* to the sampled output voltage. Differencing removes the operating point so no
+* offset has to be estimated. The result is in m_Theta[] and can be given to
+* tools/ident_design.c to calculate new 2p2z coefficients.
+*
+* The buffer has one writer, the ISR, which only moves m_Head, and one reader,
+* the idle loop, which only moves m_Tail. Both are 16 bit so they are read and
+* written atomically and no interrupt has to be disabled. The RLS update is
+* slower than the sample rate, so when the buffer is full the ISR drops samples
+* until the idle loop has emptied it and marks the first one it stores again;
+* the estimator then restarts its regressor from that sample. Cost in the ISR:
+*
+*   ID_excite()     ~10 cycles  (~4 when identification is not running)
+*   ID_push()       ~20 cycles
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+* ID_process() takes roughly 15us per sample and only runs in the idle loop,
+* so a 4000 sample run completes in well under a second.
+*
+* The PRBS amplitude is a compromise. The ADC noise enters the regressor and
+* biases a least squares fit, so small amplitudes give a model that is wrong at
+* low frequency; in simulation +/-32 counts (about 1.5% of Vo) was needed for
+* estimates within 5% with 1 count rms of noise.
+*
+* Start identification only after the soft-start has finished, as the
+* reference is held at its value at ID_start() until the run is complete.
+*
+* EXAMPLES
+*   ID_Data MyId;
+*
+*   interrupt void IsrAdc( void )
+*   {
+*       MyCntrl.Ref.m_Int = ID_excite( &MyId, MyCntrl.Ref.m_Int );
+*       MyCntrl.Fdbk.m_Int = ADC_getValue( ADC_MOD_1 );
+*       CNTRL_2p2z( &MyCntrl );
+*       CMP_setDac( CMP_MOD_2, MyCntrl.Out.m_Int );
+*       ID_push( &MyId, MyCntrl.Out.m_Int, MyCntrl.Fdbk.m_Int );
+*   }
+*
+*   ID_init( &MyId, 32, 2, 4000 );
+*   ID_start( &MyId, MyCntrl.Ref.m_Int );
+*   while( 1 )
+*   {
+*       ID_process( &MyId, 4 );
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _IDENT_H
+#define _IDENT_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  ID_Sample       ID_Sample;
+typedef struct  ID_Data         ID_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+/* Ring buffer size in samples, must be a power of two */
+#ifndef ID_BUF_SIZE
+#define ID_BUF_SIZE     128
+#endif
+
+#define ID_PARAMS       4       /* a1, a2, b1, b2 */
+
+/*******************************************************************************
+* ENUM          : ID_State
+* DESCRIPTION   :
+* ID_RUN and ID_STOP are set by the idle loop, ID_IDLE by the ISR.
+*******************************************************************************/
+typedef enum
+{
+    ID_IDLE = 0,    /* reference is not touched */
+    ID_RUN,         /* exciting and recording */
+    ID_STOP         /* ISR restores the reference and goes to ID_IDLE */
+} ID_State;
+
+/*******************************************************************************
+* STRUCT        : ID_Sample
+* DESCRIPTION   :
+* One recorded control cycle. m_Gap is set if samples were dropped before it.
+*******************************************************************************/
+struct ID_Sample
+{
+    int         m_U;
+    int         m_Y;
+    int         m_Gap;
+};
+
+/*******************************************************************************
+* STRUCT        : ID_Data
+* DESCRIPTION   :
+* The identification structure. m_Theta[] holds a1, a2, b1 and b2 in _iq24 and
+* is updated by ID_process().
+*******************************************************************************/
+struct ID_Data
+{
+    /* shared between the ISR and the idle loop */
+    volatile int        m_State;
+    volatile uint16_t   m_Head;
+    volatile uint16_t   m_Tail;
+    ID_Sample           m_Buf[ID_BUF_SIZE];
+
+    /* ISR side */
+    int                 m_RefNom;
+    int                 m_Amp;
+    int                 m_Hold;
+    int                 m_HoldCount;
+    uint16_t            m_Lfsr;
+    int                 m_Gap;
+    uint16_t            m_Dropped;
+
+    /* idle loop side */
+    _iq24               m_Theta[ID_PARAMS];
+    _iq20               m_P[ID_PARAMS][ID_PARAMS];
+    _iq24               m_Phi[ID_PARAMS];
+    int                 m_PrevU;
+    int                 m_PrevY;
+    int                 m_Valid;    /* samples since the last gap */
+    uint32_t            m_Count;    /* samples used */
+    uint32_t            m_Target;   /* samples to use before stopping */
+};
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void ID_init( ID_Data* Ptr, int Amp, int Hold, uint32_t Samples );
+extern void ID_start( ID_Data* Ptr, int RefNom );
+extern int  ID_excite( ID_Data* Ptr, int Ref );
+extern void ID_push( ID_Data* Ptr, int U, int Y );
+extern int  ID_process( ID_Data* Ptr, int MaxSamples );
+
+/*******************************************************************************
+* MACRO         : ID_isDone
+* DESCRIPTION   :
+* True when no identification is running and the reference has been restored.
+*******************************************************************************/
+#define ID_isDone( Ptr )    ((Ptr)->m_State == ID_IDLE)
+
+/********** END ***************************************************************/
+#endif
@@ -0,0 +1,116 @@
+/******************************************************************************
+* FILE          : load.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* CPU load meter. See load.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "load.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+static int LOAD_ratio( uint32_t Ticks, uint32_t Div );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : LOAD_init
+* DESCRIPTION   :
+* Tim is the time base, counting SYSCLKOUT freely down, Window the ticks per
+* result, e.g. SYS_CLK_HZ for a second, and IsrExtra the ticks the ISR takes
+* outside LOAD_enter() and LOAD_exit().
+******************************************************************************/
+void LOAD_init( LOAD_Data* Ptr, TIM_Module Tim, uint32_t Window,
+                uint16_t IsrExtra )
+{
+    uint32_t Now = ~Tim->TIM.all;
+
+    Ptr->m_Tim      = Tim;
+    Ptr->m_IsrExtra = IsrExtra;
+    Ptr->m_Window   = Window;
+    Ptr->m_Start    = Now;
+    Ptr->m_Last     = Now;
+    Ptr->m_MinPass  = 0xFFFFFFFF;
+    Ptr->m_Busy     = 0;
+    Ptr->m_Count    = 0;
+    Ptr->m_IsrStart = Ptr->m_IsrTicks;
+    Ptr->m_Settled  = false;
+    Ptr->m_Load     = 0;
+    Ptr->m_Peak     = 0;
+    Ptr->m_IsrShare = 0;
+    Ptr->m_Passes   = 0;
+}
+
+
+/******************************************************************************
+* FUNCTION      : LOAD_process
+* DESCRIPTION   :
+* Call once per idle loop pass. Adds the time of the pass over the baseline
+* to the load and publishes the results once a window.
+******************************************************************************/
+void LOAD_process( LOAD_Data* Ptr )
+{
+    uint32_t Now  = ~Ptr->m_Tim->TIM.all;
+    uint32_t Pass = Now - Ptr->m_Last;
+    uint32_t Elapsed;
+    uint32_t Div;
+    uint32_t Isr;
+    int      Load;
+
+    Ptr->m_Last = Now;
+    if( Pass < Ptr->m_MinPass )
+    {
+        Ptr->m_MinPass = Pass;
+    }
+    Ptr->m_Busy += Pass - Ptr->m_MinPass;
+    Ptr->m_Count++;
+
+    Elapsed = Now - Ptr->m_Start;
+    if( Elapsed < Ptr->m_Window )
+    {
+        return;
+    }
+
+    /* A 32 bit read, LOAD_exit() cannot split it */
+    Isr = Ptr->m_IsrTicks;
+
+    if( Ptr->m_Settled )
+    {
+        Div  = Elapsed / LOAD_FULL;
+        Load = LOAD_ratio( Ptr->m_Busy, Div );
+
+        Ptr->m_Load     = Load;
+        Ptr->m_IsrShare = LOAD_ratio( Isr - Ptr->m_IsrStart, Div );
+        Ptr->m_Passes   = Ptr->m_Count;
+        if( Load > Ptr->m_Peak )
+        {
+            Ptr->m_Peak = Load;
+        }
+    }
+    Ptr->m_Settled  = true;
+    Ptr->m_Start    = Now;
+    Ptr->m_Busy     = 0;
+    Ptr->m_Count    = 0;
+    Ptr->m_IsrStart = Isr;
+}
+
+
+/******************************************************************************
+* FUNCTION      : LOAD_ratio
+* DESCRIPTION   :
+* Ticks / Div, at most LOAD_FULL.
+******************************************************************************/
+static int LOAD_ratio( uint32_t Ticks, uint32_t Div )
+{
+    uint32_t Ratio = Div ? Ticks / Div : 0;
+
+    return Ratio > LOAD_FULL ? LOAD_FULL : (int)Ratio;
+}
@@ -0,0 +1,121 @@
+/*******************************************************************************
+* FILE          : load.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* CPU load meter: the share of the CPU left to the idle loop and the share
+* taken by the control ISR, per second.
+*
+* Both come from a CPU timer counting SYSCLKOUT freely down from 0xFFFFFFFF,
+* set up by the caller:
+*
+*   load        LOAD_process() is called once per idle loop pass and reads
+*               the timer. A pass that nothing interrupted and that did no
+*               work is the shortest, m_MinPass, the no-load baseline; it is
+*               calibrated by the meter itself as the shortest pass seen.
+*               Anything a pass takes on top of it is load: the interrupts
+*               that came in and the idle work done, e.g. the shell.
+*   ISR share   LOAD_enter() and LOAD_exit() stamp the start and the end of
+*               the control ISR and add up the time between. The entry,
+*               prologue and epilogue of the ISR are outside the stamps and
+*               are added as m_IsrExtra ticks per run.
+*
+* Once a second, m_Window ticks, LOAD_process() publishes the load and the
+* ISR share of the last second in LOAD_FULL units, 0.01%, keeps the highest
+* load in m_Peak and the number of idle loop passes in m_Passes. The first
+* second is dropped, while m_MinPass settles. m_Peak can be cleared by
+* writing 0 to it. The load includes the meter's own stamps, about 11 cycles
+* per control cycle, and the time left is LOAD_FULL - m_Load.
+*
+*   LOAD_enter()    ~5 cycles       at the start of the control ISR
+*   LOAD_exit()     ~6 cycles       at its end
+*   LOAD_process()  ~25 cycles      in the idle loop, ~300 once a second
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+*
+* EXAMPLES
+*   LOAD_Data MyLoad;
+*
+*   TIM_config( TIM_MOD_3, 0xFFFFFFFF, 1 );             // SYSCLKOUT
+*   LOAD_init( &MyLoad, TIM_MOD_3, 60000000L, 41 );     // 1s, 41 cycles
+*
+*   interrupt void IsrAdc( void )
+*   {
+*       LOAD_enter( &MyLoad );
+*       ...
+*       LOAD_exit( &MyLoad );
+*   }
+*
+*   while(1)
+*   {
+*       LOAD_process( &MyLoad );
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _LOAD_H
+#define _LOAD_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  LOAD_Data       LOAD_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+#define LOAD_FULL       10000   /* 100.00% */
+
+/*******************************************************************************
+* STRUCT        : LOAD_Data
+* DESCRIPTION   :
+* The load meter structure.
+*******************************************************************************/
+struct LOAD_Data
+{
+    /* written every cycle by LOAD_enter() and LOAD_exit() */
+    TIM_Module          m_Tim;
+    uint32_t            m_IsrExtra;     /* ticks per run outside the stamps */
+    uint32_t            m_Enter;        /* timer at the start, + m_IsrExtra */
+    volatile uint32_t   m_IsrTicks;     /* ticks in the ISR, running total */
+
+    uint32_t            m_Window;       /* ticks per result */
+    uint32_t            m_Start;        /* time the window started */
+    uint32_t            m_Last;         /* time of the last pass */
+    uint32_t            m_MinPass;      /* shortest pass, the baseline */
+    uint32_t            m_Busy;         /* ticks on top of the baseline */
+    uint32_t            m_Count;        /* passes in the window */
+    uint32_t            m_IsrStart;     /* m_IsrTicks at the window start */
+    int                 m_Settled;      /* the first window is over */
+
+    /* results, LOAD_FULL units, once a window */
+    volatile int        m_Load;
+    volatile int        m_Peak;
+    volatile int        m_IsrShare;
+    volatile uint32_t   m_Passes;       /* idle loop passes in the window */
+};
+
+
+/*******************************************************************************
+* MACRO         : LOAD_enter, LOAD_exit
+* DESCRIPTION   :
+* Stamp the start and the end of the control ISR. The timer counts down.
+*******************************************************************************/
+#define LOAD_enter( Ptr )                                                   \
+    ((Ptr)->m_Enter = (Ptr)->m_Tim->TIM.all + (Ptr)->m_IsrExtra)
+
+#define LOAD_exit( Ptr )                                                    \
+    ((Ptr)->m_IsrTicks += (Ptr)->m_Enter - (Ptr)->m_Tim->TIM.all)
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void LOAD_init( LOAD_Data* Ptr, TIM_Module Tim, uint32_t Window,
+                       uint16_t IsrExtra );
+extern void LOAD_process( LOAD_Data* Ptr );
+
+/********** END ***************************************************************/
+#endif
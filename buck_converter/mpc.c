@@ -0,0 +1,103 @@
+/******************************************************************************
+* FILE          : mpc.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Fixed depth region search and law evaluation for the explicit MPC. See
+* mpc.h for the timing and tools/mpc_gen.c for how the tables are generated.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "mpc.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#pragma CODE_SECTION( MPC_run, "hotfuncs" );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : MPC_init
+* DESCRIPTION   :
+* Initialises the controller. Uff is the starting feed-forward duty in ticks,
+* normally Vo/Vin of the period, and Ki is the per-cycle integral trim that
+* removes the steady state offset caused by losses.
+******************************************************************************/
+void MPC_init( MPC_Data* Ptr, const MPC_Table* Table, int Ref,
+               uint16_t Min, uint16_t Max, uint16_t Uff, _iq16 Ki )
+{
+    Ptr->Ref.m_Int  = Ref;
+    Ptr->Fdbk.m_Int = 0;
+    Ptr->Out.m_Int  = Min;
+    Ptr->m_Prev     = 0;
+    Ptr->m_Uff      = (_iq16)Uff << 16;
+    Ptr->m_Uff0     = Ptr->m_Uff;
+    Ptr->m_Ki       = Ki;
+    Ptr->m_Min      = (_iq16)Min << 16;
+    Ptr->m_Max      = (_iq16)Max << 16;
+    Ptr->m_pTable   = Table;
+}
+
+
+/******************************************************************************
+* FUNCTION      : MPC_run
+* DESCRIPTION   :
+* Runs one step of the explicit MPC.
+*
+* The loop always runs m_Depth times as the leaves point back to themselves,
+* so there is no early exit and the execution time does not depend on the
+* state. The child is selected by indexing rather than branching.
+******************************************************************************/
+void MPC_run( MPC_Data* Ptr )
+{
+    const MPC_Node* pNodes = Ptr->m_pTable->m_pNodes;
+    const MPC_Node* pNode;
+    const MPC_Law*  pLaw;
+    _iq16           X0, X1, U;
+    uint16_t        Idx = 0;
+    int             i;
+
+    X0 = (_iq16)(Ptr->Ref.m_Int - Ptr->Fdbk.m_Int) << 16;
+    X1 = (_iq16)(Ptr->Fdbk.m_Int - Ptr->m_Prev) << 16;
+    Ptr->m_Prev = Ptr->Fdbk.m_Int;
+
+    for( i = 0; i < Ptr->m_pTable->m_Depth; i++ )
+    {
+        pNode = &pNodes[Idx];
+        Idx = pNode->m_Child[ (_IQ24mpy( pNode->m_Hx, X0 )
+                             + _IQ24mpy( pNode->m_Hy, X1 )) > pNode->m_Hc ];
+    }
+    pLaw = &Ptr->m_pTable->m_pLaws[ pNodes[Idx].m_Law ];
+
+    /* Slow trim of the operating point, then the first move of the plan */
+    Ptr->m_Uff += Ptr->m_Ki * (Ptr->Ref.m_Int - Ptr->Fdbk.m_Int);
+    Ptr->m_Uff  = _IQsat( Ptr->m_Uff, Ptr->m_Max, Ptr->m_Min );
+
+    U = Ptr->m_Uff + pLaw->m_G
+      + _IQ24mpy( pLaw->m_Fx, X0 ) + _IQ24mpy( pLaw->m_Fy, X1 );
+    U = _IQsat( U, Ptr->m_Max, Ptr->m_Min );
+
+    Ptr->Out.m_Int = (int)(U >> 16);
+}
+
+
+/******************************************************************************
+* FUNCTION      : MPC_reset
+* DESCRIPTION   :
+* Puts the controller back to the state MPC_init() left it in. While the ePWM
+* is tripped the trim integrates the full error and m_Uff winds up to m_Max, so
+* this is called before the ePWM is let go again. The previous feedback is
+* taken from the present one so that the first step sees no rate of change.
+******************************************************************************/
+void MPC_reset( MPC_Data* Ptr )
+{
+    Ptr->Out.m_Int = (int)(Ptr->m_Min >> 16);
+    Ptr->m_Prev    = Ptr->Fdbk.m_Int;
+    Ptr->m_Uff     = Ptr->m_Uff0;
+}
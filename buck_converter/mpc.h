@@ -0,0 +1,132 @@
+/*******************************************************************************
+* FILE          : mpc.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Explicit model predictive controller (MPC) for voltage mode operation.
+*
+* The constrained MPC problem is solved offline by tools/mpc_gen.c which emits
+* mpc_table.c: a binary search tree over the critical regions of the solution
+* and the affine first-move law of each region. At run time MPC_run() walks the
+* tree for a fixed number of levels and evaluates one affine law. There is no
+* data dependent branch: the search always runs m_Depth levels, the child is
+* picked by indexing and the saturations are MINL and MAXL, so every sample
+* takes the same time and that time is the worst case.
+*
+*   search    MPC_Table.m_Depth levels x 14 cycles
+*   law + sat 38 cycles
+*
+* With the default table (depth 5) that is 108 cycles, 1.8us at 60MHz,
+* counted from the instruction sequence, see doc/timing.txt. The count is also
+* stored in MpcTable.m_Cycles. Build the example with ISR_BENCH to measure it:
+* MpcTicksMax holds the longest MPC_run() seen, in CPU cycles.
+*
+* The tables are placed in the "mpcTable" section which the linker command
+* file maps to RAM.
+*
+* EXAMPLES
+*   MPC_Data MyMpc;
+*
+*   MPC_init( &MyMpc, &MpcTable, 2048, 0, PWM_nsToTicks(PERIOD_NS)*0.6,
+*             PWM_nsToTicks(PERIOD_NS)*0.275, _IQ16(0.002) );
+*
+*   interrupt void IsrAdc( void )
+*   {
+*       MyMpc.Fdbk.m_Int = ADC_getValue( ADC_MOD_1 );
+*       MPC_run( &MyMpc );
+*       PWM_setDutyA( PWM_MOD_1, MyMpc.Out.m_Int );
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _MPC_H
+#define _MPC_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  MPC_Node        MPC_Node;
+typedef struct  MPC_Law         MPC_Law;
+typedef struct  MPC_Table       MPC_Table;
+typedef struct  MPC_Data        MPC_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+/*******************************************************************************
+* STRUCT        : MPC_Node
+* DESCRIPTION   :
+* One node of the region search tree. The state goes to m_Child[1] when
+* m_Hx*x0 + m_Hy*x1 > m_Hc and to m_Child[0] otherwise. Leaves point to
+* themselves and hold the index of their law.
+*******************************************************************************/
+struct MPC_Node
+{
+    _iq24       m_Hx;
+    _iq24       m_Hy;
+    _iq16       m_Hc;
+    uint16_t    m_Child[2];
+    uint16_t    m_Law;
+};
+
+/*******************************************************************************
+* STRUCT        : MPC_Law
+* DESCRIPTION   :
+* Affine first-move law u = m_Fx*x0 + m_Fy*x1 + m_G in PWM ticks.
+*******************************************************************************/
+struct MPC_Law
+{
+    _iq24       m_Fx;
+    _iq24       m_Fy;
+    _iq16       m_G;
+};
+
+/*******************************************************************************
+* STRUCT        : MPC_Table
+* DESCRIPTION   :
+* A generated explicit MPC solution.
+*******************************************************************************/
+struct MPC_Table
+{
+    const MPC_Node* m_pNodes;
+    const MPC_Law*  m_pLaws;
+    int             m_Depth;    /* fixed number of search levels */
+    int             m_Cycles;   /* counted cycles of MPC_run */
+};
+
+/*******************************************************************************
+* STRUCT        : MPC_Data
+* DESCRIPTION   :
+* The explicit MPC controller structure. Ref and Fdbk are in ADC counts, in the
+* same way as CNTRL_2p2zData, and Out is the PWM duty in ticks.
+*******************************************************************************/
+struct MPC_Data
+{
+    CNTRL_ARG           Ref;
+    CNTRL_ARG           Fdbk;
+    CNTRL_ARG           Out;
+    int                 m_Prev;     /* previous feedback */
+    _iq16               m_Uff;      /* feed-forward duty, ticks */
+    _iq16               m_Uff0;     /* starting feed-forward duty */
+    _iq16               m_Ki;       /* feed-forward trim per count of error */
+    _iq16               m_Min;
+    _iq16               m_Max;
+    const MPC_Table*    m_pTable;
+};
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void MPC_init( MPC_Data* Ptr, const MPC_Table* Table, int Ref,
+                      uint16_t Min, uint16_t Max, uint16_t Uff, _iq16 Ki );
+extern void MPC_run( MPC_Data* Ptr );
+extern void MPC_reset( MPC_Data* Ptr );
+
+/********** CLASS SECTION *****************************************************/
+extern const MPC_Table MpcTable;
+
+/********** END ***************************************************************/
+#endif
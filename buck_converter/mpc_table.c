@@ -0,0 +1,72 @@
+/*******************************************************************************
+* FILE          : mpc_table.c
+* AUTHOR        : Generated by tools/mpc_gen.c - do not edit
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Explicit MPC search tree and first-move laws for the voltage mode buck.
+*
+*   L = 3.3e-05 H, C = 0.0001 F, R = 3.3 Ohm, Vin = 12 V, Vref = 3.3 V, fs = 200000 Hz
+*   N = 3, Qe = 1, Qi = 0.05, R = 0.02, duty max = 0.6
+*
+*   regions = 19, laws = 7, nodes = 31, depth = 5
+*   worst-case search = 108 cycles
+*******************************************************************************/
+
+#include "csl.h"
+#include "mpc.h"
+
+#pragma DATA_SECTION( MpcNodes, "mpcTable" );
+static const MPC_Node MpcNodes[31] =
+{
+    {   -14667007,   -16777216,     6015668, {    1,   20 },   0 },
+    {     9027454,   -16777216,     1118680, {    2,   13 },   0 },
+    {    14667007,    16777216,     5090181, {    3,    6 },   0 },
+    {    -9027454,    16777216,      946576, {    4,    5 },   0 },
+    {           0,           0,           0, {    4,    4 },   0 },
+    {           0,           0,           0, {    5,    5 },   1 },
+    {    16777216,     2808599,     7445532, {    7,   10 },   0 },
+    {    -7181331,    16777216,     1269419, {    8,    9 },   0 },
+    {           0,           0,           0, {    8,    8 },   3 },
+    {           0,           0,           0, {    9,    9 },   1 },
+    {    -6818284,    16777216,     1415471, {   11,   12 },   0 },
+    {           0,           0,           0, {   11,   11 },   5 },
+    {           0,           0,           0, {   12,   12 },   1 },
+    {     7181331,   -16777216,      634925, {   14,   17 },   0 },
+    {    16777216,     2808599,     7445532, {   15,   16 },   0 },
+    {           0,           0,           0, {   15,   15 },   3 },
+    {           0,           0,           0, {   16,   16 },   5 },
+    {     6818284,   -16777216,      482436, {   18,   19 },   0 },
+    {           0,           0,           0, {   18,   18 },   5 },
+    {           0,           0,           0, {   19,   19 },   2 },
+    {    -7181331,    16777216,      404122, {   21,   28 },   0 },
+    {   -16777216,    -2808599,     8799265, {   22,   25 },   0 },
+    {     7181331,   -16777216,     1500223, {   23,   24 },   0 },
+    {           0,           0,           0, {   23,   23 },   4 },
+    {           0,           0,           0, {   24,   24 },   2 },
+    {     6818284,   -16777216,     1672830, {   26,   27 },   0 },
+    {           0,           0,           0, {   26,   26 },   6 },
+    {           0,           0,           0, {   27,   27 },   2 },
+    {    -6818284,    16777216,      225078, {   29,   30 },   0 },
+    {           0,           0,           0, {   29,   29 },   6 },
+    {           0,           0,           0, {   30,   30 },   1 },
+};
+
+#pragma DATA_SECTION( MpcLaws, "mpcTable" );
+static const MPC_Law MpcLaws[7] =
+{
+    {    51563665,   -95829313,           0 },
+    {           0,           0,    -5406720 },
+    {           0,           0,     6389760 },
+    {    44484822,  -103926621,     2456710 },
+    {    44484822,  -103926621,    -2903385 },
+    {    42379181,  -104279117,     3391169 },
+    {    42379181,  -104279117,    -4007746 },
+};
+
+const MPC_Table MpcTable =
+{
+    MpcNodes,
+    MpcLaws,
+    5,
+    108
+};
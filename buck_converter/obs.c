@@ -0,0 +1,71 @@
+/******************************************************************************
+* FILE          : obs.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Luenberger observer for the inductor and load current. See obs.h for the
+* model and tools/obs_sim.c for the design of the gains.
+*
+* Only IQmath is used so this file can also be built into the host simulation.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "IQmathLib.h"
+#include "csl_stdint.h"
+#include "obs.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#pragma CODE_SECTION( OBS_update, "hotfuncs" );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : OBS_init
+* DESCRIPTION   :
+* Initialises the observer with its constants. Offset is in DAC counts and Vo
+* is the output voltage at start up in ADC counts. The current estimates start
+* at zero.
+******************************************************************************/
+void OBS_init( OBS_Data* Ptr, _iq24 Kv, _iq24 A, _iq24 L1, _iq24 L2,
+               _iq24 L3, int Offset, int Vo )
+{
+    Ptr->m_V      = (_iq16)Vo << 16;
+    Ptr->m_IL     = 0;
+    Ptr->m_IO     = 0;
+    Ptr->m_Offset = (_iq16)Offset << 16;
+    Ptr->m_Kv     = Kv;
+    Ptr->m_A      = A;
+    Ptr->m_L1     = L1;
+    Ptr->m_L2     = L2;
+    Ptr->m_L3     = L3;
+}
+
+
+/******************************************************************************
+* FUNCTION      : OBS_update
+* DESCRIPTION   :
+* Runs one step of the observer. Vo is the output voltage sampled this cycle
+* and Dac is the peak current demand that applies from the next cycle.
+*
+* All the right hand sides use the previous estimates, so this is the standard
+* prediction form x(k+1) = A.x(k) + B.u(k) + L.(y(k) - v(k)).
+******************************************************************************/
+void OBS_update( OBS_Data* Ptr, int Vo, int Dac )
+{
+    _iq16 E, IL, IO;
+
+    E  = ((_iq16)Vo << 16) - Ptr->m_V;
+    IL = Ptr->m_IL;
+    IO = Ptr->m_IO;
+
+    Ptr->m_V  += _IQ24mpy( Ptr->m_Kv, IL - IO ) + _IQ24mpy( Ptr->m_L1, E );
+    Ptr->m_IL += _IQ24mpy( Ptr->m_A, ((_iq16)Dac << 16) - Ptr->m_Offset - IL )
+               + _IQ24mpy( Ptr->m_L2, E );
+    Ptr->m_IO += _IQ24mpy( Ptr->m_L3, E );
+}
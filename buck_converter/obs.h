@@ -0,0 +1,115 @@
+/*******************************************************************************
+* FILE          : obs.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Fixed point Luenberger observer for the buck power stage.
+*
+* The observer estimates the average inductor current and the load current from
+* the sampled output voltage and the peak current demand written to the
+* comparator DAC. No current sensor is needed beyond the one used by the peak
+* current loop. The model, updated once per switching cycle, is
+*
+*   v(k+1)  = v(k) + Kv*(iL(k) - io(k))
+*   iL(k+1) = iL(k) + A*(u(k) - Offset - iL(k))
+*   io(k+1) = io(k)
+*
+* where v is in ADC counts and the currents and the demand u are in comparator
+* DAC counts. Kv = Ts*Kadc/(C*Kdac) folds the output capacitor and both sensor
+* gains into one constant, A models the lag of the peak current loop and Offset
+* is the difference between the peak demand and the average inductor current,
+* i.e. the slope compensation at turn off plus half the current ripple. Each
+* state is corrected by the voltage error through the gains L1..L3.
+*
+* All the constants are calculated by tools/obs_sim.c from the power stage
+* values and the wanted observer poles. The same tool runs OBS_update() against
+* a switching model of the converter and reports the accuracy of the estimates.
+*
+* OBS_update() is 5 IQ multiplies and runs on the main CPU after the new demand
+* has been written to the DAC, so it does not delay the control path. The CLA is
+* not used as the slope compensation task occupies it for most of the period.
+*
+*   OBS_update()    ~55 cycles  .92us at 60MHz
+*
+* This is counted from the instruction sequence, see doc/timing.txt.
+*
+* EXAMPLES
+*   OBS_Data MyObs;
+*
+*   OBS_init( &MyObs, _IQ24(OBS_KV), _IQ24(OBS_A), _IQ24(OBS_L1),
+*             _IQ24(OBS_L2), _IQ24(OBS_L3), OBS_OFFSET, 0 );
+*
+*   interrupt void IsrAdc( void )
+*   {
+*       ...
+*       CMP_setDac( CMP_MOD_2, MyCntrl.Out.m_Int );
+*       OBS_update( &MyObs, MyCntrl.Fdbk.m_Int, MyCntrl.Out.m_Int );
+*   }
+*
+*   Load = OBS_getIo( &MyObs );     // load current in DAC counts
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _OBS_H
+#define _OBS_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  OBS_Data        OBS_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+/*******************************************************************************
+* STRUCT        : OBS_Data
+* DESCRIPTION   :
+* The observer structure. The estimates are _iq16 so that the fractional part
+* is kept between cycles; use the OBS_get macros to read them as integers.
+*******************************************************************************/
+struct OBS_Data
+{
+    _iq16       m_V;        /* estimated output voltage, ADC counts */
+    _iq16       m_IL;       /* estimated average inductor current, DAC counts */
+    _iq16       m_IO;       /* estimated load current, DAC counts */
+    _iq16       m_Offset;   /* peak demand to average current, DAC counts */
+    _iq24       m_Kv;
+    _iq24       m_A;
+    _iq24       m_L1;
+    _iq24       m_L2;
+    _iq24       m_L3;
+};
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void OBS_init( OBS_Data* Ptr, _iq24 Kv, _iq24 A, _iq24 L1, _iq24 L2,
+                      _iq24 L3, int Offset, int Vo );
+extern void OBS_update( OBS_Data* Ptr, int Vo, int Dac );
+
+/*******************************************************************************
+* MACRO         : OBS_getIL
+* DESCRIPTION   :
+* Returns the estimated average inductor current in DAC counts.
+*******************************************************************************/
+#define OBS_getIL( Ptr )    ((int)((Ptr)->m_IL >> 16))
+
+/*******************************************************************************
+* MACRO         : OBS_getIo
+* DESCRIPTION   :
+* Returns the estimated load current in DAC counts.
+*******************************************************************************/
+#define OBS_getIo( Ptr )    ((int)((Ptr)->m_IO >> 16))
+
+/*******************************************************************************
+* MACRO         : OBS_getV
+* DESCRIPTION   :
+* Returns the filtered output voltage estimate in ADC counts.
+*******************************************************************************/
+#define OBS_getV( Ptr )     ((int)((Ptr)->m_V >> 16))
+
+/********** END ***************************************************************/
+#endif
@@ -0,0 +1,372 @@
+/******************************************************************************
+* FILE          : pmbus.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* PMBus style I2C slave. See pmbus.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "pmbus.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#pragma CODE_SECTION( PMB_event, "hotfuncs" );
+#pragma CODE_SECTION( PMB_reply, "hotfuncs" );
+#pragma CODE_SECTION( PMB_execute, "hotfuncs" );
+#pragma CODE_SECTION( PMB_setVout, "hotfuncs" );
+#pragma CODE_SECTION( PMB_setOn, "hotfuncs" );
+#pragma CODE_SECTION( PMB_update, "hotfuncs" );
+
+/* I2CIER bits */
+#define PMB_IER_RRDY        0x0008
+#define PMB_IER_XRDY        0x0010
+#define PMB_IER_SCD         0x0020
+#define PMB_IER_AAS         0x0040
+
+/* I2CISRC interrupt codes */
+#define PMB_INT_RRDY        4
+#define PMB_INT_XRDY        5
+#define PMB_INT_SCD         6
+#define PMB_INT_AAS         7
+
+/* Events handled per call, so the time in the I2C interrupt is bounded */
+#define PMB_MAX_EVENTS      4
+
+#define PMB_VOUT_DIRECT     0x40
+
+static void PMB_reply( PMB_Data* Ptr );
+static void PMB_execute( PMB_Data* Ptr );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : PMB_init
+* DESCRIPTION   :
+* Puts the I2C module in slave mode at the 7 bit Address with the FIFOs off
+* and the slave interrupts on. Call it after I2C_config(), which sets up the
+* pins and the module clock. Vout points to the feedback sample returned by
+* READ_VOUT. The output starts on at VoutNom. With I2c set to 0 the I2C is
+* not touched and only PMB_setVout() and PMB_setOn() change the output, e.g.
+* from the UART shell.
+******************************************************************************/
+void PMB_init( PMB_Data* Ptr, I2C_Module I2c, uint16_t Address,
+               const volatile int* Vout, int VoutNom, int VoutMin,
+               int VoutMax )
+{
+    Ptr->m_I2c      = I2c;
+    Ptr->m_State    = PMB_IDLE;
+    Ptr->m_pVout    = Vout;
+    Ptr->m_VoutNom  = VoutNom;
+    Ptr->m_VoutMin  = VoutMin;
+    Ptr->m_VoutMax  = VoutMax;
+    Ptr->m_PgWindow = PMB_PG_WINDOW;
+    Ptr->m_Status   = 0;
+    Ptr->m_Vout     = VoutNom;
+    Ptr->m_On       = true;
+    Ptr->m_Request  = false;
+    Ptr->m_pSet     = &Ptr->m_Vout;
+    Ptr->m_Dvs      = 0;
+    Ptr->m_SlewRate = 0;
+
+    if( !I2c )
+    {
+        return;
+    }
+
+    I2c->I2CMDR.all     = 0;    /* hold in reset */
+    I2c->I2COAR         = Address;
+    I2c->I2CFFTX.all    = 0;
+    I2c->I2CFFRX.all    = 0;
+    I2c->I2CIER.all     = PMB_IER_RRDY | PMB_IER_XRDY | PMB_IER_SCD |
+                          PMB_IER_AAS;
+    I2c->I2CSTR.all     = 0xFFFF;
+    I2c->I2CMDR.bit.FREE = 1;
+    I2c->I2CMDR.bit.IRS  = 1;   /* slave receiver, 8 bit data */
+}
+
+
+/******************************************************************************
+* FUNCTION      : PMB_event
+* DESCRIPTION   :
+* Called by the I2C interrupt. Handles up to PMB_MAX_EVENTS pending events.
+* The interrupt codes come in priority order, so a data byte can be seen
+* before the address match that started the transfer; the state machine
+* therefore works from the data and the stop condition and only uses the
+* address match to start a reply.
+******************************************************************************/
+void PMB_event( PMB_Data* Ptr )
+{
+    I2C_Module I2c = Ptr->m_I2c;
+    uint16_t   Byte;
+    int        n;
+
+    for( n = 0; n < PMB_MAX_EVENTS; n++ )
+    {
+        switch( I2c->I2CISRC.bit.INTCODE )
+        {
+        case PMB_INT_RRDY:
+            Byte = I2c->I2CDRR & 0xFF;
+            if( Ptr->m_State != PMB_RX )
+            {
+                Ptr->m_Cmd     = Byte;
+                Ptr->m_RxCount = 0;
+                Ptr->m_State   = PMB_RX;
+            }
+            else if( Ptr->m_RxCount < PMB_MAX_DATA )
+            {
+                Ptr->m_Rx[Ptr->m_RxCount++] = Byte;
+            }
+            else
+            {
+                Ptr->m_Status |= PMB_STATUS_CML;
+            }
+            break;
+
+        case PMB_INT_XRDY:
+            if( Ptr->m_State != PMB_TX )
+            {
+                PMB_reply( Ptr );
+            }
+            if( Ptr->m_TxIndex < Ptr->m_TxCount )
+            {
+                I2c->I2CDXR = Ptr->m_Tx[Ptr->m_TxIndex++];
+            }
+            else
+            {
+                I2c->I2CDXR = 0xFF;
+            }
+            break;
+
+        case PMB_INT_AAS:
+            if( I2c->I2CSTR.bit.SDIR && Ptr->m_State != PMB_TX )
+            {
+                PMB_reply( Ptr );
+            }
+            break;
+
+        case PMB_INT_SCD:
+            if( Ptr->m_State == PMB_RX )
+            {
+                PMB_execute( Ptr );
+            }
+            Ptr->m_State = PMB_IDLE;
+            break;
+
+        case 0:
+            return;
+
+        default:
+            break;
+        }
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : PMB_reply
+* DESCRIPTION   :
+* Prepares the reply to a read of m_Cmd.
+******************************************************************************/
+static void PMB_reply( PMB_Data* Ptr )
+{
+    uint16_t Word = 0;
+    int      Vout = *Ptr->m_pVout;
+    int      Status;
+
+    Ptr->m_State   = PMB_TX;
+    Ptr->m_TxIndex = 0;
+    Ptr->m_TxCount = 2;
+
+    Status = Ptr->m_Status;
+    if( !Ptr->m_On )
+    {
+        Status |= PMB_STATUS_OFF;
+    }
+
+    switch( Ptr->m_Cmd )
+    {
+    case PMB_OPERATION:
+        Word = Ptr->m_On ? 0x80 : 0x00;
+        Ptr->m_TxCount = 1;
+        break;
+
+    case PMB_VOUT_MODE:
+        Word = PMB_VOUT_DIRECT;
+        Ptr->m_TxCount = 1;
+        break;
+
+    case PMB_VOUT_COMMAND:
+        Word = Ptr->m_Vout;
+        break;
+
+    case PMB_STATUS_BYTE:
+        Word = Status;
+        Ptr->m_TxCount = 1;
+        break;
+
+    case PMB_STATUS_WORD:
+        Word = Status;
+        if( !Ptr->m_On || Vout > Ptr->m_Vout + Ptr->m_PgWindow ||
+                          Vout < Ptr->m_Vout - Ptr->m_PgWindow )
+        {
+            Word |= PMB_STATUS_PGOOD << 8;
+        }
+        break;
+
+    case PMB_READ_VOUT:
+        Word = Vout;
+        break;
+
+    default:
+        Ptr->m_Status |= PMB_STATUS_CML;
+        Ptr->m_TxCount = 0;
+        break;
+    }
+
+    Ptr->m_Tx[0] = Word & 0xFF;
+    Ptr->m_Tx[1] = Word >> 8;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PMB_execute
+* DESCRIPTION   :
+* Carries out a write of m_RxCount bytes to m_Cmd at the stop condition. A
+* command that only sets up a read ends with a repeated start, not a stop, so
+* it never gets here.
+******************************************************************************/
+static void PMB_execute( PMB_Data* Ptr )
+{
+    int Vout;
+
+    switch( Ptr->m_Cmd )
+    {
+    case PMB_OPERATION:
+        if( Ptr->m_RxCount != 1 )
+        {
+            break;
+        }
+        PMB_setOn( Ptr, (Ptr->m_Rx[0] & 0x80) != 0 );
+        return;
+
+    case PMB_CLEAR_FAULTS:
+        if( Ptr->m_RxCount != 0 )
+        {
+            break;
+        }
+        Ptr->m_Status = 0;
+        return;
+
+    case PMB_VOUT_COMMAND:
+        if( Ptr->m_RxCount != 2 )
+        {
+            break;
+        }
+        Vout = Ptr->m_Rx[0] | (Ptr->m_Rx[1] << 8);
+        if( !PMB_setVout( Ptr, Vout ) )
+        {
+            break;
+        }
+        return;
+
+    default:
+        break;
+    }
+    Ptr->m_Status |= PMB_STATUS_CML;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PMB_setVout
+* DESCRIPTION   :
+* Sets the output voltage in ADC counts, slewed to at m_SlewRate if a DVS is
+* attached, with its feed-forward while the output is on. Returns false, and
+* changes nothing, if Vout is outside [m_VoutMin, m_VoutMax] or the DVS does
+* not take the slew rate.
+******************************************************************************/
+int PMB_setVout( PMB_Data* Ptr, int Vout )
+{
+    if( Vout < Ptr->m_VoutMin || Vout > Ptr->m_VoutMax )
+    {
+        return false;
+    }
+    if( Ptr->m_Dvs &&
+        DVS_setTarget( Ptr->m_Dvs, Vout, Ptr->m_SlewRate, Ptr->m_On ) < 0 )
+    {
+        return false;
+    }
+    Ptr->m_Vout = Vout;
+    return true;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PMB_setSlew
+* DESCRIPTION   :
+* Attaches Dvs, which must be settled at VOUT_COMMAND, so that commands slew
+* at RatePerMs ADC counts per ms; PMB_setSlewRate() changes it later. The
+* reference is then taken from the slewed value of Dvs.
+******************************************************************************/
+void PMB_setSlew( PMB_Data* Ptr, DVS_Data* Dvs, int RatePerMs )
+{
+    Ptr->m_SlewRate = RatePerMs;
+    Ptr->m_Dvs      = Dvs;
+    Ptr->m_pSet     = &Dvs->m_Value;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PMB_setSlewRate
+* DESCRIPTION   :
+* Sets the rate that the following commands slew at, ADC counts per ms.
+* Returns false, and changes nothing, if RatePerMs is not above 0, which
+* DVS_setTarget() would refuse.
+******************************************************************************/
+int PMB_setSlewRate( PMB_Data* Ptr, int RatePerMs )
+{
+    if( RatePerMs <= 0 )
+    {
+        return false;
+    }
+    Ptr->m_SlewRate = RatePerMs;
+    return true;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PMB_setOn
+* DESCRIPTION   :
+* Turns the output on or off through the soft-start at the next control cycle.
+******************************************************************************/
+void PMB_setOn( PMB_Data* Ptr, int On )
+{
+    Ptr->m_On      = On;
+    Ptr->m_Request = true;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PMB_update
+* DESCRIPTION   :
+* Called by the control ISR after SOFT_update() and DVS_update(). Applies a
+* new OPERATION and writes the set point, VOUT_COMMAND or its slewed value,
+* times the level of the soft-start to its controller. Both are kept apart,
+* so the scaling never compounds, whether or not either is moving.
+******************************************************************************/
+void PMB_update( PMB_Data* Ptr, SOFT_Data* Soft )
+{
+    if( Ptr->m_Request )
+    {
+        Ptr->m_Request = false;
+        SOFT_direction( Soft, Ptr->m_On );
+    }
+
+    Soft->m_Cntrl->Ref.m_Int = (int)((Soft->m_Level * *Ptr->m_pSet) >> 15);
+}
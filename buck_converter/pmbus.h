@@ -0,0 +1,175 @@
+/*******************************************************************************
+* FILE          : pmbus.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Interrupt driven PMBus style command interface on the I2C module.
+*
+* The CSL only supports the I2C as a blocking master, so PMB_init() puts the
+* module in slave mode without FIFOs and PMB_event(), called from the I2C
+* interrupt, runs a small state machine on the interrupt source register. Each
+* call handles the events that are pending, a byte received or requested, the
+* address match or the stop condition, in a few tens of cycles and never waits
+* for the bus. The PMBus transactions used are
+*
+*   Write byte/word     S Addr+W Cmd Data... P
+*   Send byte           S Addr+W Cmd P
+*   Read byte/word      S Addr+W Cmd Sr Addr+R Data... P
+*
+* with words sent low byte first. Commands:
+*
+*   0x01 OPERATION      r/w byte   0x80 on, 0x00 off (soft-start up or down)
+*   0x03 CLEAR_FAULTS   send byte  clears PMB_STATUS_CML
+*   0x20 VOUT_MODE      read byte  0x40, direct format
+*   0x21 VOUT_COMMAND   r/w word   output voltage, ADC counts
+*   0x78 STATUS_BYTE    read byte  PMB_STATUS_...
+*   0x79 STATUS_WORD    read word  STATUS_BYTE, power not good in bit 11
+*   0x8B READ_VOUT      read word  last feedback sample, ADC counts
+*
+* This is PMBus-like rather than PMBus: voltages are raw ADC counts (VOUT_MODE
+* reports direct format, the host applies the divider and ADC scale), there is
+* no PEC and unknown commands or bad data only set PMB_STATUS_CML.
+*
+* Writes take effect at the stop condition. OPERATION and VOUT_COMMAND do not
+* touch the controller from the I2C interrupt; PMB_update() applies them in the
+* control ISR after SOFT_update(). The reference is the set point, m_pSet,
+* times the level of the soft-start, m_Level, so the soft-start ramps up and
+* down to the commanded voltage. The set point is VOUT_COMMAND itself, which a
+* new command steps, or with a DVS attached by PMB_setSlew() the value that
+* DVS_update() slews to it at m_SlewRate, see dvs.h. Cost:
+*
+*   PMB_update()    ~16 cycles   in the control ISR
+*   PMB_event()     ~60 cycles   per byte at 400kHz, outside the control ISR
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+* The I2C interrupt is in PIE group 8, which is above the ADC, so the I2C ISR
+* should allow IsrAdc to nest.
+*
+* EXAMPLES
+*   PMB_Data MyPmb;
+*
+*   interrupt void IsrI2c( void )
+*   {
+*       PMB_event( &MyPmb );
+*       INT_ackGroup( INT_GROUP_8 );
+*   }
+*
+*   I2C_config( I2C_MOD_1, 5, 10, 5 );
+*   PMB_init( &MyPmb, I2C_MOD_1, 0x40, &MyCntrl.Fdbk.m_Int, 2048, 1800, 2300 );
+*   INT_setCallback( INT_pieIdToVectorId( PMB_PIE_ID ), IsrI2c );
+*   INT_enablePieId( PMB_PIE_ID, true );
+*   DVS_init( &MyDvs, 2048, PERIOD_NS, 13 );
+*   PMB_setSlew( &MyPmb, &MyDvs, 1000 );           // 1000 counts per ms
+*
+*   interrupt void IsrAdc( void )
+*   {
+*       ...
+*       SOFT_update( &MySoft );
+*       DVS_update( &MyDvs );
+*       PMB_update( &MyPmb, &MySoft );
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _PMBUS_H
+#define _PMBUS_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+#include "soft.h"
+#include "dvs.h"
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  PMB_Data        PMB_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+/* I2CINT1A, PIE group 8, is not in INT_PieId */
+#define PMB_PIE_ID          ((INT_PieId)INT_GROUP_VAL( 8, 1 ))
+
+/* Command codes */
+#define PMB_OPERATION       0x01
+#define PMB_CLEAR_FAULTS    0x03
+#define PMB_VOUT_MODE       0x20
+#define PMB_VOUT_COMMAND    0x21
+#define PMB_STATUS_BYTE     0x78
+#define PMB_STATUS_WORD     0x79
+#define PMB_READ_VOUT       0x8B
+
+/* STATUS_BYTE bits */
+#define PMB_STATUS_OFF      0x40    /* output turned off by OPERATION */
+#define PMB_STATUS_CML      0x02    /* unknown command or bad data */
+
+/* STATUS_WORD high byte bits */
+#define PMB_STATUS_PGOOD    0x08    /* output not within m_PgWindow */
+
+#define PMB_MAX_DATA        2       /* bytes in the longest write */
+
+/* Power good window around VOUT_COMMAND, ADC counts */
+#ifndef PMB_PG_WINDOW
+#define PMB_PG_WINDOW       40
+#endif
+
+/*******************************************************************************
+* ENUM          : PMB_State
+* DESCRIPTION   :
+*******************************************************************************/
+typedef enum
+{
+    PMB_IDLE = 0,       /* next byte received is a command code */
+    PMB_RX,             /* receiving data for m_Cmd */
+    PMB_TX              /* sending the reply to m_Cmd */
+} PMB_State;
+
+/*******************************************************************************
+* STRUCT        : PMB_Data
+* DESCRIPTION   :
+* The PMBus slave structure.
+*******************************************************************************/
+struct PMB_Data
+{
+    /* I2C interrupt side */
+    I2C_Module          m_I2c;
+    int                 m_State;
+    uint16_t            m_Cmd;
+    uint16_t            m_Rx[PMB_MAX_DATA];
+    int                 m_RxCount;
+    uint16_t            m_Tx[PMB_MAX_DATA];
+    int                 m_TxCount;
+    int                 m_TxIndex;
+    const volatile int* m_pVout;
+    int                 m_VoutNom;
+    int                 m_VoutMin;
+    int                 m_VoutMax;
+    int                 m_PgWindow;
+    uint16_t            m_Status;
+
+    /* written by the I2C interrupt, applied by the control ISR */
+    volatile int        m_Vout;         /* VOUT_COMMAND */
+    volatile int        m_On;           /* OPERATION */
+    volatile int        m_Request;      /* m_On has changed */
+
+    /* set point, slewed by m_Dvs if not 0 */
+    const volatile int* m_pSet;         /* &m_Vout or &m_Dvs->m_Value */
+    DVS_Data*           m_Dvs;
+    int                 m_SlewRate;     /* ADC counts per ms */
+};
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void PMB_init( PMB_Data* Ptr, I2C_Module I2c, uint16_t Address,
+                      const volatile int* Vout, int VoutNom, int VoutMin,
+                      int VoutMax );
+extern void PMB_event( PMB_Data* Ptr );
+extern int  PMB_setVout( PMB_Data* Ptr, int Vout );
+extern void PMB_setOn( PMB_Data* Ptr, int On );
+extern void PMB_update( PMB_Data* Ptr, SOFT_Data* Soft );
+extern void PMB_setSlew( PMB_Data* Ptr, DVS_Data* Dvs, int RatePerMs );
+extern int  PMB_setSlewRate( PMB_Data* Ptr, int RatePerMs );
+
+/********** END ***************************************************************/
+#endif
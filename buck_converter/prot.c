@@ -0,0 +1,276 @@
+/******************************************************************************
+* FILE          : prot.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Debounced protection limits and fault log. See prot.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "prot.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#pragma CODE_SECTION( PROT_limit, "hotfuncs" );
+#pragma CODE_SECTION( PROT_trip, "hotfuncs" );
+#pragma CODE_SECTION( PROT_log, "hotfuncs" );
+#pragma CODE_SECTION( PROT_getTime, "hotfuncs" );
+
+/* Cause of a trip by each per cycle limit */
+static const int PROT_Cause[PROT_LIMITS] = { FLT_OVP, FLT_UVP, FLT_OVERLOAD };
+
+static void PROT_trip( PROT_Data* Ptr, int Cause, int Value );
+static void PROT_log( PROT_Data* Ptr, int Cause, int Value );
+static void PROT_setWindow( PROT_Data* Ptr, int Armed );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : PROT_init
+* DESCRIPTION   :
+* Starts with no limits and no inputs; trips go to the one-shot trip of Flt,
+* which must be initialised first. Tim is the free running time base and
+* Period the control period in its ticks, at least 2.
+******************************************************************************/
+void PROT_init( PROT_Data* Ptr, FLT_Data* Flt, TIM_Module Tim,
+                uint16_t Period )
+{
+    int i;
+
+    Ptr->m_Flt      = Flt;
+    Ptr->m_Tim      = Tim;
+    Ptr->m_GapMin   = Period - Period/2;
+    Ptr->m_GapSpan  = Period/2 + Period/2;
+    for( i = 0; i < PROT_LIMITS; i++ )
+    {
+        Ptr->m_Level[i]     = i == PROT_UV ? 0 : PROT_NO_LIMIT;
+        Ptr->m_Debounce[i]  = 1;
+        Ptr->m_Run[i]       = 0;
+        Ptr->m_Last[i]      = 0;
+    }
+    Ptr->m_IoMax    = PROT_NO_LIMIT;
+    Ptr->m_Inputs   = 0;
+    Ptr->m_FltCount = Flt->m_Count;
+    Ptr->m_Pending  = false;
+    Ptr->m_LogCount = 0;
+
+    PROT_setWindow( Ptr, false );
+}
+
+
+/******************************************************************************
+* FUNCTION      : PROT_setLimit
+* DESCRIPTION   :
+* Sets the level of a per cycle limit, in the units passed to PROT_check(),
+* and the number of consecutive cycles it must be exceeded for to trip, 1 for
+* the first. PROT_NO_LIMIT, or 0 for PROT_UV, turns the limit off. Can be
+* called while running.
+******************************************************************************/
+void PROT_setLimit( PROT_Data* Ptr, PROT_Limit Limit, int Level,
+                    uint16_t Debounce )
+{
+    uint16_t St = __disable_interrupts();
+
+    Ptr->m_Level[Limit]     = Level;
+    Ptr->m_Debounce[Limit]  = Debounce ? Debounce : 1;
+    Ptr->m_IoMax            = Ptr->m_Level[PROT_OC];
+    PROT_setWindow( Ptr, Ptr->m_Armed );
+
+    __restore_interrupts( St );
+}
+
+
+/******************************************************************************
+* FUNCTION      : PROT_addInput
+* DESCRIPTION   :
+* Adds an ADC result for PROT_process() to check against Min..Max and returns
+* its number, or -1 if there are already PROT_INPUTS. Outside the window for
+* Debounce timer ticks it trips with Cause.
+******************************************************************************/
+int PROT_addInput( PROT_Data* Ptr, const volatile uint16_t* pValue,
+                   int Min, int Max, uint32_t Debounce, FLT_Cause Cause )
+{
+    PROT_Input* pIn;
+
+    if( Ptr->m_Inputs == PROT_INPUTS )
+    {
+        return -1;
+    }
+    pIn = &Ptr->m_Input[Ptr->m_Inputs];
+    pIn->m_pValue   = pValue;
+    pIn->m_Min      = Min;
+    pIn->m_Max      = Max;
+    pIn->m_Debounce = Debounce;
+    pIn->m_Cause    = Cause;
+    pIn->m_Out      = false;
+    pIn->m_Since    = 0;
+    return Ptr->m_Inputs++;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PROT_limit
+* DESCRIPTION   :
+* Called by PROT_check() when a limit is exceeded. A run starts unless the
+* same limit was exceeded on the cycle before, a period ago give or take half
+* a period; the run trips once it is m_Debounce cycles long.
+******************************************************************************/
+void PROT_limit( PROT_Data* Ptr, PROT_Limit Limit, int Value )
+{
+    uint32_t Now = PROT_getTime( Ptr );
+
+    /* PROT_check() tests both voltage levels as one window */
+    if( Limit == PROT_OV && Value < Ptr->m_VoMin )
+    {
+        Limit = PROT_UV;
+    }
+
+    if( (uint32_t)(Now - Ptr->m_Last[Limit]) - Ptr->m_GapMin >
+        Ptr->m_GapSpan )
+    {
+        Ptr->m_Run[Limit] = 0;
+    }
+    Ptr->m_Last[Limit] = Now;
+    if( Ptr->m_Run[Limit] < Ptr->m_Debounce[Limit] )
+    {
+        Ptr->m_Run[Limit]++;
+    }
+
+    if( Ptr->m_Run[Limit] >= Ptr->m_Debounce[Limit] )
+    {
+        PROT_trip( Ptr, PROT_Cause[Limit], Value );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : PROT_process
+* DESCRIPTION   :
+* Call from the idle loop. Arms the under voltage limit while the
+* soft-started reference of Cntrl is at its target, checks the inputs and
+* logs the trips of the fault module.
+******************************************************************************/
+void PROT_process( PROT_Data* Ptr, CNTRL_2p2zData* Cntrl )
+{
+    FLT_Data*   Flt = Ptr->m_Flt;
+    PROT_Input* pIn;
+    uint32_t    Now = PROT_getTime( Ptr );
+    uint16_t    St;
+    int         Armed;
+    int         Value;
+    int         i;
+
+    /* PROT_check() reads m_VoMin and m_VoSpan as a pair */
+    Armed = Cntrl->m_SoftRef == Cntrl->m_SoftMax &&
+            !Flt->m_Forced && !Flt->m_Tripped;
+    if( Armed != Ptr->m_Armed )
+    {
+        St = __disable_interrupts();
+        PROT_setWindow( Ptr, Armed );
+        __restore_interrupts( St );
+    }
+
+    for( i = 0; i < Ptr->m_Inputs; i++ )
+    {
+        pIn   = &Ptr->m_Input[i];
+        Value = (int)*pIn->m_pValue;
+        if( Value < pIn->m_Min || Value > pIn->m_Max )
+        {
+            if( !pIn->m_Out )
+            {
+                pIn->m_Out   = true;
+                pIn->m_Since = Now;
+            }
+            if( Now - pIn->m_Since >= pIn->m_Debounce )
+            {
+                PROT_trip( Ptr, pIn->m_Cause, Value );
+            }
+        }
+        else
+        {
+            pIn->m_Out = false;
+        }
+    }
+
+    /* A trip from here is already logged, with its value */
+    if( Flt->m_Count != Ptr->m_FltCount )
+    {
+        Ptr->m_FltCount = Flt->m_Count;
+        if( !Ptr->m_Pending )
+        {
+            St = __disable_interrupts();
+            PROT_log( Ptr, Flt->m_Cause, (int)Flt->m_Flags );
+            __restore_interrupts( St );
+        }
+        Ptr->m_Pending = false;
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : PROT_getTime
+* DESCRIPTION   :
+* Returns the ticks of the time base since it was started, the time of the
+* log. The timer counts down.
+******************************************************************************/
+uint32_t PROT_getTime( PROT_Data* Ptr )
+{
+    return ~Ptr->m_Tim->TIM.all;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PROT_trip
+* DESCRIPTION   :
+* Trips the ePWM and logs why, unless it is already tripped.
+******************************************************************************/
+static void PROT_trip( PROT_Data* Ptr, int Cause, int Value )
+{
+    FLT_Data* Flt = Ptr->m_Flt;
+    uint16_t  St  = __disable_interrupts();
+
+    if( !Flt->m_Forced && !Flt->m_Tripped )
+    {
+        FLT_trip( Flt, (FLT_Cause)Cause );
+        PROT_log( Ptr, Cause, Value );
+        Ptr->m_Pending = true;
+    }
+
+    __restore_interrupts( St );
+}
+
+
+/******************************************************************************
+* FUNCTION      : PROT_log
+* DESCRIPTION   :
+* Adds a record to the log, over the oldest. Call with interrupts off.
+******************************************************************************/
+static void PROT_log( PROT_Data* Ptr, int Cause, int Value )
+{
+    PROT_Record* pRec = &Ptr->m_Log[Ptr->m_LogCount & (PROT_LOG_SIZE - 1)];
+
+    pRec->m_Time    = PROT_getTime( Ptr );
+    pRec->m_Cause   = Cause;
+    pRec->m_Value   = Value;
+    Ptr->m_LogCount++;
+}
+
+
+/******************************************************************************
+* FUNCTION      : PROT_setWindow
+* DESCRIPTION   :
+* Sets the voltage window of PROT_check(), with or without the under voltage
+* level. Call with interrupts off.
+******************************************************************************/
+static void PROT_setWindow( PROT_Data* Ptr, int Armed )
+{
+    Ptr->m_Armed    = Armed;
+    Ptr->m_VoMin    = Armed ? Ptr->m_Level[PROT_UV] : 0;
+    Ptr->m_VoSpan   = (uint16_t)(Ptr->m_Level[PROT_OV] - Ptr->m_VoMin);
+}
@@ -0,0 +1,198 @@
+/*******************************************************************************
+* FILE          : prot.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Over voltage, under voltage and over current protection with debounce,
+* input voltage and temperature limits and a time stamped fault log.
+*
+* Limits that must be exceeded for a number of consecutive cycles before they
+* latch the one-shot trip of the ePWM through FLT_trip(), see fault.h. The fault
+* module stays the fast, single cycle over voltage trip and the hardware trips;
+* this module adds the debounced limits on top of it:
+*
+*   PROT_OV     Vo above the level                    every cycle, in the ISR
+*   PROT_UV     Vo below the level, once the soft-start is up        "
+*   PROT_OC     the current, e.g. the peak demand, above the level   "
+*   inputs      up to PROT_INPUTS ADC results, e.g. Vin and the     idle loop
+*               temperature sensor, outside a Min..Max window
+*
+* PROT_check() is the per cycle part and only loads and compares: the over
+* and under voltage levels are one window, tested with a single unsigned
+* compare, and the over current a signed one. Nothing is stored while the
+* limits are met. A limit that is exceeded calls PROT_limit(), which counts
+* the run of cycles it has been exceeded for and trips once the run reaches
+* m_Debounce.
+*
+* The time base is a CPU timer, set up by the caller to count down freely
+* from 0xFFFFFFFF, e.g. at 1MHz. PROT_limit() reads it to tell whether the
+* limit was also exceeded on the cycle before, one control period ago give or
+* take half a period, and every trip is stamped with it. The timer costs the
+* ISR nothing, where a cycle count would be a store on every cycle.
+*
+* Vin and the temperature change slowly and are read from the ADC results by
+* PROT_process() in the idle loop, with their debounce in timer ticks.
+* PROT_process() also arms the under voltage limit while the soft-started
+* reference is at its target: during the ramp, and with the output turned
+* off, Vo is below it by design.
+*
+* Every trip is logged in m_Log[], the last PROT_LOG_SIZE of them, with the
+* cause, the value that tripped and the time. Trips of the fault module
+* itself, FLT_checkOvp() and the hardware, are logged by PROT_process() when
+* it sees them, with TZFLG as the value and the idle loop's time. Once
+* tripped the limits are ignored until FLT_clear().
+*
+*   PROT_check()    ~9 cycles       in the control ISR, all limits met
+*   PROT_limit()    ~30 cycles      per cycle a limit is exceeded
+*   PROT_process()  ~60 cycles      with two inputs
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+*
+* EXAMPLES
+*   PROT_Data MyProt;
+*
+*   TIM_config( TIM_MOD_2, 0xFFFFFFFF, 60 );        // 1us ticks at 60MHz
+*   PROT_init( &MyProt, &MyFlt, TIM_MOD_2, 5 );     // 5us control period
+*   PROT_setLimit( &MyProt, PROT_OV, 2294, 4 );     // +12% for 20us
+*   PROT_setLimit( &MyProt, PROT_UV, 1638, 100 );   // -20% for 500us
+*   PROT_setLimit( &MyProt, PROT_OC, 800, 40 );
+*   PROT_addInput( &MyProt, &AdcResult.ADCRESULT2, 1500, 2600, 1000, FLT_VIN );
+*
+*   interrupt void IsrAdc( void )
+*   {
+*       ...
+*       PROT_check( &MyProt, MyCntrl.Fdbk.m_Int, MyCntrl.Out.m_Int );
+*   }
+*
+*   while(1)
+*   {
+*       PROT_process( &MyProt, &MyCntrl );
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _PROT_H
+#define _PROT_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+#include "fault.h"
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  PROT_Data       PROT_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+#define PROT_INPUTS     2       /* inputs checked by PROT_process() */
+#define PROT_LOG_SIZE   8       /* records kept, a power of 2 */
+#define PROT_NO_LIMIT   0x7FFF
+
+/*******************************************************************************
+* ENUM          : PROT_Limit
+* DESCRIPTION   :
+* The limits checked every cycle by PROT_check().
+*******************************************************************************/
+typedef enum
+{
+    PROT_OV = 0,        /* Vo above the level */
+    PROT_UV,            /* Vo below the level */
+    PROT_OC,            /* current above the level */
+    PROT_LIMITS
+} PROT_Limit;
+
+/*******************************************************************************
+* STRUCT        : PROT_Record
+* DESCRIPTION   :
+* A fault log entry.
+*******************************************************************************/
+typedef struct
+{
+    uint32_t            m_Time;         /* timer ticks, see PROT_getTime() */
+    int                 m_Cause;        /* FLT_Cause */
+    int                 m_Value;        /* reading that tripped, or TZFLG */
+} PROT_Record;
+
+/*******************************************************************************
+* STRUCT        : PROT_Input
+* DESCRIPTION   :
+* An ADC result checked by PROT_process().
+*******************************************************************************/
+typedef struct
+{
+    const volatile uint16_t* m_pValue;
+    int                 m_Min;
+    int                 m_Max;
+    uint32_t            m_Debounce;     /* timer ticks */
+    int                 m_Cause;        /* FLT_Cause to trip with */
+    int                 m_Out;          /* outside the window since m_Since */
+    uint32_t            m_Since;
+} PROT_Input;
+
+/*******************************************************************************
+* STRUCT        : PROT_Data
+* DESCRIPTION   :
+* The protection structure.
+*******************************************************************************/
+struct PROT_Data
+{
+    /* read every cycle by PROT_check() */
+    volatile int        m_VoMin;        /* under voltage level, 0 unarmed */
+    volatile uint16_t   m_VoSpan;       /* over voltage level - m_VoMin */
+    int                 m_IoMax;
+
+    FLT_Data*           m_Flt;
+    TIM_Module          m_Tim;
+    uint16_t            m_GapMin;       /* ticks between consecutive cycles */
+    uint16_t            m_GapSpan;
+    int                 m_Level[PROT_LIMITS];
+    uint16_t            m_Debounce[PROT_LIMITS];    /* control cycles */
+    uint16_t            m_Run[PROT_LIMITS];         /* cycles exceeded */
+    uint32_t            m_Last[PROT_LIMITS];        /* time last exceeded */
+    int                 m_Armed;        /* under voltage limit is on */
+
+    PROT_Input          m_Input[PROT_INPUTS];
+    int                 m_Inputs;
+
+    int                 m_FltCount;     /* fault module trips seen */
+    volatile int        m_Pending;      /* trip from here not yet seen */
+
+    PROT_Record         m_Log[PROT_LOG_SIZE];
+    volatile uint16_t   m_LogCount;     /* records since PROT_init() */
+};
+
+
+/*******************************************************************************
+* MACRO         : PROT_check
+* DESCRIPTION   :
+* Checks the per cycle limits. Call it once per control cycle in the control
+* ISR with the output voltage in ADC counts and the current in the units of
+* the PROT_OC level; pass 0 for the current if PROT_OC is not used.
+*******************************************************************************/
+#define PROT_check( Ptr, Vo, Io )                                           \
+    do                                                                      \
+    {                                                                       \
+        if( (uint16_t)((Vo) - (Ptr)->m_VoMin) > (Ptr)->m_VoSpan )           \
+            { PROT_limit( (Ptr), PROT_OV, (Vo) ); }                         \
+        if( (Io) > (Ptr)->m_IoMax )                                         \
+            { PROT_limit( (Ptr), PROT_OC, (Io) ); }                         \
+    } while( 0 )
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void PROT_init( PROT_Data* Ptr, FLT_Data* Flt, TIM_Module Tim,
+                       uint16_t Period );
+extern void PROT_setLimit( PROT_Data* Ptr, PROT_Limit Limit, int Level,
+                           uint16_t Debounce );
+extern int  PROT_addInput( PROT_Data* Ptr, const volatile uint16_t* pValue,
+                           int Min, int Max, uint32_t Debounce,
+                           FLT_Cause Cause );
+extern void PROT_limit( PROT_Data* Ptr, PROT_Limit Limit, int Value );
+extern void PROT_process( PROT_Data* Ptr, CNTRL_2p2zData* Cntrl );
+extern uint32_t PROT_getTime( PROT_Data* Ptr );
+
+/********** END ***************************************************************/
+#endif
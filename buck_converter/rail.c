@@ -0,0 +1,550 @@
+/******************************************************************************
+* FILE          : rail.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Multi-rail runtime, sequencing, tracking and cycle budget. See rail.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "rail.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#pragma CODE_SECTION( RAIL_run, "hotfuncs" );
+#pragma CODE_SECTION( RAIL_isr1, "hotfuncs" );
+#pragma CODE_SECTION( RAIL_isr2, "hotfuncs" );
+#pragma CODE_SECTION( RAIL_isr3, "hotfuncs" );
+
+#define RAIL_CLA_START  17      /* cycles, 280ns from zero to the slope */
+#define RAIL_CLA_STEP   3       /* cycles per slope step */
+#define RAIL_TZ_OST     0x0004  /* TZFRC one-shot trip */
+
+/* The dispatch table: the rail of each ADC interrupt and its vector */
+static RAIL_Output* RAIL_Dispatch[RAIL_MAX];
+
+static const INT_IsrAddr RAIL_Isr[RAIL_MAX] =
+{
+    RAIL_isr1, RAIL_isr2, RAIL_isr3
+};
+
+static const ADC_Interrupt RAIL_Int[RAIL_MAX] =
+{
+    ADC_INT_1, ADC_INT_2, ADC_INT_3
+};
+
+static void RAIL_direction( RAIL_Output* Out, int PowerUp );
+static void RAIL_good( RAIL_Data* Ptr );
+static void RAIL_sequence( RAIL_Data* Ptr );
+static void RAIL_report( RAIL_Data* Ptr );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : RAIL_init
+* DESCRIPTION   :
+* No rails yet, all to switch every PeriodNs. Extra is the cycles the rail
+* ISRs take outside the stamps of RAIL_run(), added to the report.
+******************************************************************************/
+void RAIL_init( RAIL_Data* Ptr, uint32_t PeriodNs, uint16_t Extra )
+{
+    Ptr->m_Count    = 0;
+    Ptr->m_Ticks    = PWM_nsToTicks( PeriodNs );
+    Ptr->m_PeriodNs = PeriodNs;
+    Ptr->m_Extra    = Extra;
+    Ptr->m_Request  = -1;
+    Ptr->m_State    = RAIL_OFF;
+    Ptr->m_Step     = 0;
+    Ptr->m_Started  = false;
+    Ptr->m_Fault    = RAIL_NONE;
+    Ptr->m_LastRuns = 0;
+    Ptr->m_PerMs    = 1000000L / PeriodNs;
+    Ptr->m_Now      = 0;
+    Ptr->m_Wait     = 0;
+    Ptr->m_Deadline = 0;
+    Ptr->m_Report   = RAIL_REPORT_MS * Ptr->m_PerMs;
+    Ptr->m_Total    = 0;
+}
+
+
+/******************************************************************************
+* FUNCTION      : RAIL_add
+* DESCRIPTION   :
+* Sets up the next rail as Cfg gives, with Cntrl, already initialised, as its
+* controller, and returns its number. The rail starts off, its reference at
+* zero. Returns -1 if there are RAIL_MAX rails already or the leader is not
+* an earlier, sequenced, rail.
+******************************************************************************/
+int RAIL_add( RAIL_Data* Ptr, CNTRL_2p2zData* Cntrl, const RAIL_Config* Cfg )
+{
+    int          N      = Ptr->m_Count;
+    int          Leader = Cfg->m_Leader;
+    RAIL_Output* Out    = &Ptr->m_Out[N];
+    PWM_Module   Pwm    = Cfg->m_Pwm;
+    int          Index  = PWM_getIndex( Pwm );
+    int          Comp   = CMP_getIndex( Cfg->m_Cmp );
+
+    if( N >= RAIL_MAX )
+    {
+        return -1;
+    }
+    if( Leader != RAIL_NONE &&
+        (Leader < 0 || Leader >= N ||
+         Ptr->m_Out[Leader].m_Cfg->m_Leader != RAIL_NONE) )
+    {
+        return -1;
+    }
+
+    Out->m_Cntrl    = Cntrl;
+    Out->m_Pwm      = Pwm;
+    Out->m_Cmp      = Cfg->m_Cmp;
+    Out->m_Adc      = (ADC_Module)(ADC_MOD_1 + N);
+    Out->m_Target   = Cfg->m_Target;
+    Out->m_Trigger  = Ptr->m_Ticks - PWM_nsToTicks( RAIL_TRIGGER_NS );
+    Out->m_Runs     = 0;
+    Out->m_Latency  = 0;
+    Out->m_DacTicks = 0;
+    Out->m_Body     = 0;
+    Out->m_Late     = 0;
+    Out->m_Cfg      = Cfg;
+    Out->m_Good     = false;
+    Out->m_Slack    = 0;
+    Out->m_Share    = 0;
+
+    /* A ramp set going down from zero retires there at the first update */
+    Cntrl->Ref.m_Int = Cfg->m_Target;
+    SOFT_init( &Out->m_Soft, Cntrl, SOFT_LINEAR, 0 );
+    SOFT_start( &Out->m_Soft, Cfg->m_RampMs, Ptr->m_PeriodNs );
+    SOFT_direction( &Out->m_Soft, false );
+    Out->m_pLevel = Leader == RAIL_NONE ? &Out->m_Soft.m_Level :
+                                          &Ptr->m_Out[Leader].m_Soft.m_Level;
+
+    /* The loop of the example, on this rail's ePWM, comparator and SOC */
+    CMP_config( Cfg->m_Cmp, CMP_ASYNC, GPIO_NON_INVERT, CMP_DAC );
+    CMP_setDac( Cfg->m_Cmp, 0 );
+
+    CLA_config( (CLA_Module)Index, Cfg->m_pSlope, CLA_INT_PWM );
+    PWM_config( Pwm, Ptr->m_Ticks, PWM_COUNT_UP );
+    PWM_pin( Pwm, PWM_CH_A, GPIO_NON_INVERT );
+    /* Off at the end of the slope, past which nothing compensates */
+    PWM_setDutyA( Pwm, RAIL_CLA_START + RAIL_CLA_STEP*Cfg->m_SlopeSteps );
+    PWM_setDutyB( Pwm, Out->m_Trigger );
+    PWM_setAdcSoc( Pwm, PWM_CH_B, PWM_INT_CMPB_UP );
+    PWM_setCallback( Pwm, 0, PWM_INT_ZERO, PWM_INT_PRD_1 );
+
+    PWM_configBlanking( Pwm, (PWM_CmpSelect)(PWM_CMP_COMP1 + Comp),
+                        GPIO_NON_INVERT, true );
+    PWM_setBlankingWindow( Pwm, PWM_nsToTicks( RAIL_BLANK_NS ) );
+    PWM_setTripZone( Pwm, PWM_DCEVT, PWM_TPZ_CYCLE_BY_CYCLE );
+    PWM_setTripState( Pwm, PWM_CH_A, GPIO_CLR );
+    PWM_setTripState( Pwm, PWM_CH_B, GPIO_NO_ACTION );
+
+    RAIL_Dispatch[N] = Out;
+    ADC_config( Out->m_Adc, ADC_SH_WIDTH_7, Cfg->m_Vout,
+                (ADC_TriggerSelect)(ADC_TRIG_EPWM1_SOCB + 2*Index) );
+    ADC_setCallback( Out->m_Adc, RAIL_Isr[N], RAIL_Int[N] );
+
+    Ptr->m_Count++;
+    return N;
+}
+
+
+/******************************************************************************
+* FUNCTION      : RAIL_start
+* DESCRIPTION   :
+* Sets the counters of the rails a period over the number of rails apart,
+* with the time base clocks stopped so that they stay so. Returns -1 if there
+* are no rails or a slope task would not be over within its turn; m_State is
+* then RAIL_UNFIT, m_Fault the rail, and the ePWMs of the rails are tripped.
+******************************************************************************/
+int RAIL_start( RAIL_Data* Ptr )
+{
+    int      N = Ptr->m_Count;
+    uint16_t Turn;
+    int      i;
+
+    if( N == 0 )
+    {
+        Ptr->m_State = RAIL_UNFIT;
+        return -1;
+    }
+    Turn = Ptr->m_Ticks / N;
+    for( i = 0; i < N; i++ )
+    {
+        int Steps = Ptr->m_Out[i].m_Cfg->m_SlopeSteps;
+
+        if( RAIL_CLA_START + (long)RAIL_CLA_STEP*Steps > Turn )
+        {
+            Ptr->m_State = RAIL_UNFIT;
+            Ptr->m_Fault = i;
+            EALLOW;
+            for( i = 0; i < N; i++ )
+            {
+                Ptr->m_Out[i].m_Pwm->TZFRC.all = RAIL_TZ_OST;
+            }
+            EDIS;
+            return -1;
+        }
+    }
+
+    EALLOW;
+    SysCtrlRegs.PCLKCR0.bit.TBCLKSYNC = 0;
+    EDIS;
+
+    /* Rail i reaches zero i turns after rail 0 */
+    for( i = 0; i < N; i++ )
+    {
+        Ptr->m_Out[i].m_Pwm->TBCTR = i ? Ptr->m_Ticks - i*Turn : 0;
+    }
+
+    EALLOW;
+    SysCtrlRegs.PCLKCR0.bit.TBCLKSYNC = 1;
+    EDIS;
+
+    Ptr->m_LastRuns = Ptr->m_Out[0].m_Runs;
+    return 0;
+}
+
+
+/******************************************************************************
+* FUNCTION      : RAIL_powerUp
+* DESCRIPTION   :
+* Asks RAIL_process() to power the rails up in sequence.
+******************************************************************************/
+void RAIL_powerUp( RAIL_Data* Ptr )
+{
+    Ptr->m_Request = RAIL_ON;
+}
+
+
+/******************************************************************************
+* FUNCTION      : RAIL_powerDown
+* DESCRIPTION   :
+* Asks RAIL_process() to power the rails down in the reverse sequence.
+******************************************************************************/
+void RAIL_powerDown( RAIL_Data* Ptr )
+{
+    Ptr->m_Request = RAIL_OFF;
+}
+
+
+/******************************************************************************
+* FUNCTION      : RAIL_process
+* DESCRIPTION   :
+* Call once per idle loop pass. Counts the control cycles, updates the power
+* good of each rail, moves the sequence on and, every RAIL_REPORT_MS, updates
+* the budget report.
+******************************************************************************/
+void RAIL_process( RAIL_Data* Ptr )
+{
+    uint16_t Runs;
+
+    if( !Ptr->m_Count )
+    {
+        return;
+    }
+
+    Runs = Ptr->m_Out[0].m_Runs;
+    Ptr->m_Now     += (uint16_t)(Runs - Ptr->m_LastRuns);
+    Ptr->m_LastRuns = Runs;
+
+    RAIL_good( Ptr );
+    RAIL_sequence( Ptr );
+
+    if( (int32_t)(Ptr->m_Now - Ptr->m_Report) >= 0 )
+    {
+        Ptr->m_Report += RAIL_REPORT_MS * Ptr->m_PerMs;
+        RAIL_report( Ptr );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : RAIL_clearBudget
+* DESCRIPTION   :
+* Starts the worst values of every rail again.
+******************************************************************************/
+void RAIL_clearBudget( RAIL_Data* Ptr )
+{
+    uint16_t St;
+    int      i;
+
+    for( i = 0; i < Ptr->m_Count; i++ )
+    {
+        RAIL_Output* Out = &Ptr->m_Out[i];
+
+        St = __disable_interrupts();
+        Out->m_Latency  = 0;
+        Out->m_DacTicks = 0;
+        Out->m_Body     = 0;
+        Out->m_Late     = 0;
+        __restore_interrupts( St );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : RAIL_run
+* DESCRIPTION   :
+* One control cycle of a rail, called by its ISR once the ADC has converted
+* its Vo.
+******************************************************************************/
+void RAIL_run( RAIL_Output* Ptr )
+{
+    PWM_Module      Pwm   = Ptr->m_Pwm;
+    CNTRL_2p2zData* Cntrl = Ptr->m_Cntrl;
+    uint16_t        Start = Pwm->TBCTR;
+    uint16_t        Ticks;
+    uint16_t        Dac;
+    uint16_t        End;
+
+    Cntrl->Fdbk.m_Int = ADC_getValue( Ptr->m_Adc );
+    CNTRL_2p2z( Cntrl );
+    CMP_setDac( Ptr->m_Cmp, Cntrl->Out.m_Int );
+    Dac = Pwm->TBCTR;
+
+    SOFT_update( &Ptr->m_Soft );
+    Cntrl->Ref.m_Int = (int)((Ptr->m_Target * *Ptr->m_pLevel) >> 15);
+    Ptr->m_Runs++;
+
+    /* Off the critical path. The ISR starts after the trigger, so a count
+    *  below it has gone past zero
+    */
+    Ticks = Pwm->TBPRD + 1;
+    if( Start < Ptr->m_Trigger )
+    {
+        Start += Ticks;
+    }
+    if( Dac < Ptr->m_Trigger )
+    {
+        Dac += Ticks;
+        Ptr->m_Late++;
+    }
+    End = Pwm->TBCTR;
+    if( End < Ptr->m_Trigger )
+    {
+        End += Ticks;
+    }
+
+    if( Start - Ptr->m_Trigger > Ptr->m_Latency )
+    {
+        Ptr->m_Latency = Start - Ptr->m_Trigger;
+    }
+    if( Dac > Ptr->m_DacTicks )
+    {
+        Ptr->m_DacTicks = Dac;
+    }
+    if( End - Start > Ptr->m_Body )
+    {
+        Ptr->m_Body = End - Start;
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : RAIL_isr1
+* DESCRIPTION   :
+* The first entry of the dispatch table, ADC_INT_1. RAIL_isr2() and
+* RAIL_isr3() are the same for ADC_INT_2 and ADC_INT_3.
+******************************************************************************/
+interrupt void RAIL_isr1( void )
+{
+    ADC_ackInt( ADC_INT_1 );
+    RAIL_run( RAIL_Dispatch[0] );
+}
+
+
+interrupt void RAIL_isr2( void )
+{
+    ADC_ackInt( ADC_INT_2 );
+    RAIL_run( RAIL_Dispatch[1] );
+}
+
+
+interrupt void RAIL_isr3( void )
+{
+    ADC_ackInt( ADC_INT_3 );
+    RAIL_run( RAIL_Dispatch[2] );
+}
+
+
+/******************************************************************************
+* FUNCTION      : RAIL_direction
+* DESCRIPTION   :
+* Ramps a rail up or down. The soft-start is stepped by the rail's ISR.
+******************************************************************************/
+static void RAIL_direction( RAIL_Output* Out, int PowerUp )
+{
+    uint16_t St = __disable_interrupts();
+
+    SOFT_direction( &Out->m_Soft, PowerUp );
+
+    __restore_interrupts( St );
+}
+
+
+/******************************************************************************
+* FUNCTION      : RAIL_good
+* DESCRIPTION   :
+* A rail is power good once its reference is up and Vo is within
+* RAIL_PG_WINDOW of its target.
+******************************************************************************/
+static void RAIL_good( RAIL_Data* Ptr )
+{
+    int i;
+
+    for( i = 0; i < Ptr->m_Count; i++ )
+    {
+        RAIL_Output* Out = &Ptr->m_Out[i];
+        int Error = Out->m_Cntrl->Fdbk.m_Int - Out->m_Target;
+
+        Out->m_Good = *Out->m_pLevel == SOFT_LEVEL_ONE &&
+                      Error <= RAIL_PG_WINDOW && Error >= -RAIL_PG_WINDOW;
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : RAIL_sequence
+* DESCRIPTION   :
+* Takes a request and moves the sequence on by one rail at most. Tracking
+* rails are passed over, they follow their leader.
+******************************************************************************/
+static void RAIL_sequence( RAIL_Data* Ptr )
+{
+    int          Request = Ptr->m_Request;
+    RAIL_Output* Out;
+
+    if( Ptr->m_State == RAIL_UNFIT )
+    {
+        return;
+    }
+    if( Request != -1 )
+    {
+        Ptr->m_Request = -1;
+        if( Request == RAIL_ON && Ptr->m_State != RAIL_UP &&
+                                  Ptr->m_State != RAIL_ON )
+        {
+            Ptr->m_State   = RAIL_UP;
+            Ptr->m_Step    = 0;
+            Ptr->m_Started = false;
+            Ptr->m_Fault   = RAIL_NONE;
+            Ptr->m_Wait    = Ptr->m_Now +
+                             Ptr->m_Out[0].m_Cfg->m_DelayMs * Ptr->m_PerMs;
+        }
+        else if( Request == RAIL_OFF && (Ptr->m_State == RAIL_UP ||
+                                         Ptr->m_State == RAIL_ON) )
+        {
+            Ptr->m_State   = RAIL_DOWN;
+            Ptr->m_Step    = Ptr->m_Count - 1;
+            Ptr->m_Started = false;
+            Ptr->m_Wait    = Ptr->m_Now;
+        }
+    }
+
+    if( Ptr->m_State == RAIL_UP )
+    {
+        if( Ptr->m_Step == Ptr->m_Count )
+        {
+            Ptr->m_State = RAIL_ON;
+            return;
+        }
+        Out = &Ptr->m_Out[Ptr->m_Step];
+
+        if( Out->m_Cfg->m_Leader != RAIL_NONE ||
+            (!Ptr->m_Started && Out->m_Good) )
+        {
+            Ptr->m_Step++;
+        }
+        else if( !Ptr->m_Started )
+        {
+            if( (int32_t)(Ptr->m_Now - Ptr->m_Wait) >= 0 )
+            {
+                RAIL_direction( Out, true );
+                Ptr->m_Started  = true;
+                Ptr->m_Deadline = Ptr->m_Now + Ptr->m_PerMs *
+                                  (Out->m_Cfg->m_RampMs + RAIL_TIMEOUT_MS);
+            }
+            return;
+        }
+        else if( Out->m_Good )
+        {
+            Ptr->m_Step++;
+            Ptr->m_Started = false;
+            if( Ptr->m_Step < Ptr->m_Count )
+            {
+                Ptr->m_Wait = Ptr->m_Now + Ptr->m_PerMs *
+                              Ptr->m_Out[Ptr->m_Step].m_Cfg->m_DelayMs;
+            }
+        }
+        else if( (int32_t)(Ptr->m_Now - Ptr->m_Deadline) >= 0 )
+        {
+            /* Everything that is up comes down again, from here */
+            Ptr->m_Fault   = Ptr->m_Step;
+            Ptr->m_State   = RAIL_DOWN;
+            Ptr->m_Started = false;
+            Ptr->m_Wait    = Ptr->m_Now;
+        }
+    }
+    else if( Ptr->m_State == RAIL_DOWN )
+    {
+        if( Ptr->m_Step < 0 )
+        {
+            Ptr->m_State = Ptr->m_Fault == RAIL_NONE ? RAIL_OFF : RAIL_FAULT;
+            return;
+        }
+        Out = &Ptr->m_Out[Ptr->m_Step];
+
+        if( Out->m_Cfg->m_Leader != RAIL_NONE ||
+            (!Ptr->m_Started && *Out->m_pLevel == 0 &&
+             !Out->m_Soft.m_Active) )
+        {
+            Ptr->m_Step--;
+        }
+        else if( !Ptr->m_Started )
+        {
+            if( (int32_t)(Ptr->m_Now - Ptr->m_Wait) >= 0 )
+            {
+                RAIL_direction( Out, false );
+                Ptr->m_Started = true;
+            }
+        }
+        else if( *Out->m_pLevel == 0 && !Out->m_Soft.m_Active )
+        {
+            Ptr->m_Step--;
+            Ptr->m_Started = false;
+            Ptr->m_Wait    = Ptr->m_Now + Ptr->m_PerMs * Out->m_Cfg->m_DelayMs;
+        }
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : RAIL_report
+* DESCRIPTION   :
+* The slack and the CPU share of each rail from its worst values, and the
+* share of all the rails.
+******************************************************************************/
+static void RAIL_report( RAIL_Data* Ptr )
+{
+    long Total = 0;
+    int  i;
+
+    for( i = 0; i < Ptr->m_Count; i++ )
+    {
+        RAIL_Output* Out = &Ptr->m_Out[i];
+        long Share = ((long)Out->m_Body + Ptr->m_Extra) * 10000L /
+                     Ptr->m_Ticks;
+
+        Out->m_Slack = (int)Ptr->m_Ticks - (int)Out->m_DacTicks;
+        Out->m_Share = (int)Share;
+        Total += Share;
+    }
+    Ptr->m_Total = (int)Total;
+}
@@ -0,0 +1,239 @@
+/*******************************************************************************
+* FILE          : rail.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Runtime for up to RAIL_MAX peak current mode buck rails on one device.
+*
+* Each rail is the same loop as the single rail of the example: an ePWM whose
+* channel A drives the switch and is tripped cycle by cycle through the
+* blanking window by a comparator, whose DAC takes the current demand of a
+* 2p2z controller, a CLA slope task started by the ePWM at zero and an ADC
+* conversion of Vo started by the ePWM at CMPB. RAIL_add() sets all of that
+* up from a RAIL_Config. The 2803x has three comparators, which is what
+* limits the rails to three; the CLA task of a rail must be the one its
+* ePWM starts, CLA_MOD_n for PWM_MOD_n.
+*
+* Rail n converts Vo on ADC_MOD_n+1 and raises ADC_INT_n+1, whose vector is
+* the n'th entry of the dispatch table, a small ISR that acks the interrupt
+* and runs RAIL_run() on the rail in the n'th slot. RAIL_run() reads Vo, runs
+* the 2p2z, writes the DAC and then steps the reference.
+*
+* All rails switch at the same period. RAIL_start() sets their counters a
+* period over the number of rails apart, so the conversions, the ISRs and the
+* slope tasks take turns rather than pile up. The CLA runs one task at a time,
+* so the slope of each rail, 3 cycles per step, must be over within its turn,
+* which RAIL_start() checks. If one is not, RAIL_start() trips the ePWM of
+* every rail, sets m_State to RAIL_UNFIT and m_Fault to that rail, and the
+* rails never power up.
+*
+* The slope is the only compensation of the current loop, so the on-time of
+* a rail ends with its slope: RAIL_add() sets the longest on-time, CMPA, to
+* the end of the last step, 280ns and 3 cycles per step from zero. With 60
+* steps that is 197 cycles, 3.28us or 33% at 100kHz, above the 28% of 3.3V
+* from 12V. A rail that needs more on-time needs more steps, and so fewer
+* rails or a longer period.
+*
+* The reference of a rail is its target times a level, m_pLevel, Q15:
+*
+*   sequenced   the level of its own soft-start. RAIL_powerUp() ramps the
+*               rails up in the order they were added, each once the one
+*               before is power good, up and within RAIL_PG_WINDOW of its
+*               target, and its m_DelayMs more has passed. RAIL_powerDown()
+*               ramps them down in the reverse order, each once the one after
+*               is at zero and that one's m_DelayMs more has passed, from
+*               wherever the power up got to. A rail not power good
+*               RAIL_TIMEOUT_MS after its ramp should have ended stops the
+*               power up and turns the rails off again; m_Fault says which
+*   tracking    the level of the soft-start of its leader, given in its
+*               RAIL_Config. It is not sequenced but ramps with the leader,
+*               the same fraction of its own target, so the rails keep their
+*               ratio all the way up and down
+*
+* The sequencing is done by RAIL_process() in the idle loop, timed by the
+* control cycles of the first rail.
+*
+* Budget. RAIL_run() stamps the counter of its ePWM, which counts CPU cycles
+* from zero, as it starts, at the DAC write and as it ends, and keeps the worst
+* of each:
+*
+*   m_Latency   cycles from the ADC trigger to the start, the conversion, the
+*               PIE, the context save and any other rail's ISR in the way
+*   m_DacTicks  count at the DAC write; the slope task reads the DAC at zero,
+*               so it must stay under the period, m_Slack is what is left
+*   m_Body      cycles of RAIL_run() itself
+*   m_Late      DAC writes after the period had ended, each a cycle that ran
+*               on the previous current demand
+*
+* RAIL_process() turns them into a report: m_Share of each rail is the part of
+* the CPU its ISR takes, m_Body and m_Extra, the entry and exit cycles not seen
+* by the stamps, over the period, in 0.01%, and m_Total of all of them. The
+* worst values are kept from boot, or RAIL_clearBudget().
+*
+*   RAIL_isr1..3()  ~140 cycles     per rail per period, entry to exit
+*   RAIL_process()  ~80 cycles      in the idle loop, ~250 once a report
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+* At 200kHz, 300 cycles per period, that is two rails at most; three want
+* 100kHz or slower.
+*
+* EXAMPLES
+*   CLA_slopeCode( Slope1, 2,1, -1.0, 60 );
+*   CLA_slopeCode( Slope2, 1,2, -1.0, 60 );
+*
+*   const RAIL_Config MyCfg[2] =
+*   {
+*       { PWM_MOD_1, CMP_MOD_2, ADC_CH_B2, &Slope1, 60, 2048, 20, 0,  -1 },
+*       { PWM_MOD_2, CMP_MOD_1, ADC_CH_B4, &Slope2, 60, 1241, 20, 5,  -1 },
+*   };
+*
+*   RAIL_init( &MyRails, 10000, 41 );
+*   RAIL_add( &MyRails, &MyCntrl1, &MyCfg[0] );
+*   RAIL_add( &MyRails, &MyCntrl2, &MyCfg[1] );
+*   RAIL_start( &MyRails );
+*   INT_enableGlobal( true );
+*   RAIL_powerUp( &MyRails );
+*
+*   while(1)
+*   {
+*       RAIL_process( &MyRails );
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _RAIL_H
+#define _RAIL_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+#include "soft.h"
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  RAIL_Output     RAIL_Output;
+typedef struct  RAIL_Data       RAIL_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+#define RAIL_MAX        CMP_MOD_COUNT   /* one comparator per rail */
+#define RAIL_NONE       -1              /* no leader, or no fault */
+#define RAIL_PG_WINDOW  40              /* power good, ADC counts */
+#define RAIL_BLANK_NS   420             /* leading edge blanking */
+#define RAIL_TRIGGER_NS 2450            /* ADC trigger before zero */
+#define RAIL_REPORT_MS  100             /* between budget reports */
+#define RAIL_TIMEOUT_MS 20              /* power good after the ramp */
+
+/*******************************************************************************
+* ENUM          : RAIL_State
+* DESCRIPTION   :
+* Where the sequence is.
+*******************************************************************************/
+typedef enum
+{
+    RAIL_OFF = 0,       /* all sequenced rails at zero */
+    RAIL_UP,            /* ramping up, m_Step is the rail in hand */
+    RAIL_ON,            /* all sequenced rails power good */
+    RAIL_DOWN,          /* ramping down, m_Step is the rail in hand */
+    RAIL_FAULT,         /* ramped down after a power up timed out */
+    RAIL_UNFIT          /* RAIL_start() failed, the ePWMs are tripped */
+} RAIL_State;
+
+/*******************************************************************************
+* STRUCT        : RAIL_Config
+* DESCRIPTION   :
+* The hardware and the sequencing of one rail.
+*******************************************************************************/
+typedef struct
+{
+    PWM_Module          m_Pwm;
+    CMP_Module          m_Cmp;
+    ADC_Channel         m_Vout;         /* Vo, the same scale as REF */
+    Uint32*             m_pSlope;       /* CLA_slopeCode() task of m_Pwm */
+    int                 m_SlopeSteps;   /* Steps of that task, and on-time */
+    int                 m_Target;       /* ADC counts */
+    int                 m_RampMs;       /* zero to the target */
+    int                 m_DelayMs;      /* after the rail before */
+    int                 m_Leader;       /* rail tracked, or RAIL_NONE */
+} RAIL_Config;
+
+/*******************************************************************************
+* STRUCT        : RAIL_Output
+* DESCRIPTION   :
+* One rail.
+*******************************************************************************/
+struct RAIL_Output
+{
+    /* read every cycle by RAIL_run() */
+    CNTRL_2p2zData*     m_Cntrl;
+    PWM_Module          m_Pwm;
+    CMP_Module          m_Cmp;
+    ADC_Module          m_Adc;
+    SOFT_Data           m_Soft;
+    const volatile long* m_pLevel;      /* own m_Soft, or the leader's */
+    int                 m_Target;
+    uint16_t            m_Trigger;      /* ADC trigger, CMPB */
+
+    /* written by RAIL_run() */
+    volatile uint16_t   m_Runs;
+    volatile uint16_t   m_Latency;      /* worst, cycles */
+    volatile uint16_t   m_DacTicks;     /* worst, ePWM count */
+    volatile uint16_t   m_Body;         /* worst, cycles */
+    volatile uint16_t   m_Late;
+
+    /* sequencing and report, idle loop */
+    const RAIL_Config*  m_Cfg;
+    volatile int        m_Good;         /* power good */
+    volatile int        m_Slack;        /* cycles, m_DacTicks to the period */
+    volatile int        m_Share;        /* CPU, 0.01% */
+};
+
+/*******************************************************************************
+* STRUCT        : RAIL_Data
+* DESCRIPTION   :
+* The rails and their sequence.
+*******************************************************************************/
+struct RAIL_Data
+{
+    RAIL_Output         m_Out[RAIL_MAX];
+    int                 m_Count;
+    uint16_t            m_Ticks;        /* period, cycles */
+    uint32_t            m_PeriodNs;
+    uint16_t            m_Extra;        /* ISR cycles outside the stamps */
+
+    /* sequence */
+    volatile int        m_Request;      /* RAIL_ON or RAIL_OFF, else -1 */
+    volatile int        m_State;        /* RAIL_State */
+    volatile int        m_Step;
+    int                 m_Started;      /* m_Step is ramping */
+    volatile int        m_Fault;        /* rail that timed out or is unfit */
+    uint16_t            m_LastRuns;
+    uint32_t            m_PerMs;        /* control cycles per ms */
+    uint32_t            m_Now;          /* control cycles of rail 0 */
+    uint32_t            m_Wait;         /* m_Now at which m_Step may go */
+    uint32_t            m_Deadline;     /* m_Now by which it must be good */
+    uint32_t            m_Report;       /* m_Now of the next report */
+
+    /* report */
+    volatile int        m_Total;        /* CPU of all the rails, 0.01% */
+};
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void RAIL_init( RAIL_Data* Ptr, uint32_t PeriodNs, uint16_t Extra );
+extern int  RAIL_add( RAIL_Data* Ptr, CNTRL_2p2zData* Cntrl,
+                      const RAIL_Config* Cfg );
+extern int  RAIL_start( RAIL_Data* Ptr );
+extern void RAIL_powerUp( RAIL_Data* Ptr );
+extern void RAIL_powerDown( RAIL_Data* Ptr );
+extern void RAIL_process( RAIL_Data* Ptr );
+extern void RAIL_clearBudget( RAIL_Data* Ptr );
+extern void RAIL_run( RAIL_Output* Ptr );
+extern interrupt void RAIL_isr1( void );
+extern interrupt void RAIL_isr2( void );
+extern interrupt void RAIL_isr3( void );
+
+/********** END ***************************************************************/
+#endif
@@ -0,0 +1,90 @@
+/******************************************************************************
+* FILE          : sched.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Gain scheduling of the 2p2z coefficients. See sched.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "sched.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#pragma CODE_SECTION( SCHED_update, "hotfuncs" );
+#pragma CODE_SECTION( SCHED_load, "hotfuncs" );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : SCHED_init
+* DESCRIPTION   :
+* Initialises the scheduler and loads bank Bank straight away. Call it after
+* CNTRL_2p2zInit() and before the control interrupt is enabled.
+******************************************************************************/
+void SCHED_init( SCHED_Data* Ptr, CNTRL_2p2zData* Cntrl,
+                 const SCHED_Bank* Banks, int Count, int Bank, int Decimate )
+{
+    Ptr->m_pCntrl    = Cntrl;
+    Ptr->m_pBanks    = Banks;
+    Ptr->m_Count     = Count;
+    Ptr->m_Decimate  = Decimate;
+    Ptr->m_Countdown = Decimate;
+    SCHED_load( Ptr, Bank );
+}
+
+
+/******************************************************************************
+* FUNCTION      : SCHED_load
+* DESCRIPTION   :
+* Copies the coefficients of bank Bank into the controller. Only the
+* coefficients are written, never the history. This must be called from the
+* control ISR, or with that interrupt disabled, so that CNTRL_2p2z() cannot run
+* in the middle of the copy.
+******************************************************************************/
+void SCHED_load( SCHED_Data* Ptr, int Bank )
+{
+    const SCHED_Bank* pBank = &Ptr->m_pBanks[Bank];
+    CNTRL_2p2zData*   pCntrl = Ptr->m_pCntrl;
+
+    pCntrl->m_B2 = pBank->m_B2;
+    pCntrl->m_B1 = pBank->m_B1;
+    pCntrl->m_B0 = pBank->m_B0;
+    pCntrl->m_A2 = pBank->m_A2;
+    pCntrl->m_A1 = pBank->m_A1;
+    pCntrl->m_K  = pBank->m_K;
+    Ptr->m_Bank  = Bank;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SCHED_update
+* DESCRIPTION   :
+* Called once per control cycle with the operating point Op. Every m_Decimate
+* calls Op is compared with the window of the active bank and the neighbouring
+* bank is selected if Op has left it. The comparisons are summed rather than
+* branched on and the selected bank is loaded even when it is the active one,
+* so that every decision takes the same time.
+******************************************************************************/
+void SCHED_update( SCHED_Data* Ptr, int Op )
+{
+    const SCHED_Bank* pBank;
+    int               Up, Down;
+
+    if( --Ptr->m_Countdown )
+    {
+        return;
+    }
+    Ptr->m_Countdown = Ptr->m_Decimate;
+
+    pBank = &Ptr->m_pBanks[Ptr->m_Bank];
+    Up    = (Op > pBank->m_Hi) & (Ptr->m_Bank < Ptr->m_Count-1);
+    Down  = (Op < pBank->m_Lo) & (Ptr->m_Bank > 0);
+    SCHED_load( Ptr, Ptr->m_Bank + Up - Down );
+}
@@ -0,0 +1,124 @@
+/*******************************************************************************
+* FILE          : sched.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Gain scheduling for the 2p2z controller.
+*
+* A table of coefficient banks (A1, A2, B0, B1, B2 and K) is held in memory
+* and one of them is loaded into the CNTRL_2p2zData structure according to the
+* operating point, for example the load current estimated by the observer in
+* obs.h. Only the coefficients are written; the controller history m_U1, m_U2
+* and m_E0..m_E2, the reference and the soft-start state are left alone so the
+* output carries on from where it was.
+*
+* SCHED_update() is called from the control ISR after CNTRL_2p2z(), so a new
+* bank is always loaded between two runs of the controller and the controller
+* never sees a half written set. Every Decimate calls it compares the operating
+* point with the window [m_Lo, m_Hi] of the active bank and moves at most one
+* bank up or down. The windows of neighbouring banks should overlap to give
+* hysteresis. The decision has no data dependent branch and loads the bank it
+* selects whether or not that is the active one, so its cost depends neither
+* on the operating point nor on the number of banks; only the decimation
+* makes it differ from cycle to cycle:
+*
+*   SCHED_update()  ~12 cycles   between decisions
+*                   ~50 cycles   on a decision
+*
+* These are counted from the instruction sequence, see doc/timing.txt. The
+* example measures them with ISR_BENCH, in SchedTicksMax.
+*
+* EXAMPLES
+*   const SCHED_Bank MyBanks[2] =
+*   {
+*       SCHED_BANK( A1L, A2L, B0L, B1L, B2L, 0.5, -32768, 40 ),
+*       SCHED_BANK( A1,  A2,  B0,  B1,  B2,  0.5, 24, 32767 )
+*   };
+*
+*   SCHED_init( &MySched, &MyCntrl, MyBanks, 2, 1, 8 );
+*
+*   interrupt void IsrAdc( void )
+*   {
+*       ...
+*       CNTRL_2p2z( &MyCntrl );
+*       ...
+*       SCHED_update( &MySched, OBS_getIo( &MyObs ) );
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _SCHED_H
+#define _SCHED_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  SCHED_Bank      SCHED_Bank;
+typedef struct  SCHED_Data      SCHED_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+/*******************************************************************************
+* STRUCT        : SCHED_Bank
+* DESCRIPTION   :
+* One set of 2p2z coefficients in the formats used by CNTRL_2p2zInit() and the
+* operating point window in which it is used.
+*******************************************************************************/
+struct SCHED_Bank
+{
+    _iq26       m_B2;
+    _iq26       m_B1;
+    _iq26       m_B0;
+    _iq26       m_A2;
+    _iq26       m_A1;
+    _iq23       m_K;
+    int         m_Lo;   /* move to the bank below under this */
+    int         m_Hi;   /* move to the bank above over this */
+};
+
+/*******************************************************************************
+* STRUCT        : SCHED_Data
+* DESCRIPTION   :
+* The scheduler structure.
+*******************************************************************************/
+struct SCHED_Data
+{
+    CNTRL_2p2zData*     m_pCntrl;
+    const SCHED_Bank*   m_pBanks;
+    int                 m_Count;        /* number of banks */
+    int                 m_Bank;         /* active bank */
+    int                 m_Decimate;     /* calls per decision */
+    int                 m_Countdown;
+};
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void SCHED_init( SCHED_Data* Ptr, CNTRL_2p2zData* Cntrl,
+                        const SCHED_Bank* Banks, int Count, int Bank,
+                        int Decimate );
+extern void SCHED_update( SCHED_Data* Ptr, int Op );
+extern void SCHED_load( SCHED_Data* Ptr, int Bank );
+
+/*******************************************************************************
+* MACRO         : SCHED_BANK
+* DESCRIPTION   :
+* Static initialiser of a SCHED_Bank from the same floating point values that
+* are passed to CNTRL_2p2zInit().
+*******************************************************************************/
+#define SCHED_BANK( A1, A2, B0, B1, B2, K, Lo, Hi ) \
+    { _IQ26(B2), _IQ26(B1), _IQ26(B0), _IQ26(A2), _IQ26(A1), _IQ23(K), Lo, Hi }
+
+/*******************************************************************************
+* MACRO         : SCHED_getBank
+* DESCRIPTION   :
+* Returns the index of the active bank.
+*******************************************************************************/
+#define SCHED_getBank( Ptr )    ((Ptr)->m_Bank)
+
+/********** END ***************************************************************/
+#endif
@@ -0,0 +1,634 @@
+/******************************************************************************
+* FILE          : shell.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Interrupt driven UART command shell. See shell.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "shell.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#pragma CODE_SECTION( SH_rx, "hotfuncs" );
+#pragma CODE_SECTION( SH_drain, "hotfuncs" );
+
+#define SH_RX_MASK          (SH_RX_SIZE-1)
+#define SH_TX_MASK          (SH_TX_SIZE-1)
+
+#if SH_RX_SIZE & SH_RX_MASK
+#error "SH_RX_SIZE must be a power of two"
+#endif
+
+#if SH_TX_SIZE & SH_TX_MASK
+#error "SH_TX_SIZE must be a power of two"
+#endif
+
+#define SH_PROMPT           "> "
+
+static void SH_execute( SH_Data* Ptr );
+static int  SH_same( const char* a, const char* b );
+static const SH_Var* SH_findVar( SH_Data* Ptr, const char* Name );
+static void SH_putVar( SH_Data* Ptr, const SH_Var* Var );
+static void SH_help( SH_Data* Ptr, int Argc, char** Argv );
+static void SH_vars( SH_Data* Ptr, int Argc, char** Argv );
+static void SH_get( SH_Data* Ptr, int Argc, char** Argv );
+static void SH_set( SH_Data* Ptr, int Argc, char** Argv );
+
+/* Built in commands, searched after the user's table */
+static const SH_Command SH_Builtin[] =
+{
+    { "help", SH_help, "list the commands" },
+    { "vars", SH_vars, "list the variables" },
+    { "get",  SH_get,  "get <var>" },
+    { "set",  SH_set,  "set <var> <value>" }
+};
+
+#define SH_BUILTIN_COUNT    ((int)(sizeof(SH_Builtin) / sizeof(SH_Builtin[0])))
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : SH_init
+* DESCRIPTION   :
+* Initialises the shell with the user's commands and variables and queues the
+* prompt. Call it after UART_setRxCallback() and UART_setTxCallback(); the Tx
+* interrupt is left off until SH_process() has something to send.
+******************************************************************************/
+void SH_init( SH_Data* Ptr, UART_Module Uart, const SH_Command* Cmds,
+              int CmdCount, const SH_Var* Vars, int VarCount )
+{
+    Ptr->m_RxHead    = 0;
+    Ptr->m_RxTail    = 0;
+    Ptr->m_RxDropped = 0;
+    Ptr->m_TxHead    = 0;
+    Ptr->m_TxTail    = 0;
+    Ptr->m_TxIdle    = true;
+    Ptr->m_TxDropped = 0;
+    Ptr->m_Uart      = Uart;
+    Ptr->m_pCmds     = Cmds;
+    Ptr->m_CmdCount  = CmdCount;
+    Ptr->m_pVars     = Vars;
+    Ptr->m_VarCount  = VarCount;
+    Ptr->m_Length    = 0;
+    Ptr->m_Overflow  = false;
+    UART_enableTxInt( Uart, false );
+    UART_enableRxInt( Uart, true );
+    SH_puts( Ptr, "\r\n" SH_PROMPT );
+}
+
+
+/******************************************************************************
+* FUNCTION      : SH_rx
+* DESCRIPTION   :
+* Called by the UART Rx interrupt. Empties the Rx FIFO into the Rx ring;
+* characters that do not fit are counted in m_RxDropped.
+******************************************************************************/
+void SH_rx( SH_Data* Ptr )
+{
+    uint16_t Head = Ptr->m_RxHead;
+    uint16_t Next;
+
+    while( UART_getRxCount( Ptr->m_Uart ) )
+    {
+        Next = (Head+1) & SH_RX_MASK;
+        if( Next == Ptr->m_RxTail )
+        {
+            UART_getc( Ptr->m_Uart );
+            Ptr->m_RxDropped++;
+        }
+        else
+        {
+            Ptr->m_Rx[Head] = UART_getc( Ptr->m_Uart );
+            Head = Next;
+        }
+    }
+    Ptr->m_RxHead = Head;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SH_drain
+* DESCRIPTION   :
+* Called by the UART Tx interrupt when the Tx FIFO is empty. Refills the FIFO
+* from the Tx ring and turns the interrupt off when the ring is empty. Only
+* the idle loop adds to the ring, so unlike TLM_drain() the head cannot move
+* while this function runs.
+******************************************************************************/
+void SH_drain( SH_Data* Ptr )
+{
+    uint16_t Tail = Ptr->m_TxTail;
+    int      n;
+
+    for( n = 0; n < UART_FIFO_DEPTH; n++ )
+    {
+        if( Tail == Ptr->m_TxHead )
+        {
+            UART_enableTxInt( Ptr->m_Uart, false );
+            Ptr->m_TxIdle = true;
+            break;
+        }
+        UART_putc( Ptr->m_Uart, Ptr->m_Tx[Tail] );
+        Tail = (Tail+1) & SH_TX_MASK;
+    }
+    Ptr->m_TxTail = Tail;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SH_process
+* DESCRIPTION   :
+* Called from the idle loop. Takes up to SH_CHARS_PER_PASS characters from
+* the Rx ring and runs the line if one of them ends it, so one call never
+* runs more than one command. TxFree tells the shell whether it may start the
+* UART Tx interrupt, i.e. no one else is using it; output waits in the Tx ring
+* until it is. TxFree may only go from true to false in the idle loop, e.g.
+* when a command starts the telemetry.
+*
+* Backspace or delete removes the last character, CR or LF ends the line and
+* a line longer than SH_LINE_SIZE is thrown away when it ends.
+******************************************************************************/
+void SH_process( SH_Data* Ptr, int TxFree )
+{
+    uint16_t Tail = Ptr->m_RxTail;
+    char     c;
+    int      n;
+
+    for( n = 0; n < SH_CHARS_PER_PASS && Tail != Ptr->m_RxHead; n++ )
+    {
+        c = Ptr->m_Rx[Tail];
+        Tail = (Tail+1) & SH_RX_MASK;
+
+        if( c == '\r' || c == '\n' )
+        {
+            SH_puts( Ptr, "\r\n" );
+            if( Ptr->m_Overflow )
+            {
+                SH_puts( Ptr, "line too long\r\n" );
+            }
+            else if( Ptr->m_Length )
+            {
+                Ptr->m_Line[Ptr->m_Length] = 0;
+                SH_execute( Ptr );
+            }
+            Ptr->m_Length   = 0;
+            Ptr->m_Overflow = false;
+            SH_puts( Ptr, SH_PROMPT );
+            break;
+        }
+        else if( c == '\b' || c == 0x7F )
+        {
+            if( Ptr->m_Length )
+            {
+                Ptr->m_Length--;
+                SH_puts( Ptr, "\b \b" );
+            }
+        }
+        else if( c >= ' ' && c < 0x7F )
+        {
+            if( Ptr->m_Length < SH_LINE_SIZE-1 )
+            {
+                Ptr->m_Line[Ptr->m_Length++] = c;
+                SH_putc( Ptr, c );
+            }
+            else
+            {
+                Ptr->m_Overflow = true;
+            }
+        }
+    }
+    Ptr->m_RxTail = Tail;
+
+    if( !TxFree )
+    {
+        /* the interrupt is the other user's, start it again once it is free */
+        Ptr->m_TxIdle = true;
+    }
+    else if( Ptr->m_TxIdle && Ptr->m_TxTail != Ptr->m_TxHead )
+    {
+        Ptr->m_TxIdle = false;
+        UART_enableTxInt( Ptr->m_Uart, true );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : SH_execute
+* DESCRIPTION   :
+* Splits m_Line into words and calls the command named by the first one.
+******************************************************************************/
+static void SH_execute( SH_Data* Ptr )
+{
+    char* Argv[SH_MAX_ARGS];
+    int   Argc = 0;
+    char* p    = Ptr->m_Line;
+    int   i;
+
+    while( *p )
+    {
+        while( *p == ' ' )
+        {
+            *p++ = 0;
+        }
+        if( !*p )
+        {
+            break;
+        }
+        if( Argc == SH_MAX_ARGS )
+        {
+            SH_puts( Ptr, "too many arguments\r\n" );
+            return;
+        }
+        Argv[Argc++] = p;
+        while( *p && *p != ' ' )
+        {
+            p++;
+        }
+    }
+    if( !Argc )
+    {
+        return;
+    }
+
+    for( i = 0; i < Ptr->m_CmdCount; i++ )
+    {
+        if( SH_same( Argv[0], Ptr->m_pCmds[i].m_Name ) )
+        {
+            Ptr->m_pCmds[i].m_Func( Ptr, Argc, Argv );
+            return;
+        }
+    }
+    for( i = 0; i < SH_BUILTIN_COUNT; i++ )
+    {
+        if( SH_same( Argv[0], SH_Builtin[i].m_Name ) )
+        {
+            SH_Builtin[i].m_Func( Ptr, Argc, Argv );
+            return;
+        }
+    }
+    SH_puts( Ptr, "unknown command, try help\r\n" );
+}
+
+
+/******************************************************************************
+* FUNCTION      : SH_putc
+* DESCRIPTION   :
+* Adds c to the Tx ring, or counts it in m_TxDropped if the ring is full.
+******************************************************************************/
+void SH_putc( SH_Data* Ptr, char c )
+{
+    uint16_t Head = Ptr->m_TxHead;
+    uint16_t Next = (Head+1) & SH_TX_MASK;
+
+    if( Next == Ptr->m_TxTail )
+    {
+        Ptr->m_TxDropped++;
+        return;
+    }
+    Ptr->m_Tx[Head] = c;
+    Ptr->m_TxHead   = Next;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SH_puts
+* DESCRIPTION   :
+******************************************************************************/
+void SH_puts( SH_Data* Ptr, const char* s )
+{
+    while( *s )
+    {
+        SH_putc( Ptr, *s++ );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : SH_putInt
+* DESCRIPTION   :
+* Writes Value in decimal.
+******************************************************************************/
+void SH_putInt( SH_Data* Ptr, long Value )
+{
+    char          Digits[11];
+    unsigned long u = Value < 0 ? 0UL - (unsigned long)Value :
+                                  (unsigned long)Value;
+    int           n = 0;
+
+    if( Value < 0 )
+    {
+        SH_putc( Ptr, '-' );
+    }
+    do
+    {
+        Digits[n++] = '0' + (char)(u % 10);
+        u /= 10;
+    } while( u );
+    while( n )
+    {
+        SH_putc( Ptr, Digits[--n] );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : SH_putFixed
+* DESCRIPTION   :
+* Writes the _iq Value in format Q with six decimals, truncated.
+******************************************************************************/
+void SH_putFixed( SH_Data* Ptr, long Value, int Q )
+{
+    unsigned long u = Value < 0 ? 0UL - (unsigned long)Value :
+                                  (unsigned long)Value;
+    unsigned long Frac;
+    int           n;
+
+    if( Q <= 0 )
+    {
+        SH_putInt( Ptr, Value );
+        return;
+    }
+    if( Value < 0 )
+    {
+        SH_putc( Ptr, '-' );
+    }
+    SH_putInt( Ptr, (long)(u >> Q) );
+    SH_putc( Ptr, '.' );
+
+    /* one digit at a time so the fraction never needs more than 32 bits */
+    Frac = u & ((1UL << Q) - 1);
+    if( Q > 28 )
+    {
+        Frac >>= Q - 28;
+        Q = 28;
+    }
+    for( n = 0; n < 6; n++ )
+    {
+        Frac *= 10;
+        SH_putc( Ptr, '0' + (char)(Frac >> Q) );
+        Frac &= (1UL << Q) - 1;
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : SH_parse
+* DESCRIPTION   :
+* Converts s to a value in format Q, Q being SH_TYPE_INT, SH_TYPE_LONG or the
+* Q of an _iq. Accepts an optional sign, decimal digits and, for an _iq, a
+* fraction, or 0x and hex digits taken as the raw value. Returns false if s is
+* not a number or the value does not fit.
+******************************************************************************/
+int SH_parse( const char* s, int Q, long* Value )
+{
+    uint32_t      Int  = 0;
+    uint32_t      Frac = 0;
+    uint32_t      Div  = 1;
+    uint32_t      Limit = Q < 0 ? 0x7FFFUL : 0x7FFFFFFFUL;
+    uint32_t      Max;
+    int           Neg  = false;
+    int           Digits = 0;
+    int           d;
+
+    if( Q < 0 )
+    {
+        Q = 0;
+    }
+    Max = Limit >> Q;
+
+    if( s[0] == '0' && (s[1] == 'x' || s[1] == 'X') )
+    {
+        for( s += 2; *s; s++, Digits++ )
+        {
+            if( *s >= '0' && *s <= '9' )        d = *s - '0';
+            else if( *s >= 'a' && *s <= 'f' )   d = *s - 'a' + 10;
+            else if( *s >= 'A' && *s <= 'F' )   d = *s - 'A' + 10;
+            else                                return false;
+            if( Int >> 28 )
+            {
+                return false;
+            }
+            Int = (Int << 4) | d;
+        }
+        if( !Digits || (Limit == 0x7FFFUL && Int > 0xFFFFUL) )
+        {
+            return false;
+        }
+        *Value = (long)Int;
+        return true;
+    }
+
+    if( *s == '-' || *s == '+' )
+    {
+        Neg = *s++ == '-';
+    }
+    for( ; *s >= '0' && *s <= '9'; s++, Digits++ )
+    {
+        d = *s - '0';
+        if( Int > (Max + Neg) / 10 ||
+            (Int == (Max + Neg) / 10 && d > (int)((Max + Neg) % 10)) )
+        {
+            return false;
+        }
+        Int = Int*10 + d;
+    }
+    if( *s == '.' && Q > 0 )
+    {
+        for( s++; *s >= '0' && *s <= '9'; s++, Digits++ )
+        {
+            if( Div < 100000000UL )
+            {
+                Frac = Frac*10 + (*s - '0');
+                Div *= 10;
+            }
+        }
+    }
+    if( *s || !Digits )
+    {
+        return false;
+    }
+
+    /* Int is at most Max+Neg so Int << Q is at most 2^31, and Frac/Div < 1 so
+    *  the scaled fraction, rounded to nearest, is under 2^Q: the sum fits */
+    Int = (Int << Q) + (uint32_t)
+          ((((uint64_t)Frac << Q) + Div/2) / Div);
+    if( Int > Limit + Neg )
+    {
+        return false;
+    }
+    *Value = Neg ? (long)(0UL - Int) : (long)Int;
+    return true;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SH_same
+* DESCRIPTION   :
+******************************************************************************/
+static int SH_same( const char* a, const char* b )
+{
+    while( *a && *a == *b )
+    {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SH_findVar
+* DESCRIPTION   :
+* Returns the variable called Name, or 0 after printing an error.
+******************************************************************************/
+static const SH_Var* SH_findVar( SH_Data* Ptr, const char* Name )
+{
+    int i;
+
+    for( i = 0; i < Ptr->m_VarCount; i++ )
+    {
+        if( SH_same( Name, Ptr->m_pVars[i].m_Name ) )
+        {
+            return &Ptr->m_pVars[i];
+        }
+    }
+    SH_puts( Ptr, "unknown variable, try vars\r\n" );
+    return 0;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SH_putVar
+* DESCRIPTION   :
+* Writes "name = value". 32 bit values are read with a single load.
+******************************************************************************/
+static void SH_putVar( SH_Data* Ptr, const SH_Var* Var )
+{
+    SH_puts( Ptr, Var->m_Name );
+    SH_puts( Ptr, " = " );
+    if( Var->m_Q == SH_TYPE_INT )
+    {
+        SH_putInt( Ptr, *(volatile int*)Var->m_pValue );
+    }
+    else
+    {
+        SH_putFixed( Ptr, *(volatile long*)Var->m_pValue, Var->m_Q );
+    }
+    SH_puts( Ptr, "\r\n" );
+}
+
+
+/******************************************************************************
+* FUNCTION      : SH_help
+* DESCRIPTION   :
+******************************************************************************/
+static void SH_help( SH_Data* Ptr, int Argc, char** Argv )
+{
+    int i;
+
+    (void)Argc;
+    (void)Argv;
+
+    for( i = 0; i < Ptr->m_CmdCount; i++ )
+    {
+        SH_puts( Ptr, Ptr->m_pCmds[i].m_Name );
+        SH_puts( Ptr, "\t" );
+        SH_puts( Ptr, Ptr->m_pCmds[i].m_Help );
+        SH_puts( Ptr, "\r\n" );
+    }
+    for( i = 0; i < SH_BUILTIN_COUNT; i++ )
+    {
+        SH_puts( Ptr, SH_Builtin[i].m_Name );
+        SH_puts( Ptr, "\t" );
+        SH_puts( Ptr, SH_Builtin[i].m_Help );
+        SH_puts( Ptr, "\r\n" );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : SH_vars
+* DESCRIPTION   :
+******************************************************************************/
+static void SH_vars( SH_Data* Ptr, int Argc, char** Argv )
+{
+    int i;
+
+    (void)Argc;
+    (void)Argv;
+
+    for( i = 0; i < Ptr->m_VarCount; i++ )
+    {
+        SH_putVar( Ptr, &Ptr->m_pVars[i] );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : SH_get
+* DESCRIPTION   :
+******************************************************************************/
+static void SH_get( SH_Data* Ptr, int Argc, char** Argv )
+{
+    const SH_Var* Var;
+
+    if( Argc != 2 )
+    {
+        SH_puts( Ptr, "usage: get <var>\r\n" );
+        return;
+    }
+    Var = SH_findVar( Ptr, Argv[1] );
+    if( Var )
+    {
+        SH_putVar( Ptr, Var );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : SH_set
+* DESCRIPTION   :
+* Writes a variable with a single store and reads it back.
+******************************************************************************/
+static void SH_set( SH_Data* Ptr, int Argc, char** Argv )
+{
+    const SH_Var* Var;
+    long          Value;
+
+    if( Argc != 3 )
+    {
+        SH_puts( Ptr, "usage: set <var> <value>\r\n" );
+        return;
+    }
+    Var = SH_findVar( Ptr, Argv[1] );
+    if( !Var )
+    {
+        return;
+    }
+    if( Var->m_ReadOnly )
+    {
+        SH_puts( Ptr, "read only\r\n" );
+        return;
+    }
+    if( !SH_parse( Argv[2], Var->m_Q, &Value ) )
+    {
+        SH_puts( Ptr, "bad value\r\n" );
+        return;
+    }
+    if( Var->m_Q == SH_TYPE_INT )
+    {
+        *(volatile int*)Var->m_pValue = (int)Value;
+    }
+    else
+    {
+        *(volatile long*)Var->m_pValue = Value;
+    }
+    SH_putVar( Ptr, Var );
+}
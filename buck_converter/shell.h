@@ -0,0 +1,179 @@
+/*******************************************************************************
+* FILE          : shell.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Interrupt driven command shell on a UART.
+*
+* SH_rx() is the body of the UART Rx interrupt and moves the received
+* characters from the Rx FIFO into a ring buffer. SH_process() is called from
+* the idle loop; each call takes at most SH_CHARS_PER_PASS characters from the
+* ring, echoes them and edits the line, and runs at most one complete line.
+* A line is split into up to SH_MAX_ARGS words and the first one is looked up
+* in a table of SH_Command given to SH_init(); the handlers must themselves
+* be bounded. Output is written into a Tx ring with SH_puts(), SH_putInt() and
+* SH_putFixed() and sent by SH_drain(), the body of the UART Tx interrupt, so
+* neither side ever waits for the UART. Output that does not fit in the Tx
+* ring is dropped and counted in m_TxDropped.
+*
+* Named variables can be given to SH_init() as a table of SH_Var, each an int,
+* a long or an _iq of any Q, which the built in commands "get", "set" and
+* "vars" read and write. Values are entered in decimal, with a fraction for
+* _iq variables, or in hex with 0x. 32 bit values are written with a single
+* store, so the control ISR never sees half of one.
+*
+* The Tx interrupt may be shared with another user of the UART, such as the
+* binary telemetry in telem.h; SH_process() is told whether the shell may
+* start the Tx interrupt and holds its output until then.
+*
+* EXAMPLES
+*   const SH_Var MyVars[] =
+*   {
+*       SH_INT( "ref", MyCntrl.Ref.m_Int ),
+*       SH_IQ(  "a1",  MyCntrl.m_A1, 26 )
+*   };
+*
+*   const SH_Command MyCmds[] =
+*   {
+*       { "stat", CmdStat, "show the loop state" }
+*   };
+*
+*   interrupt void IsrUartRx( void )
+*   {
+*       SH_rx( &MyShell );
+*       UART_ackRxInt( UART_MOD_1 );
+*   }
+*
+*   interrupt void IsrUartTx( void )
+*   {
+*       SH_drain( &MyShell );
+*       UART_ackTxInt( UART_MOD_1 );
+*   }
+*
+*   UART_setRxCallback( UART_MOD_1, IsrUartRx, 1 );
+*   UART_setTxCallback( UART_MOD_1, IsrUartTx, 0 );
+*   SH_init( &MyShell, UART_MOD_1, MyCmds, 1, MyVars, 2 );
+*   while( 1 )
+*   {
+*       SH_process( &MyShell, true );
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _SHELL_H
+#define _SHELL_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  SH_Command      SH_Command;
+typedef struct  SH_Var          SH_Var;
+typedef struct  SH_Data         SH_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+/* Ring sizes in characters, must be powers of two */
+#ifndef SH_RX_SIZE
+#define SH_RX_SIZE          32
+#endif
+
+#ifndef SH_TX_SIZE
+#define SH_TX_SIZE          256
+#endif
+
+#define SH_LINE_SIZE        40      /* longest command line */
+#define SH_MAX_ARGS         4       /* words per command line */
+#define SH_CHARS_PER_PASS   8       /* characters per SH_process() */
+
+#define SH_TYPE_INT         (-1)    /* m_Q of a 16 bit int variable */
+#define SH_TYPE_LONG        0       /* m_Q of a 32 bit long variable */
+
+/*******************************************************************************
+* STRUCT        : SH_Command
+* DESCRIPTION   :
+* One entry of the command table. m_Func is called with the words of the line,
+* Argv[0] being the command itself.
+*******************************************************************************/
+struct SH_Command
+{
+    const char* m_Name;
+    void        (*m_Func)( SH_Data* Ptr, int Argc, char** Argv );
+    const char* m_Help;
+};
+
+/*******************************************************************************
+* STRUCT        : SH_Var
+* DESCRIPTION   :
+* One entry of the variable table. m_Q is SH_TYPE_INT, SH_TYPE_LONG or the Q
+* of an _iq variable.
+*******************************************************************************/
+struct SH_Var
+{
+    const char*     m_Name;
+    volatile void*  m_pValue;
+    int             m_Q;
+    int             m_ReadOnly;
+};
+
+/*******************************************************************************
+* STRUCT        : SH_Data
+* DESCRIPTION   :
+* The shell structure.
+*******************************************************************************/
+struct SH_Data
+{
+    /* Rx ring, written by the Rx interrupt */
+    volatile uint16_t   m_RxHead;
+    volatile uint16_t   m_RxTail;
+    char                m_Rx[SH_RX_SIZE];
+    uint16_t            m_RxDropped;
+
+    /* Tx ring, read by the Tx interrupt */
+    volatile uint16_t   m_TxHead;
+    volatile uint16_t   m_TxTail;
+    volatile int        m_TxIdle;
+    char                m_Tx[SH_TX_SIZE];
+    uint16_t            m_TxDropped;
+
+    /* idle loop side */
+    UART_Module         m_Uart;
+    const SH_Command*   m_pCmds;
+    int                 m_CmdCount;
+    const SH_Var*       m_pVars;
+    int                 m_VarCount;
+    char                m_Line[SH_LINE_SIZE];
+    int                 m_Length;
+    int                 m_Overflow;
+};
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void SH_init( SH_Data* Ptr, UART_Module Uart, const SH_Command* Cmds,
+                     int CmdCount, const SH_Var* Vars, int VarCount );
+extern void SH_rx( SH_Data* Ptr );
+extern void SH_drain( SH_Data* Ptr );
+extern void SH_process( SH_Data* Ptr, int TxFree );
+extern void SH_putc( SH_Data* Ptr, char c );
+extern void SH_puts( SH_Data* Ptr, const char* s );
+extern void SH_putInt( SH_Data* Ptr, long Value );
+extern void SH_putFixed( SH_Data* Ptr, long Value, int Q );
+extern int  SH_parse( const char* s, int Q, long* Value );
+
+/*******************************************************************************
+* MACRO         : SH_INT, SH_LONG, SH_IQ, SH_RO_INT, SH_RO_IQ
+* DESCRIPTION   :
+* Static initialisers of an SH_Var.
+*******************************************************************************/
+#define SH_INT( Name, Var )     { Name, &(Var), SH_TYPE_INT,  0 }
+#define SH_LONG( Name, Var )    { Name, &(Var), SH_TYPE_LONG, 0 }
+#define SH_IQ( Name, Var, Q )   { Name, &(Var), Q,            0 }
+#define SH_RO_INT( Name, Var )  { Name, &(Var), SH_TYPE_INT,  1 }
+#define SH_RO_IQ( Name, Var, Q ) { Name, &(Var), Q,           1 }
+
+/********** END ***************************************************************/
+#endif
@@ -0,0 +1,236 @@
+/******************************************************************************
+* FILE          : soft.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Self-retiring soft-start with linear and S-curve profiles. See soft.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "soft.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#pragma CODE_SECTION( SOFT_direction, "hotfuncs" );
+#pragma CODE_SECTION( SOFT_step, "hotfuncs" );
+#pragma CODE_SECTION( SOFT_level, "hotfuncs" );
+
+static long     SOFT_level( const SOFT_Data* Ptr, uint32_t Phase );
+static uint32_t SOFT_phaseOf( const SOFT_Data* Ptr, int Vout );
+static void     SOFT_go( SOFT_Data* Ptr, uint32_t Inc );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : SOFT_init
+* DESCRIPTION   :
+* Takes the present reference of Cntrl as the target and leaves the soft-start
+* retired, at the target. pVout, if not 0, is read at each start for the
+* pre-bias, in the same ADC counts as the reference.
+******************************************************************************/
+void SOFT_init( SOFT_Data* Ptr, CNTRL_2p2zData* Cntrl, SOFT_Profile Profile,
+                const volatile uint16_t* pVout )
+{
+    Ptr->m_Active   = false;
+    Ptr->m_Cntrl    = Cntrl;
+    Ptr->m_Profile  = Profile;
+    Ptr->m_Target   = Cntrl->Ref.m_Int;
+    Ptr->m_pVout    = pVout;
+    Ptr->m_Inc      = SOFT_PHASE_END;
+    Ptr->m_Phase    = SOFT_PHASE_END;
+    Ptr->m_Up       = true;
+    Ptr->m_Level    = SOFT_LEVEL_ONE;
+
+    Cntrl->m_SoftRamp = 0;
+    Cntrl->m_SoftMax  = (long)Ptr->m_Target << 16;
+    Cntrl->m_SoftRef  = Cntrl->m_SoftMax;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SOFT_start
+* DESCRIPTION   :
+* Starts a ramp up to the target, taking RampMs from zero, SOFT_update() being
+* called every UpdatePeriodNs. The division is done before the interrupts are
+* turned off.
+******************************************************************************/
+void SOFT_start( SOFT_Data* Ptr, uint32_t RampMs, uint32_t UpdatePeriodNs )
+{
+    uint32_t Steps = RampMs * 1000000L / UpdatePeriodNs;
+
+    SOFT_go( Ptr, Steps ? SOFT_PHASE_END / Steps : SOFT_PHASE_END );
+}
+
+
+/******************************************************************************
+* FUNCTION      : SOFT_restart
+* DESCRIPTION   :
+* Starts the ramp up again at the rate last given to SOFT_start(), e.g. after
+* a fault.
+******************************************************************************/
+void SOFT_restart( SOFT_Data* Ptr )
+{
+    SOFT_go( Ptr, Ptr->m_Inc );
+}
+
+
+/******************************************************************************
+* FUNCTION      : SOFT_direction
+* DESCRIPTION   :
+* Ramps the reference up to the target if PowerUp is true, otherwise down to
+* zero, from wherever it is. Call it from the control ISR, or with the
+* interrupts off.
+******************************************************************************/
+void SOFT_direction( SOFT_Data* Ptr, int PowerUp )
+{
+    Ptr->m_Up     = PowerUp;
+    Ptr->m_Active = true;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SOFT_step
+* DESCRIPTION   :
+* One step along the ramp, called by SOFT_update(). At either end it writes
+* the end value and retires.
+******************************************************************************/
+void SOFT_step( SOFT_Data* Ptr )
+{
+    CNTRL_2p2zData* Cntrl = Ptr->m_Cntrl;
+    uint32_t Phase = Ptr->m_Phase;
+    long     Level;
+    int      Ref;
+
+    if( Ptr->m_Up )
+    {
+        Phase += Ptr->m_Inc;
+        if( Phase < Ptr->m_Inc )
+        {
+            Phase = SOFT_PHASE_END;
+        }
+    }
+    else
+    {
+        Phase = Phase > Ptr->m_Inc ? Phase - Ptr->m_Inc : 0;
+    }
+    Ptr->m_Phase = Phase;
+
+    if( Phase == SOFT_PHASE_END )
+    {
+        Level = SOFT_LEVEL_ONE;
+        Ptr->m_Active = false;
+    }
+    else if( Phase == 0 )
+    {
+        Level = 0;
+        Ptr->m_Active = false;
+    }
+    else
+    {
+        Level = SOFT_level( Ptr, Phase );
+    }
+
+    Ref = (int)((Ptr->m_Target * Level) >> 15);
+    Ptr->m_Level     = Level;
+    Cntrl->Ref.m_Int = Ref;
+    Cntrl->m_SoftRef = (long)Ref << 16;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SOFT_level
+* DESCRIPTION   :
+* The level at Phase, short of the end, Q15.
+******************************************************************************/
+static long SOFT_level( const SOFT_Data* Ptr, uint32_t Phase )
+{
+    int  X = (int)(Phase >> 17);        /* 0 to 1, Q15 */
+    long Y = X;
+
+    /* One rounding per half keeps it rising, which a cubic would not */
+    if( Ptr->m_Profile == SOFT_SCURVE )
+    {
+        if( X < 16384 )
+        {
+            Y = ((long)X * X) >> 14;
+        }
+        else
+        {
+            X = (int)(32768L - X);
+            Y = 32768L - (((long)X * X) >> 14);
+        }
+    }
+    return Y;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SOFT_phaseOf
+* DESCRIPTION   :
+* The phase whose reference is the highest not above Vout, the start of a
+* pre-biased ramp. A binary search, as the profile is rising.
+******************************************************************************/
+static uint32_t SOFT_phaseOf( const SOFT_Data* Ptr, int Vout )
+{
+    uint32_t Phase = 0;
+    uint32_t Bit;
+
+    if( Vout <= 0 )
+    {
+        return 0;
+    }
+    if( Vout >= Ptr->m_Target )
+    {
+        return SOFT_PHASE_END;
+    }
+
+    /* SOFT_level() only looks at the top 15 bits */
+    for( Bit = 1UL << 31; Bit >= 1UL << 17; Bit >>= 1 )
+    {
+        if( ((Ptr->m_Target * SOFT_level( Ptr, Phase | Bit )) >> 15) <= Vout )
+        {
+            Phase |= Bit;
+        }
+    }
+    return Phase;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SOFT_go
+* DESCRIPTION   :
+* Sets the ramp going up at Inc from the pre-biased start, or from zero.
+******************************************************************************/
+static void SOFT_go( SOFT_Data* Ptr, uint32_t Inc )
+{
+    CNTRL_2p2zData* Cntrl = Ptr->m_Cntrl;
+    uint32_t Phase = 0;
+    long     Level = 0;
+    uint16_t St;
+
+    if( Ptr->m_pVout )
+    {
+        Phase = SOFT_phaseOf( Ptr, (int)*Ptr->m_pVout );
+        Level = Phase == SOFT_PHASE_END ? SOFT_LEVEL_ONE :
+                                          SOFT_level( Ptr, Phase );
+    }
+
+    St = __disable_interrupts();
+
+    Ptr->m_Inc       = Inc;
+    Ptr->m_Phase     = Phase;
+    Ptr->m_Level     = Level;
+    Ptr->m_Up        = true;
+    Ptr->m_Active    = true;
+    Cntrl->Ref.m_Int = (int)((Ptr->m_Target * Level) >> 15);
+    Cntrl->m_SoftMax = (long)Ptr->m_Target << 16;
+    Cntrl->m_SoftRef = (long)Cntrl->Ref.m_Int << 16;
+
+    __restore_interrupts( St );
+}
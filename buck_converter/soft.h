@@ -0,0 +1,136 @@
+/*******************************************************************************
+* FILE          : soft.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Soft-start of the controller reference that retires once it is up.
+*
+* CNTRL_2p2zSoftStartUpdate() is a call and a ramp step on every control
+* cycle for good, about 23 cycles, long after the reference has reached its
+* target. Here SOFT_update() is a macro that tests m_Active and only calls
+* SOFT_step() while the ramp moves; SOFT_step() clears m_Active as it writes
+* the end value, after which the soft-start costs the test alone, about 4
+* cycles. SOFT_direction() sets it going again, up to the target or down to
+* zero from wherever it is.
+*
+* The position along the ramp is a 32 bit phase, from 0 at zero to
+* SOFT_PHASE_END at the target, stepped by m_Inc per update, so that a ramp
+* from zero to the target takes the time given to SOFT_start(). The phase
+* maps to the reference through the profile:
+*
+*   SOFT_LINEAR     a straight ramp, as CNTRL_2p2zSoftStartConfig()
+*   SOFT_SCURVE     2x^2 of the phase x up to half way and 1 - 2(1-x)^2
+*                   after it, which starts and ends with no slope: the
+*                   charging current of the output capacitor rises and falls
+*                   smoothly instead of stepping, for less inrush at the
+*                   start and less overshoot at the end, at a peak slope of
+*                   twice the straight ramp half way
+*
+* Given a Vout sample, e.g. the ADC result register, the ramp is pre-biased:
+* SOFT_start() and SOFT_restart() start it at the phase whose reference is
+* just under the output as it is, found by a binary search on the profile, so
+* a charged output is neither pulled down nor stepped up, and the time left
+* is the time from there. Without it the ramp starts at zero.
+*
+* The reference along the ramp is written to Ref of the controller with each
+* step, and the ramp itself is kept as m_Level, from 0 to SOFT_LEVEL_ONE, for
+* those that set their own reference, e.g. PMB_update(). The controller's
+* m_SoftRef and m_SoftMax follow, shifted up by 16 as the CSL keeps them, so
+* that m_SoftRef == m_SoftMax still means the reference is up; m_SoftRamp is
+* left at 0 so that the CSL soft-start functions leave it alone.
+*
+*   SOFT_update()   ~4 cycles       in the control ISR, once up or down
+*                   ~35 cycles      while ramping, ~45 with SOFT_SCURVE
+*   SOFT_start()    ~150 cycles     in the idle loop, ~800 pre-biased,
+*                                   ~20 of them with the interrupts off
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+*
+* EXAMPLES
+*   SOFT_Data MySoft;
+*
+*   CNTRL_2p2zInit( &MyCntrl, _IQ15(REF), ... );
+*   SOFT_init( &MySoft, &MyCntrl, SOFT_SCURVE, &AdcResult.ADCRESULT0 );
+*   SOFT_start( &MySoft, 500, PERIOD_NS );              // 500ms
+*
+*   interrupt void IsrAdc( void )
+*   {
+*       ...
+*       SOFT_update( &MySoft );
+*   }
+*
+*   SOFT_direction( &MySoft, false );                   // ramp down, ints off
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _SOFT_H
+#define _SOFT_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  SOFT_Data       SOFT_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+#define SOFT_PHASE_END  0xFFFFFFFFUL    /* phase at the target */
+#define SOFT_LEVEL_ONE  32768L          /* m_Level at the target, Q15 */
+
+/*******************************************************************************
+* ENUM          : SOFT_Profile
+* DESCRIPTION   :
+* The shape of the ramp.
+*******************************************************************************/
+typedef enum
+{
+    SOFT_LINEAR = 0,
+    SOFT_SCURVE
+} SOFT_Profile;
+
+/*******************************************************************************
+* STRUCT        : SOFT_Data
+* DESCRIPTION   :
+* The soft-start structure.
+*******************************************************************************/
+struct SOFT_Data
+{
+    /* read every cycle by SOFT_update() */
+    volatile int        m_Active;       /* the ramp moves, SOFT_step() runs */
+
+    CNTRL_2p2zData*     m_Cntrl;
+    int                 m_Profile;      /* SOFT_Profile */
+    int                 m_Target;       /* nominal reference, ADC counts */
+    const volatile uint16_t* m_pVout;   /* pre-bias sample, 0 for none */
+    uint32_t            m_Inc;          /* phase per update */
+    uint32_t            m_Phase;        /* 0 at zero, SOFT_PHASE_END up */
+    volatile int        m_Up;           /* towards the target, else zero */
+    volatile long       m_Level;        /* along the ramp, Q15 */
+};
+
+
+/*******************************************************************************
+* MACRO         : SOFT_update
+* DESCRIPTION   :
+* Moves the reference one step along the ramp, if it is moving. Call it once
+* per control cycle in the control ISR.
+*******************************************************************************/
+#define SOFT_update( Ptr )                                                  \
+    do { if( (Ptr)->m_Active ) { SOFT_step( (Ptr) ); } } while( 0 )
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void SOFT_init( SOFT_Data* Ptr, CNTRL_2p2zData* Cntrl,
+                       SOFT_Profile Profile, const volatile uint16_t* pVout );
+extern void SOFT_start( SOFT_Data* Ptr, uint32_t RampMs,
+                        uint32_t UpdatePeriodNs );
+extern void SOFT_restart( SOFT_Data* Ptr );
+extern void SOFT_direction( SOFT_Data* Ptr, int PowerUp );
+extern void SOFT_step( SOFT_Data* Ptr );
+
+/********** END ***************************************************************/
+#endif
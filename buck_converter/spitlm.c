@@ -0,0 +1,185 @@
+/******************************************************************************
+* FILE          : spitlm.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* High rate telemetry over SPI. See spitlm.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "spitlm.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#pragma CODE_SECTION( STLM_sample, "hotfuncs" );
+#pragma CODE_SECTION( STLM_drain, "hotfuncs" );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : STLM_init
+* DESCRIPTION   :
+* Initialises the SPI telemetry with no channels. Call it after
+* SPI_setTxCallback(); the Tx interrupt is turned off until the first block
+* is ready.
+******************************************************************************/
+void STLM_init( STLM_Data* Ptr, SPI_Module Spi, int Decimate )
+{
+    Ptr->m_Run       = false;
+    Ptr->m_Busy      = false;
+    Ptr->m_Channels  = 0;
+    Ptr->m_Length    = 1;
+    Ptr->m_Decimate  = Decimate;
+    Ptr->m_Countdown = Decimate;
+    Ptr->m_Seq       = 0;
+    Ptr->m_Blocks    = 0;
+    Ptr->m_Dropped   = 0;
+    Ptr->m_Spi       = Spi;
+    STLM_enableTxInt( Spi, false );
+}
+
+
+/******************************************************************************
+* FUNCTION      : STLM_addChannel
+* DESCRIPTION   :
+* Adds the value at Value to every sample and returns its channel number, or
+* -1 if there are already STLM_MAX_CHANNELS or telemetry is running. The block
+* length is the largest number of whole samples that fits in STLM_BLOCK.
+******************************************************************************/
+int STLM_addChannel( STLM_Data* Ptr, const volatile int* Value )
+{
+    int Channels = Ptr->m_Channels;
+
+    if( Ptr->m_Run || Channels == STLM_MAX_CHANNELS )
+    {
+        return -1;
+    }
+    Ptr->m_pChan[Channels] = Value;
+    Ptr->m_Channels = ++Channels;
+    Ptr->m_Length   = STLM_LENGTH( Channels );
+    return Channels-1;
+}
+
+
+/******************************************************************************
+* FUNCTION      : STLM_start
+* DESCRIPTION   :
+* Starts filling the first block.
+******************************************************************************/
+void STLM_start( STLM_Data* Ptr )
+{
+    STLM_stop( Ptr );
+    if( Ptr->m_Channels == 0 )
+    {
+        return;
+    }
+    Ptr->m_Fill      = 0;
+    Ptr->m_Index     = 1;
+    Ptr->m_Buf[0][0] = STLM_SYNC | (Ptr->m_Seq & 0xFF);
+    Ptr->m_Countdown = Ptr->m_Decimate;
+    Ptr->m_Run       = true;
+}
+
+
+/******************************************************************************
+* FUNCTION      : STLM_stop
+* DESCRIPTION   :
+* Stops sampling and abandons the block being sent.
+******************************************************************************/
+void STLM_stop( STLM_Data* Ptr )
+{
+    Ptr->m_Run = false;
+    STLM_enableTxInt( Ptr->m_Spi, false );
+    Ptr->m_Busy = false;
+}
+
+
+/******************************************************************************
+* FUNCTION      : STLM_sample
+* DESCRIPTION   :
+* Called once per control cycle by the control ISR. Every m_Decimate calls
+* the channels are appended to the block being filled. A full block is handed
+* to the drain if it is free, otherwise it is dropped and refilled.
+******************************************************************************/
+void STLM_sample( STLM_Data* Ptr )
+{
+    uint16_t* pWord;
+    int       i;
+
+    if( !Ptr->m_Run || --Ptr->m_Countdown )
+    {
+        return;
+    }
+    Ptr->m_Countdown = Ptr->m_Decimate;
+
+    pWord = &Ptr->m_Buf[Ptr->m_Fill][Ptr->m_Index];
+    for( i = 0; i < Ptr->m_Channels; i++ )
+    {
+        *pWord++ = *Ptr->m_pChan[i];
+    }
+    Ptr->m_Index += Ptr->m_Channels;
+    if( Ptr->m_Index < Ptr->m_Length )
+    {
+        return;
+    }
+
+    /* Block complete */
+    Ptr->m_Index = 1;
+    Ptr->m_Seq++;
+    if( Ptr->m_Busy )
+    {
+        Ptr->m_Dropped++;
+    }
+    else
+    {
+        Ptr->m_pSend = Ptr->m_Buf[Ptr->m_Fill];
+        Ptr->m_Sent  = 0;
+        Ptr->m_Sum   = 0;
+        Ptr->m_Busy  = true;
+        Ptr->m_Fill ^= 1;
+        STLM_enableTxInt( Ptr->m_Spi, true );
+    }
+    Ptr->m_Buf[Ptr->m_Fill][0] = STLM_SYNC | (Ptr->m_Seq & 0xFF);
+}
+
+
+/******************************************************************************
+* FUNCTION      : STLM_drain
+* DESCRIPTION   :
+* Called by the SPI Tx interrupt. Tops the Tx FIFO up from the block being
+* sent and, once all of it and the check word are in the FIFO, frees the
+* buffer and turns the interrupt off. The interrupt is turned off before
+* m_Busy is cleared so that a block completed by a nested control ISR in
+* between is dropped rather than left with the interrupt off.
+******************************************************************************/
+void STLM_drain( STLM_Data* Ptr )
+{
+    const uint16_t* pSend = Ptr->m_pSend;
+    int             Sent  = Ptr->m_Sent;
+    uint16_t        Sum   = Ptr->m_Sum;
+    uint16_t        Word;
+    int             n;
+
+    for( n = STLM_TX_WORDS; n; n-- )
+    {
+        if( Sent == Ptr->m_Length )
+        {
+            SPI_write( Ptr->m_Spi, Sum | STLM_CHECK );
+            STLM_enableTxInt( Ptr->m_Spi, false );
+            Ptr->m_Blocks++;
+            Ptr->m_Busy = false;
+            break;
+        }
+        Word = pSend[Sent++];
+        Sum += Word;
+        SPI_write( Ptr->m_Spi, Word );
+    }
+    Ptr->m_Sent = Sent;
+    Ptr->m_Sum  = Sum;
+}
@@ -0,0 +1,129 @@
+/*******************************************************************************
+* FILE          : spitlm.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* High rate telemetry over SPI with a ping-pong buffer.
+*
+* STLM_sample() is called by the control ISR and writes the channels registered
+* with STLM_addChannel() into one of two block buffers every m_Decimate cycles.
+* When the block is full the buffers swap: the full one is handed to the SPI
+* Tx interrupt and the ISR carries on filling the other. STLM_drain() is the
+* body of the SPI Tx interrupt and writes the block into the 4 deep Tx FIFO,
+* STLM_TX_WORDS words each time the FIFO falls to STLM_TX_LEVEL, so the SPI
+* clocks the block out without gaps. If the ISR fills a block before the
+* previous one has been sent the new block is discarded and counted in
+* m_Dropped.
+*
+* Each block is m_Length 16 bit words, a header of STLM_SYNC in the high byte
+* and an 8 bit block count in the low byte followed by whole samples of all the
+* channels, and is sent followed by a check word, the sum of the block with
+* STLM_CHECK set, which the drain adds up as it goes. spitlm_rx.h reassembles
+* the stream, on the host in tools/spitlm_recv.c or on the target for the
+* SPI_setLoopback() self test.
+*
+* With LSPCLK at 15MHz the fastest SPI clock is 3.75Mbit/s, 234k words/s, so
+* channels x 200kHz / m_Decimate must stay below about 200k words/s to leave
+* time for the interrupt latency between blocks: one channel at full rate or
+* two at half rate. Cost:
+*
+*   STLM_sample()   ~10 cycles   between samples
+*                   ~12 cycles   + 6 per channel, sample
+*                   ~30 cycles   more at the end of a block
+*   STLM_drain()    ~45 cycles   per 3 words, outside the control ISR
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+* The Tx interrupt is in PIE group 6, which is higher priority than the ADC
+* interrupt, so the Tx ISR should allow IsrAdc to nest.
+*
+* EXAMPLES
+*   STLM_Data MySpiTlm;
+*
+*   interrupt void IsrSpiTx( void )
+*   {
+*       STLM_drain( &MySpiTlm );
+*       SPI_ackTxInt( SPI_MOD_1 );
+*   }
+*
+*   SPI_config( SPI_MOD_1, SPI_baudToTicks(3750000), SPI_DO_POS_DI_NEG );
+*   SPI_setTxCallback( SPI_MOD_1, IsrSpiTx, STLM_TX_LEVEL );
+*   STLM_init( &MySpiTlm, SPI_MOD_1, 2 );
+*   STLM_addChannel( &MySpiTlm, &MyCntrl.Fdbk.m_Int );
+*   STLM_addChannel( &MySpiTlm, &MyCntrl.Out.m_Int );
+*   STLM_start( &MySpiTlm );
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _SPITLM_H
+#define _SPITLM_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+#include "spitlm_rx.h"
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  STLM_Data       STLM_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+#define STLM_MAX_CHANNELS   4
+
+/* The Tx interrupt comes when the FIFO holds STLM_TX_LEVEL words and refills
+*  the rest, so one word is still being shifted out while the ISR runs.
+*/
+#define STLM_TX_LEVEL       1
+#define STLM_TX_WORDS       (SPI_FIFO_DEPTH - STLM_TX_LEVEL)
+
+/*******************************************************************************
+* STRUCT        : STLM_Data
+* DESCRIPTION   :
+* The SPI telemetry structure.
+*******************************************************************************/
+struct STLM_Data
+{
+    /* shared between the control ISR and the drain */
+    volatile int        m_Busy;     /* a block is being sent */
+    uint16_t            m_Buf[2][STLM_BLOCK];
+
+    /* control ISR side */
+    volatile int        m_Run;
+    const volatile int* m_pChan[STLM_MAX_CHANNELS];
+    int                 m_Channels;
+    int                 m_Length;       /* words per block */
+    int                 m_Decimate;     /* cycles per sample */
+    int                 m_Countdown;
+    int                 m_Fill;         /* buffer being filled */
+    int                 m_Index;        /* next word in it */
+    uint16_t            m_Seq;
+    uint16_t            m_Blocks;
+    uint16_t            m_Dropped;
+
+    /* drain side */
+    SPI_Module          m_Spi;
+    const uint16_t*     m_pSend;
+    int                 m_Sent;
+    uint16_t            m_Sum;
+};
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void STLM_init( STLM_Data* Ptr, SPI_Module Spi, int Decimate );
+extern int  STLM_addChannel( STLM_Data* Ptr, const volatile int* Value );
+extern void STLM_start( STLM_Data* Ptr );
+extern void STLM_stop( STLM_Data* Ptr );
+extern void STLM_sample( STLM_Data* Ptr );
+extern void STLM_drain( STLM_Data* Ptr );
+
+/*******************************************************************************
+* MACRO         : STLM_enableTxInt
+* DESCRIPTION   :
+* Turns the SPI Tx FIFO interrupt on or off without changing its level. The
+* CSL only sets it in SPI_setTxCallback().
+*******************************************************************************/
+#define STLM_enableTxInt( Spi, Enable )  (Spi)->SPIFFTX.bit.TXFFIENA = (Enable)
+
+/********** END ***************************************************************/
+#endif
@@ -0,0 +1,90 @@
+/******************************************************************************
+* FILE          : spitlm_rx.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Receiver for the SPI telemetry stream. See spitlm_rx.h.
+*
+* Only csl_stdint.h is used so this file can also be built into the host
+* receiver.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl_stdint.h"
+#include "spitlm_rx.h"
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : STLM_rxInit
+* DESCRIPTION   :
+* Initialises the receiver for a stream of Channels channels, hunting for the
+* first header.
+******************************************************************************/
+void STLM_rxInit( STLM_Rx* Ptr, int Channels )
+{
+    Ptr->m_Channels = Channels;
+    Ptr->m_Length   = STLM_LENGTH( Channels );
+    Ptr->m_Index    = 0;
+    Ptr->m_Locked   = 0;
+    Ptr->m_Hunting  = 1;
+    Ptr->m_Seq      = 0;
+    Ptr->m_Blocks   = 0;
+    Ptr->m_Lost     = 0;
+    Ptr->m_Errors   = 0;
+}
+
+
+/******************************************************************************
+* FUNCTION      : STLM_rxWord
+* DESCRIPTION   :
+* Takes the next word of the stream. Returns 1 when it completes a good block.
+******************************************************************************/
+int STLM_rxWord( STLM_Rx* Ptr, uint16_t Word )
+{
+    if( Ptr->m_Index == 0 )
+    {
+        if( (Word & 0xFF00) != STLM_SYNC )
+        {
+            if( !Ptr->m_Hunting )
+            {
+                Ptr->m_Hunting = 1;
+                Ptr->m_Errors++;
+            }
+            return 0;
+        }
+        Ptr->m_Block[0] = Word;
+        Ptr->m_Sum      = Word;
+        Ptr->m_Index    = 1;
+        return 0;
+    }
+
+    if( Ptr->m_Index < Ptr->m_Length )
+    {
+        Ptr->m_Block[Ptr->m_Index++] = Word;
+        Ptr->m_Sum += Word;
+        return 0;
+    }
+
+    /* Check word. The block count is only trusted once it has passed. */
+    Ptr->m_Index = 0;
+    if( Word != (Ptr->m_Sum | STLM_CHECK) )
+    {
+        Ptr->m_Hunting = 1;
+        Ptr->m_Errors++;
+        return 0;
+    }
+    if( Ptr->m_Locked )
+    {
+        Ptr->m_Lost += (Ptr->m_Block[0] - Ptr->m_Seq) & 0xFF;
+    }
+    Ptr->m_Seq     = (Ptr->m_Block[0] + 1) & 0xFF;
+    Ptr->m_Locked  = 1;
+    Ptr->m_Hunting = 0;
+    Ptr->m_Blocks++;
+    return 1;
+}
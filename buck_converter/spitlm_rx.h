@@ -0,0 +1,115 @@
+/*******************************************************************************
+* FILE          : spitlm_rx.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Receiver for the SPI telemetry stream of spitlm.h.
+*
+* STLM_rxWord() is given the stream one 16 bit word at a time and returns true
+* each time a complete block is in m_Block[]. It hunts for a header word, with
+* STLM_SYNC in the high byte, and then takes the next m_Length-1 words as the
+* block followed by the check word, the 15 bit sum of the block with bit 15
+* set so that it can never be taken for a header. A block whose
+* sum does not match is discarded, and so is any word found where a header
+* should be; both are counted in m_Errors and the receiver hunts again. Blocks
+* missing from the 8 bit block count, dropped by the sender or lost to an
+* error, are counted in m_Lost.
+*
+* The file only uses csl_stdint.h so that it builds into the host receiver
+* tools/spitlm_recv.c as well as the target, where it checks the stream in the
+* SPI_setLoopback() self test.
+*
+* EXAMPLES
+*   STLM_Rx MyRx;
+*
+*   STLM_rxInit( &MyRx, 2 );
+*   while( SPI_getRxCount( SPI_MOD_1 ) )
+*   {
+*       if( STLM_rxWord( &MyRx, SPI_read( SPI_MOD_1 ) ) )
+*       {
+*           Fdbk = STLM_rxSample( &MyRx, 0, 0 );
+*       }
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _SPITLM_RX_H
+#define _SPITLM_RX_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  STLM_Rx         STLM_Rx;
+
+/********** TYPES SECTION *****************************************************/
+
+/* Maximum block length in words, including the header */
+#ifndef STLM_BLOCK
+#define STLM_BLOCK      64
+#endif
+
+#define STLM_SYNC       0x5A00  /* high byte of every block header */
+#define STLM_CHECK      0x8000  /* set in every check word */
+
+/*******************************************************************************
+* MACRO         : STLM_LENGTH
+* DESCRIPTION   :
+* Words per block for a number of channels: the header and as many whole
+* samples as fit in STLM_BLOCK. The check word is sent after these.
+*******************************************************************************/
+#define STLM_LENGTH( Channels ) (1 + ((STLM_BLOCK-1) / (Channels)) * (Channels))
+
+/*******************************************************************************
+* STRUCT        : STLM_Rx
+* DESCRIPTION   :
+* The receiver structure.
+*******************************************************************************/
+struct STLM_Rx
+{
+    int         m_Channels;
+    int         m_Length;   /* words per block */
+    int         m_Index;    /* words of m_Block[] received, 0 when hunting */
+    int         m_Locked;   /* m_Seq is valid */
+    int         m_Hunting;  /* error already counted, looking for a header */
+    uint16_t    m_Seq;      /* block count expected next */
+    uint16_t    m_Sum;
+    uint32_t    m_Blocks;   /* good blocks */
+    uint32_t    m_Lost;     /* blocks missing from the count */
+    uint32_t    m_Errors;   /* bad check words and missing headers */
+    uint16_t    m_Block[STLM_BLOCK];
+};
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void STLM_rxInit( STLM_Rx* Ptr, int Channels );
+extern int  STLM_rxWord( STLM_Rx* Ptr, uint16_t Word );
+
+/*******************************************************************************
+* MACRO         : STLM_rxSamples
+* DESCRIPTION   :
+* Number of samples in a block.
+*******************************************************************************/
+#define STLM_rxSamples( Ptr )   (((Ptr)->m_Length-1) / (Ptr)->m_Channels)
+
+/*******************************************************************************
+* MACRO         : STLM_rxSample
+* DESCRIPTION   :
+* Channel Chan of sample N of the last complete block.
+*******************************************************************************/
+#define STLM_rxSample( Ptr, N, Chan ) \
+    ((int16_t)(Ptr)->m_Block[1 + (N)*(Ptr)->m_Channels + (Chan)])
+
+/*******************************************************************************
+* MACRO         : STLM_rxCount
+* DESCRIPTION   :
+* The 8 bit block count of the last complete block.
+*******************************************************************************/
+#define STLM_rxCount( Ptr )     ((Ptr)->m_Block[0] & 0xFF)
+
+/********** END ***************************************************************/
+#endif
@@ -0,0 +1,119 @@
+/******************************************************************************
+* FILE          : stack.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Stack high-water mark and overflow trip. See stack.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "stack.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+/* Set by the linker, as in the CSL */
+#ifndef SYS_STACK_SIZE
+extern uint16_t _stack[];
+extern uint16_t _STACK_SIZE;
+#define SYS_STACK_SIZE  ((uint16_t)(uint32_t)&_STACK_SIZE)
+#endif
+
+static void STK_trip( STK_Data* Ptr );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : STK_init
+* DESCRIPTION   :
+* Call at the top of main(). Marks the stack and takes the high-water mark so
+* far; trips go to the one-shot trip of Flt, which must be initialised before
+* the first STK_process(). Guard is the number of unused words left at which
+* it trips.
+******************************************************************************/
+void STK_init( STK_Data* Ptr, FLT_Data* Flt, int Guard )
+{
+    SYS_setTideMarker();
+
+    /* The mark of the library may differ, the top word is not yet used */
+    Ptr->m_Mark     = _stack[SYS_STACK_SIZE - 1];
+    Ptr->m_Flt      = Flt;
+    Ptr->m_Size     = SYS_STACK_SIZE;
+    Ptr->m_Guard    = Guard;
+    Ptr->m_Next     = 0;
+    Ptr->m_Unused   = SYS_getStackUnused();
+    Ptr->m_Used     = Ptr->m_Size - Ptr->m_Unused;
+    Ptr->m_Sweeps   = 0;
+    Ptr->m_Tripped  = false;
+}
+
+
+/******************************************************************************
+* FUNCTION      : STK_process
+* DESCRIPTION   :
+* Call from the idle loop. Checks the next STK_WORDS_PER_PASS unused words
+* and the top word, and trips once the stack is too full.
+******************************************************************************/
+void STK_process( STK_Data* Ptr )
+{
+    int i;
+
+    if( Ptr->m_Tripped )
+    {
+        return;
+    }
+
+    SYS_checkStack();
+    if( ERR_Value == ERR_SYS_STACK_OVERFLOW )
+    {
+        Ptr->m_Unused = 0;
+        Ptr->m_Used   = Ptr->m_Size;
+        STK_trip( Ptr );
+        return;
+    }
+
+    for( i = 0; i < STK_WORDS_PER_PASS; i++ )
+    {
+        if( Ptr->m_Next >= Ptr->m_Unused )
+        {
+            Ptr->m_Next = 0;
+            Ptr->m_Sweeps++;
+            break;
+        }
+        if( _stack[Ptr->m_Size - 1 - Ptr->m_Next] != Ptr->m_Mark )
+        {
+            /* One above it used since the sweep passed is found next sweep */
+            Ptr->m_Unused = Ptr->m_Next;
+            Ptr->m_Used   = Ptr->m_Size - Ptr->m_Next;
+            Ptr->m_Next   = 0;
+            break;
+        }
+        Ptr->m_Next++;
+    }
+
+    if( Ptr->m_Unused < Ptr->m_Guard )
+    {
+        STK_trip( Ptr );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : STK_trip
+* DESCRIPTION   :
+* Trips the ePWM, for good.
+******************************************************************************/
+static void STK_trip( STK_Data* Ptr )
+{
+    uint16_t St = __disable_interrupts();
+
+    FLT_trip( Ptr->m_Flt, FLT_STACK );
+    Ptr->m_Tripped = true;
+
+    __restore_interrupts( St );
+}
@@ -0,0 +1,90 @@
+/*******************************************************************************
+* FILE          : stack.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Stack high-water mark and overflow trip.
+*
+* .stack shares RAMM with .text in the RAM build, and with the data in the
+* flash build, so running off its end corrupts code or data before anything
+* fails. STK_init() fills the stack above main() with the tide mark of the
+* CSL, SYS_setTideMarker(); the C28x stack grows up, so the words at the top
+* that still hold the mark have never been used.
+*
+* SYS_getStackUnused() counts them in one go, a few thousand cycles for the
+* whole stack. STK_process() instead checks STK_WORDS_PER_PASS words per idle
+* loop pass, sweeping the unused part from the top down; a word found
+* overwritten moves the high-water mark up to it and the sweep starts again
+* from the top. A sweep of the whole 0x200 word stack takes 64 passes, so a
+* new mark is seen within two sweeps. m_Used is the high-water mark in words,
+* the most the stack has held, and m_Unused what is left above it.
+*
+* The top word is also checked on every pass with SYS_checkStack(). Once
+* fewer than m_Guard words are left, or the top word is used, the ePWM is
+* tripped through FLT_trip() with FLT_STACK and m_Tripped stops the checks.
+* FLT_clear() would let the ePWM go again, but the stack is still too small.
+*
+*   STK_process()   ~60 cycles      in the idle loop
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+*
+* EXAMPLES
+*   STK_Data MyStk;
+*
+*   void main( void )
+*   {
+*       SYS_init();
+*       STK_init( &MyStk, &MyFlt, 32 );
+*       ...
+*       while(1)
+*       {
+*           STK_process( &MyStk );
+*       }
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _STACK_H
+#define _STACK_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+#include "fault.h"
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  STK_Data        STK_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+#define STK_WORDS_PER_PASS  8   /* words checked by STK_process() */
+
+/*******************************************************************************
+* STRUCT        : STK_Data
+* DESCRIPTION   :
+* The stack monitor structure.
+*******************************************************************************/
+struct STK_Data
+{
+    FLT_Data*           m_Flt;
+    uint16_t            m_Mark;         /* the tide mark, as read back */
+    int                 m_Size;         /* words */
+    int                 m_Guard;        /* words left that trip */
+    int                 m_Next;         /* depth from the top, next check */
+
+    volatile int        m_Unused;       /* words never used */
+    volatile int        m_Used;         /* high-water mark, words */
+    volatile uint16_t   m_Sweeps;       /* sweeps of the unused words */
+    volatile int        m_Tripped;
+};
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void STK_init( STK_Data* Ptr, FLT_Data* Flt, int Guard );
+extern void STK_process( STK_Data* Ptr );
+
+/********** END ***************************************************************/
+#endif
@@ -0,0 +1,156 @@
+/******************************************************************************
+* FILE          : sup.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Watchdog supervisor. See sup.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "sup.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#define SUP_WDCR_FLAG       0x0080  /* WDFLAG, reset by the watchdog */
+#define SUP_WDCR_KEEP       0x0040  /* WDDIS */
+#define SUP_WDCR_CHECK      0x0028  /* WDCHK must be written as 101 */
+#define SUP_WDCR_PS1        0x0001  /* WDPS, OSCCLK/512 */
+
+static void SUP_violate( SUP_Data* Ptr, SUP_Cause Cause );
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : SUP_init
+* DESCRIPTION   :
+* Starts watching the control ISR only; trips go to the one-shot trip of Flt,
+* which must be initialised first. DeadlineUs is the longest time without a
+* beat, from 1 to about 6.5ms. Call after WDG_config(): it sets the watchdog
+* prescaler, which WDG_config() leaves at /4, to /1, and reads and clears the
+* watchdog reset flag.
+******************************************************************************/
+void SUP_init( SUP_Data* Ptr, FLT_Data* Flt, uint16_t DeadlineUs )
+{
+    uint16_t Wdcr = SysCtrlRegs.WDCR;
+    uint32_t Counts;
+
+    Ptr->m_WdReset = (Wdcr & SUP_WDCR_FLAG) != 0;
+    EALLOW;
+    SysCtrlRegs.WDCR = (Wdcr & SUP_WDCR_KEEP) | SUP_WDCR_CHECK |
+                       SUP_WDCR_FLAG | SUP_WDCR_PS1;
+    EDIS;
+
+    /* The count may be just about to step at the kick, so one more */
+    Counts = ((uint32_t)DeadlineUs * 1000L + SUP_WD_NS - 1) / SUP_WD_NS + 1;
+    if( Counts > SUP_DEADLINE_MAX )
+    {
+        Counts = SUP_DEADLINE_MAX;
+    }
+
+    Ptr->m_Flt      = Flt;
+    Ptr->m_Deadline = (uint16_t)Counts;
+    Ptr->m_ClaMask  = 0;
+    Ptr->m_IsrSeen  = Ptr->m_IsrBeat;
+    Ptr->m_Missed   = Ptr->m_IsrBeat - Ptr->m_ClaBeat;
+    Ptr->m_Cause    = SUP_OK;
+    Ptr->m_Kicks    = 0;
+    Ptr->m_LateMax  = 0;
+}
+
+
+/******************************************************************************
+* FUNCTION      : SUP_watchCla
+* DESCRIPTION   :
+* Also watches CLA task Mod, which must run during every control cycle and
+* still be running when the control ISR calls SUP_beat().
+******************************************************************************/
+void SUP_watchCla( SUP_Data* Ptr, CLA_Module Mod )
+{
+    uint16_t St = __disable_interrupts();
+
+    Ptr->m_ClaMask  = 1 << Mod;
+    Ptr->m_Missed   = Ptr->m_IsrBeat - Ptr->m_ClaBeat;
+
+    __restore_interrupts( St );
+}
+
+
+/******************************************************************************
+* FUNCTION      : SUP_process
+* DESCRIPTION   :
+* Call from the idle loop. Checks the beats since the last call, kicks the
+* watchdog once the ISR has beaten and trips the ePWM on a violation, after
+* which it never kicks again.
+******************************************************************************/
+void SUP_process( SUP_Data* Ptr )
+{
+    uint16_t  Isr;
+    uint16_t  Missed;
+    uint16_t  Count;
+    uint16_t  St;
+
+    if( Ptr->m_Cause != SUP_OK )
+    {
+        return;
+    }
+
+    /* SUP_beat() increments the two together */
+    St     = __disable_interrupts();
+    Isr    = Ptr->m_IsrBeat;
+    Missed = Isr - Ptr->m_ClaBeat;
+    __restore_interrupts( St );
+
+    if( Ptr->m_ClaMask )
+    {
+        /* A stuck task leaves its next trigger waiting */
+        if( Missed != Ptr->m_Missed )
+        {
+            SUP_violate( Ptr, (Cla1Regs.MIFR.all & Ptr->m_ClaMask) ?
+                              SUP_CLA_STUCK : SUP_CLA_MISSED );
+            return;
+        }
+        if( Cla1Regs.MIOVF.all & Ptr->m_ClaMask )
+        {
+            SUP_violate( Ptr, SUP_CLA_OVERRUN );
+            return;
+        }
+    }
+
+    Count = SysCtrlRegs.WDCNTR;
+    if( Isr != Ptr->m_IsrSeen )
+    {
+        WDG_kick();
+        Ptr->m_IsrSeen = Isr;
+        Ptr->m_Kicks++;
+        if( Count > Ptr->m_LateMax )
+        {
+            Ptr->m_LateMax = Count;
+        }
+    }
+    else if( Count >= Ptr->m_Deadline )
+    {
+        SUP_violate( Ptr, SUP_ISR_LATE );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : SUP_violate
+* DESCRIPTION   :
+* Trips the ePWM and stops the kicks, the watchdog resets the device.
+******************************************************************************/
+static void SUP_violate( SUP_Data* Ptr, SUP_Cause Cause )
+{
+    uint16_t St = __disable_interrupts();
+
+    FLT_trip( Ptr->m_Flt, FLT_WATCHDOG );
+    Ptr->m_Cause = Cause;
+
+    __restore_interrupts( St );
+}
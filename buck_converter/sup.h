@@ -0,0 +1,152 @@
+/*******************************************************************************
+* FILE          : sup.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Watchdog supervisor: the idle loop kicks the watchdog only while the control
+* ISR and the CLA slope task keep their beat.
+*
+* Kicking the watchdog from the idle loop alone only shows that the idle loop
+* runs. A control ISR that no longer fires, or a CLA task that runs away or
+* stops, leaves the idle loop running and the ePWM at whatever state it froze
+* in. Two heartbeat counters are kept instead, both by SUP_beat() in the
+* control ISR:
+*
+*   m_IsrBeat   incremented every control cycle
+*   m_ClaBeat   incremented when the ISR finds the CLA task running, MIRUN,
+*               with no trigger of it waiting, MIFR
+*
+* SUP_process() in the idle loop compares them with what it saw last. A cycle
+* with the ISR but without the task is a missed slope at once; so is an
+* overrun of the task trigger, MIOVF. A task that started but never ended is
+* still running at the next trigger, which then waits in MIFR, so it is a
+* missed beat in the very next cycle. Nothing is read from or written to the
+* PIE. The watchdog is kicked once the ISR has beaten since the last kick.
+*
+* The beat relies on the task running when SUP_beat() reads MIRUN. The slope
+* task is triggered at the start of the 5us period, starts about 0.3us later
+* and ends after its 80 steps of 50ns, at about 4.3us. SUP_beat() in IsrAdc
+* comes at about 3.4us, so the read has about 0.9us, 54 cycles, to the end of
+* SlopeTask and 3.1us to its start. Code added before SUP_beat() in IsrAdc, a
+* later ADC trigger or fewer steps in the task eat into the 0.9us: keep
+* SUP_beat() before the control law, and with fewer steps check that the task
+* still ends after it.
+*
+* The watchdog counter, WDCNTR, counts the time since the last kick in steps
+* of 512 OSCCLK, 51.2us at 10MHz, with the prescaler at /1 as SUP_init() sets
+* it. Once it reaches m_Deadline without a kick the beat is late. On a late or
+* missed beat the supervisor trips the ePWM through FLT_trip() with
+* FLT_WATCHDOG, keeps the cause in m_Cause and stops kicking, and the watchdog
+* resets the device about 13ms after the last kick. A trigger still waiting in
+* MIFR tells a task stuck in a loop from one that was not triggered. A long
+* step in the idle loop is not a violation: the beats carry on meanwhile and
+* the next SUP_process() kicks, as long as it comes within the 13ms.
+*
+* An ISR that never returns stops the idle loop too. Nothing trips the ePWM
+* then, but nothing kicks either and the reset, which returns the ePWM pins
+* to inputs, comes within 13ms. m_WdReset records a reset by the watchdog.
+*
+*   SUP_beat()      ~10 cycles      in the control ISR
+*   SUP_process()   ~30 cycles      in the idle loop
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+*
+* EXAMPLES
+*   SUP_Data MySup;
+*
+*   WDG_config( WDG_RESET, 0 );
+*   SUP_init( &MySup, &MyFlt, 200 );            // 200us deadline
+*   SUP_watchCla( &MySup, CLA_MOD_1 );
+*
+*   interrupt void IsrAdc( void )
+*   {
+*       ...
+*       SUP_beat( &MySup );
+*   }
+*
+*   while(1)
+*   {
+*       SUP_process( &MySup );
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _SUP_H
+#define _SUP_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+#include "fault.h"
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  SUP_Data        SUP_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+#define SUP_WD_NS           51200   /* a watchdog count, 512 OSCCLK */
+#define SUP_DEADLINE_MAX    128     /* counts, half the watchdog timeout */
+
+/*******************************************************************************
+* ENUM          : SUP_Cause
+* DESCRIPTION   :
+* Why the supervisor stopped kicking the watchdog.
+*******************************************************************************/
+typedef enum
+{
+    SUP_OK = 0,
+    SUP_ISR_LATE,       /* no control ISR within the deadline */
+    SUP_CLA_MISSED,     /* a control cycle without the CLA task */
+    SUP_CLA_OVERRUN,    /* the task was triggered again before it started */
+    SUP_CLA_STUCK       /* a missed cycle, the task has not ended */
+} SUP_Cause;
+
+/*******************************************************************************
+* STRUCT        : SUP_Data
+* DESCRIPTION   :
+* The supervisor structure.
+*******************************************************************************/
+struct SUP_Data
+{
+    /* written every cycle by SUP_beat() */
+    volatile uint16_t   m_IsrBeat;
+    volatile uint16_t   m_ClaBeat;
+    uint16_t            m_ClaMask;      /* MIRUN bit of the task, 0 none */
+
+    FLT_Data*           m_Flt;
+    uint16_t            m_Deadline;     /* watchdog counts */
+    uint16_t            m_IsrSeen;      /* m_IsrBeat at the last kick */
+    uint16_t            m_Missed;       /* m_IsrBeat - m_ClaBeat, the same */
+
+    volatile int        m_Cause;        /* SUP_Cause, SUP_OK while kicking */
+    volatile uint16_t   m_Kicks;
+    volatile uint16_t   m_LateMax;      /* largest WDCNTR at a kick */
+    int                 m_WdReset;      /* the last reset was the watchdog */
+};
+
+
+/*******************************************************************************
+* MACRO         : SUP_beat
+* DESCRIPTION   :
+* The heartbeats. Call it once per control cycle in the control ISR, while
+* the CLA task watched runs.
+*******************************************************************************/
+#define SUP_beat( Ptr )                                                     \
+    do                                                                      \
+    {                                                                       \
+        (Ptr)->m_IsrBeat++;                                                 \
+        if( Cla1Regs.MIRUN.all & ~Cla1Regs.MIFR.all & (Ptr)->m_ClaMask )    \
+            { (Ptr)->m_ClaBeat++; }                                         \
+    } while( 0 )
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void SUP_init( SUP_Data* Ptr, FLT_Data* Flt, uint16_t DeadlineUs );
+extern void SUP_watchCla( SUP_Data* Ptr, CLA_Module Mod );
+extern void SUP_process( SUP_Data* Ptr );
+
+/********** END ***************************************************************/
+#endif
@@ -0,0 +1,263 @@
+/******************************************************************************
+* FILE          : telem.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Per-cycle telemetry capture and UART drain. See telem.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+#include "telem.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#pragma CODE_SECTION( TLM_sample, "hotfuncs" );
+#pragma CODE_SECTION( TLM_drain, "hotfuncs" );
+
+#define TLM_MASK    (TLM_BUF_SIZE-1)
+
+#if (TLM_BUF_SIZE & TLM_MASK)
+#error TLM_BUF_SIZE must be a power of two
+#endif
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : TLM_init
+* DESCRIPTION   :
+* Initialises the telemetry with no channels and nothing recorded. Call it
+* after UART_setTxCallback(), which it overrides by turning the Tx interrupt
+* off until there is something to send.
+******************************************************************************/
+void TLM_init( TLM_Data* Ptr, UART_Module Uart, int Decimate )
+{
+    Ptr->m_State     = TLM_OFF;
+    Ptr->m_Head      = 0;
+    Ptr->m_Tail      = 0;
+    Ptr->m_Channels  = 0;
+    Ptr->m_Decimate  = Decimate;
+    Ptr->m_Countdown = Decimate;
+    Ptr->m_Seq       = 0;
+    Ptr->m_Dropped   = 0;
+    Ptr->m_Uart      = Uart;
+    Ptr->m_HighByte  = 0;
+    Ptr->m_TxIdle    = true;
+    UART_enableTxInt( Uart, false );
+}
+
+
+/******************************************************************************
+* FUNCTION      : TLM_addChannel
+* DESCRIPTION   :
+* Adds the value at Value to every record and returns its channel number, or
+* -1 if there are already TLM_MAX_CHANNELS or telemetry is running. Channel 0
+* is the one used by the trigger.
+******************************************************************************/
+int TLM_addChannel( TLM_Data* Ptr, const volatile int* Value )
+{
+    if( Ptr->m_State != TLM_OFF || Ptr->m_Channels == TLM_MAX_CHANNELS )
+    {
+        return -1;
+    }
+    Ptr->m_pChan[Ptr->m_Channels] = Value;
+    return Ptr->m_Channels++;
+}
+
+
+/******************************************************************************
+* FUNCTION      : TLM_stop
+* DESCRIPTION   :
+* Stops recording and discards anything not yet sent. The Tx interrupt is
+* turned off first so the drain cannot run while the ring is emptied.
+******************************************************************************/
+void TLM_stop( TLM_Data* Ptr )
+{
+    Ptr->m_State = TLM_OFF;
+    UART_enableTxInt( Ptr->m_Uart, false );
+    Ptr->m_TxIdle   = true;
+    Ptr->m_HighByte = 0;
+    Ptr->m_Tail     = Ptr->m_Head;
+}
+
+
+/******************************************************************************
+* FUNCTION      : TLM_stream
+* DESCRIPTION   :
+* Starts sending one record every m_Decimate cycles.
+******************************************************************************/
+void TLM_stream( TLM_Data* Ptr )
+{
+    TLM_stop( Ptr );
+    Ptr->m_Countdown = Ptr->m_Decimate;
+    Ptr->m_State     = TLM_STREAM;
+}
+
+
+/******************************************************************************
+* FUNCTION      : TLM_arm
+* DESCRIPTION   :
+* Starts a triggered capture of Pre records before and Post records after
+* channel 0 crosses Level in the direction Edge. The record in which the
+* crossing is seen is the first of the Post records. Returns false, and
+* leaves telemetry stopped, if there are no channels or the capture does not
+* fit in the ring.
+******************************************************************************/
+int TLM_arm( TLM_Data* Ptr, int Level, TLM_Edge Edge, uint16_t Pre,
+             uint16_t Post )
+{
+    uint32_t Words = (uint32_t)(Pre + Post) * (Ptr->m_Channels + 1);
+
+    TLM_stop( Ptr );
+    if( Ptr->m_Channels == 0 || Post == 0 || Words > TLM_MASK )
+    {
+        return false;
+    }
+
+    Ptr->m_Level     = Level;
+    Ptr->m_Edge      = Edge;
+    Ptr->m_Pre       = Pre;
+    Ptr->m_Post      = Post;
+    Ptr->m_Count     = 0;
+    Ptr->m_Prev      = *Ptr->m_pChan[0];
+    Ptr->m_Countdown = Ptr->m_Decimate;
+    Ptr->m_State     = TLM_ARMED;
+    return true;
+}
+
+
+/******************************************************************************
+* FUNCTION      : TLM_sample
+* DESCRIPTION   :
+* Called once per control cycle by the control ISR. Every m_Decimate calls a
+* record is appended to the ring and, depending on the mode, the drain is
+* started or the trigger is checked.
+******************************************************************************/
+void TLM_sample( TLM_Data* Ptr )
+{
+    uint16_t Head;
+    int      Value;
+    int      i;
+
+    if( Ptr->m_State == TLM_OFF || Ptr->m_State == TLM_HOLD )
+    {
+        return;
+    }
+    if( --Ptr->m_Countdown )
+    {
+        return;
+    }
+    Ptr->m_Countdown = Ptr->m_Decimate;
+
+    /* When streaming the drain owns everything from m_Tail to m_Head */
+    Head = Ptr->m_Head;
+    if( Ptr->m_State == TLM_STREAM &&
+        ((Ptr->m_Tail - Head - 1) & TLM_MASK) <= Ptr->m_Channels )
+    {
+        Ptr->m_Dropped++;
+        Ptr->m_Seq++;
+        return;
+    }
+
+    Ptr->m_Buf[Head] = TLM_SYNC | (Ptr->m_Seq++ & 0xFF);
+    Head = (Head+1) & TLM_MASK;
+    for( i = 0; i < Ptr->m_Channels; i++ )
+    {
+        Ptr->m_Buf[Head] = *Ptr->m_pChan[i];
+        Head = (Head+1) & TLM_MASK;
+    }
+    Ptr->m_Head = Head;
+
+    if( Ptr->m_State == TLM_STREAM )
+    {
+        if( Ptr->m_TxIdle )
+        {
+            Ptr->m_TxIdle = false;
+            UART_enableTxInt( Ptr->m_Uart, true );
+        }
+        return;
+    }
+
+    if( Ptr->m_State == TLM_ARMED )
+    {
+        Value = *Ptr->m_pChan[0];
+        if( Ptr->m_Count < Ptr->m_Pre )
+        {
+            /* not enough history yet */
+            Ptr->m_Count++;
+        }
+        else if( Ptr->m_Edge == TLM_RISING ?
+                 (Ptr->m_Prev < Ptr->m_Level && Value >= Ptr->m_Level) :
+                 (Ptr->m_Prev > Ptr->m_Level && Value <= Ptr->m_Level) )
+        {
+            Ptr->m_Count = 0;
+            Ptr->m_State = TLM_POST;
+        }
+        Ptr->m_Prev = Value;
+    }
+
+    if( Ptr->m_State == TLM_POST && ++Ptr->m_Count >= Ptr->m_Post )
+    {
+        /* Freeze the ring and send the capture from its oldest record */
+        Ptr->m_Tail = (Head - (Ptr->m_Pre + Ptr->m_Post) *
+                       (Ptr->m_Channels + 1)) & TLM_MASK;
+        Ptr->m_State  = TLM_HOLD;
+        Ptr->m_TxIdle = false;
+        UART_enableTxInt( Ptr->m_Uart, true );
+    }
+}
+
+
+/******************************************************************************
+* FUNCTION      : TLM_drain
+* DESCRIPTION   :
+* Called by the UART Tx interrupt when the Tx FIFO is empty. Refills the FIFO
+* from the ring and turns the interrupt off when the ring is empty. The
+* control ISR may interrupt this function and add a record, so m_Head is read
+* again after the interrupt has been turned off.
+******************************************************************************/
+void TLM_drain( TLM_Data* Ptr )
+{
+    uint16_t Tail = Ptr->m_Tail;
+    uint16_t Word;
+    int      n;
+
+    for( n = 0; n < UART_FIFO_DEPTH; n++ )
+    {
+        if( Tail == Ptr->m_Head )
+        {
+            UART_enableTxInt( Ptr->m_Uart, false );
+            Ptr->m_TxIdle = true;
+            if( Tail != Ptr->m_Head )
+            {
+                /* a record arrived after the check, keep going */
+                Ptr->m_TxIdle = false;
+                UART_enableTxInt( Ptr->m_Uart, true );
+            }
+            else if( Ptr->m_State == TLM_HOLD )
+            {
+                Ptr->m_State = TLM_OFF;
+            }
+            break;
+        }
+
+        Word = Ptr->m_Buf[Tail];
+        if( Ptr->m_HighByte )
+        {
+            UART_putc( Ptr->m_Uart, Word >> 8 );
+            Ptr->m_HighByte = 0;
+            Tail = (Tail+1) & TLM_MASK;
+        }
+        else
+        {
+            UART_putc( Ptr->m_Uart, Word & 0xFF );
+            Ptr->m_HighByte = 1;
+        }
+    }
+    Ptr->m_Tail = Tail;
+}
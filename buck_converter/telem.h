@@ -0,0 +1,170 @@
+/*******************************************************************************
+* FILE          : telem.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Per-cycle telemetry capture with an interrupt driven UART drain.
+*
+* TLM_sample() is called by the control ISR. Every m_Decimate calls it appends
+* one record to a power of two ring of 16 bit words: a header word followed by
+* the current value of each channel registered with TLM_addChannel(). The
+* header is TLM_SYNC in the high byte and an 8 bit record count in the low byte
+* so a host can find the start of a record and see how many were lost.
+*
+* In TLM_STREAM mode records are sent as they are taken and the ISR drops a
+* record, and counts it in m_Dropped, when the ring is full. TLM_arm() instead
+* records continuously, overwriting the oldest records, until channel 0 crosses
+* m_Level in the chosen direction; m_Post more records are then taken, the
+* ring is frozen with m_Pre records of history before the trigger and the
+* capture is sent once.
+*
+* TLM_drain() is the body of the UART Tx interrupt. It writes the ring straight
+* into the 4 deep Tx FIFO with no intermediate copy, low byte first, and turns
+* the Tx interrupt off when there is nothing left to send; the ISR turns it back
+* on when the next record is complete. The ring has one writer, the ISR, which
+* only moves m_Head, and one reader, the drain, which only moves m_Tail, so no
+* interrupt has to be disabled. Cost in the control ISR:
+*
+*   TLM_sample()    ~10 cycles   between records
+*                   ~40 cycles   record of 3 channels, +5 per extra channel
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+*
+* At 115200 baud the link carries about 5700 words/s, so stream one 4 word
+* record every 200 or more cycles, a 6 word one every 250. Triggered captures
+* are taken at any rate and only sent afterwards.
+*
+* EXAMPLES
+*   TLM_Data MyTlm;
+*
+*   interrupt void IsrAdc( void )
+*   {
+*       ...
+*       CMP_setDac( CMP_MOD_2, MyCntrl.Out.m_Int );
+*       TLM_sample( &MyTlm );
+*   }
+*
+*   interrupt void IsrUartTx( void )
+*   {
+*       TLM_drain( &MyTlm );
+*       UART_ackTxInt( UART_MOD_1 );
+*   }
+*
+*   UART_config( UART_MOD_1, GPIO_28, GPIO_29, UART_baudToTicks(115200),
+*                UART_DATA_8, UART_PARITY_NONE, UART_STOP_1 );
+*   UART_setTxCallback( UART_MOD_1, IsrUartTx, 0 );
+*   TLM_init( &MyTlm, UART_MOD_1, 200 );
+*   TLM_addChannel( &MyTlm, &MyCntrl.Fdbk.m_Int );
+*   TLM_addChannel( &MyTlm, &MyCntrl.Out.m_Int );
+*   TLM_stream( &MyTlm );
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _TELEM_H
+#define _TELEM_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  TLM_Data        TLM_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+/* Ring buffer size in words, must be a power of two */
+#ifndef TLM_BUF_SIZE
+#define TLM_BUF_SIZE    512
+#endif
+
+#define TLM_MAX_CHANNELS    5
+#define TLM_SYNC            0xA500  /* high byte of every record header */
+
+/*******************************************************************************
+* ENUM          : TLM_State
+* DESCRIPTION   :
+* TLM_OFF, TLM_STREAM and TLM_ARMED are set by the idle loop, TLM_POST and
+* TLM_HOLD by the ISR and TLM_OFF again by the drain when a capture is sent.
+*******************************************************************************/
+typedef enum
+{
+    TLM_OFF = 0,        /* nothing recorded */
+    TLM_STREAM,         /* records sent as they are taken */
+    TLM_ARMED,          /* recording history, waiting for the trigger */
+    TLM_POST,           /* triggered, recording m_Post more records */
+    TLM_HOLD            /* capture frozen and being sent */
+} TLM_State;
+
+/*******************************************************************************
+* ENUM          : TLM_Edge
+* DESCRIPTION   :
+*******************************************************************************/
+typedef enum
+{
+    TLM_RISING = 0,     /* channel 0 goes from below to at or above m_Level */
+    TLM_FALLING         /* channel 0 goes from above to at or below m_Level */
+} TLM_Edge;
+
+/*******************************************************************************
+* STRUCT        : TLM_Data
+* DESCRIPTION   :
+* The telemetry structure.
+*******************************************************************************/
+struct TLM_Data
+{
+    /* shared between the control ISR and the drain */
+    volatile int        m_State;
+    volatile uint16_t   m_Head;
+    volatile uint16_t   m_Tail;
+    volatile int        m_TxIdle;   /* drain has turned the Tx interrupt off */
+    uint16_t            m_Buf[TLM_BUF_SIZE];
+
+    /* control ISR side */
+    const volatile int* m_pChan[TLM_MAX_CHANNELS];
+    int                 m_Channels;
+    int                 m_Decimate;     /* cycles per record */
+    int                 m_Countdown;
+    uint16_t            m_Seq;
+    uint16_t            m_Dropped;
+    int                 m_Level;
+    int                 m_Edge;
+    int                 m_Prev;         /* channel 0 in the last record */
+    uint16_t            m_Pre;          /* records kept before the trigger */
+    uint16_t            m_Post;         /* records taken after the trigger */
+    uint16_t            m_Count;
+
+    /* drain side */
+    UART_Module         m_Uart;
+    int                 m_HighByte;     /* next byte is the high byte */
+};
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void TLM_init( TLM_Data* Ptr, UART_Module Uart, int Decimate );
+extern int  TLM_addChannel( TLM_Data* Ptr, const volatile int* Value );
+extern void TLM_stream( TLM_Data* Ptr );
+extern int  TLM_arm( TLM_Data* Ptr, int Level, TLM_Edge Edge, uint16_t Pre,
+                     uint16_t Post );
+extern void TLM_stop( TLM_Data* Ptr );
+extern void TLM_sample( TLM_Data* Ptr );
+extern void TLM_drain( TLM_Data* Ptr );
+
+/*******************************************************************************
+* MACRO         : TLM_isDone
+* DESCRIPTION   :
+* True when nothing is being recorded or sent.
+*******************************************************************************/
+#define TLM_isDone( Ptr )   ((Ptr)->m_State == TLM_OFF)
+
+/*******************************************************************************
+* MACRO         : TLM_setDecimate
+* DESCRIPTION   :
+* Changes the number of control cycles per record.
+*******************************************************************************/
+#define TLM_setDecimate( Ptr, Decimate )    ((Ptr)->m_Decimate = (Decimate))
+
+/********** END ***************************************************************/
+#endif
@@ -0,0 +1,522 @@
+/*******************************************************************************
+* FILE          : acm_sim.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter - host tools
+* DESCRIPTION   :
+* Design and host simulation of the average current mode cascade in acm.c.
+*
+* The inner loop is designed on the duty to sampled current plant, in ADC
+* counts per tick of duty,
+*
+*   Gi(s) = Vin/Ticks . Ki . (1 + sRC)/(s^2.LCR + sL + R)
+*
+* and the outer loop on the current reference to Vo plant, with the inner
+* loop closed, Ti(s), in ADC counts of Vo per ADC count of current,
+*
+*   Gv(s) = Kadc/Ki . R/(1 + sRC) . Ti(s)
+*
+* Both compensators are type II, Kc.(s + wz)/(s.(1 + s/wp)), with the zero a
+* quarter and the pole four times the cross over, or for the 1p1z inner loop a
+* PI, Kc.(s + wz)/s, discretised by the bilinear transform at their own rate,
+* the outer loop's fs/N. Kc puts the cross over where asked. The phase margins
+* are then worked out with the delays of the firmware: for the inner loop the
+* 2.45us from the sample to the CMPA load plus the modulator, D.T; for the
+* outer the cycle before the inner loop takes the reference up plus half the
+* hold of N cycles.
+*
+* The tool then simulates the buck at every ePWM tick, with diode conduction,
+* samples Vo and the inductor current at the ADC trigger, 2.45us before the
+* period ends, quantised with noise, and runs the real ACM_1p1z() or
+* CNTRL_2p2z() for the CPU inner loop, or a model of the float CLA task, and
+* the real ACM_update() and CNTRL_2p2z() for the outer loop. The duty and the
+* reference they set take effect from the next period, as in the firmware.
+* The reference ramps up over T_SOFT, the load steps from -R to -Rstep at
+* T_STEP1 and back at T_STEP2, and a report of both orders at each decimation
+* is printed, followed by the #defines to paste into the example.
+*
+* BUILD
+*   cc -O2 -DCSL_C2803X -DCSL_SOURCE -I host -I ../csl -I .. -o acm_sim \
+*      acm_sim.c ../acm.c ../csl/src/csl_cntrl_Pri.c -lm
+*
+* EXAMPLES
+*   ./acm_sim                         (default power stage, inner on the CLA)
+*   ./acm_sim -cla 0 -fci 8e3 -Rstep 2.2
+*
+* HISTORY       :
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <complex.h>
+
+#include "csl.h"
+#include "acm.h"
+
+/********** DECLARATIONS SECTION **********************************************/
+
+#define TICKS           300         /* ePWM ticks per period */
+#define TICK            (1.0/60e6)  /* s */
+#define SAMPLE_TICK     153         /* ADC trigger, CMPB */
+#define ADC_MAX         4095
+#define DUTY_MAX        180         /* ticks, 60% */
+#define I_MAX           3630        /* ADC counts, about 2.25A */
+#define T_SOFT          2e-3
+#define T_STEP1         4e-3
+#define T_STEP2         7e-3
+#define T_END           10e-3
+#define BAND            0.01        /* of Vo, for the recovery time */
+#define DECIMATIONS     4
+
+/* power stage and design, SI units */
+static double L       = 33e-6;
+static double Cap     = 100e-6;
+static double Rload   = 3.3;
+static double Rstep   = 1.65;
+static double Vin     = 12.0;
+static double Vref    = 3.3;
+static double Fs      = 200e3;
+static double Kadc    = 4095.0/3.3*0.5;   /* ADC counts per volt at Vo */
+static double Ki      = 4095.0/3.3*1.3;   /* ADC counts per amp, 1.3V/A */
+static double Fci     = 15e3;             /* inner cross over */
+static double Fcv     = 4e3;              /* outer cross over, at most */
+static double Noise   = 1.0;              /* ADC counts, uniform +/- */
+static int    Cla     = 1;
+
+static const int Decimations[DECIMATIONS] = { 1, 2, 4, 8 };
+
+/* a 1p1z or 2p2z, z^-1 coefficients as the firmware takes them */
+typedef struct
+{
+    double  A1, A2, B0, B1, B2;
+    double  Fc, Pm;
+} Design;
+
+/* the float CLA task, CLA_2p2zVMode() */
+typedef struct
+{
+    float   Pre, U[2], E[2];
+} ClaModel;
+
+typedef struct
+{
+    double  Err;        /* mean Vo error before the step, V */
+    double  SoftOver;   /* overshoot at the end of the ramp, V */
+    double  Under;      /* at the step up, V */
+    double  TUp;        /* recovery to BAND, s */
+    double  Over;       /* at the step down, V */
+    double  TDown;
+    double  Track;      /* rms inner loop error before the step, A */
+    double  IPeak;      /* highest current sample, A */
+} Result;
+
+
+/********** FUNCTIONS SECTION *************************************************/
+
+/*******************************************************************************
+* FUNCTION      : uniform
+* DESCRIPTION   :
+* Uniform noise in -1..1, fixed seed for repeatability.
+*******************************************************************************/
+static double uniform( void )
+{
+    return 2.0 * rand() / RAND_MAX - 1.0;
+}
+
+/*******************************************************************************
+* FUNCTION      : bilinear
+* DESCRIPTION   :
+* Kc.(s + wz)/s, or with Wp Kc.(s + wz)/(s.(1 + s/wp)), at a period of T.
+*******************************************************************************/
+static void bilinear( Design* D, double Kc, double Wz, double Wp, double T )
+{
+    double c = 2.0 / T;
+
+    if( Wp > 0 )
+    {
+        /* n: Kc.s + Kc.wz   d: s^2/wp + s, times (1 + z^-1)^2 */
+        double n1 = Kc, n0 = Kc*Wz, d2 = 1.0/Wp, d1 = 1.0;
+        double a0 = d2*c*c + d1*c;
+
+        D->B0 = (n1*c + n0) / a0;
+        D->B1 = 2*n0 / a0;
+        D->B2 = (n0 - n1*c) / a0;
+        D->A1 = 2*d2*c*c / a0;
+        D->A2 = -(d2*c*c - d1*c) / a0;
+    }
+    else
+    {
+        D->B0 = Kc*(c + Wz) / c;
+        D->B1 = Kc*(Wz - c) / c;
+        D->B2 = 0;
+        D->A1 = 1.0;
+        D->A2 = 0;
+    }
+}
+
+/*******************************************************************************
+* FUNCTION      : ctrl
+* DESCRIPTION   :
+* The discrete compensator at w, period T.
+*******************************************************************************/
+static double complex ctrl( const Design* D, double W, double T )
+{
+    double complex q = cexp( -I*W*T );
+
+    return (D->B0 + D->B1*q + D->B2*q*q) / (1.0 - D->A1*q - D->A2*q*q);
+}
+
+/*******************************************************************************
+* FUNCTION      : plantI, plantV
+* DESCRIPTION   :
+* Gi and Zout.Kadc/Ki above, at w.
+*******************************************************************************/
+static double complex plantI( double W )
+{
+    double complex s = I*W;
+
+    return Vin/TICKS * Ki * (1.0 + s*Rload*Cap)
+                          / (s*s*L*Cap*Rload + s*L + Rload);
+}
+
+static double complex plantV( double W )
+{
+    double complex s = I*W;
+
+    return Kadc/Ki * Rload / (1.0 + s*Rload*Cap);
+}
+
+/*******************************************************************************
+* FUNCTION      : loopI, loopV
+* DESCRIPTION   :
+* The loop gains with the delays, at w.
+*******************************************************************************/
+static double complex loopI( const Design* Di, double W )
+{
+    double T  = 1.0 / Fs;
+    double Td = (TICKS - SAMPLE_TICK)*TICK + Vref/Vin*T;
+
+    return ctrl( Di, W, T ) * plantI( W ) * cexp( -I*W*Td );
+}
+
+static double complex loopV( const Design* Di, const Design* Dv, int N,
+                             double W )
+{
+    double T  = 1.0 / Fs;
+    double complex Li = loopI( Di, W );
+
+    return ctrl( Dv, W, N*T ) * plantV( W ) * Li/(1.0 + Li)
+         * cexp( -I*W*(T + N*T/2) );
+}
+
+/*******************************************************************************
+* FUNCTION      : margin
+* DESCRIPTION   :
+* The cross over and phase margin of the inner, Dv 0, or outer loop.
+*******************************************************************************/
+static void margin( const Design* Di, const Design* Dv, int N, Design* Out )
+{
+    double F, Last = 0;
+    double complex G;
+
+    for( F = 100.0; F < Fs/2; F *= 1.001 )
+    {
+        G = Dv ? loopV( Di, Dv, N, 2*M_PI*F ) : loopI( Di, 2*M_PI*F );
+        if( cabs( G ) < 1.0 && Last >= 1.0 )
+        {
+            Out->Fc = F;
+            Out->Pm = 180.0 + carg( G )*180.0/M_PI;
+            return;
+        }
+        Last = cabs( G );
+    }
+    Out->Fc = 0;
+    Out->Pm = 0;
+}
+
+/*******************************************************************************
+* FUNCTION      : designI, designV
+* DESCRIPTION   :
+* The inner loop of Order, and the outer loop at a decimation of N.
+*******************************************************************************/
+static void designI( Design* Di, int Order )
+{
+    double Wc = 2*M_PI*Fci;
+    double T  = 1.0 / Fs;
+
+    bilinear( Di, 1.0, Wc/4, Order == 2 ? Wc*4 : 0, T );
+    bilinear( Di, 1.0/cabs( ctrl( Di, Wc, T ) * plantI( Wc ) ), Wc/4,
+              Order == 2 ? Wc*4 : 0, T );
+    margin( Di, 0, 1, Di );
+}
+
+static void designV( Design* Dv, const Design* Di, int N )
+{
+    double Fc = fmin( Fcv, Fs/(20.0*N) );
+    double Wc = 2*M_PI*Fc;
+    double T  = N / Fs;
+    double complex Li = loopI( Di, Wc );
+
+    bilinear( Dv, 1.0, Wc/4, Wc*4, T );
+    bilinear( Dv, 1.0/cabs( ctrl( Dv, Wc, T ) * plantV( Wc ) * Li/(1.0+Li) ),
+              Wc/4, Wc*4, T );
+    margin( Di, Dv, N, Dv );
+}
+
+/*******************************************************************************
+* FUNCTION      : claRun
+* DESCRIPTION   :
+* The CLA task, CLA_2p2zVMode() with K 1.0, in single precision.
+*******************************************************************************/
+static int claRun( ClaModel* M, const Design* D, int32_t Ref, int Adc )
+{
+    float E0 = (float)(int16_t)(Ref >> 16) - (float)Adc;
+    float U0 = M->Pre + E0*(float)D->B0;
+    float Out = U0;
+
+    if( Out > DUTY_MAX ) Out = DUTY_MAX;
+    if( Out < 0 )        Out = 0;
+
+    M->Pre  = (float)D->A2*M->U[1] + (float)D->A1*U0
+            + (float)D->B2*M->E[1] + (float)D->B1*E0;
+    M->U[1] = U0;
+    M->E[1] = E0;
+    return (int)Out;
+}
+
+/*******************************************************************************
+* FUNCTION      : simulate
+* DESCRIPTION   :
+* Runs the cascade with the inner loop of Order at a decimation of N.
+*******************************************************************************/
+static void simulate( const Design* Di, const Design* Dv, int Order, int N,
+                      Result* R )
+{
+    static CNTRL_2p2zData Outer, Inner2;
+    ACM_1p1zData Inner1;
+    ACM_Data     Acm;
+    ClaModel     Cla_ = { 0 };
+    int32_t      ClaRef = 0;
+    double  T  = 1.0 / Fs;
+    double  IL = 0, Vc = 0, Rl;
+    double  Err = 0, Track = 0;
+    long    Cycles = (long)(T_END * Fs);
+    long    k, ErrN = 0;
+    int     Duty = 0, Vadc = 0, Iadc = 0, t;
+    int     SoftMax = (int)floor( Vref*Kadc + 0.5 );
+
+    memset( R, 0, sizeof(*R) );
+    CNTRL_2p2zInit( &Outer, 0, _IQ26(Dv->A1), _IQ26(Dv->A2), _IQ26(Dv->B0),
+                    _IQ26(Dv->B1), _IQ26(Dv->B2), _IQ23(1.0), 0, I_MAX );
+    if( Cla )
+    {
+        ACM_init( &Acm, &Outer, &ClaRef, ACM_SHIFT_Q16, N, 0 );
+    }
+    else if( Order == 1 )
+    {
+        ACM_1p1zInit( &Inner1, _IQ24(Di->A1), _IQ24(Di->B0), _IQ24(Di->B1),
+                      0, DUTY_MAX );
+        ACM_init( &Acm, &Outer, &Inner1.m_Ref, ACM_SHIFT_Q16, N, 0 );
+    }
+    else
+    {
+        CNTRL_2p2zInit( &Inner2, 0, _IQ26(Di->A1), _IQ26(Di->A2),
+                        _IQ26(Di->B0), _IQ26(Di->B1), _IQ26(Di->B2),
+                        _IQ23(1.0), 0, DUTY_MAX );
+        ACM_init( &Acm, &Outer, &Inner2.Ref.m_IQ, ACM_SHIFT_Q0, N, 0 );
+    }
+
+    for( k = 0; k < Cycles; k++ )
+    {
+        double Time = k * T;
+
+        Rl = (Time >= T_STEP1 && Time < T_STEP2) ? Rstep : Rload;
+
+        /* the period, at the duty set in the last */
+        for( t = 0; t < TICKS; t++ )
+        {
+            double Vsw = t < Duty ? Vin : 0.0;
+
+            IL += (Vsw - Vc) / L * TICK;
+            if( IL < 0 )
+            {
+                IL = 0;                         /* the diode blocks */
+            }
+            Vc += (IL - Vc/Rl) / Cap * TICK;
+            if( t == SAMPLE_TICK )
+            {
+                Vadc = (int)floor( Vc*Kadc + Noise*uniform() + 0.5 );
+                Iadc = (int)floor( IL*Ki + Noise*uniform() + 0.5 );
+                Vadc = Vadc < 0 ? 0 : Vadc > ADC_MAX ? ADC_MAX : Vadc;
+                Iadc = Iadc < 0 ? 0 : Iadc > ADC_MAX ? ADC_MAX : Iadc;
+            }
+        }
+
+        /* the inner loop, on the reference of the last outer run */
+        if( Cla )
+        {
+            Duty = claRun( &Cla_, Di, ClaRef, Iadc );
+        }
+        else if( Order == 1 )
+        {
+            Inner1.m_Fdbk = Iadc;
+            ACM_1p1z( &Inner1 );
+            Duty = Inner1.m_Out;
+        }
+        else
+        {
+            Inner2.Fdbk.m_Int = Iadc;
+            CNTRL_2p2z( &Inner2 );
+            Duty = Inner2.Out.m_Int;
+        }
+
+        /* the outer loop, on the soft-started reference */
+        Outer.Ref.m_Int  = Time < T_SOFT ? (int)(SoftMax * Time/T_SOFT)
+                                         : SoftMax;
+        Outer.Fdbk.m_Int = Vadc;
+        ACM_update( &Acm );
+
+        /* statistics */
+        if( Iadc/Ki > R->IPeak )
+        {
+            R->IPeak = Iadc/Ki;
+        }
+        if( Time >= T_SOFT && Time < T_STEP1 && Vc - Vref > R->SoftOver )
+        {
+            R->SoftOver = Vc - Vref;
+        }
+        if( Time >= T_STEP1 - 0.5e-3 && Time < T_STEP1 )
+        {
+            double Ir = (Cla ? ClaRef : Order == 1 ? Inner1.m_Ref
+                                                   : Inner2.Ref.m_IQ << 16)
+                      / 65536.0;
+            Err   += Vc - Vref;
+            Track += (Ir - Iadc)*(Ir - Iadc) / (Ki*Ki);
+            ErrN++;
+        }
+        if( Time >= T_STEP1 && Time < T_STEP2 )
+        {
+            R->Under = fmax( R->Under, Vref - Vc );
+            if( fabs( Vc - Vref ) > BAND*Vref )
+            {
+                R->TUp = Time - T_STEP1 + T;
+            }
+        }
+        if( Time >= T_STEP2 )
+        {
+            R->Over = fmax( R->Over, Vc - Vref );
+            if( fabs( Vc - Vref ) > BAND*Vref )
+            {
+                R->TDown = Time - T_STEP2 + T;
+            }
+        }
+    }
+    R->Err   = Err / ErrN;
+    R->Track = sqrt( Track / ErrN );
+}
+
+/*******************************************************************************
+* FUNCTION      : main
+*******************************************************************************/
+int main( int argc, char** argv )
+{
+    Design Di[2], Dv[DECIMATIONS];
+    Result Res[2][DECIMATIONS];
+    int    i, n, o;
+
+    for( i = 1; i+1 < argc; i += 2 )
+    {
+        double val = atof( argv[i+1] );
+
+        if(      !strcmp( argv[i], "-L"     ) ) L      = val;
+        else if( !strcmp( argv[i], "-C"     ) ) Cap    = val;
+        else if( !strcmp( argv[i], "-R"     ) ) Rload  = val;
+        else if( !strcmp( argv[i], "-Rstep" ) ) Rstep  = val;
+        else if( !strcmp( argv[i], "-Vin"   ) ) Vin    = val;
+        else if( !strcmp( argv[i], "-Vo"    ) ) Vref   = val;
+        else if( !strcmp( argv[i], "-fci"   ) ) Fci    = val;
+        else if( !strcmp( argv[i], "-fcv"   ) ) Fcv    = val;
+        else if( !strcmp( argv[i], "-noise" ) ) Noise  = val;
+        else if( !strcmp( argv[i], "-cla"   ) ) Cla    = (int)val;
+        else
+        {
+            fprintf( stderr, "acm_sim: unknown option %s\n", argv[i] );
+            return 1;
+        }
+    }
+    srand( 1 );
+
+    designI( &Di[0], 1 );
+    designI( &Di[1], 2 );
+    for( n = 0; n < DECIMATIONS; n++ )
+    {
+        /* the outer loop is designed on the 2p2z inner loop */
+        designV( &Dv[n], &Di[1], Decimations[n] );
+        for( o = 0; o < 2; o++ )
+        {
+            simulate( &Di[o], &Dv[n], o + 1, Decimations[n], &Res[o][n] );
+        }
+    }
+
+    printf( "Average current mode report\n\n" );
+    printf( "power stage  L %.1fuH  C %.0fuF  Vin %.1fV  Vo %.2fV  "
+            "fs %.0fkHz\n", L*1e6, Cap*1e6, Vin, Vref, Fs*1e-3 );
+    printf( "load         %.2fA -> %.2fA at %.0fms -> %.2fA at %.0fms, "
+            "ramp %.0fms\n", Vref/Rload, Vref/Rstep, T_STEP1*1e3,
+            Vref/Rload, T_STEP2*1e3, T_SOFT*1e3 );
+    printf( "sensors      %.1f ADC counts/V  %.1f ADC counts/A  "
+            "noise %.1f counts\n", Kadc, Ki, Noise );
+    printf( "inner loop   on the %s, duty 0..%d ticks\n",
+            Cla ? "CLA, float" : "CPU, fixed point", DUTY_MAX );
+    printf( "outer loop   CNTRL_2p2z(), current 0..%d counts (%.2fA)\n\n",
+            I_MAX, I_MAX/Ki );
+
+    printf( "  inner   fc        pm\n" );
+    for( o = 0; o < 2; o++ )
+    {
+        printf( "  %dp%dz    %5.2fkHz  %4.1fdeg\n", o + 1, o + 1,
+                Di[o].Fc*1e-3, Di[o].Pm );
+    }
+    printf( "\n  N   outer fc   pm       inner  error   ramp    "
+            "step up          step down        track   peak\n" );
+    for( n = 0; n < DECIMATIONS; n++ )
+    {
+        for( o = 0; o < 2; o++ )
+        {
+            Result* R = &Res[o][n];
+
+            printf( "  %d   %5.2fkHz  %4.1fdeg  %dp%dz   %+5.1fmV "
+                    "%+5.1fmV  -%5.1fmV %5.0fus  +%5.1fmV %5.0fus  "
+                    "%5.3fA  %4.2fA\n", Decimations[n], Dv[n].Fc*1e-3,
+                    Dv[n].Pm, o + 1, o + 1, R->Err*1e3, R->SoftOver*1e3,
+                    R->Under*1e3, R->TUp*1e6, R->Over*1e3, R->TDown*1e6,
+                    R->Track, R->IPeak );
+        }
+    }
+    printf( "  (error is the mean Vo error over the 0.5ms before the step, "
+            "ramp the\n   overshoot after the soft-start, the times to within "
+            "%.0f%% of Vo, track the\n   rms inner loop error and peak the "
+            "highest current sample)\n\n", BAND*100 );
+
+    printf( "#define ACM_I1_A1   %+.8f\n", Di[0].A1 );
+    printf( "#define ACM_I1_B0   %+.8f\n", Di[0].B0 );
+    printf( "#define ACM_I1_B1   %+.8f\n", Di[0].B1 );
+    printf( "#define ACM_I2_A1   %+.8f\n", Di[1].A1 );
+    printf( "#define ACM_I2_A2   %+.8f\n", Di[1].A2 );
+    printf( "#define ACM_I2_B0   %+.8f\n", Di[1].B0 );
+    printf( "#define ACM_I2_B1   %+.8f\n", Di[1].B1 );
+    printf( "#define ACM_I2_B2   %+.8f\n", Di[1].B2 );
+    for( n = 0; n < DECIMATIONS; n++ )
+    {
+        printf( "#%s (ACM_DECIMATE == %d)\n", n ? "elif" : "if",
+                Decimations[n] );
+        printf( "#define ACM_V_A1    %+.8f\n", Dv[n].A1 );
+        printf( "#define ACM_V_A2    %+.8f\n", Dv[n].A2 );
+        printf( "#define ACM_V_B0    %+.8f\n", Dv[n].B0 );
+        printf( "#define ACM_V_B1    %+.8f\n", Dv[n].B1 );
+        printf( "#define ACM_V_B2    %+.8f\n", Dv[n].B2 );
+    }
+    printf( "#endif\n" );
+    return 0;
+}
@@ -0,0 +1,313 @@
+/*******************************************************************************
+* FILE          : dead_sim.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter - host tools
+* DESCRIPTION   :
+* Host simulation of the dead time optimiser in dead.c on a loss model of the
+* synchronous buck.
+*
+* The loss model is per switching period, at the average inductor current Io
+* and the dead band td of the ePWM, the low side off to the high side on:
+*
+*   conduction      Irms^2 of the ripple (D.Rhi + (1-D).Rlo + Rdcr)
+*   turn off        0.5 Vin.Ipk.tf of the high side, at the trip, then the
+*                   body diode for the gate driver's own dead time
+*   turn on         the low side takes Tboff + Kboff.Io to turn off. A td
+*                   shorter than that shoots through, the current rising at
+*                   Vin/Lloop for the overlap; a longer one leaves the body
+*                   diode carrying the valley current for the rest of td and
+*                   recovering, Qrr growing with its conduction time, before
+*                   the high side switches Coss hard. Below about 0.2A the
+*                   valley current is negative and charges the switch node
+*                   instead, up to zero voltage switching given the time
+*   gate            both FETs, Qg.Vdrv.fs
+*
+* The loop holds Vout, so the losses come out of the input through a longer
+* on-time, D = (Vo.Io + Ploss)/(Vin.Io), which the loop reaches with a first
+* order lag of TAU_CYCLES. The on-time in ticks, with TRIP_JITTER ticks of
+* uniform jitter, is what the ISR reads as DCCAP, with the DCAEVT2 flag set
+* as the model never reaches the duty clamp, and the current demand is
+* Io in DAC counts with noise. The real DEAD_update() and DEAD_process() run
+* on them every cycle through the host CSL, and the dead band they set, DBRED
+* of ePWM1, is the td of the model.
+*
+* For each load the tool sweeps the dead band to find the true best, then
+* runs the optimiser from the start value for T_RUN and reports the
+* efficiency at the start value, the best and the optimiser's average over
+* the last second, probing included. It then steps the load between the first
+* and the last every T_STEP to show rounds with a load change thrown away.
+*
+* BUILD
+*   cc -O2 -DCSL_C2803X -DCSL_SOURCE -I host -I ../csl -I .. -o dead_sim \
+*      dead_sim.c ../dead.c host/csl_host.c ../csl/src/csl_pwm_t1_Pri.c \
+*      ../csl/src/csl_err_Pri.c ../csl/src/csl_int_t0_Pri.c \
+*      ../csl/src/csl_gpio_t0_Pri.c -lm
+*
+* EXAMPLES
+*   ./dead_sim                        (default power stage)
+*   ./dead_sim -Vin 5 -start 50 -tboff 40
+*
+* HISTORY       :
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "csl.h"
+#include "dead.h"
+
+/********** DECLARATIONS SECTION **********************************************/
+
+#define TICK            (1.0/60e6)  /* ePWM tick, s */
+#define DAC_PER_A       403.0       /* current demand, DAC counts per amp */
+#define TAU_CYCLES      40.0        /* loop settling, cycles */
+#define TRIP_JITTER     1.5         /* ticks, uniform +/- */
+#define DEMAND_NOISE    2.0         /* DAC counts, uniform +/- */
+#define T_RUN           3.0         /* s per load */
+#define T_STEP          0.25        /* s between load steps */
+#define TD_TICKS_MAX    10
+
+/* power stage, SI units */
+static double Vin     = 12.0;
+static double Vo      = 3.3;
+static double L       = 33e-6;
+static double Fs      = 200e3;
+static double Rhi     = 0.020;
+static double Rlo     = 0.010;
+static double Rdcr    = 0.015;
+static double Tf      = 10e-9;      /* high side turn off */
+static double Tdrv    = 20e-9;      /* driver dead time at the trip */
+static double Tboff   = 15e-9;      /* low side turn off */
+static double Kboff   = 4e-9;       /* more per amp */
+static double Lloop   = 5e-9;       /* shoot through loop */
+static double Vf      = 0.8;        /* body diode */
+static double Qrrk    = 8e-9;       /* recovered charge per amp */
+static double TauRr   = 15e-9;      /* conduction time to full Qrr */
+static double Coss    = 600e-12;
+static double Qg      = 10e-9;
+static double Vdrv    = 10.0;
+static double StartNs = 100.0;
+static double MinNs   = 17.0;
+static double MaxNs   = 170.0;
+
+static const double Loads[] = { 0.1, 0.25, 0.5, 1.0, 2.0, 3.0 };
+#define LOADS   ((int)(sizeof(Loads)/sizeof(Loads[0])))
+
+static DEAD_Data    Dead;
+static volatile int Demand;
+
+
+/********** FUNCTIONS SECTION *************************************************/
+
+/*******************************************************************************
+* FUNCTION      : uniform
+* DESCRIPTION   :
+* Uniform noise in -1..1, fixed seed for repeatability.
+*******************************************************************************/
+static double uniform( void )
+{
+    return 2.0 * rand() / RAND_MAX - 1.0;
+}
+
+/*******************************************************************************
+* FUNCTION      : loss
+* DESCRIPTION   :
+* The loss model above, W, at Io and a dead band of Td seconds. D is the duty,
+* from the last evaluation.
+*******************************************************************************/
+static double loss( double Io, double Td, double D )
+{
+    double Ts    = 1.0 / Fs;
+    double Ripple = (Vin - Vo) * D * Ts / L;
+    double Ipk   = Io + Ripple/2;
+    double Ival  = Io - Ripple/2;
+    double Toff  = Tboff + Kboff*Io;
+    double E     = 0;
+
+    /* conduction, turn off and gate */
+    E += (Io*Io + Ripple*Ripple/12) * (D*Rhi + (1-D)*Rlo + Rdcr) * Ts;
+    E += 0.5*Vin*Ipk*Tf + Vf*Ipk*Tdrv;
+    E += 2*Qg*Vdrv;
+
+    /* turn on, through the dead band */
+    if( Td < Toff )
+    {
+        double t = Toff - Td;
+        E += Vin * 0.5*(Vin/Lloop)*t*t;
+        E += 0.5*Coss*Vin*Vin;
+    }
+    else if( Ival >= 0 )
+    {
+        double t = Td - Toff;
+        E += Vf*Ival*t + Qrrk*Ival*(1 - exp( -t/TauRr ))*Vin;
+        E += 0.5*Coss*Vin*Vin;
+    }
+    else
+    {
+        double t     = Td - Toff;
+        double Trise = Coss*Vin / -Ival;
+
+        if( t >= Trise )
+        {
+            E += Vf*(-Ival)*(t - Trise);
+        }
+        else
+        {
+            double Vleft = Vin - (-Ival)*t/Coss;
+            E += 0.5*Coss*Vleft*Vleft;
+        }
+    }
+    return E * Fs;
+}
+
+/*******************************************************************************
+* FUNCTION      : steady
+* DESCRIPTION   :
+* The duty and loss at Io and Td, D found by iteration.
+*******************************************************************************/
+static double steady( double Io, double Td, double* Loss )
+{
+    double D = Vo / Vin;
+    int    i;
+
+    for( i = 0; i < 20; i++ )
+    {
+        *Loss = loss( Io, Td, D );
+        D     = (Vo*Io + *Loss) / (Vin*Io);
+    }
+    return D;
+}
+
+/*******************************************************************************
+* FUNCTION      : cycle
+* DESCRIPTION   :
+* One switching period at Io: moves the duty towards its steady value, runs
+* the ISR and the idle loop and returns the loss.
+*******************************************************************************/
+static double cycle( double Io, double* D )
+{
+    double Td = EPwm1Regs.DBRED * TICK;
+    double Loss;
+    double Target = steady( Io, Td, &Loss );
+    double On;
+
+    *D += (Target - *D) / TAU_CYCLES;
+    On  = *D / Fs / TICK + TRIP_JITTER*uniform();
+
+    EPwm1Regs.DCCAP = (Uint16)floor( On + 0.5 );
+    EPwm1Regs.TZFLG.bit.DCAEVT2 = 1;
+    Demand = (int)floor( Io*DAC_PER_A + DEMAND_NOISE*uniform() + 0.5 );
+    DEAD_update( &Dead );
+    DEAD_process( &Dead, true );
+    return Loss;
+}
+
+/*******************************************************************************
+* FUNCTION      : main
+*******************************************************************************/
+int main( int argc, char** argv )
+{
+    long   Cycles;
+    long   Last;
+    double EffStart[LOADS], EffBest[LOADS], EffOpt[LOADS];
+    int    TdBest[LOADS], TdEnd[LOADS], Moves[LOADS];
+    double D, Loss, Sum;
+    long   k;
+    int    i, l, t;
+
+    for( i = 1; i+1 < argc; i += 2 )
+    {
+        double val = atof( argv[i+1] );
+
+        if(      !strcmp( argv[i], "-Vin"   ) ) Vin     = val;
+        else if( !strcmp( argv[i], "-Vo"    ) ) Vo      = val;
+        else if( !strcmp( argv[i], "-L"     ) ) L       = val;
+        else if( !strcmp( argv[i], "-fs"    ) ) Fs      = val;
+        else if( !strcmp( argv[i], "-tboff" ) ) Tboff   = val*1e-9;
+        else if( !strcmp( argv[i], "-qrr"   ) ) Qrrk    = val*1e-9;
+        else if( !strcmp( argv[i], "-start" ) ) StartNs = val;
+        else if( !strcmp( argv[i], "-min"   ) ) MinNs   = val;
+        else if( !strcmp( argv[i], "-max"   ) ) MaxNs   = val;
+        else
+        {
+            fprintf( stderr, "dead_sim: unknown option %s\n", argv[i] );
+            return 1;
+        }
+    }
+    Cycles = (long)(T_RUN * Fs);
+    Last   = (long)(1.0 * Fs);
+    srand( 1 );
+
+    for( l = 0; l < LOADS; l++ )
+    {
+        double Io = Loads[l];
+        double Po = Vo * Io;
+
+        /* the sweep, and the start value */
+        EffBest[l] = 0;
+        for( t = 1; t <= TD_TICKS_MAX; t++ )
+        {
+            steady( Io, t*TICK, &Loss );
+            if( Po / (Po + Loss) > EffBest[l] )
+            {
+                EffBest[l] = Po / (Po + Loss);
+                TdBest[l]  = t;
+            }
+        }
+        steady( Io, PWM_nsToTicks( (uint32_t)StartNs ) * TICK, &Loss );
+        EffStart[l] = Po / (Po + Loss);
+
+        /* the optimiser */
+        DEAD_init( &Dead, PWM_MOD_1, &Demand, (uint32_t)StartNs,
+                   (uint32_t)MinNs, (uint32_t)MaxNs );
+        D   = steady( Io, EPwm1Regs.DBRED * TICK, &Loss );
+        Sum = 0;
+        for( k = 0; k < Cycles; k++ )
+        {
+            Loss = cycle( Io, &D );
+            if( k >= Cycles - Last )
+            {
+                Sum += Loss;
+            }
+        }
+        EffOpt[l] = Po / (Po + Sum / Last);
+        TdEnd[l]  = Dead.m_Base;
+        Moves[l]  = Dead.m_Moves;
+    }
+
+    printf( "Dead time optimiser report\n\n" );
+    printf( "power stage  Vin %.1fV  Vo %.2fV  L %.1fuH  fs %.0fkHz\n",
+            Vin, Vo, L*1e6, Fs*1e-3 );
+    printf( "low side     off in %.0fns + %.0fns/A  Qrr %.0fnC/A  "
+            "Coss %.0fpF\n", Tboff*1e9, Kboff*1e9, Qrrk*1e9, Coss*1e12 );
+    printf( "dead band    start %.0fns  limits %.0f..%.0fns  tick %.1fns\n\n",
+            StartNs, MinNs, MaxNs, TICK*1e9 );
+    printf( "  load    start     best          optimised     gain   moves\n" );
+    for( l = 0; l < LOADS; l++ )
+    {
+        printf( "  %4.2fA  %5.2f%%   %5.2f%% %3.0fns  %5.2f%% %3.0fns  "
+                "%+5.2f%%  %3d\n", Loads[l], EffStart[l]*100, EffBest[l]*100,
+                TdBest[l]*TICK*1e9, EffOpt[l]*100, TdEnd[l]*TICK*1e9,
+                (EffOpt[l] - EffStart[l])*100, Moves[l] );
+    }
+    printf( "  (optimised is the average over the last second, probing "
+            "included)\n\n" );
+
+    /* load steps */
+    DEAD_init( &Dead, PWM_MOD_1, &Demand, (uint32_t)StartNs,
+               (uint32_t)MinNs, (uint32_t)MaxNs );
+    D = steady( Loads[0], EPwm1Regs.DBRED * TICK, &Loss );
+    for( k = 0; k < Cycles; k++ )
+    {
+        double Io = ((long)(k / (T_STEP * Fs)) & 1) ? Loads[LOADS-1]
+                                                     : Loads[0];
+        cycle( Io, &D );
+    }
+    printf( "load steps   %.2fA <-> %.2fA every %.0fms for %.0fs: "
+            "%d rounds, %d thrown away, %d moves, ends at %.0fns\n",
+            Loads[0], Loads[LOADS-1], T_STEP*1e3, T_RUN, Dead.m_Rounds,
+            Dead.m_Discarded, Dead.m_Moves, Dead.m_Base*TICK*1e9 );
+    return 0;
+}
@@ -0,0 +1,487 @@
+/*******************************************************************************
+* FILE          : DSP2803x_Device.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter - host tools
+* DESCRIPTION   :
+* Host emulation of TI's F2803x peripheral header, for building the CSL
+* sources in csl/src (CSL_SOURCE) and the code that uses them on a PC.
+*
+* Only the registers and bit fields used by the CSL are declared. The names
+* and word offsets are those of the TI header, so the CSL code and its macros
+* compile unchanged. The registers are plain memory defined by csl_host.c: a
+* write is not acted on by any peripheral, but it can be read back by a
+* simulation, and a simulation can set status bits and ADC results for the
+* code under test to read.
+*
+* Modules with more than one instance are laid out at the strides of the
+* TL_*_MOD_SIZE types of the CSL, so CMP_getIndex(), PWM_getIndex() and the
+* like give the same answers as on the target.
+*
+* EXAMPLES
+*   cc -DCSL_C2803X -DCSL_SOURCE -I tools/host -I csl -I . ... \
+*      tools/host/csl_host.c csl/src/csl_*.c
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _HOST_DSP2803X_DEVICE_H
+#define _HOST_DSP2803X_DEVICE_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+#include <stdint.h>
+
+
+/********** TYPES SECTION *****************************************************/
+typedef int16_t     int16;
+typedef int32_t     int32;
+typedef int64_t     int64;
+typedef uint16_t    Uint16;
+typedef uint32_t    Uint32;
+typedef uint64_t    Uint64;
+typedef float       float32;
+typedef double      float64;
+
+/* The ISR qualifier and the C28x control registers */
+#define interrupt
+#define cregister
+
+typedef interrupt void( *PINT )( void );
+
+extern volatile Uint16 IER;
+extern volatile Uint16 IFR;
+extern volatile Uint16 HOST_Intm;   /* 1 while interrupts are disabled */
+
+#define EINT    (HOST_Intm = 0)
+#define DINT    (HOST_Intm = 1)
+#define ERTM
+#define DRTM
+#define EALLOW
+#define EDIS
+#define ESTOP0
+#define __asm( Str )
+
+#define __disable_interrupts()      HOST_disableInterrupts()
+#define __restore_interrupts( St )  (HOST_Intm = (St))
+extern Uint16 HOST_disableInterrupts( void );
+extern int HOST_interrupt( int PieId );
+
+/*******************************************************************************
+* STRUCT        : EPWM_REGS
+* DESCRIPTION   :
+* Enhanced PWM module, 0x40 words.
+*******************************************************************************/
+struct EPWM_REGS
+{
+    union { Uint16 all; struct { Uint16 CTRMODE:2, PHSEN:1, PRDLD:1,
+            SYNCOSEL:2, SWFSYNC:1, HSPCLKDIV:3, CLKDIV:3, PHSDIR:1,
+            FREE_SOFT:2; } bit; }                           TBCTL;      /* 0x00 */
+    Uint16                                                  TBSTS;
+    union { Uint32 all; struct { Uint16 TBPHSHR, TBPHS; } half; } TBPHS;
+    Uint16                                                  TBCTR;
+    Uint16                                                  TBPRD;
+    Uint16                                                  TBPRDHR;
+    union { Uint16 all; struct { Uint16 LOADAMODE:2, LOADBMODE:2,
+            SHDWAMODE:1, rsvd1:1, SHDWBMODE:1, rsvd2:1, SHDWAFULL:1,
+            SHDWBFULL:1, rsvd3:6; } bit; }                  CMPCTL;     /* 0x07 */
+    union { Uint32 all; struct { Uint16 CMPAHR, CMPA; } half; } CMPA;
+    Uint16                                                  CMPB;       /* 0x0A */
+    union { Uint16 all; struct { Uint16 ZRO:2, PRD:2, CAU:2, CAD:2,
+            CBU:2, CBD:2, rsvd:4; } bit; }                  AQCTLA, AQCTLB;
+    union { Uint16 all; }                                   AQSFRC, AQCSFRC;
+    union { Uint16 all; struct { Uint16 OUT_MODE:2, POLSEL:2,
+            IN_MODE:2, rsvd1:9, HALFCYCLE:1; } bit; }       DBCTL;      /* 0x0F */
+    Uint16                                                  DBRED;
+    Uint16                                                  DBFED;
+    union { Uint16 all; struct { Uint16 CBC1:1, CBC2:1, CBC3:1, CBC4:1,
+            CBC5:1, CBC6:1, DCAEVT2:1, DCBEVT2:1, OSHT1:1, OSHT2:1,
+            OSHT3:1, OSHT4:1, OSHT5:1, OSHT6:1, DCAEVT1:1,
+            DCBEVT1:1; } bit; }                             TZSEL;      /* 0x12 */
+    union { Uint16 all; struct { Uint16 DCAEVT1:3, DCAEVT2:3, DCBEVT1:3,
+            DCBEVT2:3, rsvd:4; } bit; }                     TZDCSEL;
+    union { Uint16 all; struct { Uint16 TZA:2, TZB:2, DCAEVT1:2,
+            DCAEVT2:2, DCBEVT1:2, DCBEVT2:2, rsvd:4; } bit; } TZCTL;
+    union { Uint16 all; struct { Uint16 rsvd1:1, CBC:1, OST:1, DCAEVT1:1,
+            DCAEVT2:1, DCBEVT1:1, DCBEVT2:1, rsvd2:9; } bit; } TZEINT;
+    union { Uint16 all; struct { Uint16 INT:1, CBC:1, OST:1, DCAEVT1:1,
+            DCAEVT2:1, DCBEVT1:1, DCBEVT2:1, rsvd2:9; } bit; } TZFLG, TZCLR, TZFRC;
+    union { Uint16 all; struct { Uint16 INTSEL:3, INTEN:1, rsvd1:4,
+            SOCASEL:3, SOCAEN:1, SOCBSEL:3, SOCBEN:1; } bit; } ETSEL;   /* 0x19 */
+    union { Uint16 all; struct { Uint16 INTPRD:2, INTCNT:2, rsvd1:4,
+            SOCAPRD:2, SOCACNT:2, SOCBPRD:2, SOCBCNT:2; } bit; } ETPS;
+    union { Uint16 all; struct { Uint16 INT:1, rsvd1:1, SOCA:1, SOCB:1,
+            rsvd2:12; } bit; }                              ETFLG, ETCLR, ETFRC;
+    Uint16                                                  PCCTL;      /* 0x1E */
+    Uint16                                                  rsvd1;
+    Uint16                                                  HRCNFG;     /* 0x20 */
+    Uint16                                                  rsvd2[15];
+    union { Uint16 all; struct { Uint16 DCAHCOMPSEL:4, DCALCOMPSEL:4,
+            DCBHCOMPSEL:4, DCBLCOMPSEL:4; } bit; }          DCTRIPSEL;  /* 0x30 */
+    union { Uint16 all; struct { Uint16 EVT1SRCSEL:1, EVT1FRCSYNCSEL:1,
+            EVT1SOCE:1, EVT1SYNCE:1, rsvd1:4, EVT2SRCSEL:1,
+            EVT2FRCSYNCSEL:1, rsvd2:6; } bit; }             DCACTL, DCBCTL;
+    union { Uint16 all; struct { Uint16 SRCSEL:2, BLANKE:1, BLANKINV:1,
+            PULSESEL:2, rsvd1:10; } bit; }                  DCFCTL;
+    union { Uint16 all; struct { Uint16 CAPE:1, SHDWMODE:1,
+            rsvd1:14; } bit; }                              DCCAPCTL;
+    Uint16                                                  DCFOFFSET;  /* 0x35 */
+    Uint16                                                  DCFOFFSETCNT;
+    Uint16                                                  DCFWINDOW;
+    Uint16                                                  DCFWINDOWCNT;
+    Uint16                                                  DCCAP;
+    Uint16                                                  rsvd3[6];
+};
+
+/*******************************************************************************
+* STRUCT        : COMP_REGS
+* DESCRIPTION   :
+* Comparator and DAC, 0x20 words.
+*******************************************************************************/
+struct COMP_REGS
+{
+    union { Uint16 all; struct { Uint16 COMPDACEN:1, COMPSOURCE:1,
+            CMPINV:1, QUALSEL:5, SYNCSEL:1, rsvd1:7; } bit; } COMPCTL;  /* 0x00 */
+    Uint16                                                  rsvd1;
+    union { Uint16 all; struct { Uint16 COMPSTS:1, rsvd1:15; } bit; } COMPSTS;
+    Uint16                                                  rsvd2;
+    union { Uint16 all; struct { Uint16 DACSOURCE:1, RAMPSOURCE:4,
+            rsvd1:9, FREE_SOFT:2; } bit; }                  DACCTL;
+    Uint16                                                  rsvd3;
+    union { Uint16 all; struct { Uint16 DACVAL:10, rsvd1:6; } bit; } DACVAL; /* 0x06 */
+    Uint16                                                  rsvd4[25];
+};
+
+/*******************************************************************************
+* STRUCT        : ADC_REGS, ADC_RESULT_REGS
+* DESCRIPTION   :
+* ADC configuration registers and the result registers.
+*******************************************************************************/
+struct ADC_REGS
+{
+    union { Uint16 all; struct { Uint16 TEMPCONV:1, VREFLOCONV:1,
+            INTPULSEPOS:1, ADCREFSEL:1, rsvd1:1, ADCREFPWD:1, ADCBGPWD:1,
+            ADCPWDN:1, ADCBSYCHN:5, ADCBSY:1, ADCENABLE:1,
+            RESET:1; } bit; }                               ADCCTL1;    /* 0x00 */
+    Uint16                                                  rsvd1[3];
+    union { Uint16 all; }                                   ADCINTFLG;  /* 0x04 */
+    union { Uint16 all; }                                   ADCINTFLGCLR;
+    union { Uint16 all; }                                   ADCINTOVF;
+    union { Uint16 all; }                                   ADCINTOVFCLR;
+    union { Uint16 all; }                                   INTSEL1N2;  /* 0x08 */
+    union { Uint16 all; }                                   INTSEL3N4;
+    union { Uint16 all; }                                   INTSEL5N6;
+    union { Uint16 all; }                                   INTSEL7N8;
+    union { Uint16 all; }                                   INTSEL9N10;
+    Uint16                                                  rsvd2[3];
+    union { Uint16 all; struct { Uint16 SOCPRIORITY:5, RRPOINTER:6,
+            rsvd1:5; } bit; }                               SOCPRICTL;  /* 0x10 */
+    Uint16                                                  rsvd3;
+    union { Uint16 all; }                                   ADCSAMPLEMODE;
+    Uint16                                                  rsvd4;
+    union { Uint16 all; }                                   ADCINTSOCSEL1; /* 0x14 */
+    union { Uint16 all; }                                   ADCINTSOCSEL2;
+    Uint16                                                  rsvd5[2];
+    union { Uint16 all; }                                   ADCSOCFLG1; /* 0x18 */
+    Uint16                                                  rsvd6;
+    union { Uint16 all; }                                   ADCSOCFRC1;
+    Uint16                                                  rsvd7;
+    union { Uint16 all; }                                   ADCSOCOVF1;
+    Uint16                                                  rsvd8;
+    union { Uint16 all; }                                   ADCSOCOVFCLR1;
+    Uint16                                                  rsvd9;
+    union { Uint16 all; struct { Uint16 ACQPS:6, CHSEL:4, rsvd1:1,
+            TRIGSEL:5; } bit; }                             ADCSOC0CTL, ADCSOC1CTL,
+            ADCSOC2CTL, ADCSOC3CTL, ADCSOC4CTL, ADCSOC5CTL, ADCSOC6CTL,
+            ADCSOC7CTL, ADCSOC8CTL, ADCSOC9CTL, ADCSOC10CTL, ADCSOC11CTL,
+            ADCSOC12CTL, ADCSOC13CTL, ADCSOC14CTL, ADCSOC15CTL;    /* 0x20 */
+    Uint16                                                  rsvd10[16];
+    Uint16                                                  ADCREFTRIM; /* 0x40 */
+    Uint16                                                  ADCOFFTRIM;
+    Uint16                                                  rsvd11[14];
+};
+
+struct ADC_RESULT_REGS
+{
+    Uint16  ADCRESULT0,  ADCRESULT1,  ADCRESULT2,  ADCRESULT3,
+            ADCRESULT4,  ADCRESULT5,  ADCRESULT6,  ADCRESULT7,
+            ADCRESULT8,  ADCRESULT9,  ADCRESULT10, ADCRESULT11,
+            ADCRESULT12, ADCRESULT13, ADCRESULT14, ADCRESULT15;
+};
+
+/*******************************************************************************
+* STRUCT        : PIE_CTRL_REGS, PIE_VECT_TABLE
+* DESCRIPTION   :
+* PIE enable and flag registers, group by group, and the vector table.
+*******************************************************************************/
+struct PIE_CTRL_REGS
+{
+    union { Uint16 all; struct { Uint16 ENPIE:1, PIEVECT:15; } bit; } PIECTRL;
+    union { Uint16 all; }   PIEACK;
+    union { Uint16 all; }   PIEIER1,  PIEIFR1,  PIEIER2,  PIEIFR2,
+                            PIEIER3,  PIEIFR3,  PIEIER4,  PIEIFR4,
+                            PIEIER5,  PIEIFR5,  PIEIER6,  PIEIFR6,
+                            PIEIER7,  PIEIFR7,  PIEIER8,  PIEIFR8,
+                            PIEIER9,  PIEIFR9,  PIEIER10, PIEIFR10,
+                            PIEIER11, PIEIFR11, PIEIER12, PIEIFR12;
+};
+
+struct PIE_VECT_TABLE
+{
+    PINT    Vector[128];    /* 32 CPU vectors then the 96 PIE vectors */
+};
+
+/*******************************************************************************
+* STRUCT        : SYS_CTRL_REGS
+* DESCRIPTION   :
+* Clocks, PLL, peripheral clock enables and the watchdog.
+*******************************************************************************/
+struct SYS_CTRL_REGS
+{
+    union { Uint16 all; struct { Uint16 XCLKOUTDIV:2, rsvd1:4,
+            XCLKINSEL:1, rsvd2:9; } bit; }                  XCLK;
+    union { Uint16 all; struct { Uint16 PLLLOCKS:1, rsvd1:1, PLLOFF:1,
+            MCLKSTS:1, MCLKCLR:1, OSCOFF:1, MCLKOFF:1, DIVSEL:2,
+            rsvd2:6, NORMRDYE:1; } bit; }                   PLLSTS;
+    union { Uint16 all; }                                   CLKCTL;
+    Uint16                                                  PLLLOCKPRD;
+    Uint16                                                  rsvd1[7];
+    union { Uint16 all; struct { Uint16 LSPCLK:3, rsvd1:13; } bit; } LOSPCP;
+    union { Uint16 all; struct { Uint16 HRPWMENCLK:1, rsvd1:1,
+            TBCLKSYNC:1, ADCENCLK:1, I2CAENCLK:1, rsvd2:3, SPIAENCLK:1,
+            SPIBENCLK:1, SCIAENCLK:1, rsvd3:1, LINAENCLK:1, rsvd4:1,
+            ECANAENCLK:1, rsvd5:1; } bit; }                 PCLKCR0;
+    union { Uint16 all; struct { Uint16 EPWM1ENCLK:1, EPWM2ENCLK:1,
+            EPWM3ENCLK:1, EPWM4ENCLK:1, EPWM5ENCLK:1, EPWM6ENCLK:1,
+            EPWM7ENCLK:1, rsvd1:1, ECAP1ENCLK:1, rsvd2:5, EQEP1ENCLK:1,
+            rsvd3:1; } bit; }                               PCLKCR1;
+    union { Uint16 all; }                                   LPMCR0;
+    Uint16                                                  rsvd2;
+    union { Uint16 all; struct { Uint16 COMP1ENCLK:1, COMP2ENCLK:1,
+            COMP3ENCLK:1, rsvd1:5, CPUTIMER0ENCLK:1, CPUTIMER1ENCLK:1,
+            CPUTIMER2ENCLK:1, rsvd2:2, GPIOINENCLK:1, CLA1ENCLK:1,
+            rsvd3:1; } bit; }                               PCLKCR3;
+    union { Uint16 all; struct { Uint16 DIV:4, rsvd1:12; } bit; } PLLCR;
+    Uint16                                                  SCSR;
+    Uint16                                                  WDCNTR;
+    Uint16                                                  rsvd3;
+    Uint16                                                  WDKEY;
+    Uint16                                                  rsvd4[3];
+    Uint16                                                  WDCR;
+};
+
+/*******************************************************************************
+* STRUCT        : GPIO_CTRL_REGS, GPIO_DATA_REGS
+* DESCRIPTION   :
+* Port A and B control and data. Port B starts 16 control words and 8 data
+* words after port A.
+*******************************************************************************/
+struct GPIO_CTRL_REGS
+{
+    union { Uint32 all; }   GPACTRL, GPAQSEL1, GPAQSEL2, GPAMUX1, GPAMUX2,
+                            GPADIR, GPAPUD;
+    Uint32                  rsvd1;
+    union { Uint32 all; }   GPBCTRL, GPBQSEL1, GPBQSEL2, GPBMUX1, GPBMUX2,
+                            GPBDIR, GPBPUD;
+    Uint32                  rsvd2;
+};
+
+struct GPIO_DATA_REGS
+{
+    union { Uint32 all; }   GPADAT, GPASET, GPACLEAR, GPATOGGLE,
+                            GPBDAT, GPBSET, GPBCLEAR, GPBTOGGLE;
+};
+
+/*******************************************************************************
+* STRUCT        : FLASH_REGS
+* DESCRIPTION   :
+* Flash wait states and pipeline.
+*******************************************************************************/
+struct FLASH_REGS
+{
+    union { Uint16 all; struct { Uint16 ENPIPE:1, rsvd1:15; } bit; } FOPT;
+    Uint16                                                  rsvd1;
+    union { Uint16 all; }                                   FPWR;
+    union { Uint16 all; }                                   FSTATUS;
+    union { Uint16 all; struct { Uint16 STDBYWAIT:9, rsvd1:7; } bit; } FSTDBYWAIT;
+    union { Uint16 all; struct { Uint16 ACTIVEWAIT:9, rsvd1:7; } bit; } FACTIVEWAIT;
+    union { Uint16 all; struct { Uint16 RANDWAIT:4, rsvd1:4, PAGEWAIT:4,
+            rsvd2:4; } bit; }                               FBANKWAIT;
+    union { Uint16 all; struct { Uint16 OTPWAIT:5, rsvd1:11; } bit; } FOTPWAIT;
+};
+
+/*******************************************************************************
+* STRUCT        : SCI_REGS
+* DESCRIPTION   :
+* Serial communications interface (UART).
+*******************************************************************************/
+struct SCI_REGS
+{
+    union { Uint16 all; struct { Uint16 SCICHAR:3, ADDRIDLE_MODE:1,
+            LOOPBKENA:1, PARITYENA:1, PARITY:1, STOPBITS:1,
+            rsvd1:8; } bit; }                               SCICCR;
+    union { Uint16 all; struct { Uint16 RXENA:1, TXENA:1, SLEEP:1,
+            TXWAKE:1, rsvd1:1, SWRESET:1, RXERRINTENA:1,
+            rsvd2:9; } bit; }                               SCICTL1;
+    Uint16                                                  SCIHBAUD;
+    Uint16                                                  SCILBAUD;
+    union { Uint16 all; struct { Uint16 TXINTENA:1, RXBKINTENA:1,
+            rsvd1:4, TXEMPTY:1, TXRDY:1, rsvd2:8; } bit; }  SCICTL2;
+    union { Uint16 all; }                                   SCIRXST;
+    Uint16                                                  SCIRXEMU;
+    union { Uint16 all; struct { Uint16 RXDT:8, rsvd1:6, SCIFFPE:1,
+            SCIFFFE:1; } bit; }                             SCIRXBUF;
+    Uint16                                                  rsvd1;
+    Uint16                                                  SCITXBUF;
+    union { Uint16 all; struct { Uint16 TXFFIL:5, TXFFIENA:1,
+            TXFFINTCLR:1, TXFFINT:1, TXFFST:5, TXFIFOXRESET:1,
+            SCIFFENA:1, SCIRST:1; } bit; }                  SCIFFTX;
+    union { Uint16 all; struct { Uint16 RXFFIL:5, RXFFIENA:1,
+            RXFFINTCLR:1, RXFFINT:1, RXFFST:5, RXFIFORESET:1,
+            RXFFOVRCLR:1, RXFFOVF:1; } bit; }               SCIFFRX;
+    union { Uint16 all; }                                   SCIFFCT;
+    Uint16                                                  rsvd2[2];
+    union { Uint16 all; struct { Uint16 rsvd1:3, FREE:1, SOFT:1,
+            rsvd2:11; } bit; }                              SCIPRI;
+};
+
+/*******************************************************************************
+* STRUCT        : SPI_REGS
+* DESCRIPTION   :
+* Serial peripheral interface.
+*******************************************************************************/
+struct SPI_REGS
+{
+    union { Uint16 all; struct { Uint16 SPICHAR:4, SPILBK:1, rsvd1:1,
+            CLKPOLARITY:1, SPISWRESET:1, rsvd2:8; } bit; }  SPICCR;
+    union { Uint16 all; struct { Uint16 SPIINTENA:1, TALK:1,
+            MASTER_SLAVE:1, CLK_PHASE:1, OVERRUNINTENA:1,
+            rsvd1:11; } bit; }                              SPICTL;
+    union { Uint16 all; }                                   SPISTS;
+    Uint16                                                  rsvd1;
+    Uint16                                                  SPIBRR;
+    Uint16                                                  rsvd2;
+    Uint16                                                  SPIRXEMU;
+    Uint16                                                  SPIRXBUF;
+    Uint16                                                  SPITXBUF;
+    Uint16                                                  SPIDAT;
+    union { Uint16 all; struct { Uint16 TXFFIL:5, TXFFIENA:1,
+            TXFFINTCLR:1, TXFFINT:1, TXFFST:5, TXFIFO:1, SPIFFENA:1,
+            SPIRST:1; } bit; }                              SPIFFTX;
+    union { Uint16 all; struct { Uint16 RXFFIL:5, RXFFIENA:1,
+            RXFFINTCLR:1, RXFFINT:1, RXFFST:5, RXFIFORESET:1,
+            RXFFOVFCLR:1, RXFFOVF:1; } bit; }               SPIFFRX;
+    union { Uint16 all; }                                   SPIFFCT;
+    Uint16                                                  rsvd3[2];
+    union { Uint16 all; struct { Uint16 rsvd1:4, FREE:1, SOFT:1,
+            rsvd2:10; } bit; }                              SPIPRI;
+};
+
+/*******************************************************************************
+* STRUCT        : I2C_REGS
+* DESCRIPTION   :
+* I2C module.
+*******************************************************************************/
+struct I2C_REGS
+{
+    Uint16                                                  I2COAR;
+    union { Uint16 all; struct { Uint16 ARBL:1, NACK:1, ARDY:1, RRDY:1,
+            XRDY:1, SCD:1, AAS:1, rsvd1:9; } bit; }         I2CIER;
+    union { Uint16 all; struct { Uint16 ARBL:1, NACK:1, ARDY:1, RRDY:1,
+            XRDY:1, SCD:1, rsvd1:2, AD0:1, AAS:1, XSMT:1, RSFULL:1,
+            BB:1, NACKSNT:1, SDIR:1, rsvd2:1; } bit; }      I2CSTR;
+    Uint16                                                  I2CCLKL;
+    Uint16                                                  I2CCLKH;
+    Uint16                                                  I2CCNT;
+    Uint16                                                  I2CDRR;
+    Uint16                                                  I2CSAR;
+    Uint16                                                  I2CDXR;
+    union { Uint16 all; struct { Uint16 BC:3, FDF:1, STB:1, IRS:1, DLB:1,
+            RM:1, XA:1, TRX:1, MST:1, STP:1, rsvd1:1, STT:1, FREE:1,
+            NACKMOD:1; } bit; }                             I2CMDR;
+    union { Uint16 all; struct { Uint16 INTCODE:3, rsvd1:13; } bit; } I2CISRC;
+    Uint16                                                  I2CEMDR;
+    union { Uint16 all; }                                   I2CPSC;
+    Uint16                                                  rsvd1[19];
+    union { Uint16 all; }                                   I2CFFTX;
+    union { Uint16 all; }                                   I2CFFRX;
+};
+
+/*******************************************************************************
+* STRUCT        : CPUTIMER_REGS
+* DESCRIPTION   :
+* CPU timers 0 to 2. TIM does not count on the host.
+*******************************************************************************/
+struct CPUTIMER_REGS
+{
+    union { Uint32 all; }                                   TIM;
+    union { Uint32 all; }                                   PRD;
+    union { Uint16 all; struct { Uint16 rsvd1:4, TSS:1, TRB:1, rsvd2:4,
+            SOFT:1, FREE:1, rsvd3:2, TIE:1, TIF:1; } bit; } TCR;
+    Uint16                                                  rsvd1;
+    union { Uint16 all; struct { Uint16 TDDR:8, PSC:8; } bit; } TPR;
+    union { Uint16 all; struct { Uint16 TDDRH:8, PSCH:8; } bit; } TPRH;
+};
+
+/*******************************************************************************
+* STRUCT        : CLA_REGS
+* DESCRIPTION   :
+* Control law accelerator.
+*******************************************************************************/
+struct CLA_REGS
+{
+    Uint16                                                  MVECT1, MVECT2,
+            MVECT3, MVECT4, MVECT5, MVECT6, MVECT7, MVECT8;
+    Uint16                                                  rsvd1[8];
+    union { Uint16 all; struct { Uint16 HARDRESET:1, SOFTRESET:1,
+            IACKE:1, rsvd1:13; } bit; }                     MCTL;       /* 0x10 */
+    union { Uint16 all; struct { Uint16 PROGE:1, rsvd1:3, RAM0E:1,
+            RAM1E:1, rsvd2:10; } bit; }                     MMEMCFG;
+    Uint16                                                  rsvd2[2];
+    union { Uint32 all; }                                   MPISRCSEL1; /* 0x14 */
+    Uint16                                                  rsvd3[10];
+    union { Uint16 all; }                                   MIFR;       /* 0x20 */
+    union { Uint16 all; }                                   MIOVF;
+    union { Uint16 all; }                                   MIFRC;
+    union { Uint16 all; }                                   MICLR;
+    union { Uint16 all; }                                   MICLROVF;
+    union { Uint16 all; }                                   MIER;
+    union { Uint16 all; }                                   MIRUN;
+};
+
+
+/********** CLASS SECTION *****************************************************/
+
+/* The register instances, at the CSL strides */
+extern Uint32 HOST_EPwmRegs[7][0x20];
+extern Uint32 HOST_CompRegs[3][0x10];
+
+#define EPwm1Regs   (*(volatile struct EPWM_REGS*)HOST_EPwmRegs[0])
+#define EPwm2Regs   (*(volatile struct EPWM_REGS*)HOST_EPwmRegs[1])
+#define EPwm3Regs   (*(volatile struct EPWM_REGS*)HOST_EPwmRegs[2])
+#define EPwm4Regs   (*(volatile struct EPWM_REGS*)HOST_EPwmRegs[3])
+#define EPwm5Regs   (*(volatile struct EPWM_REGS*)HOST_EPwmRegs[4])
+#define EPwm6Regs   (*(volatile struct EPWM_REGS*)HOST_EPwmRegs[5])
+#define EPwm7Regs   (*(volatile struct EPWM_REGS*)HOST_EPwmRegs[6])
+
+#define Comp1Regs   (*(volatile struct COMP_REGS*)HOST_CompRegs[0])
+#define Comp2Regs   (*(volatile struct COMP_REGS*)HOST_CompRegs[1])
+#define Comp3Regs   (*(volatile struct COMP_REGS*)HOST_CompRegs[2])
+
+extern volatile struct ADC_REGS         AdcRegs;
+extern volatile struct ADC_RESULT_REGS  AdcResult;
+extern volatile struct PIE_CTRL_REGS    PieCtrlRegs;
+extern volatile struct PIE_VECT_TABLE   PieVectTable;
+extern volatile struct SYS_CTRL_REGS    SysCtrlRegs;
+extern volatile struct GPIO_CTRL_REGS   GpioCtrlRegs;
+extern volatile struct GPIO_DATA_REGS   GpioDataRegs;
+extern volatile struct FLASH_REGS       FlashRegs;
+extern volatile struct SCI_REGS         SciaRegs;
+extern volatile struct SPI_REGS         SpiaRegs, SpibRegs, SpicRegs, SpidRegs;
+extern volatile struct I2C_REGS         I2caRegs;
+extern volatile struct CLA_REGS         Cla1Regs;
+extern volatile struct CPUTIMER_REGS    CpuTimer0Regs, CpuTimer1Regs,
+                                        CpuTimer2Regs;
+
+
+/********** END ***************************************************************/
+#endif
@@ -0,0 +1,44 @@
+/*******************************************************************************
+* FILE          : DSP2803x_Examples.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter - host tools
+* DESCRIPTION   :
+* Host emulation of the parts of TI's examples header used by the CSL and the
+* example: the delay loop, the factory calibration calls and the stack the
+* linker would reserve. They are defined in csl_host.c. See DSP2803x_Device.h.
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _HOST_DSP2803X_EXAMPLES_H
+#define _HOST_DSP2803X_EXAMPLES_H
+
+/********** TYPES SECTION *****************************************************/
+
+/* ADC and oscillator calibration of the boot ROM */
+#define Device_cal  HOST_deviceCal
+
+/* Temperature sensor calibration in OTP: degrees per count, Q15, and the
+*  count at 0 degrees
+*/
+#define getTempSlope()  HOST_getTempSlope()
+#define getTempOffset() HOST_getTempOffset()
+
+/* .stack of the linker command file; SYS_STACK_SIZE replaces __STACK_SIZE */
+#define SYS_STACK_SIZE  0x300
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+extern void DSP28x_usDelay( Uint32 Count );
+extern void HOST_deviceCal( void );
+extern int HOST_getTempSlope( void );
+extern int HOST_getTempOffset( void );
+extern Uint16 _stack[];
+
+#define DELAY_US( A )   DSP28x_usDelay( A )
+
+
+/********** END ***************************************************************/
+#endif
@@ -0,0 +1,17 @@
+/*******************************************************************************
+* FILE          : DSP2803x_SysCtrl.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter - host tools
+* DESCRIPTION   :
+* Host emulation of TI's system control header. The registers are declared in
+* DSP2803x_Device.h; this file only exists because csl_c2803x.h includes it.
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _HOST_DSP2803X_SYSCTRL_H
+#define _HOST_DSP2803X_SYSCTRL_H
+
+/********** END ***************************************************************/
+#endif
@@ -0,0 +1,136 @@
+/*******************************************************************************
+* FILE          : IQmathLib.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter - host tools
+* DESCRIPTION   :
+* Host emulation of the subset of TI's IQmath library used by the firmware, so
+* that the fixed point control code can be compiled and simulated on a PC.
+*
+* The arithmetic matches the C28x: 32 bit values, 64 bit intermediate products
+* and truncation towards minus infinity when shifting the result back.
+*
+* EXAMPLES
+*   cc -I tools/host -I csl -I . tools/obs_sim.c obs.c -lm
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _HOST_IQMATHLIB_H
+#define _HOST_IQMATHLIB_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+#include <stdint.h>
+
+
+/********** TYPES SECTION *****************************************************/
+#ifndef GLOBAL_Q
+#define GLOBAL_Q 24
+#endif
+
+typedef int32_t _iq;
+typedef int32_t _iq30;
+typedef int32_t _iq29;
+typedef int32_t _iq28;
+typedef int32_t _iq27;
+typedef int32_t _iq26;
+typedef int32_t _iq25;
+typedef int32_t _iq24;
+typedef int32_t _iq23;
+typedef int32_t _iq22;
+typedef int32_t _iq21;
+typedef int32_t _iq20;
+typedef int32_t _iq19;
+typedef int32_t _iq18;
+typedef int32_t _iq17;
+typedef int32_t _iq16;
+typedef int32_t _iq15;
+typedef int32_t _iq14;
+typedef int32_t _iq13;
+typedef int32_t _iq12;
+typedef int32_t _iq11;
+typedef int32_t _iq10;
+typedef int32_t _iq9;
+typedef int32_t _iq8;
+typedef int32_t _iq7;
+typedef int32_t _iq6;
+typedef int32_t _iq5;
+typedef int32_t _iq4;
+typedef int32_t _iq3;
+typedef int32_t _iq2;
+typedef int32_t _iq1;
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* Conversion from floating point constants */
+#define _IQN( A, Q )    ((int32_t)((A)*(double)(1L<<(Q))))
+#define _IQ30( A )      _IQN( A, 30 )
+#define _IQ29( A )      _IQN( A, 29 )
+#define _IQ28( A )      _IQN( A, 28 )
+#define _IQ27( A )      _IQN( A, 27 )
+#define _IQ26( A )      _IQN( A, 26 )
+#define _IQ25( A )      _IQN( A, 25 )
+#define _IQ24( A )      _IQN( A, 24 )
+#define _IQ23( A )      _IQN( A, 23 )
+#define _IQ22( A )      _IQN( A, 22 )
+#define _IQ21( A )      _IQN( A, 21 )
+#define _IQ20( A )      _IQN( A, 20 )
+#define _IQ19( A )      _IQN( A, 19 )
+#define _IQ18( A )      _IQN( A, 18 )
+#define _IQ17( A )      _IQN( A, 17 )
+#define _IQ16( A )      _IQN( A, 16 )
+#define _IQ15( A )      _IQN( A, 15 )
+#define _IQ14( A )      _IQN( A, 14 )
+#define _IQ13( A )      _IQN( A, 13 )
+#define _IQ12( A )      _IQN( A, 12 )
+#define _IQ10( A )      _IQN( A, 10 )
+#define _IQ8( A )       _IQN( A, 8 )
+#define _IQ( A )        _IQN( A, GLOBAL_Q )
+
+/* Conversion to floating point */
+#define _IQNtoF( A, Q ) ((float)(A)/(float)(1L<<(Q)))
+#define _IQ30toF( A )   _IQNtoF( A, 30 )
+#define _IQ26toF( A )   _IQNtoF( A, 26 )
+#define _IQ24toF( A )   _IQNtoF( A, 24 )
+#define _IQ23toF( A )   _IQNtoF( A, 23 )
+#define _IQ20toF( A )   _IQNtoF( A, 20 )
+#define _IQ16toF( A )   _IQNtoF( A, 16 )
+#define _IQ15toF( A )   _IQNtoF( A, 15 )
+#define _IQtoF( A )     _IQNtoF( A, GLOBAL_Q )
+
+/* Multiplication with a 64 bit intermediate product */
+#define __IQmpy( A, B, Q ) ((int32_t)(((int64_t)(A)*(int64_t)(B))>>(Q)))
+#define _IQ30mpy( A, B )   __IQmpy( A, B, 30 )
+#define _IQ29mpy( A, B )   __IQmpy( A, B, 29 )
+#define _IQ28mpy( A, B )   __IQmpy( A, B, 28 )
+#define _IQ27mpy( A, B )   __IQmpy( A, B, 27 )
+#define _IQ26mpy( A, B )   __IQmpy( A, B, 26 )
+#define _IQ25mpy( A, B )   __IQmpy( A, B, 25 )
+#define _IQ24mpy( A, B )   __IQmpy( A, B, 24 )
+#define _IQ23mpy( A, B )   __IQmpy( A, B, 23 )
+#define _IQ22mpy( A, B )   __IQmpy( A, B, 22 )
+#define _IQ20mpy( A, B )   __IQmpy( A, B, 20 )
+#define _IQ16mpy( A, B )   __IQmpy( A, B, 16 )
+#define _IQ15mpy( A, B )   __IQmpy( A, B, 15 )
+#define _IQmpy( A, B )     __IQmpy( A, B, GLOBAL_Q )
+
+/* Division */
+#define __IQdiv( A, B, Q ) ((int32_t)((((int64_t)(A))<<(Q))/(int64_t)(B)))
+#define _IQ24div( A, B )   __IQdiv( A, B, 24 )
+#define _IQ20div( A, B )   __IQdiv( A, B, 20 )
+#define _IQ16div( A, B )   __IQdiv( A, B, 16 )
+#define _IQ15div( A, B )   __IQdiv( A, B, 15 )
+#define _IQdiv( A, B )     __IQdiv( A, B, GLOBAL_Q )
+
+/* Saturation and absolute value */
+#define _IQsat( A, Pos, Neg ) ((A) > (Pos) ? (Pos) : ((A) < (Neg) ? (Neg) : (A)))
+#define _IQabs( A )           ((A) < 0 ? -(A) : (A))
+
+/* Integer part and format changes */
+#define _IQint( A )           ((int32_t)((A) >> GLOBAL_Q))
+#define _IQ24toIQ15( A )      ((A) >> 9)
+
+
+/********** END ***************************************************************/
+#endif
@@ -0,0 +1,155 @@
+/*******************************************************************************
+* FILE          : csl_host.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter - host tools
+* DESCRIPTION   :
+* The register instances and device services declared by the host headers in
+* this directory, for running the CSL sources (CSL_SOURCE) on a PC.
+*
+* The registers start at their reset values where the CSL waits on them: the
+* PLL reports lock straight away. The linker symbols of the ramfuncs and
+* Cla1Prog sections all name one word, so their copies are skipped.
+*
+* HOST_interrupt() stands in for the PIE: it calls the vector of a PIE
+* interrupt if the interrupt, its group and INTM allow it, as a simulation
+* would when a peripheral event fires. PIEACK is not modelled, so a missing
+* acknowledge does not block the group as it would on the target.
+*
+* EXAMPLES
+*   cc -DCSL_C2803X -DCSL_SOURCE -I tools/host -I csl -I . -o sim \
+*      sim.c tools/host/csl_host.c csl/src/csl_*.c
+*
+*   HOST_interrupt( INT_ID_ADCINT1 );
+*
+* HISTORY       :
+*******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include "csl.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+_Static_assert( sizeof(struct EPWM_REGS) == sizeof(TL_PWM_MOD_SIZE),
+                "EPWM_REGS stride" );
+_Static_assert( sizeof(struct COMP_REGS) == sizeof(TL_CMP_MOD_SIZE),
+                "COMP_REGS stride" );
+
+Uint32 HOST_EPwmRegs[7][0x20];
+Uint32 HOST_CompRegs[3][0x10];
+
+volatile struct ADC_REGS        AdcRegs;
+volatile struct ADC_RESULT_REGS AdcResult;
+volatile struct PIE_CTRL_REGS   PieCtrlRegs;
+volatile struct PIE_VECT_TABLE  PieVectTable;
+volatile struct SYS_CTRL_REGS   SysCtrlRegs = { .PLLSTS.bit.PLLLOCKS = 1 };
+volatile struct GPIO_CTRL_REGS  GpioCtrlRegs;
+volatile struct GPIO_DATA_REGS  GpioDataRegs;
+volatile struct FLASH_REGS      FlashRegs;
+volatile struct SCI_REGS        SciaRegs;
+volatile struct SPI_REGS        SpiaRegs, SpibRegs, SpicRegs, SpidRegs;
+volatile struct I2C_REGS        I2caRegs;
+volatile struct CLA_REGS        Cla1Regs;
+volatile struct CPUTIMER_REGS   CpuTimer0Regs, CpuTimer1Regs, CpuTimer2Regs;
+
+volatile Uint16 IER;
+volatile Uint16 IFR;
+volatile Uint16 HOST_Intm = 1;
+
+Uint16 _stack[SYS_STACK_SIZE];
+
+/* Load and run addresses of the copied sections, all the same word */
+Uint16 HOST_section[1];
+extern Uint16 RamfuncsLoadStart     __attribute__(( alias( "HOST_section" ) ));
+extern Uint16 RamfuncsLoadEnd       __attribute__(( alias( "HOST_section" ) ));
+extern Uint16 RamfuncsRunStart      __attribute__(( alias( "HOST_section" ) ));
+extern Uint16 Cla1funcsLoadStart    __attribute__(( alias( "HOST_section" ) ));
+extern Uint16 Cla1funcsLoadEnd      __attribute__(( alias( "HOST_section" ) ));
+extern Uint16 Cla1funcsRunStart     __attribute__(( alias( "HOST_section" ) ));
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : HOST_disableInterrupts
+* DESCRIPTION   :
+* __disable_interrupts(): sets INTM and returns its previous value.
+******************************************************************************/
+Uint16 HOST_disableInterrupts( void )
+{
+    Uint16 St = HOST_Intm;
+
+    HOST_Intm = 1;
+    return St;
+}
+
+
+/******************************************************************************
+* FUNCTION      : HOST_deviceCal
+* DESCRIPTION   :
+* Device_cal() of the boot ROM; there is nothing to trim.
+******************************************************************************/
+void HOST_deviceCal( void )
+{
+}
+
+
+/******************************************************************************
+* FUNCTION      : HOST_getTempSlope
+* DESCRIPTION   :
+* getTempSlope() of the OTP, .18 degrees per count in Q15. Each device has
+* its own trimmed value.
+******************************************************************************/
+int HOST_getTempSlope( void )
+{
+    return 5898;
+}
+
+
+/******************************************************************************
+* FUNCTION      : HOST_getTempOffset
+* DESCRIPTION   :
+* getTempOffset() of the OTP, the sensor's count at 0 degrees.
+******************************************************************************/
+int HOST_getTempOffset( void )
+{
+    return 1750;
+}
+
+
+/******************************************************************************
+* FUNCTION      : DSP28x_usDelay
+* DESCRIPTION   :
+* The delay loop of TI's DSP2803x_usDelay.asm; time does not pass here.
+******************************************************************************/
+void DSP28x_usDelay( Uint32 Count )
+{
+    (void)Count;
+}
+
+
+/******************************************************************************
+* FUNCTION      : HOST_interrupt
+* DESCRIPTION   :
+* Takes PIE interrupt PieId if it is enabled, as the PIE and CPU would. The
+* flag is left pending in PIEIFR otherwise. Returns 1 if the ISR ran.
+******************************************************************************/
+int HOST_interrupt( int PieId )
+{
+    volatile Uint16* pIer = &PieCtrlRegs.PIEIER1.all + 2*INT_pieIdToGroup(PieId);
+    Uint16 Bit            = 1 << INT_pieIdToIndex( PieId );
+    PINT Isr              = PieVectTable.Vector[INT_pieIdToVectorId( PieId )];
+
+    pIer[1] |= Bit;
+    if( HOST_Intm || !(*pIer & Bit) || !(IER & (1 << INT_pieIdToGroup(PieId))) )
+    {
+        return 0;
+    }
+    pIer[1] &= ~Bit;
+
+    HOST_Intm = 1;
+    Isr();
+    HOST_Intm = 0;
+    return 1;
+}
@@ -0,0 +1,178 @@
+/*******************************************************************************
+* FILE          : ident_design.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter - host tools
+* DESCRIPTION   :
+* Calculates 2p2z coefficients from the plant model identified on the target
+* by ident.c.
+*
+* Read m_Theta[0..3] of the ID_Data structure in the debugger (_IQ24 values,
+* shown as floats with the Q-value set to 24) and pass them as -a1 -a2 -b1 -b2.
+* The plant is
+*
+*   G(z) = (b1.z^-1 + b2.z^-2) / (1 + a1.z^-1 + a2.z^-2)
+*
+* from the DAC demand to the ADC reading. The compensator has the same form as
+* the one in the example, an integrator, a high frequency pole p and a double
+* zero z0:
+*
+*   C(z) = Kc.(1 - z0.z^-1)^2 / ((1 - z^-1).(1 - p.z^-1))
+*
+* z0 is found by bisection to give the wanted phase margin at the cross over
+* frequency and Kc sets the cross over. The result is printed as the #defines
+* used by CNTRL_2p2zInit() in Example_2803xAdc_TempSensorConv.c, followed by the
+* margins of the resulting loop.
+*
+* BUILD
+*   cc -O2 -o ident_design ident_design.c -lm
+*
+* EXAMPLES
+*   ./ident_design -a1 -1.59 -a2 0.62 -b1 0.90 -b2 0.52 -fc 15e3 -pm 45
+*
+* HISTORY       :
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <complex.h>
+#include <math.h>
+
+/********** DECLARATIONS SECTION **********************************************/
+
+static double Pa1 = 0, Pa2 = 0, Pb1 = 0, Pb2 = 0;
+static double Fs  = 200e3;
+static double Fc  = 15e3;
+static double Pm  = 45.0;
+static double Fp  = 50e3;       /* high frequency pole */
+static double K   = 0.5;        /* K of CNTRL_2p2zInit() */
+
+
+/********** FUNCTIONS SECTION *************************************************/
+
+/*******************************************************************************
+* FUNCTION      : plant
+*******************************************************************************/
+static double complex plant( double F )
+{
+    double complex zi = cexp( -I*2.0*M_PI*F/Fs );
+
+    return (Pb1*zi + Pb2*zi*zi) / (1.0 + Pa1*zi + Pa2*zi*zi);
+}
+
+/*******************************************************************************
+* FUNCTION      : comp
+* DESCRIPTION   :
+* Compensator with Kc = 1.
+*******************************************************************************/
+static double complex comp( double F, double Z0, double P )
+{
+    double complex zi = cexp( -I*2.0*M_PI*F/Fs );
+
+    return (1.0 - Z0*zi)*(1.0 - Z0*zi) / ((1.0 - zi)*(1.0 - P*zi));
+}
+
+/*******************************************************************************
+* FUNCTION      : phase
+* DESCRIPTION   :
+* Loop phase in degrees, unwrapped to lie in (-360, 0].
+*******************************************************************************/
+static double phase( double complex V )
+{
+    double p = carg( V ) * 180.0 / M_PI;
+
+    while( p > 0 )
+        p -= 360.0;
+    while( p <= -360.0 )
+        p += 360.0;
+    return p;
+}
+
+/*******************************************************************************
+* FUNCTION      : main
+*******************************************************************************/
+int main( int argc, char** argv )
+{
+    double lo = 0.0, hi = 0.999, z0 = 0, p, kc, f, gm = 1e9, pmAct = 0, fcAct = 0;
+    double prevMag = 0, prevPh = 0;
+    int    i;
+
+    for( i = 1; i+1 < argc; i += 2 )
+    {
+        double v = atof( argv[i+1] );
+
+        if(      !strcmp( argv[i], "-a1" ) ) Pa1 = v;
+        else if( !strcmp( argv[i], "-a2" ) ) Pa2 = v;
+        else if( !strcmp( argv[i], "-b1" ) ) Pb1 = v;
+        else if( !strcmp( argv[i], "-b2" ) ) Pb2 = v;
+        else if( !strcmp( argv[i], "-fs" ) ) Fs  = v;
+        else if( !strcmp( argv[i], "-fc" ) ) Fc  = v;
+        else if( !strcmp( argv[i], "-pm" ) ) Pm  = v;
+        else if( !strcmp( argv[i], "-fp" ) ) Fp  = v;
+        else if( !strcmp( argv[i], "-k"  ) ) K   = v;
+        else
+        {
+            fprintf( stderr, "ident_design: unknown option %s\n", argv[i] );
+            return 1;
+        }
+    }
+    if( Pb1 == 0 && Pb2 == 0 )
+    {
+        fprintf( stderr, "ident_design: give the model with -a1 -a2 -b1 -b2\n" );
+        return 1;
+    }
+
+    /* The phase at Fc rises with z0, so bisect for the wanted margin */
+    p = exp( -2.0*M_PI*Fp/Fs );
+    if( phase( comp( Fc, hi, p ) * plant( Fc ) ) < Pm - 180.0 )
+    {
+        fprintf( stderr, "ident_design: %.0f degrees of margin is not possible "
+                 "at %.0fHz, lower -fc or raise -fp\n", Pm, Fc );
+        return 1;
+    }
+    for( i = 0; i < 60; i++ )
+    {
+        z0 = 0.5*(lo + hi);
+        if( phase( comp( Fc, z0, p ) * plant( Fc ) ) < Pm - 180.0 )
+            lo = z0;
+        else
+            hi = z0;
+    }
+    kc = 1.0 / cabs( comp( Fc, z0, p ) * plant( Fc ) );
+
+    /* Check the margins of the loop that was designed */
+    for( f = 10.0; f < Fs/2; f *= 1.01 )
+    {
+        double complex l = kc * comp( f, z0, p ) * plant( f );
+        double mag = cabs( l ), ph = phase( l );
+
+        if( prevMag >= 1.0 && mag < 1.0 )
+        {
+            fcAct = f;
+            pmAct = 180.0 + ph;
+        }
+        if( prevPh > -180.0 && ph <= -180.0 && prevMag != 0 )
+        {
+            if( -20.0*log10( mag ) < gm )
+                gm = -20.0*log10( mag );
+        }
+        prevMag = mag;
+        prevPh  = ph;
+    }
+
+    printf( "#define K   (%.1f)\n", K );
+    printf( "#define A1  %+.8f\n", 1.0 + p );
+    printf( "#define A2  %+.8f\n", -p );
+    printf( "#define B0  %+.8f\n", kc / K );
+    printf( "#define B1  %+.8f\n", -2.0*z0*kc / K );
+    printf( "#define B2  %+.8f\n", z0*z0*kc / K );
+    printf( "\ncross over %.0fHz, phase margin %.1f degrees, gain margin ",
+            fcAct, pmAct );
+    if( gm < 1e8 )
+        printf( "%.1fdB\n", gm );
+    else
+        printf( "infinite\n" );
+    if( fabs( kc / K ) >= 32.0 || fabs( 2.0*z0*kc / K ) >= 32.0 )
+        printf( "warning: coefficients exceed the _iq26 range, raise -k\n" );
+    return 0;
+}
@@ -0,0 +1,820 @@
+/*******************************************************************************
+* FILE          : mpc_gen.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter - host tools
+* DESCRIPTION   :
+* Offline explicit model predictive control (MPC) generator for the buck
+* converter in voltage mode.
+*
+* An online QP solver cannot run in the 5us control ISR, so the constrained
+* finite horizon problem is solved here as a multi-parametric QP. Every
+* combination of active input constraints is enumerated, the affine control
+* law and its critical region are computed, and the regions are clipped to
+* the parameter box as 2D polygons. A binary search tree is then built over
+* the region facets and padded to a fixed depth so the target search always
+* performs exactly the same number of steps, giving a guaranteed worst-case
+* cycle count. The tree and the first-move laws are quantised to IQ format
+* and written out as a C source file that the linker places in RAM (see
+* mpc.h and the "mpcTable" section in csl_28035_RAM_lnk.cmd).
+*
+* The model is the averaged voltage mode buck with the parameter vector
+*
+*   x0 = Ref - Vo                   (ADC counts)
+*   x1 = Vo(n) - Vo(n-1)            (ADC counts, proportional to the
+*                                    capacitor current)
+*
+* and the input is the duty deviation from the feed-forward duty Vo/Vin in
+* PWM ticks. Both states are zero in any steady state regardless of load,
+* the remaining offset is removed by the slow integral trim in mpc.c.
+*
+* BUILD
+*   cc -O2 -o mpc_gen mpc_gen.c -lm
+*
+* EXAMPLES
+*   ./mpc_gen                         (default model, writes ../mpc_table.c)
+*   ./mpc_gen -L 22e-6 -C 220e-6 -N 3 -o ../mpc_table.c
+*
+* HISTORY       :
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/********** DECLARATIONS SECTION **********************************************/
+
+#define MAX_N           4       /* maximum horizon */
+#define MAX_SETS        81      /* 3^MAX_N active sets */
+#define MAX_PLANES      (2*MAX_N+4)
+#define MAX_VERT        32
+#define MAX_NODES       1024
+#define MAX_DEPTH       10
+#define EPS_AREA        1e-9
+
+/* cycle costs of the target search, see mpc.c */
+#define CYCLES_PER_LEVEL    14
+#define CYCLES_FIXED        38
+
+typedef struct Plane    { double a[2]; double c; } Plane;      /* a.x <= c */
+typedef struct Poly     { int n; double v[MAX_VERT][2]; } Poly;
+typedef struct Law      { double f[2]; double g; } Law;         /* u = f.x + g */
+
+typedef struct Region
+{
+    int     nPlanes;
+    Plane   planes[MAX_PLANES];
+    Poly    poly;
+    Law     law;
+} Region;
+
+typedef struct Node
+{
+    Plane   split;
+    int     child[2];
+    int     law;            /* -1 if this is not a leaf */
+    int     depth;
+} Node;
+
+/* model and tuning parameters, all SI units */
+static double L     = 33e-6;
+static double Cap   = 100e-6;
+static double Rload = 3.3;
+static double Vin   = 12.0;
+static double Vref  = 3.3;
+static double Fs    = 200e3;
+static double Kadc  = 4095.0/3.3*0.5;  /* ADC counts per volt at Vo */
+static double Ticks = 300.0;           /* PWM period in ticks */
+static double DutyMax = 0.6;
+static double Qe    = 1.0;
+static double Qi    = 0.05;
+static double Rw    = 0.02;
+static double Xmax0 = 400.0;           /* parameter box, ADC counts */
+static double Xmax1 = 100.0;
+static int    N     = 3;
+static const char* OutName = "../mpc_table.c";
+
+static Region   Regions[MAX_SETS];
+static int      nRegions;
+static Law      Laws[MAX_SETS];
+static int      nLaws;
+static Node     Nodes[MAX_NODES];
+static int      nNodes;
+
+/********** FUNCTIONS SECTION *************************************************/
+
+/*******************************************************************************
+* FUNCTION      : mat_inv
+* DESCRIPTION   :
+* Inverts the n x n matrix A in place using Gauss-Jordan elimination.
+*******************************************************************************/
+static int mat_inv( int n, double A[MAX_N][MAX_N] )
+{
+    double  M[MAX_N][2*MAX_N];
+    int     i, j, k;
+
+    for( i = 0; i < n; i++ )
+    {
+        for( j = 0; j < n; j++ )
+        {
+            M[i][j]   = A[i][j];
+            M[i][j+n] = (i == j);
+        }
+    }
+    for( i = 0; i < n; i++ )
+    {
+        int     p = i;
+        double  t;
+
+        for( k = i+1; k < n; k++ )
+        {
+            if( fabs(M[k][i]) > fabs(M[p][i]) )
+            {
+                p = k;
+            }
+        }
+        if( fabs(M[p][i]) < 1e-15 )
+        {
+            return -1;
+        }
+        for( j = 0; j < 2*n; j++ )
+        {
+            t = M[i][j]; M[i][j] = M[p][j]; M[p][j] = t;
+        }
+        t = M[i][i];
+        for( j = 0; j < 2*n; j++ )
+        {
+            M[i][j] /= t;
+        }
+        for( k = 0; k < n; k++ )
+        {
+            if( k != i )
+            {
+                t = M[k][i];
+                for( j = 0; j < 2*n; j++ )
+                {
+                    M[k][j] -= t*M[i][j];
+                }
+            }
+        }
+    }
+    for( i = 0; i < n; i++ )
+    {
+        for( j = 0; j < n; j++ )
+        {
+            A[i][j] = M[i][j+n];
+        }
+    }
+    return 0;
+}
+
+/*******************************************************************************
+* FUNCTION      : discretise
+* DESCRIPTION   :
+* Zero order hold discretisation of the 2 state continuous model using a
+* truncated series of the augmented matrix exponential.
+*******************************************************************************/
+static void discretise( double Ac[2][2], double Bc[2], double Ts,
+                        double Ad[2][2], double Bd[2] )
+{
+    double  T[3][3] = {{0}}, S[3][3] = {{0}}, E[3][3] = {{0}};
+    int     i, j, k, n;
+
+    for( i = 0; i < 2; i++ )
+    {
+        for( j = 0; j < 2; j++ )
+        {
+            T[i][j] = Ac[i][j]*Ts;
+        }
+        T[i][2] = Bc[i]*Ts;
+    }
+    for( i = 0; i < 3; i++ )
+    {
+        S[i][i] = 1.0;
+        E[i][i] = 1.0;
+    }
+    for( n = 1; n < 30; n++ )
+    {
+        double R[3][3] = {{0}};
+
+        for( i = 0; i < 3; i++ )
+        {
+            for( j = 0; j < 3; j++ )
+            {
+                for( k = 0; k < 3; k++ )
+                {
+                    R[i][j] += S[i][k]*T[k][j];
+                }
+                R[i][j] /= n;
+            }
+        }
+        for( i = 0; i < 3; i++ )
+        {
+            for( j = 0; j < 3; j++ )
+            {
+                S[i][j] = R[i][j];
+                E[i][j] += R[i][j];
+            }
+        }
+    }
+    for( i = 0; i < 2; i++ )
+    {
+        for( j = 0; j < 2; j++ )
+        {
+            Ad[i][j] = E[i][j];
+        }
+        Bd[i] = E[i][2];
+    }
+}
+
+/*******************************************************************************
+* FUNCTION      : poly_clip
+* DESCRIPTION   :
+* Clips the convex polygon by the half plane a.x <= c (Sutherland-Hodgman).
+*******************************************************************************/
+static void poly_clip( const Poly* In, const Plane* P, Poly* Out )
+{
+    Poly    r;
+    int     i;
+
+    r.n = 0;
+    for( i = 0; i < In->n; i++ )
+    {
+        const double* p = In->v[i];
+        const double* q = In->v[(i+1) % In->n];
+        double  dp = P->a[0]*p[0] + P->a[1]*p[1] - P->c;
+        double  dq = P->a[0]*q[0] + P->a[1]*q[1] - P->c;
+
+        if( dp <= 0 && r.n < MAX_VERT )
+        {
+            r.v[r.n][0] = p[0];
+            r.v[r.n][1] = p[1];
+            r.n++;
+        }
+        if( ((dp < 0 && dq > 0) || (dp > 0 && dq < 0)) && r.n < MAX_VERT )
+        {
+            double t = dp/(dp-dq);
+            r.v[r.n][0] = p[0] + t*(q[0]-p[0]);
+            r.v[r.n][1] = p[1] + t*(q[1]-p[1]);
+            r.n++;
+        }
+    }
+    *Out = r;
+}
+
+/*******************************************************************************
+* FUNCTION      : poly_area
+*******************************************************************************/
+static double poly_area( const Poly* P )
+{
+    double  a = 0;
+    int     i;
+
+    for( i = 0; i < P->n; i++ )
+    {
+        const double* p = P->v[i];
+        const double* q = P->v[(i+1) % P->n];
+        a += p[0]*q[1] - q[0]*p[1];
+    }
+    return fabs(a)/2;
+}
+
+/*******************************************************************************
+* FUNCTION      : solve_mpqp
+* DESCRIPTION   :
+* Builds the condensed QP and enumerates every active set of the input box
+* constraints. Each active set with a non-empty critical region inside the
+* parameter box is stored in Regions[].
+*******************************************************************************/
+static void solve_mpqp( void )
+{
+    double  Ac[2][2], Bc[2], A[2][2], B[2];
+    double  Sx[2*MAX_N][2], Su[2*MAX_N][MAX_N];
+    double  H[MAX_N][MAX_N], F[MAX_N][2];
+    double  ulo, uhi, ts = 1.0/Fs;
+    double  d0 = Vref/Vin;
+    double  sx0, sx1;
+    int     i, j, k, set, nSets = 1;
+
+    /* e = Vref - v, ic = capacitor current, u = duty deviation (fraction) */
+    Ac[0][0] = 0;           Ac[0][1] = -1.0/Cap;
+    Ac[1][0] = 1.0/L;       Ac[1][1] = -1.0/(Rload*Cap);
+    Bc[0]    = 0;           Bc[1]    = Vin/L;
+    discretise( Ac, Bc, ts, A, B );
+
+    /* prediction matrices x(k) = Sx x0 + Su U */
+    for( k = 0; k < N; k++ )
+    {
+        double P[2][2];
+
+        for( i = 0; i < 2; i++ )
+        {
+            for( j = 0; j < 2; j++ )
+            {
+                P[i][j] = (i == j);
+            }
+        }
+        for( i = 0; i <= k; i++ )
+        {
+            double R[2][2];
+            R[0][0] = A[0][0]*P[0][0] + A[0][1]*P[1][0];
+            R[0][1] = A[0][0]*P[0][1] + A[0][1]*P[1][1];
+            R[1][0] = A[1][0]*P[0][0] + A[1][1]*P[1][0];
+            R[1][1] = A[1][0]*P[0][1] + A[1][1]*P[1][1];
+            memcpy( P, R, sizeof(P) );
+        }
+        for( i = 0; i < 2; i++ )
+        {
+            Sx[2*k+i][0] = P[i][0];
+            Sx[2*k+i][1] = P[i][1];
+        }
+        for( j = 0; j < N; j++ )
+        {
+            double v[2] = { 0, 0 };
+
+            if( j <= k )
+            {
+                /* A^(k-j) B */
+                int m;
+                v[0] = B[0];
+                v[1] = B[1];
+                for( m = 0; m < k-j; m++ )
+                {
+                    double t0 = A[0][0]*v[0] + A[0][1]*v[1];
+                    double t1 = A[1][0]*v[0] + A[1][1]*v[1];
+                    v[0] = t0;
+                    v[1] = t1;
+                }
+            }
+            Su[2*k+0][j] = v[0];
+            Su[2*k+1][j] = v[1];
+        }
+    }
+
+    /* states are weighted in counts so Qe/Qi are independent of scaling */
+    sx0 = Kadc;
+    sx1 = Kadc*ts/Cap;
+    for( i = 0; i < N; i++ )
+    {
+        for( j = 0; j < N; j++ )
+        {
+            double h = 0;
+            for( k = 0; k < N; k++ )
+            {
+                h += Su[2*k][i]*Su[2*k][j]*Qe*sx0*sx0
+                   + Su[2*k+1][i]*Su[2*k+1][j]*Qi*sx1*sx1;
+            }
+            H[i][j] = 2*(h + (i == j ? Rw*Ticks*Ticks : 0));
+        }
+        for( j = 0; j < 2; j++ )
+        {
+            double f = 0;
+            for( k = 0; k < N; k++ )
+            {
+                f += Su[2*k][i]*Sx[2*k][j]*Qe*sx0*sx0
+                   + Su[2*k+1][i]*Sx[2*k+1][j]*Qi*sx1*sx1;
+            }
+            F[i][j] = 2*f;
+        }
+    }
+
+    /* parameter is in counts: x_phys = x_counts / scale */
+    for( i = 0; i < N; i++ )
+    {
+        F[i][0] /= sx0;
+        F[i][1] /= sx1;
+    }
+
+    ulo = -d0;
+    uhi = DutyMax - d0;
+
+    for( i = 0; i < N; i++ )
+    {
+        nSets *= 3;
+    }
+    nRegions = 0;
+
+    for( set = 0; set < nSets; set++ )
+    {
+        int     act[MAX_N], fr[MAX_N], nf = 0, s = set;
+        double  Hff[MAX_N][MAX_N], M[MAX_N][2], m[MAX_N], ua[MAX_N];
+        Region* r = &Regions[nRegions];
+        Poly    box;
+
+        /* 0 = free, 1 = at lower bound, 2 = at upper bound */
+        for( i = 0; i < N; i++ )
+        {
+            act[i] = s % 3;
+            s /= 3;
+            ua[i] = act[i] == 1 ? ulo : (act[i] == 2 ? uhi : 0);
+            if( act[i] == 0 )
+            {
+                fr[nf++] = i;
+            }
+        }
+        for( i = 0; i < nf; i++ )
+        {
+            for( j = 0; j < nf; j++ )
+            {
+                Hff[i][j] = H[fr[i]][fr[j]];
+            }
+        }
+        if( nf && mat_inv( nf, Hff ) )
+        {
+            continue;
+        }
+
+        /* U(x) = M x + m */
+        for( i = 0; i < N; i++ )
+        {
+            M[i][0] = M[i][1] = 0;
+            m[i] = ua[i];
+        }
+        for( i = 0; i < nf; i++ )
+        {
+            double b0 = 0, b1 = 0, bc = 0;
+            for( j = 0; j < nf; j++ )
+            {
+                int     q = fr[j];
+                double  hu = 0;
+                for( k = 0; k < N; k++ )
+                {
+                    if( act[k] )
+                    {
+                        hu += H[q][k]*ua[k];
+                    }
+                }
+                b0 -= Hff[i][j]*F[q][0];
+                b1 -= Hff[i][j]*F[q][1];
+                bc -= Hff[i][j]*hu;
+            }
+            M[fr[i]][0] = b0;
+            M[fr[i]][1] = b1;
+            m[fr[i]]    = bc;
+        }
+
+        /* critical region */
+        r->nPlanes = 0;
+        for( i = 0; i < N; i++ )
+        {
+            Plane*  p = &r->planes[r->nPlanes];
+
+            if( act[i] == 0 )
+            {
+                /* U_i <= uhi and -U_i <= -ulo */
+                p->a[0] = M[i][0]; p->a[1] = M[i][1]; p->c = uhi - m[i];
+                p++;
+                p->a[0] = -M[i][0]; p->a[1] = -M[i][1]; p->c = m[i] - ulo;
+                r->nPlanes += 2;
+            }
+            else
+            {
+                /* gradient g_i = H_i U + F_i x, >=0 at lower, <=0 at upper */
+                double g0 = F[i][0], g1 = F[i][1], gc = 0, sg;
+                for( k = 0; k < N; k++ )
+                {
+                    g0 += H[i][k]*M[k][0];
+                    g1 += H[i][k]*M[k][1];
+                    gc += H[i][k]*m[k];
+                }
+                sg = act[i] == 1 ? -1.0 : 1.0;
+                p->a[0] = sg*g0; p->a[1] = sg*g1; p->c = -sg*gc;
+                r->nPlanes += 1;
+            }
+        }
+
+        box.n = 4;
+        box.v[0][0] = -Xmax0; box.v[0][1] = -Xmax1;
+        box.v[1][0] = +Xmax0; box.v[1][1] = -Xmax1;
+        box.v[2][0] = +Xmax0; box.v[2][1] = +Xmax1;
+        box.v[3][0] = -Xmax0; box.v[3][1] = +Xmax1;
+        r->poly = box;
+        for( i = 0; i < r->nPlanes && r->poly.n >= 3; i++ )
+        {
+            poly_clip( &r->poly, &r->planes[i], &r->poly );
+        }
+        if( r->poly.n < 3 || poly_area( &r->poly ) < EPS_AREA )
+        {
+            continue;
+        }
+
+        /* first move only, converted to PWM ticks */
+        r->law.f[0] = M[0][0]*Ticks;
+        r->law.f[1] = M[0][1]*Ticks;
+        r->law.g    = m[0]*Ticks;
+        nRegions++;
+    }
+}
+
+/*******************************************************************************
+* FUNCTION      : law_index
+* DESCRIPTION   :
+* Returns the index of the first-move law in Laws[], adding it if it is new.
+* Regions that only differ in later moves share a law and so a tree leaf.
+*******************************************************************************/
+static int law_index( const Law* l )
+{
+    int i;
+
+    for( i = 0; i < nLaws; i++ )
+    {
+        if( fabs(Laws[i].f[0]-l->f[0]) < 1e-9 &&
+            fabs(Laws[i].f[1]-l->f[1]) < 1e-9 &&
+            fabs(Laws[i].g   -l->g   ) < 1e-6 )
+        {
+            return i;
+        }
+    }
+    Laws[nLaws] = *l;
+    return nLaws++;
+}
+
+/*******************************************************************************
+* FUNCTION      : count_side
+* DESCRIPTION   :
+* Clips every listed region by the cell and the half plane and returns the
+* number of distinct laws that remain, storing the surviving regions.
+*******************************************************************************/
+static int count_side( const int* List, int nList, const Poly* Cell,
+                       const Plane* P, int* Out, int* nOut, Poly* CellOut )
+{
+    int laws[MAX_SETS], nl = 0, i, j;
+
+    poly_clip( Cell, P, CellOut );
+    *nOut = 0;
+    if( CellOut->n < 3 || poly_area( CellOut ) < EPS_AREA )
+    {
+        return 0;
+    }
+    for( i = 0; i < nList; i++ )
+    {
+        const Region*   r = &Regions[List[i]];
+        Poly            p = *CellOut;
+
+        for( j = 0; j < r->nPlanes && p.n >= 3; j++ )
+        {
+            poly_clip( &p, &r->planes[j], &p );
+        }
+        if( p.n >= 3 && poly_area( &p ) > EPS_AREA )
+        {
+            int l = law_index( &r->law ), k;
+
+            Out[(*nOut)++] = List[i];
+            for( k = 0; k < nl && laws[k] != l; k++ );
+            if( k == nl )
+            {
+                laws[nl++] = l;
+            }
+        }
+    }
+    return nl;
+}
+
+/*******************************************************************************
+* FUNCTION      : build_tree
+* DESCRIPTION   :
+* Recursively builds the search tree. At each node the region facet that
+* minimises the larger of the two resulting law counts is selected.
+*******************************************************************************/
+static int build_tree( const int* List, int nList, const Poly* Cell, int Depth )
+{
+    int     me = nNodes++;
+    int     i, j, best = -1, bestScore = 1 << 30;
+    Plane   bestPlane;
+    int     laws[MAX_SETS], nl = 0;
+
+    if( me >= MAX_NODES || Depth > MAX_DEPTH )
+    {
+        fprintf( stderr, "mpc_gen: search tree too large\n" );
+        exit( 1 );
+    }
+    Nodes[me].depth = Depth;
+    Nodes[me].law = -1;
+
+    for( i = 0; i < nList; i++ )
+    {
+        int l = law_index( &Regions[List[i]].law ), k;
+        for( k = 0; k < nl && laws[k] != l; k++ );
+        if( k == nl )
+        {
+            laws[nl++] = l;
+        }
+    }
+    if( nl <= 1 )
+    {
+        Nodes[me].law = nl ? laws[0] : 0;
+        Nodes[me].child[0] = Nodes[me].child[1] = me;
+        return me;
+    }
+
+    for( i = 0; i < nList; i++ )
+    {
+        const Region* r = &Regions[List[i]];
+
+        for( j = 0; j < r->nPlanes; j++ )
+        {
+            int     tmp[MAX_SETS], nt, a, b;
+            Poly    c;
+            Plane   neg;
+
+            neg.a[0] = -r->planes[j].a[0];
+            neg.a[1] = -r->planes[j].a[1];
+            neg.c    = -r->planes[j].c;
+            a = count_side( List, nList, Cell, &r->planes[j], tmp, &nt, &c );
+            b = count_side( List, nList, Cell, &neg, tmp, &nt, &c );
+            if( a == 0 || b == 0 )
+            {
+                continue;
+            }
+            if( (a > b ? a : b)*64 + a + b < bestScore )
+            {
+                bestScore = (a > b ? a : b)*64 + a + b;
+                bestPlane = r->planes[j];
+                best = 1;
+            }
+        }
+    }
+    if( best < 0 )
+    {
+        /* degenerate: regions only touch along an edge, pick any law */
+        Nodes[me].law = laws[0];
+        Nodes[me].child[0] = Nodes[me].child[1] = me;
+        return me;
+    }
+
+    Nodes[me].split = bestPlane;
+    {
+        int     left[MAX_SETS], right[MAX_SETS], nLeft, nRight;
+        Poly    cl, cr;
+        Plane   neg;
+
+        neg.a[0] = -bestPlane.a[0];
+        neg.a[1] = -bestPlane.a[1];
+        neg.c    = -bestPlane.c;
+        count_side( List, nList, Cell, &bestPlane, left, &nLeft, &cl );
+        count_side( List, nList, Cell, &neg, right, &nRight, &cr );
+
+        /* child[0]: a.x <= c, child[1]: a.x > c */
+        Nodes[me].child[0] = build_tree( left, nLeft, &cl, Depth+1 );
+        Nodes[me].child[1] = build_tree( right, nRight, &cr, Depth+1 );
+    }
+    return me;
+}
+
+/*******************************************************************************
+* FUNCTION      : iq
+* DESCRIPTION   :
+* Quantises a value to the given Q format and checks it fits in 32 bits.
+*******************************************************************************/
+static long iq( double v, int q, const char* what )
+{
+    double s = v*(double)(1L << q);
+
+    if( s > 2147483647.0 || s < -2147483648.0 )
+    {
+        fprintf( stderr, "mpc_gen: %s (%g) overflows IQ%d\n", what, v, q );
+        exit( 1 );
+    }
+    return (long)floor( s + 0.5 );
+}
+
+/*******************************************************************************
+* FUNCTION      : write_table
+*******************************************************************************/
+static void write_table( int Depth )
+{
+    FILE*   f = fopen( OutName, "w" );
+    int     i;
+
+    if( !f )
+    {
+        perror( OutName );
+        exit( 1 );
+    }
+    fprintf( f,
+"/*******************************************************************************\n"
+"* FILE          : mpc_table.c\n"
+"* AUTHOR        : Generated by tools/mpc_gen.c - do not edit\n"
+"* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control\n"
+"* DESCRIPTION   :\n"
+"* Explicit MPC search tree and first-move laws for the voltage mode buck.\n"
+"*\n"
+"*   L = %g H, C = %g F, R = %g Ohm, Vin = %g V, Vref = %g V, fs = %g Hz\n"
+"*   N = %d, Qe = %g, Qi = %g, R = %g, duty max = %g\n"
+"*\n"
+"*   regions = %d, laws = %d, nodes = %d, depth = %d\n"
+"*   worst-case search = %d cycles\n"
+"*******************************************************************************/\n\n"
+"#include \"csl.h\"\n#include \"mpc.h\"\n\n",
+        L, Cap, Rload, Vin, Vref, Fs, N, Qe, Qi, Rw, DutyMax,
+        nRegions, nLaws, nNodes, Depth,
+        CYCLES_FIXED + CYCLES_PER_LEVEL*Depth );
+
+    fprintf( f, "#pragma DATA_SECTION( MpcNodes, \"mpcTable\" );\n" );
+    fprintf( f, "static const MPC_Node MpcNodes[%d] =\n{\n", nNodes );
+    for( i = 0; i < nNodes; i++ )
+    {
+        const Node* n = &Nodes[i];
+        double      s = 1.0;
+
+        if( n->law < 0 )
+        {
+            /* normalise so the largest coefficient is 1.0 */
+            s = fabs(n->split.a[0]) > fabs(n->split.a[1]) ?
+                fabs(n->split.a[0]) : fabs(n->split.a[1]);
+            fprintf( f, "    { %11ld, %11ld, %11ld, { %4d, %4d }, %3d },\n",
+                     iq( n->split.a[0]/s, 24, "plane" ),
+                     iq( n->split.a[1]/s, 24, "plane" ),
+                     iq( n->split.c/s, 16, "offset" ),
+                     n->child[0], n->child[1], 0 );
+        }
+        else
+        {
+            fprintf( f, "    { %11d, %11d, %11d, { %4d, %4d }, %3d },\n",
+                     0, 0, 0, i, i, n->law );
+        }
+    }
+    fprintf( f, "};\n\n" );
+
+    fprintf( f, "#pragma DATA_SECTION( MpcLaws, \"mpcTable\" );\n" );
+    fprintf( f, "static const MPC_Law MpcLaws[%d] =\n{\n", nLaws );
+    for( i = 0; i < nLaws; i++ )
+    {
+        fprintf( f, "    { %11ld, %11ld, %11ld },\n",
+                 iq( Laws[i].f[0], 24, "gain" ),
+                 iq( Laws[i].f[1], 24, "gain" ),
+                 iq( Laws[i].g, 16, "offset" ) );
+    }
+    fprintf( f, "};\n\n" );
+
+    fprintf( f, "const MPC_Table MpcTable =\n{\n" );
+    fprintf( f, "    MpcNodes,\n    MpcLaws,\n    %d,\n    %d\n};\n", Depth,
+             CYCLES_FIXED + CYCLES_PER_LEVEL*Depth );
+    fclose( f );
+}
+
+/*******************************************************************************
+* FUNCTION      : main
+*******************************************************************************/
+int main( int argc, char** argv )
+{
+    int     list[MAX_SETS], i, depth = 0;
+    Poly    box;
+
+    for( i = 1; i+1 < argc; i += 2 )
+    {
+        double v = atof( argv[i+1] );
+
+        if(      !strcmp( argv[i], "-L"    ) ) L       = v;
+        else if( !strcmp( argv[i], "-C"    ) ) Cap     = v;
+        else if( !strcmp( argv[i], "-R"    ) ) Rload   = v;
+        else if( !strcmp( argv[i], "-Vin"  ) ) Vin     = v;
+        else if( !strcmp( argv[i], "-Vref" ) ) Vref    = v;
+        else if( !strcmp( argv[i], "-fs"   ) ) Fs      = v;
+        else if( !strcmp( argv[i], "-kadc" ) ) Kadc    = v;
+        else if( !strcmp( argv[i], "-ticks") ) Ticks   = v;
+        else if( !strcmp( argv[i], "-dmax" ) ) DutyMax = v;
+        else if( !strcmp( argv[i], "-qe"   ) ) Qe      = v;
+        else if( !strcmp( argv[i], "-qi"   ) ) Qi      = v;
+        else if( !strcmp( argv[i], "-r"    ) ) Rw      = v;
+        else if( !strcmp( argv[i], "-N"    ) ) N       = (int)v;
+        else if( !strcmp( argv[i], "-o"    ) ) OutName = argv[i+1];
+        else
+        {
+            fprintf( stderr, "mpc_gen: unknown option %s\n", argv[i] );
+            return 1;
+        }
+    }
+    if( N < 1 || N > MAX_N )
+    {
+        fprintf( stderr, "mpc_gen: horizon must be 1..%d\n", MAX_N );
+        return 1;
+    }
+
+    solve_mpqp();
+
+    box.n = 4;
+    box.v[0][0] = -Xmax0; box.v[0][1] = -Xmax1;
+    box.v[1][0] = +Xmax0; box.v[1][1] = -Xmax1;
+    box.v[2][0] = +Xmax0; box.v[2][1] = +Xmax1;
+    box.v[3][0] = -Xmax0; box.v[3][1] = +Xmax1;
+    for( i = 0; i < nRegions; i++ )
+    {
+        list[i] = i;
+    }
+    build_tree( list, nRegions, &box, 0 );
+
+    for( i = 0; i < nNodes; i++ )
+    {
+        if( Nodes[i].law >= 0 && Nodes[i].depth > depth )
+        {
+            depth = Nodes[i].depth;
+        }
+    }
+    write_table( depth );
+
+    printf( "regions %d, laws %d, nodes %d, depth %d, worst case %d cycles\n",
+            nRegions, nLaws, nNodes, depth,
+            CYCLES_FIXED + CYCLES_PER_LEVEL*depth );
+    return 0;
+}
@@ -0,0 +1,340 @@
+/*******************************************************************************
+* FILE          : obs_sim.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter - host tools
+* DESCRIPTION   :
+* Design and host simulation of the current observer in obs.c.
+*
+* The observer gains are placed with Ackermann's formula for the three state
+* model given in obs.h, then quantised exactly as the firmware stores them.
+* The tool then simulates the peak current mode buck cycle by cycle with a
+* switching model (5ns steps, comparator DAC with the CLA slope compensation,
+* leading edge blanking, maximum duty and diode conduction) closed by a PI voltage
+* loop, and feeds the quantised ADC samples and the DAC demands to
+* the real OBS_update(). The estimates are compared with the true average
+* inductor current and load current and an accuracy report is printed,
+* followed by the #defines to paste into the example.
+*
+* The load steps from -R to -Rstep after 4ms and back after 7ms.
+*
+* BUILD
+*   cc -O2 -I host -I ../csl -I .. -o obs_sim obs_sim.c ../obs.c -lm
+*
+* EXAMPLES
+*   ./obs_sim                         (default power stage)
+*   ./obs_sim -p1 0.5 -p2 0.6 -p3 0.9 -noise 2
+*
+* HISTORY       :
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "IQmathLib.h"
+#include "csl_stdint.h"
+#include "obs.h"
+
+/********** DECLARATIONS SECTION **********************************************/
+
+#define SUBSTEPS        1000    /* integration steps per switching period */
+#define SLOPE_NS        50.0    /* CLA slope compensation step */
+#define SLOPE_STEPS     80
+#define BLANK_NS        420.0
+#define SAMPLE_NS       2450.0  /* ADC sample this long before period end */
+#define DAC_MAX         1023
+#define T_STEP1         4e-3
+#define T_STEP2         7e-3
+#define T_END           10e-3
+
+/* power stage and observer design, SI units */
+static double L       = 33e-6;
+static double Cap     = 100e-6;
+static double Rload   = 3.3;
+static double Rstep   = 1.65;
+static double Vin     = 12.0;
+static double Vref    = 3.3;
+static double Fs      = 200e3;
+static double Kadc    = 4095.0/3.3*0.5;   /* ADC counts per volt at Vo */
+static double Kdac    = 1023.0/3.3*1.3;   /* DAC counts per amp, 1.3V/A */
+static double DutyMax = 0.6;
+static double Alag    = 0.5;              /* current loop lag per cycle */
+static double Pole[3] = { 0.6, 0.7, 0.8 };
+static double Noise   = 1.0;              /* ADC noise, counts rms */
+
+/* Voltage loop of the simulation. The 2p2z of the example was tuned on the
+* real board, so a PI tuned for this model is used instead: about 3kHz
+* crossover with the zero at 600Hz. The observer does not depend on it.
+*/
+static double Kp      = 1.0;              /* DAC counts per ADC count */
+static double Ki      = 0.019;            /* per cycle */
+
+typedef struct Stats
+{
+    double  sum;
+    double  sum2;
+    double  max;
+    long    n;
+} Stats;
+
+
+/********** FUNCTIONS SECTION *************************************************/
+
+/*******************************************************************************
+* FUNCTION      : gauss
+* DESCRIPTION   :
+* Normally distributed noise with unit variance, fixed seed for repeatability.
+*******************************************************************************/
+static double gauss( void )
+{
+    double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+
+    return sqrt( -2.0*log( u1 ) ) * cos( 2.0*M_PI*u2 );
+}
+
+/*******************************************************************************
+* FUNCTION      : place
+* DESCRIPTION   :
+* Ackermann's formula for the observer gain, L = phi(A).inv(O).[0 0 1]' with
+* O = [C; CA; CA^2] and C = [1 0 0].
+*******************************************************************************/
+static void place( double Kv, double Gain[3] )
+{
+    double A[3][3] = { { 1, Kv, -Kv }, { 0, 1-Alag, 0 }, { 0, 0, 1 } };
+    double A2m[3][3], Phi[3][3], O[3][3], Oi[3][3], e[3], det;
+    double c0, c1, c2;
+    int    i, j, k;
+
+    for( i = 0; i < 3; i++ )
+        for( j = 0; j < 3; j++ )
+        {
+            A2m[i][j] = 0;
+            for( k = 0; k < 3; k++ )
+                A2m[i][j] += A[i][k]*A[k][j];
+        }
+
+    /* phi(z) = z^3 + c2 z^2 + c1 z + c0 */
+    c2 = -(Pole[0] + Pole[1] + Pole[2]);
+    c1 = Pole[0]*Pole[1] + Pole[0]*Pole[2] + Pole[1]*Pole[2];
+    c0 = -Pole[0]*Pole[1]*Pole[2];
+    for( i = 0; i < 3; i++ )
+        for( j = 0; j < 3; j++ )
+        {
+            double a3 = 0;
+            for( k = 0; k < 3; k++ )
+                a3 += A2m[i][k]*A[k][j];
+            Phi[i][j] = a3 + c2*A2m[i][j] + c1*A[i][j] + c0*(i == j);
+        }
+
+    for( j = 0; j < 3; j++ )
+    {
+        O[0][j] = (j == 0);
+        O[1][j] = A[0][j];
+        O[2][j] = A2m[0][j];
+    }
+    det = O[0][0]*(O[1][1]*O[2][2] - O[1][2]*O[2][1])
+        - O[0][1]*(O[1][0]*O[2][2] - O[1][2]*O[2][0])
+        + O[0][2]*(O[1][0]*O[2][1] - O[1][1]*O[2][0]);
+    if( fabs( det ) < 1e-12 )
+    {
+        fprintf( stderr, "obs_sim: model is not observable\n" );
+        exit( 1 );
+    }
+    for( i = 0; i < 3; i++ )
+        for( j = 0; j < 3; j++ )
+        {
+            int r0 = (j+1)%3, r1 = (j+2)%3, c0i = (i+1)%3, c1i = (i+2)%3;
+            Oi[i][j] = (O[r0][c0i]*O[r1][c1i] - O[r0][c1i]*O[r1][c0i]) / det;
+        }
+
+    for( i = 0; i < 3; i++ )
+        e[i] = Oi[i][2];
+    for( i = 0; i < 3; i++ )
+    {
+        Gain[i] = 0;
+        for( k = 0; k < 3; k++ )
+            Gain[i] += Phi[i][k]*e[k];
+    }
+}
+
+/*******************************************************************************
+* FUNCTION      : stats_add
+*******************************************************************************/
+static void stats_add( Stats* S, double Err )
+{
+    S->sum  += Err;
+    S->sum2 += Err*Err;
+    if( fabs( Err ) > S->max )
+        S->max = fabs( Err );
+    S->n++;
+}
+
+/*******************************************************************************
+* FUNCTION      : stats_print
+*******************************************************************************/
+static void stats_print( const char* Name, const Stats* S )
+{
+    double mean = S->sum / S->n;
+
+    printf( "  %-22s mean %+7.3f A   rms %6.3f A   max %6.3f A\n", Name, mean,
+            sqrt( S->sum2 / S->n ), S->max );
+}
+
+/*******************************************************************************
+* FUNCTION      : main
+*******************************************************************************/
+int main( int argc, char** argv )
+{
+    double   Ts, Kv, Ton, Offset, Gain[3];
+    double   v, il, t, dt, integ;
+    double   ilAvg, ioStep, settle[2] = { 0, 0 };
+    int      dac, i, k, nCycles, stepIdx = -1;
+    long     kStep = 0;
+    Stats    stIL = { 0 }, stIO = { 0 }, stSS = { 0 };
+    OBS_Data obs;
+
+    for( i = 1; i+1 < argc; i += 2 )
+    {
+        double val = atof( argv[i+1] );
+
+        if(      !strcmp( argv[i], "-L"     ) ) L        = val;
+        else if( !strcmp( argv[i], "-C"     ) ) Cap      = val;
+        else if( !strcmp( argv[i], "-R"     ) ) Rload    = val;
+        else if( !strcmp( argv[i], "-Rstep" ) ) Rstep    = val;
+        else if( !strcmp( argv[i], "-Vin"   ) ) Vin      = val;
+        else if( !strcmp( argv[i], "-Vref"  ) ) Vref     = val;
+        else if( !strcmp( argv[i], "-fs"    ) ) Fs       = val;
+        else if( !strcmp( argv[i], "-kadc"  ) ) Kadc     = val;
+        else if( !strcmp( argv[i], "-kdac"  ) ) Kdac     = val;
+        else if( !strcmp( argv[i], "-a"     ) ) Alag     = val;
+        else if( !strcmp( argv[i], "-p1"    ) ) Pole[0]  = val;
+        else if( !strcmp( argv[i], "-p2"    ) ) Pole[1]  = val;
+        else if( !strcmp( argv[i], "-p3"    ) ) Pole[2]  = val;
+        else if( !strcmp( argv[i], "-noise" ) ) Noise    = val;
+        else if( !strcmp( argv[i], "-kp"    ) ) Kp       = val;
+        else if( !strcmp( argv[i], "-ki"    ) ) Ki       = val;
+        else
+        {
+            fprintf( stderr, "obs_sim: unknown option %s\n", argv[i] );
+            return 1;
+        }
+    }
+
+    /* Design. The offset is taken at the nominal operating point: the slope
+    * compensation at turn off plus half the ripple.
+    */
+    Ts     = 1.0 / Fs;
+    Kv     = Ts * Kadc / (Cap * Kdac);
+    Ton    = Vref / Vin * Ts;
+    Offset = fmin( Ton*1e9/SLOPE_NS, SLOPE_STEPS )
+           + 0.5 * (Vin - Vref) / L * Ton * Kdac;
+    place( Kv, Gain );
+
+    OBS_init( &obs, _IQ24(Kv), _IQ24(Alag), _IQ24(Gain[0]), _IQ24(Gain[1]),
+              _IQ24(Gain[2]), (int)(Offset + 0.5), (int)(Vref*Kadc + 0.5) );
+
+    /* start in steady state at the nominal load */
+    srand( 1 );
+    v   = Vref;
+    il  = Vref / Rload;
+    dac = (int)(il*Kdac + Offset + 0.5);
+    integ = dac;
+    dt  = Ts / SUBSTEPS;
+    nCycles = (int)(T_END / Ts);
+
+    for( k = 0; k < nCycles; k++ )
+    {
+        double r  = (k*Ts >= T_STEP1 && k*Ts < T_STEP2) ? Rstep : Rload;
+        double vs = 0, e0, io;
+        int    on = 1, adc, next;
+
+        if( (k*Ts >= T_STEP1 && stepIdx < 0) || (k*Ts >= T_STEP2 && stepIdx < 1) )
+        {
+            stepIdx++;
+            kStep = k;
+        }
+
+        /* one switching period with the demand written by the last ISR */
+        ilAvg = 0;
+        for( i = 0; i < SUBSTEPS; i++ )
+        {
+            double tn    = i * dt * 1e9;
+            double slope = fmin( floor( tn / SLOPE_NS ), SLOPE_STEPS );
+
+            if( on && tn >= BLANK_NS && il*Kdac >= dac - slope )
+                on = 0;
+            if( on && tn >= DutyMax * Ts * 1e9 )
+                on = 0;
+
+            il += ((on ? Vin : 0.0) - v) / L * dt;
+            if( il < 0 )
+                il = 0;
+            v  += (il - v/r) / Cap * dt;
+            ilAvg += il / SUBSTEPS;
+
+            if( i == (int)((Ts*1e9 - SAMPLE_NS) / (Ts*1e9) * SUBSTEPS) )
+                vs = v;
+        }
+        io = v / r;
+
+        /* ISR: sample, voltage loop, DAC, then the observer */
+        adc = (int)floor( vs*Kadc + Noise*gauss() + 0.5 );
+        if( adc < 0 )    adc = 0;
+        if( adc > 4095 ) adc = 4095;
+
+        e0 = Vref*Kadc - adc;
+        integ = fmax( fmin( integ + Ki*e0, DAC_MAX ), 0 );
+        next = (int)(integ + Kp*e0);
+        if( next < 0 )       next = 0;
+        if( next > DAC_MAX ) next = DAC_MAX;
+
+        /* obs.m_IL now estimates the period that has just run with dac */
+        if( k > 100 )
+        {
+            stats_add( &stIL, obs.m_IL/65536.0/Kdac - ilAvg );
+            stats_add( &stIO, obs.m_IO/65536.0/Kdac - io );
+            if( k*Ts > T_STEP1 - 1e-3 && k*Ts < T_STEP1 )
+                stats_add( &stSS, obs.m_IO/65536.0/Kdac - io );
+        }
+
+        /* settling is the last cycle outside 5% of the step */
+        ioStep = Vref/Rstep - Vref/Rload;
+        if( stepIdx >= 0
+            && fabs( obs.m_IO/65536.0/Kdac - io ) >= 0.05*fabs( ioStep ) )
+        {
+            settle[stepIdx] = (k - kStep + 1) * Ts;
+        }
+
+        OBS_update( &obs, adc, next );
+        dac = next;
+    }
+
+    t = Vref / Rload;
+    printf( "Observer accuracy report\n\n" );
+    printf( "power stage  L %.1fuH  C %.0fuF  Vin %.1fV  Vo %.2fV  fs %.0fkHz\n",
+            L*1e6, Cap*1e6, Vin, Vref, Fs*1e-3 );
+    printf( "load         %.2fA -> %.2fA at %.0fms -> %.2fA at %.0fms\n",
+            t, Vref/Rstep, T_STEP1*1e3, t, T_STEP2*1e3 );
+    printf( "sensors      %.1f ADC counts/V  %.1f DAC counts/A  noise %.1f "
+            "counts rms\n", Kadc, Kdac, Noise );
+    printf( "poles        %.3f %.3f %.3f   lag A %.3f\n\n",
+            Pole[0], Pole[1], Pole[2], Alag );
+    printf( "errors over %d cycles:\n", nCycles - 101 );
+    stats_print( "inductor current", &stIL );
+    stats_print( "load current", &stIO );
+    printf( "  (the max load current error is the step itself, before the next "
+            "sample)\n" );
+    stats_print( "load current, steady", &stSS );
+    printf( "  load estimate settles to 5%% of the step in %.0fus (up), "
+            "%.0fus (down)\n\n", settle[0]*1e6, settle[1]*1e6 );
+
+    printf( "#define OBS_KV      (%.8f)\n", Kv );
+    printf( "#define OBS_A       (%.8f)\n", Alag );
+    printf( "#define OBS_L1      (%.8f)\n", Gain[0] );
+    printf( "#define OBS_L2      (%.8f)\n", Gain[1] );
+    printf( "#define OBS_L3      (%.8f)\n", Gain[2] );
+    printf( "#define OBS_OFFSET  %d\n", (int)(Offset + 0.5) );
+    return 0;
+}
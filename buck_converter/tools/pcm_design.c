@@ -0,0 +1,435 @@
+/*******************************************************************************
+* FILE          : pcm_design.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter - host tools
+* DESCRIPTION   :
+* 2p2z design for the peak current mode loop at any load and switching
+* frequency, from a simulation of the power stage.
+*
+* The buck is simulated at every 60MHz tick with diode conduction, so that
+* light loads run in discontinuous conduction, with the comparator tripping on
+* the DAC less the CLA slope ramp, CLA_slopeCode() with -steps and -delta,
+* after the 420ns blanking and before -maxd of the period. Vo is sampled at
+* the ADC trigger, 2.45us before the end of the period, and the demand
+* written from a sample takes effect from the next period, as in the
+* firmware. The output capacitor has an ESR, -esr; the default, 0.1ohm, is
+* about that of the board's electrolytic, and with it the example's 2p2z
+* checks at 40 degrees and 17kHz against the 42 degrees and 15kHz measured
+* on the board.
+*
+* The operating point is the demand that gives -vo at the load, -r. The plant
+* from the demand, DAC counts, to the ADC reading is then measured as a
+* frequency response analyser would: a sine is added to the demand and the
+* response over a whole number of its periods is correlated with it, at 60
+* frequencies from 200Hz to 0.49fs. The amplitude is lowered where the
+* plant gain is high so that Vo moves by about 8 counts.
+*
+* The compensator is that of ident_design.c, an integrator, a high frequency
+* pole at -fp and a double zero placed for -pm degrees of phase margin at -fc:
+*
+*   C(z) = Kc.(1 - z0.z^-1)^2 / ((1 - z^-1).(1 - p.z^-1))
+*
+* and is printed as the coefficients of CNTRL_2p2zInit() with the margins of
+* the loop. With -check the coefficients given by -A1 -A2 -B0 -B1 -B2 and -k,
+* by default the example's, are not designed but checked instead.
+*
+* Below about 20mA at 200kHz the blanking time alone is too long an on-time
+* and the converter skips pulses whatever the demand; there is no loop to
+* design and the tool says so.
+*
+* BUILD
+*   cc -O2 -o pcm_design pcm_design.c -lm
+*
+* EXAMPLES
+*   ./pcm_design -check                 (the example's 2p2z at 1A)
+*   ./pcm_design -r 100 -fc 1.7e3 -pm 60 -fp 4e3   (33mA, discontinuous)
+*   ./pcm_design -fs 100e3 -fc 7.5e3 -steps 60 -maxd 0.328   (the rails)
+*
+* HISTORY       :
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <complex.h>
+#include <math.h>
+
+/********** DECLARATIONS SECTION **********************************************/
+
+#define TICK            (1.0/60e6)  /* s */
+#define ADC_BEFORE      2450e-9     /* ADC trigger before the period end */
+#define SLOPE_START     364e-9      /* first CLA step after the period start */
+#define SLOPE_STEP      50e-9       /* per CLA step */
+#define BLANK           420e-9      /* PWM_configBlanking() */
+#define SETTLE          4000        /* periods */
+#define WINDOW          4096        /* periods per measurement */
+#define POINTS          60
+#define F_LO            200.0
+#define V_AMP           8.0         /* ADC counts */
+
+static double L       = 33e-6;
+static double Cap     = 100e-6;
+static double Esr     = 0.1;
+static double Rload   = 3.3;
+static double Vin     = 12.0;
+static double Vo      = 3.3;
+static double Fs      = 200e3;
+static double Kadc    = 4095.0/3.3*0.5;     /* ADC counts per volt at Vo */
+static double Kdac    = 1023.0/3.3*1.3;     /* DAC counts per amp, 1.3V/A */
+static double Steps   = 80;                 /* CLA_slopeCode() */
+static double Delta   = 1.0;
+static double MaxD    = 0.6;                /* PWM_setDutyA() */
+
+static double Fc      = 15e3;
+static double Pm      = 45.0;
+static double Fp      = 50e3;
+static double K       = 0.5;
+static int    Check   = 0;
+static double CA1 = +1.69020338, CA2 = -0.69020338;     /* the example's */
+static double CB0 = +3.22868006, CB1 = +0.29060216, CB2 = -2.93807791;
+
+typedef struct
+{
+    double  Il;         /* A */
+    double  Vc;         /* V, the capacitor */
+} Stage;
+
+static Stage            Op;                 /* settled at the operating point */
+static double           U0;                 /* its demand */
+static double           F[POINTS];
+static double complex   G[POINTS];
+
+
+/********** FUNCTIONS SECTION *************************************************/
+
+/*******************************************************************************
+* FUNCTION      : period
+* DESCRIPTION   :
+* Runs one switching period at demand U, DAC counts, and returns Vo at the
+* ADC trigger.
+*******************************************************************************/
+static double period( Stage* S, double U )
+{
+    int    ticks = (int)(1.0/(Fs*TICK) + 0.5);
+    int    adc   = ticks - (int)(ADC_BEFORE/TICK + 0.5);
+    int    on    = 1, t;
+    double sample = S->Vc;
+
+    for( t = 0; t < ticks; t++ )
+    {
+        double time = t*TICK, dac = U, n, v, vo;
+
+        if( time >= SLOPE_START )
+        {
+            n = floor( (time - SLOPE_START)/SLOPE_STEP ) + 1;
+            dac -= Delta * (n < Steps ? n : Steps);
+        }
+        if( on && (time >= MaxD/Fs ||
+                   (time >= BLANK && S->Il*Kdac >= dac)) )
+        {
+            on = 0;
+        }
+
+        vo = (S->Vc + Esr*S->Il) / (1.0 + Esr/Rload);
+        if( t == adc )
+        {
+            sample = vo;
+        }
+
+        v = on ? Vin - vo : -vo;
+        S->Il += v/L*TICK;
+        if( S->Il < 0 )
+        {
+            S->Il = 0;          /* the diode stops */
+        }
+        S->Vc += (S->Il - vo/Rload)/Cap*TICK;
+    }
+    return sample;
+}
+
+/*******************************************************************************
+* FUNCTION      : settle
+* DESCRIPTION   :
+* Vo at the ADC, averaged over the last 100 of SETTLE periods at demand U.
+*******************************************************************************/
+static double settle( Stage* S, double U )
+{
+    double v = 0;
+    int    i;
+
+    for( i = 0; i < SETTLE; i++ )
+    {
+        double y = period( S, U );
+
+        if( i >= SETTLE-100 )
+            v += y / 100.0;
+    }
+    return v;
+}
+
+/*******************************************************************************
+* FUNCTION      : operating
+* DESCRIPTION   :
+* Finds the demand that gives Vo and leaves the stage settled there in Op.
+*******************************************************************************/
+static void operating( void )
+{
+    double lo = 0, hi = 1023;
+    int    i;
+
+    for( i = 0; i < 30; i++ )
+    {
+        Stage s = { 0, 0 };
+
+        U0 = 0.5*(lo + hi);
+        if( settle( &s, U0 ) < Vo )
+            lo = U0;
+        else
+            hi = U0;
+    }
+    Op.Il = Op.Vc = 0;
+    settle( &Op, U0 );
+}
+
+/*******************************************************************************
+* FUNCTION      : measure
+* DESCRIPTION   :
+* The plant at the frequency nearest Freq with a whole number of periods in
+* WINDOW, which is stored in Freq. The demand written after sample k is in
+* force at sample k+1, so the one period delay of the firmware is in it.
+*******************************************************************************/
+static double complex measure( double* Freq, double Amp )
+{
+    Stage          s = Op;
+    int            m = (int)(*Freq*WINDOW/Fs + 0.5);
+    double complex y = 0, u = 0;
+    double         w, un = 0;
+    int            k;
+
+    if( m < 1 )
+        m = 1;
+    *Freq = m * Fs / WINDOW;
+    w = 2.0*M_PI*m/WINDOW;
+
+    for( k = -WINDOW/4; k < WINDOW; k++ )
+    {
+        double vk = period( &s, U0 + un ) * Kadc;
+
+        un = Amp * sin( w*k );
+        if( k >= 0 )
+        {
+            y += vk * cexp( -I*w*k );
+            u += un * cexp( -I*w*k );
+        }
+    }
+    return y / u;
+}
+
+/*******************************************************************************
+* FUNCTION      : plantAt
+* DESCRIPTION   :
+* measure() with the amplitude lowered until Vo moves by about V_AMP.
+*******************************************************************************/
+static double complex plantAt( double* Freq )
+{
+    double         amp = 4.0;
+    double complex g   = measure( Freq, amp );
+
+    if( cabs( g )*amp > 2.0*V_AMP )
+    {
+        amp = V_AMP / cabs( g );
+        g   = measure( Freq, amp );
+    }
+    return g;
+}
+
+/*******************************************************************************
+* FUNCTION      : comp, given
+* DESCRIPTION   :
+* The compensator with Kc = 1, and the coefficients of -check with K.
+*******************************************************************************/
+static double complex comp( double Freq, double Z0, double P )
+{
+    double complex zi = cexp( -I*2.0*M_PI*Freq/Fs );
+
+    return (1.0 - Z0*zi)*(1.0 - Z0*zi) / ((1.0 - zi)*(1.0 - P*zi));
+}
+
+static double complex given( double Freq )
+{
+    double complex zi = cexp( -I*2.0*M_PI*Freq/Fs );
+
+    return K * (CB0 + CB1*zi + CB2*zi*zi) / (1.0 - CA1*zi - CA2*zi*zi);
+}
+
+/*******************************************************************************
+* FUNCTION      : phase
+* DESCRIPTION   :
+* Loop phase in degrees, unwrapped to lie in (-315, 45]: in discontinuous
+* conduction the plant is nearly an integrator and the compensated loop can
+* lead at the cross over.
+*******************************************************************************/
+static double phase( double complex V )
+{
+    double p = carg( V ) * 180.0 / M_PI;
+
+    while( p > 45.0 )
+        p -= 360.0;
+    while( p <= -315.0 )
+        p += 360.0;
+    return p;
+}
+
+/*******************************************************************************
+* FUNCTION      : margins
+* DESCRIPTION   :
+* Prints the cross over and the margins of the loop C.G over the measured
+* points, and its gain at the last. A gain margin is only counted where the
+* gain is under 1: the loop is conditionally stable at light load, where the
+* phase passes -180 degrees at low frequency with plenty of gain.
+*******************************************************************************/
+static void margins( const double complex* C )
+{
+    double gm = 1e9, pm = 0, fc = 0, prevMag = 0, prevPh = 0;
+    int    i;
+
+    for( i = 0; i < POINTS; i++ )
+    {
+        double complex l = C[i] * G[i];
+        double mag = cabs( l ), ph = phase( l );
+
+        if( i && prevMag >= 1.0 && mag < 1.0 )
+        {
+            /* Interpolated on the log of the gain */
+            double a = log( prevMag ) / (log( prevMag ) - log( mag ));
+
+            fc = F[i-1] * pow( F[i]/F[i-1], a );
+            pm = 180.0 + prevPh + a*(ph - prevPh);
+        }
+        if( i && (prevPh > -180.0) != (ph > -180.0) && mag < 1.0 )
+        {
+            if( -20.0*log10( mag ) < gm )
+                gm = -20.0*log10( mag );
+        }
+        prevMag = mag;
+        prevPh  = ph;
+    }
+    if( fc == 0 )
+    {
+        printf( "no cross over between %.0fHz and %.0fHz\n", F[0],
+                F[POINTS-1] );
+        return;
+    }
+    printf( "cross over %.0fHz, phase margin %.1f degrees, gain margin ",
+            fc, pm );
+    if( gm < 1e8 )
+        printf( "%.1fdB", gm );
+    else
+        printf( "infinite" );
+    printf( ", %.1fdB at %.0fHz\n",
+            20.0*log10( cabs( C[POINTS-1] * G[POINTS-1] ) ), F[POINTS-1] );
+}
+
+/*******************************************************************************
+* FUNCTION      : main
+*******************************************************************************/
+int main( int argc, char** argv )
+{
+    double         lo = 0.0, hi = 0.999, z0 = 0, p, kc, fc, fhi;
+    double complex gc, c[POINTS];
+    int            i;
+
+    for( i = 1; i < argc; i++ )
+    {
+        double v = i+1 < argc ? atof( argv[i+1] ) : 0;
+
+        if( !strcmp( argv[i], "-check" ) ) { Check = 1; continue; }
+        if( i+1 >= argc )
+        {
+            fprintf( stderr, "pcm_design: %s needs a value\n", argv[i] );
+            return 1;
+        }
+        if(      !strcmp( argv[i], "-r"     ) ) Rload = v;
+        else if( !strcmp( argv[i], "-esr"   ) ) Esr   = v;
+        else if( !strcmp( argv[i], "-vin"   ) ) Vin   = v;
+        else if( !strcmp( argv[i], "-vo"    ) ) Vo    = v;
+        else if( !strcmp( argv[i], "-fs"    ) ) Fs    = v;
+        else if( !strcmp( argv[i], "-steps" ) ) Steps = v;
+        else if( !strcmp( argv[i], "-delta" ) ) Delta = fabs( v );
+        else if( !strcmp( argv[i], "-maxd"  ) ) MaxD  = v;
+        else if( !strcmp( argv[i], "-fc"    ) ) Fc    = v;
+        else if( !strcmp( argv[i], "-pm"    ) ) Pm    = v;
+        else if( !strcmp( argv[i], "-fp"    ) ) Fp    = v;
+        else if( !strcmp( argv[i], "-k"     ) ) K     = v;
+        else if( !strcmp( argv[i], "-A1"    ) ) CA1   = v;
+        else if( !strcmp( argv[i], "-A2"    ) ) CA2   = v;
+        else if( !strcmp( argv[i], "-B0"    ) ) CB0   = v;
+        else if( !strcmp( argv[i], "-B1"    ) ) CB1   = v;
+        else if( !strcmp( argv[i], "-B2"    ) ) CB2   = v;
+        else
+        {
+            fprintf( stderr, "pcm_design: unknown option %s\n", argv[i] );
+            return 1;
+        }
+        i++;
+    }
+
+    operating();
+    if( U0 < 1.0 )
+    {
+        printf( "load %.3gohm: the on-time of the blanking alone is too long, "
+                "the converter skips pulses\n", Rload );
+        return 1;
+    }
+    printf( "load %.3gohm, %.0fkHz, demand %.0f DAC counts, %s\n", Rload,
+            Fs/1e3, U0, Vo/Rload < 0.5*(Vin-Vo)*Vo/(Vin*L*Fs)
+            ? "discontinuous" : "continuous" );
+
+    fhi = 0.49*Fs;
+    for( i = 0; i < POINTS; i++ )
+    {
+        F[i] = F_LO * pow( fhi/F_LO, (double)i/(POINTS-1) );
+        G[i] = plantAt( &F[i] );
+    }
+
+    if( Check )
+    {
+        for( i = 0; i < POINTS; i++ )
+            c[i] = given( F[i] );
+        margins( c );
+        return 0;
+    }
+
+    /* The phase at Fc rises with z0, so bisect for the wanted margin */
+    fc = Fc;
+    gc = plantAt( &fc );
+    p  = exp( -2.0*M_PI*Fp/Fs );
+    if( phase( comp( fc, hi, p ) * gc ) < Pm - 180.0 )
+    {
+        fprintf( stderr, "pcm_design: %.0f degrees of margin is not possible "
+                 "at %.0fHz, lower -fc or raise -fp\n", Pm, fc );
+        return 1;
+    }
+    for( i = 0; i < 60; i++ )
+    {
+        z0 = 0.5*(lo + hi);
+        if( phase( comp( fc, z0, p ) * gc ) < Pm - 180.0 )
+            lo = z0;
+        else
+            hi = z0;
+    }
+    kc = 1.0 / cabs( comp( fc, z0, p ) * gc );
+
+    printf( "\n#define K   (%.1f)\n", K );
+    printf( "#define A1  %+.8f\n", 1.0 + p );
+    printf( "#define A2  %+.8f\n", -p );
+    printf( "#define B0  %+.8f\n", kc / K );
+    printf( "#define B1  %+.8f\n", -2.0*z0*kc / K );
+    printf( "#define B2  %+.8f\n\n", z0*z0*kc / K );
+    for( i = 0; i < POINTS; i++ )
+        c[i] = kc * comp( F[i], z0, p );
+    margins( c );
+    if( fabs( kc / K ) >= 32.0 || fabs( 2.0*z0*kc / K ) >= 32.0 )
+        printf( "warning: coefficients exceed the _iq26 range, raise -k\n" );
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*******************************************************************************
+* FILE          : shell_test.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter - host tools
+* DESCRIPTION   :
+* Host check of the number parser of the command shell, SH_parse() in
+* shell.c.
+*
+* Each case is a string, a format and the value expected, or a rejection.
+* The cases sit on the limits of each format, an int, a long and _iq of Q0
+* to Q31, where the decimal digits, the shift of the integer part by Q and
+* the rounding of the fraction are closest to overflowing 32 bits. The
+* parser works in 32 bit types as on the target, so a PC with a 64 bit long
+* overflows in the same places. Every case is printed and the exit status is
+* the number that failed.
+*
+* BUILD
+*   cc -O2 -DCSL_C2803X -DCSL_SOURCE -I host -I ../csl -I .. -o shell_test \
+*      shell_test.c ../shell.c host/csl_host.c ../csl/src/csl_uart_t0_Pri.c \
+*      ../csl/src/csl_err_Pri.c ../csl/src/csl_int_t0_Pri.c \
+*      ../csl/src/csl_gpio_t0_Pri.c
+*
+* EXAMPLES
+*   ./shell_test
+*
+* HISTORY       :
+*******************************************************************************/
+
+#include <stdio.h>
+
+#include "csl.h"
+#include "shell.h"
+
+/********** DECLARATIONS SECTION **********************************************/
+
+#define REJECT          0x12345678L     /* expected value of a rejection */
+
+typedef struct
+{
+    const char* m_pText;
+    int         m_Q;
+    long        m_Expect;
+} Case;
+
+static const Case Cases[] =
+{
+    /* int, 16 bit */
+    { "32767",          SH_TYPE_INT,    32767L          },
+    { "32768",          SH_TYPE_INT,    REJECT          },
+    { "-32768",         SH_TYPE_INT,    -32768L         },
+    { "-32769",         SH_TYPE_INT,    REJECT          },
+    { "0xFFFF",         SH_TYPE_INT,    0xFFFFL         },
+    { "0x10000",        SH_TYPE_INT,    REJECT          },
+
+    /* long, 32 bit */
+    { "2147483647",     SH_TYPE_LONG,   2147483647L     },
+    { "2147483648",     SH_TYPE_LONG,   REJECT          },
+    { "-2147483648",    SH_TYPE_LONG,   -2147483647L-1  },
+    { "-2147483649",    SH_TYPE_LONG,   REJECT          },
+    { "4294967296",     SH_TYPE_LONG,   REJECT          },
+    { "99999999999",    SH_TYPE_LONG,   REJECT          },
+    { "0xFFFFFFFF",     SH_TYPE_LONG,   (long)0xFFFFFFFFUL },
+    { "0x100000000",    SH_TYPE_LONG,   REJECT          },
+
+    /* _iq of Q24, 8 bits of integer */
+    { "127.99999994",   24,             0x7FFFFFFFL     },
+    { "128",            24,             REJECT          },
+    { "-128",           24,             -2147483647L-1  },
+    { "-128.00000006",  24,             REJECT          },
+    { "-129",           24,             REJECT          },
+    { "1280",           24,             REJECT          },
+
+    /* _iq of Q28 */
+    { "7.9999999",      28,             0x7FFFFFE5L     },
+    { "8",              28,             REJECT          },
+    { "-8",             28,             -2147483647L-1  },
+    { "-9",             28,             REJECT          },
+    { "16",             28,             REJECT          },
+    { "32",             28,             REJECT          },
+
+    /* _iq of Q30, -2 to just under 2 */
+    { "1.99999999",     30,             0x7FFFFFF5L     },
+    { "1",              30,             0x40000000L     },
+    { "2",              30,             REJECT          },
+    { "-2",             30,             -2147483647L-1  },
+    { "-2.00000001",    30,             REJECT          },
+    { "-3",             30,             REJECT          },
+    { "4",              30,             REJECT          },
+    { "5",              30,             REJECT          },
+    { "10",             30,             REJECT          },
+    { "0.5",            30,             0x20000000L     },
+
+    /* _iq of Q31, -1 to just under 1 */
+    { "0.99999999",     31,             0x7FFFFFEBL     },
+    { "0.5",            31,             0x40000000L     },
+    { "-0.5",           31,             -0x40000000L    },
+    { "1",              31,             REJECT          },
+    { "-1",             31,             -2147483647L-1  },
+    { "-1.00000001",    31,             REJECT          },
+    { "-2",             31,             REJECT          },
+    { "2",              31,             REJECT          },
+    { "9",              31,             REJECT          },
+    { "10",             31,             REJECT          },
+    { "0.000000001",    31,             0               },
+
+    /* not numbers */
+    { "",               30,             REJECT          },
+    { "-",              30,             REJECT          },
+    { "1.5x",           30,             REJECT          },
+    { "0x",             SH_TYPE_LONG,   REJECT          },
+    { "1.5",            SH_TYPE_LONG,   REJECT          }
+};
+
+
+/******************************************************************************
+* FUNCTION      : main
+* DESCRIPTION   :
+******************************************************************************/
+int main( void )
+{
+    int  Failed = 0;
+    int  i;
+    long Value;
+
+    for( i = 0; i < (int)(sizeof(Cases)/sizeof(Cases[0])); i++ )
+    {
+        const Case* c = &Cases[i];
+        int         Pass;
+
+        Value = REJECT;
+        if( SH_parse( c->m_pText, c->m_Q, &Value ) )
+        {
+            Pass = Value == c->m_Expect && c->m_Expect != REJECT;
+        }
+        else
+        {
+            Pass = c->m_Expect == REJECT;
+            Value = REJECT;
+        }
+        printf( "%-4s Q%-3d %-16s ", Pass ? "ok" : "FAIL", c->m_Q,
+                c->m_pText );
+        if( Value == REJECT )
+        {
+            printf( "rejected\n" );
+        }
+        else
+        {
+            printf( "0x%08lX\n", (unsigned long)Value & 0xFFFFFFFFUL );
+        }
+        Failed += !Pass;
+    }
+    printf( "%d of %d failed\n", Failed, i );
+    return Failed;
+}
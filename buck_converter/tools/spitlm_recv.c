@@ -0,0 +1,237 @@
+/*******************************************************************************
+* FILE          : spitlm_recv.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter - host tools
+* DESCRIPTION   :
+* Host receiver for the SPI telemetry of spitlm.c.
+*
+* Reads a raw capture of the SPI data line, as saved by an SPI logger or a
+* logic analyser, and reassembles it with the same STLM_rxWord() that the
+* target uses for its loopback self test. The C2000 shifts each 16 bit word out
+* MSB first, so by default the file is read as big endian words; use -le if the
+* logger stores them little endian. Samples are written to stdout as CSV, one
+* line per sample with the block count, the sample index and the channels, and
+* a summary of blocks, lost blocks and sync errors goes to stderr.
+*
+* -t runs the receiver against a generated stream instead of a file: blocks
+* with a 12 bit ramp in every channel, some missing from the count as if
+* dropped by the sender and some with a word lost on the line, and checks that
+* every error is found and every good sample is recovered.
+*
+* BUILD
+*   cc -O2 -I ../csl -I .. -o spitlm_recv spitlm_recv.c ../spitlm_rx.c
+*
+* EXAMPLES
+*   ./spitlm_recv -c 2 capture.bin > capture.csv
+*   ./spitlm_recv -t
+*
+* HISTORY       :
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "csl_stdint.h"
+#include "spitlm_rx.h"
+
+/********** DECLARATIONS SECTION **********************************************/
+
+static int Channels = 2;
+static int LittleEndian = 0;
+
+
+/********** FUNCTIONS SECTION *************************************************/
+
+/*******************************************************************************
+* FUNCTION      : PrintBlock
+* DESCRIPTION   :
+* Writes the samples of the last complete block as CSV.
+*******************************************************************************/
+static void PrintBlock( STLM_Rx* Rx )
+{
+    int n, c;
+
+    for( n = 0; n < STLM_rxSamples( Rx ); n++ )
+    {
+        printf( "%u,%d", STLM_rxCount( Rx ), n );
+        for( c = 0; c < Rx->m_Channels; c++ )
+        {
+            printf( ",%d", STLM_rxSample( Rx, n, c ) );
+        }
+        printf( "\n" );
+    }
+}
+
+
+/*******************************************************************************
+* FUNCTION      : Receive
+* DESCRIPTION   :
+* Reassembles the capture in File.
+*******************************************************************************/
+static int Receive( const char* Name )
+{
+    STLM_Rx        Rx;
+    FILE*          File = fopen( Name, "rb" );
+    unsigned char  b[2];
+    uint16_t       Word;
+
+    if( !File )
+    {
+        perror( Name );
+        return 1;
+    }
+
+    STLM_rxInit( &Rx, Channels );
+    while( fread( b, 1, 2, File ) == 2 )
+    {
+        Word = LittleEndian ? (b[1] << 8 | b[0]) : (b[0] << 8 | b[1]);
+        if( STLM_rxWord( &Rx, Word ) )
+        {
+            PrintBlock( &Rx );
+        }
+    }
+    fclose( File );
+
+    fprintf( stderr, "%lu blocks of %d samples, %lu lost, %lu sync errors\n",
+             (unsigned long)Rx.m_Blocks, STLM_rxSamples( &Rx ),
+             (unsigned long)Rx.m_Lost, (unsigned long)Rx.m_Errors );
+    return 0;
+}
+
+
+/*******************************************************************************
+* FUNCTION      : SelfTest
+* DESCRIPTION   :
+* Feeds a generated stream with known drops and corruptions to the receiver.
+*******************************************************************************/
+static int SelfTest( void )
+{
+    STLM_Rx   Rx;
+    int       Length = STLM_LENGTH( Channels );
+    int       Samples = (Length-1) / Channels;
+    uint16_t  Block[STLM_BLOCK+1];
+    uint16_t  Seq = 0;
+    long      Blocks = 0, Lost = 0, Errors = 0, Bad = 0;
+    long      b;
+    int       n, c, i;
+
+    STLM_rxInit( &Rx, Channels );
+
+    /* Noise before the first header */
+    for( i = 0; i < 7; i++ )
+    {
+        STLM_rxWord( &Rx, (uint16_t)(i * 977) );
+    }
+
+    for( b = 0; b < 10000; b++, Seq++ )
+    {
+        if( b % 97 == 13 )
+        {
+            /* dropped by the sender, only the count moves on */
+            Lost++;
+            continue;
+        }
+
+        Block[0] = STLM_SYNC | (Seq & 0xFF);
+        Block[Length] = Block[0];
+        for( n = 0; n < Samples; n++ )
+        {
+            for( c = 0; c < Channels; c++ )
+            {
+                i = 1 + n*Channels + c;
+                Block[i] = (uint16_t)((b*Samples + n + c*1000) & 0x0FFF);
+                Block[Length] += Block[i];
+            }
+        }
+        Block[Length] |= STLM_CHECK;
+
+        if( b % 211 == 50 )
+        {
+            /* a word lost on the line, the next header becomes the check
+            *  word so this block fails and the next one is lost as well
+            */
+            for( i = 0; i <= Length; i++ )
+            {
+                if( i != Length/2 )
+                {
+                    STLM_rxWord( &Rx, Block[i] );
+                }
+            }
+            Errors++;
+            Lost += 2;
+            continue;
+        }
+
+        for( i = 0; i <= Length; i++ )
+        {
+            if( STLM_rxWord( &Rx, Block[i] ) )
+            {
+                Blocks++;
+                for( n = 0; n < Samples; n++ )
+                {
+                    for( c = 0; c < Channels; c++ )
+                    {
+                        if( STLM_rxSample( &Rx, n, c ) !=
+                            ((b*Samples + n + c*1000) & 0x0FFF) )
+                        {
+                            Bad++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    printf( "blocks %lu (expected %ld), lost %lu (%ld), errors %lu (%ld), "
+            "bad samples %ld\n",
+            (unsigned long)Rx.m_Blocks, Blocks, (unsigned long)Rx.m_Lost, Lost,
+            (unsigned long)Rx.m_Errors, Errors, Bad );
+
+    if( Rx.m_Blocks != (uint32_t)Blocks || Rx.m_Lost != (uint32_t)Lost ||
+        Rx.m_Errors != (uint32_t)Errors || Bad )
+    {
+        printf( "FAIL\n" );
+        return 1;
+    }
+    printf( "PASS\n" );
+    return 0;
+}
+
+
+/*******************************************************************************
+* FUNCTION      : main
+* DESCRIPTION   :
+*******************************************************************************/
+int main( int argc, char** argv )
+{
+    int i;
+
+    for( i = 1; i < argc; i++ )
+    {
+        if( !strcmp( argv[i], "-c" ) && i+1 < argc )
+        {
+            Channels = atoi( argv[++i] );
+        }
+        else if( !strcmp( argv[i], "-le" ) )
+        {
+            LittleEndian = 1;
+        }
+        else if( !strcmp( argv[i], "-t" ) )
+        {
+            return SelfTest();
+        }
+        else if( argv[i][0] != '-' )
+        {
+            return Receive( argv[i] );
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    fprintf( stderr, "usage: spitlm_recv [-c channels] [-le] capture.bin\n"
+                     "       spitlm_recv [-c channels] -t\n" );
+    return 1;
+}
@@ -0,0 +1,312 @@
+/******************************************************************************
+* FILE          : tune.c
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+*
+* Relay feedback experiment and 2p2z design. See tune.h.
+*
+******************************************************************************/
+
+/****************************** INCLUDES SECTION *****************************/
+
+#include <math.h>
+#include "csl.h"
+#include "tune.h"
+
+
+/**************************** DECLARATIONS SECTION ***************************/
+
+#pragma CODE_SECTION( TUNE_relay, "hotfuncs" );
+#pragma CODE_SECTION( TUNE_load, "hotfuncs" );
+
+#define TUNE_PI         3.14159265f
+#define TUNE_TIMEOUT    20000   /* relay cycles before giving up */
+#define TUNE_BISECT     40
+#define TUNE_DAC_MAX    1023
+
+
+/****************************** FUNCTIONS SECTION ****************************/
+
+/******************************************************************************
+* FUNCTION      : TUNE_init
+* DESCRIPTION   :
+* Initialises the tuner with the control period and the design targets: cross
+* over Fc in Hz, phase margin Pm in degrees, the high frequency pole Fp in Hz
+* and the K used with CNTRL_2p2zInit().
+******************************************************************************/
+void TUNE_init( TUNE_Data* Ptr, uint32_t PeriodNs, float Fc, float Pm,
+                float Fp, float K )
+{
+    Ptr->m_State = TUNE_IDLE;
+    Ptr->m_Error = TUNE_ERR_NONE;
+    Ptr->m_Ts    = PeriodNs * 1e-9f;
+    Ptr->m_Fc    = Fc;
+    Ptr->m_Pm    = Pm;
+    Ptr->m_Fp    = Fp;
+    Ptr->m_K     = K;
+}
+
+
+/******************************************************************************
+* FUNCTION      : TUNE_start
+* DESCRIPTION   :
+* Starts a relay experiment around the DAC value Bias, normally the present
+* controller output, with a relay of +/-D DAC counts and +/-Hyst ADC counts of
+* hysteresis. Skip oscillation periods are ignored and Periods are averaged.
+* Called from the idle loop; the state is written last.
+******************************************************************************/
+void TUNE_start( TUNE_Data* Ptr, int Bias, int D, int Hyst, int Skip,
+                 int Periods )
+{
+    if( Ptr->m_State == TUNE_RELAY || Ptr->m_State == TUNE_LOAD )
+    {
+        return;
+    }
+
+    /* keep both relay outputs inside the DAC range */
+    if( D > Bias )
+    {
+        D = Bias;
+    }
+    if( D > TUNE_DAC_MAX - Bias )
+    {
+        D = TUNE_DAC_MAX - Bias;
+    }
+
+    Ptr->m_Bias      = Bias;
+    Ptr->m_D         = D;
+    Ptr->m_Hyst      = Hyst;
+    Ptr->m_High      = 0;
+    Ptr->m_Ymax      = 0;
+    Ptr->m_Ymin      = 0x7FFF;
+    Ptr->m_Count     = 0;
+    Ptr->m_Skip      = Skip;
+    Ptr->m_Periods   = Periods;
+    Ptr->m_Done      = 0;
+    Ptr->m_SumPeriod = 0;
+    Ptr->m_SumAmp    = 0;
+    Ptr->m_Timeout   = TUNE_TIMEOUT;
+    Ptr->m_Error     = TUNE_ERR_NONE;
+    Ptr->m_State     = TUNE_RELAY;
+}
+
+
+/******************************************************************************
+* FUNCTION      : TUNE_relay
+* DESCRIPTION   :
+* Called by the ISR in place of CNTRL_2p2z() while TUNE_isRelay() is true.
+* Reads Ref and Fdbk and writes Out of the controller structure. A period is
+* counted at every switch of the relay to its high output.
+******************************************************************************/
+void TUNE_relay( TUNE_Data* Ptr, CNTRL_2p2zData* Cntrl )
+{
+    int Y = Cntrl->Fdbk.m_Int;
+    int E = Cntrl->Ref.m_Int - Y;
+
+    if( Y > Ptr->m_Ymax )
+    {
+        Ptr->m_Ymax = Y;
+    }
+    if( Y < Ptr->m_Ymin )
+    {
+        Ptr->m_Ymin = Y;
+    }
+    Ptr->m_Count++;
+
+    if( !Ptr->m_High && E > Ptr->m_Hyst )
+    {
+        Ptr->m_High = 1;
+        if( Ptr->m_Skip > 0 )
+        {
+            Ptr->m_Skip--;
+        }
+        else
+        {
+            Ptr->m_SumPeriod += Ptr->m_Count;
+            Ptr->m_SumAmp    += Ptr->m_Ymax - Ptr->m_Ymin;
+            if( ++Ptr->m_Done >= Ptr->m_Periods )
+            {
+                Ptr->m_State = TUNE_CALC;
+            }
+        }
+        Ptr->m_Count = 0;
+        Ptr->m_Ymax  = Y;
+        Ptr->m_Ymin  = Y;
+    }
+    else if( Ptr->m_High && E < -Ptr->m_Hyst )
+    {
+        Ptr->m_High = 0;
+    }
+
+    if( --Ptr->m_Timeout == 0 )
+    {
+        Ptr->m_Error = TUNE_ERR_TIMEOUT;
+        Ptr->m_State = TUNE_FAIL;
+    }
+
+    Cntrl->Out.m_Int = Ptr->m_High ? Ptr->m_Bias + Ptr->m_D
+                                   : Ptr->m_Bias - Ptr->m_D;
+}
+
+
+/******************************************************************************
+* FUNCTION      : TUNE_load
+* DESCRIPTION   :
+* Called by the ISR, through TUNE_update(), after the controller has run.
+* Copies the new coefficients into the live controller and presets its
+* history so that the next output is m_Bias with zero error.
+******************************************************************************/
+void TUNE_load( TUNE_Data* Ptr, CNTRL_2p2zData* Cntrl )
+{
+    Cntrl->m_B2 = Ptr->m_New.m_B2;
+    Cntrl->m_B1 = Ptr->m_New.m_B1;
+    Cntrl->m_B0 = Ptr->m_New.m_B0;
+    Cntrl->m_A2 = Ptr->m_New.m_A2;
+    Cntrl->m_A1 = Ptr->m_New.m_A1;
+    Cntrl->m_K  = Ptr->m_New.m_K;
+    Cntrl->m_U1 = Ptr->m_UPreset;
+    Cntrl->m_U2 = Ptr->m_UPreset;
+    Cntrl->m_E0 = 0;
+    Cntrl->m_E1 = 0;
+    Cntrl->m_E2 = 0;
+    Ptr->m_State = TUNE_IDLE;
+}
+
+
+/******************************************************************************
+* FUNCTION      : TUNE_term
+* DESCRIPTION   :
+* Phase and magnitude at W radians per sample of the term 1 - R.z^-1.
+******************************************************************************/
+static float TUNE_term( float R, float W, float* Mag )
+{
+    float Re = 1.0f - R*cosf( W );
+    float Im = R*sinf( W );
+
+    *Mag = sqrtf( Re*Re + Im*Im );
+    return atan2f( Im, Re );
+}
+
+
+/******************************************************************************
+* FUNCTION      : TUNE_comp
+* DESCRIPTION   :
+* Phase and magnitude at W of the compensator with Kc = 1.
+******************************************************************************/
+static float TUNE_comp( float Z0, float P, float W, float* Mag )
+{
+    float Mz, Mi, Mp, Ph;
+
+    Ph   = 2.0f*TUNE_term( Z0, W, &Mz ) - TUNE_term( 1.0f, W, &Mi )
+         - TUNE_term( P, W, &Mp );
+    *Mag = Mz*Mz / (Mi*Mp);
+    return Ph;
+}
+
+
+/******************************************************************************
+* FUNCTION      : TUNE_design
+* DESCRIPTION   :
+* Calculates the coefficients from the relay measurement. Returns a
+* TUNE_Error.
+*
+* With hysteresis h and oscillation amplitude a the relay describing function
+* places the stage at |G| = pi.a/(4.d) with phase -180 + asin(h/a) degrees at
+* the oscillation frequency wu. The model G(s) = kI/s.exp(-s.tau) is fitted to
+* that point and evaluated at the cross over.
+******************************************************************************/
+static int TUNE_design( TUNE_Data* Ptr )
+{
+    float A, Wu, Gu, Tau, Wc, Gc, PhG, P, Z0, Lo, Hi, Mag, Kc;
+    int   i;
+
+    A  = Ptr->m_SumAmp * 0.5f / Ptr->m_Done;
+    if( A <= Ptr->m_Hyst )
+    {
+        return TUNE_ERR_AMPLITUDE;
+    }
+    Ptr->m_Tu = Ptr->m_SumPeriod * Ptr->m_Ts / Ptr->m_Done;
+    Gu  = TUNE_PI * A / (4.0f * Ptr->m_D);
+    Ptr->m_Ku = 1.0f / Gu;
+    Wu  = 2.0f * TUNE_PI / Ptr->m_Tu;
+    Tau = (0.5f*TUNE_PI - asinf( Ptr->m_Hyst / A )) / Wu;
+
+    Wc  = 2.0f * TUNE_PI * Ptr->m_Fc;
+    if( Wc >= Wu )
+    {
+        return TUNE_ERR_CROSSOVER;
+    }
+    Gc  = Gu * Wu / Wc;
+    PhG = -0.5f*TUNE_PI - Wc*Tau;
+
+    /* The phase rises with z0, so bisect for the wanted margin */
+    P  = expf( -2.0f * TUNE_PI * Ptr->m_Fp * Ptr->m_Ts );
+    Wc = Wc * Ptr->m_Ts;
+    Lo = 0.0f;
+    Hi = 0.999f;
+    if( TUNE_comp( Hi, P, Wc, &Mag ) + PhG <
+        (Ptr->m_Pm - 180.0f)*TUNE_PI/180.0f )
+    {
+        return TUNE_ERR_PHASE;
+    }
+    for( i = 0; i < TUNE_BISECT; i++ )
+    {
+        Z0 = 0.5f*(Lo + Hi);
+        if( TUNE_comp( Z0, P, Wc, &Mag ) + PhG
+            < (Ptr->m_Pm - 180.0f)*TUNE_PI/180.0f )
+        {
+            Lo = Z0;
+        }
+        else
+        {
+            Hi = Z0;
+        }
+    }
+    TUNE_comp( Z0, P, Wc, &Mag );
+    Kc = 1.0f / (Mag * Gc);
+
+    Ptr->m_A1 = 1.0f + P;
+    Ptr->m_A2 = -P;
+    Ptr->m_B0 = Kc / Ptr->m_K;
+    Ptr->m_B1 = -2.0f * Z0 * Kc / Ptr->m_K;
+    Ptr->m_B2 = Z0 * Z0 * Kc / Ptr->m_K;
+    if( fabsf( Ptr->m_B0 ) >= 32.0f || fabsf( Ptr->m_B1 ) >= 32.0f )
+    {
+        return TUNE_ERR_RANGE;
+    }
+    return TUNE_ERR_NONE;
+}
+
+
+/******************************************************************************
+* FUNCTION      : TUNE_process
+* DESCRIPTION   :
+* Called from the idle loop. When a relay experiment has finished it designs
+* the new coefficients and hands them to the ISR. Returns true when a new set
+* has been handed over.
+******************************************************************************/
+int TUNE_process( TUNE_Data* Ptr, CNTRL_2p2zData* Cntrl )
+{
+    if( Ptr->m_State != TUNE_CALC )
+    {
+        return false;
+    }
+
+    Ptr->m_Error = TUNE_design( Ptr );
+    if( Ptr->m_Error != TUNE_ERR_NONE )
+    {
+        Ptr->m_State = TUNE_FAIL;
+        return false;
+    }
+
+    CNTRL_2p2zInit( &Ptr->m_New, Cntrl->Ref.m_IQ,
+                    _IQ26(Ptr->m_A1), _IQ26(Ptr->m_A2), _IQ26(Ptr->m_B0),
+                    _IQ26(Ptr->m_B1), _IQ26(Ptr->m_B2), _IQ23(Ptr->m_K),
+                    Cntrl->m_min, Cntrl->m_max );
+
+    /* Out = K.u in DAC counts and u is _iq24 scaled by 2^-15, see the 2p2z */
+    Ptr->m_UPreset = (_iq24)(((int64_t)Ptr->m_Bias << 32) / Ptr->m_New.m_K);
+    Ptr->m_State   = TUNE_LOAD;
+    return true;
+}
@@ -0,0 +1,176 @@
+/*******************************************************************************
+* FILE          : tune.h
+* AUTHOR        : digital-buck-converter contributors
+* PROJECT       : Piccolo B Buck Converter Peak Current Mode Control
+* DESCRIPTION   :
+* Relay feedback autotuner for the 2p2z controller.
+*
+* While tuning, TUNE_relay() is called by the control ISR in place of
+* CNTRL_2p2z(). It sets the comparator DAC to m_Bias +/- m_D according to the
+* sign of the voltage error, with +/-m_Hyst counts of hysteresis, which drives
+* the loop into a limit cycle at the frequency where the power stage has about
+* 180 degrees of phase lag. The period and the peak to peak amplitude of the
+* feedback are averaged over m_Periods cycles of the oscillation, after m_Skip
+* cycles have been allowed to settle.
+*
+* The ISR then goes back to CNTRL_2p2z() with the old coefficients while
+* TUNE_process() works in the idle loop. The describing function of the relay
+* gives one point of the frequency response, through which an integrator plus
+* dead time model of the stage is fitted, and the compensator
+*
+*   C(z) = Kc.(1 - z0.z^-1)^2 / ((1 - z^-1).(1 - p.z^-1))
+*
+* is designed for the wanted cross over frequency and phase margin, as in
+* tools/ident_design.c. The coefficients are put into CNTRL_2p2zData format by
+* CNTRL_2p2zInit() on a scratch structure and TUNE_update() in the ISR copies
+* them into the live controller between two control cycles, with the history
+* preset so that the output carries on from m_Bias.
+*
+* The cross over must be below the oscillation frequency. The design is in
+* floating point and takes a few ms in the idle loop; the relay experiment
+* itself lasts a few hundred switching cycles, so a complete tune takes well
+* under a second. Cost in the ISR:
+*
+*   TUNE_relay()    ~30 cycles, instead of CNTRL_2p2z() (64 cycles)
+*   TUNE_update()   ~3 cycles, ~60 cycles on the cycle the new set is loaded
+*
+* These are counted from the instruction sequence, see doc/timing.txt.
+*
+* EXAMPLES
+*   TUNE_Data MyTune;
+*
+*   interrupt void IsrAdc( void )
+*   {
+*       MyCntrl.Fdbk.m_Int = ADC_getValue( ADC_MOD_1 );
+*       if( TUNE_isRelay( &MyTune ) )
+*           TUNE_relay( &MyTune, &MyCntrl );
+*       else
+*           CNTRL_2p2z( &MyCntrl );
+*       CMP_setDac( CMP_MOD_2, MyCntrl.Out.m_Int );
+*       TUNE_update( &MyTune, &MyCntrl );
+*   }
+*
+*   TUNE_init( &MyTune, PERIOD_NS, 10e3, 45.0, 50e3, 0.5 );
+*   TUNE_start( &MyTune, MyCntrl.Out.m_Int, 40, 2, 4, 16 );
+*   while( 1 )
+*   {
+*       TUNE_process( &MyTune, &MyCntrl );
+*   }
+*
+* HISTORY       :
+*******************************************************************************/
+
+
+#ifndef _TUNE_H
+#define _TUNE_H
+
+/********** INCLUDES GLOBAL SECTION *******************************************/
+
+
+/********** FORWARD REFERENCES SECTION ****************************************/
+typedef struct  TUNE_Data       TUNE_Data;
+
+/********** TYPES SECTION *****************************************************/
+
+/*******************************************************************************
+* ENUM          : TUNE_State
+* DESCRIPTION   :
+* TUNE_RELAY is set by TUNE_start(), TUNE_CALC and TUNE_IDLE by the ISR,
+* TUNE_LOAD by TUNE_process() and TUNE_FAIL by either.
+*******************************************************************************/
+typedef enum
+{
+    TUNE_IDLE = 0,      /* normal control */
+    TUNE_RELAY,         /* relay experiment running in the ISR */
+    TUNE_CALC,          /* experiment complete, design pending */
+    TUNE_LOAD,          /* new coefficients waiting for the ISR */
+    TUNE_FAIL           /* no usable oscillation or design, see m_Error */
+} TUNE_State;
+
+/*******************************************************************************
+* ENUM          : TUNE_Error
+* DESCRIPTION   :
+*******************************************************************************/
+typedef enum
+{
+    TUNE_ERR_NONE = 0,
+    TUNE_ERR_TIMEOUT,       /* no steady oscillation within m_Timeout cycles */
+    TUNE_ERR_AMPLITUDE,     /* oscillation smaller than the hysteresis */
+    TUNE_ERR_CROSSOVER,     /* cross over not below the oscillation */
+    TUNE_ERR_PHASE,         /* phase margin not possible at the cross over */
+    TUNE_ERR_RANGE          /* coefficients outside the _iq26 range */
+} TUNE_Error;
+
+/*******************************************************************************
+* STRUCT        : TUNE_Data
+* DESCRIPTION   :
+* The autotuner structure. m_Ku, m_Tu and m_A1..m_B2 hold the results of the
+* last successful tune for inspection in the debugger.
+*******************************************************************************/
+struct TUNE_Data
+{
+    volatile int    m_State;
+    int             m_Error;
+
+    /* relay, ISR side */
+    int             m_Bias;
+    int             m_D;
+    int             m_Hyst;
+    int             m_High;
+    int             m_Ymax;
+    int             m_Ymin;
+    int             m_Count;
+    int             m_Skip;
+    int             m_Periods;
+    int             m_Done;
+    uint32_t        m_SumPeriod;
+    uint32_t        m_SumAmp;
+    uint32_t        m_Timeout;
+
+    /* design, idle loop side */
+    float           m_Ts;
+    float           m_Fc;
+    float           m_Pm;
+    float           m_Fp;
+    float           m_K;
+    float           m_Ku;
+    float           m_Tu;
+    float           m_A1;
+    float           m_A2;
+    float           m_B0;
+    float           m_B1;
+    float           m_B2;
+    CNTRL_2p2zData  m_New;
+    _iq24           m_UPreset;
+};
+
+
+/********** PROTOTYPES SECTIONS ***********************************************/
+
+/* public methods */
+extern void TUNE_init( TUNE_Data* Ptr, uint32_t PeriodNs, float Fc, float Pm,
+                       float Fp, float K );
+extern void TUNE_start( TUNE_Data* Ptr, int Bias, int D, int Hyst, int Skip,
+                        int Periods );
+extern void TUNE_relay( TUNE_Data* Ptr, CNTRL_2p2zData* Cntrl );
+extern void TUNE_load( TUNE_Data* Ptr, CNTRL_2p2zData* Cntrl );
+extern int  TUNE_process( TUNE_Data* Ptr, CNTRL_2p2zData* Cntrl );
+
+/*******************************************************************************
+* MACRO         : TUNE_isRelay
+* DESCRIPTION   :
+* True while the relay experiment replaces the controller.
+*******************************************************************************/
+#define TUNE_isRelay( Ptr )     ((Ptr)->m_State == TUNE_RELAY)
+
+/*******************************************************************************
+* MACRO         : TUNE_update
+* DESCRIPTION   :
+* Called by the ISR after the controller has run. Loads a new coefficient set
+* when one is waiting.
+*******************************************************************************/
+#define TUNE_update( Ptr, Cntrl ) \
+    do { if( (Ptr)->m_State == TUNE_LOAD ) TUNE_load( Ptr, Cntrl ); } while( 0 )
+
+/********** END ***************************************************************/
+#endif